@@ -430,7 +430,7 @@ static void render(void)
             colors[i] = k_celltype_colors[g_draw3d.astar_world.cells[i]];
         }
 
-        the_3d->debug.draw_boxes(boxes, GRID_WIDTH * GRID_HEIGHT, &viewproj, RIZZ_3D_DEBUG_MAPTYPE_CHECKER, colors);
+        the_3d->debug.queue_boxes(boxes, GRID_WIDTH * GRID_HEIGHT, RIZZ_3D_DEBUG_MAPTYPE_CHECKER, colors);
     }
 
     // draw path lines
@@ -442,10 +442,13 @@ static void render(void)
             for (int i = 0; i < count; i++)
                 line[i] = sx_vec3v2(agent->path.array[i], 0.5f);
 
-            the_3d->debug.draw_path(line, count, &viewproj, agent->color);
+            the_3d->debug.queue_path(line, count, agent->color);
         }
     }
 
+    // cells and paths are merged into two draw calls
+    the_3d->debug.flush(&viewproj);
+
     // model
     const rizz_model* model = the_3d->model.get(g_draw3d.agent_model);
     draw3d_vertex_shader_uniforms vs_uniforms = { .viewproj_mat = viewproj };
@@ -177,6 +177,14 @@ typedef struct rizz_font_load_params {
     int atlas_width;
     int atlas_height;
     bool ignore_dpiscale;
+
+    // signed-distance-field mode: glyphs are rasterized once at `sdf_size` (on job threads) and
+    // scaled to any font size in the shader, instead of one bitmap glyph per size/blur.
+    // draw/batch_draw/bounds use sdf glyphs, blur is ignored. iter_xxx functions still return
+    // fontstash bitmap quads
+    bool sdf;
+    float sdf_size;      // reference size in pixels (default: 48)
+    int sdf_padding;     // distance range around glyphs in pixels (default: 6)
 } rizz_font_load_params;
 
 typedef enum {
@@ -237,6 +245,19 @@ typedef struct rizz_font_quad {
     rizz_font_vertex v1;
 } rizz_font_quad;
 
+// stats of batched font drawing, collected between two `batch_flush` calls
+typedef struct rizz_font_batch_stats {
+    int num_draws;       // draw calls submitted by batch_flush
+    int num_glyphs;      // glyphs drawn with batch_draw
+    int num_layouts;     // number of text layouts in the cache (all fonts)
+    int cache_hits;      // batch_draw calls that reused a cached layout
+    int cache_misses;    // batch_draw calls that had to layout the text
+    float draw_ms;       // CPU time spent in batch_draw calls
+    float flush_ms;      // CPU time spent in batch_flush
+    int num_atlas_updates;    // atlas texture uploads (all fonts)
+    int atlas_bytes;          // memory of all font atlas textures
+} rizz_font_batch_stats;
+
 typedef struct rizz_font {
     int img_width;
     int img_height;
@@ -275,6 +296,16 @@ typedef struct rizz_api_2d
 
         rizz_font_iter (*iter_init)(const rizz_font* fnt, sx_vec2 pos, const char* text);
         bool (*iter_next)(const rizz_font* fnt, rizz_font_iter* iter, rizz_font_quad* quad);
+
+        // batched drawing: text layouts are cached by font state (size/align/spacing/blur) and
+        // string, glyphs are collected per font until `batch_flush`, which submits them with one
+        // draw per font atlas (split only when view-proj matrix or scissor changes between calls)
+        // `batch_flush` should be called once per frame within a render pass, after batch_draw calls
+        // positions are snapped to whole pixels
+        void (*batch_draw)(const rizz_font* fnt, sx_vec2 pos, const char* text);
+        void (*batch_drawf)(const rizz_font* fnt, sx_vec2 pos, const char* fmt, ...);
+        void (*batch_flush)(void);
+        void (*batch_stats)(rizz_font_batch_stats* stats);
     } font;
 
     struct {
@@ -286,6 +317,9 @@ typedef struct rizz_api_2d
 
         // atlas
         const rizz_atlas* (*atlas_get)(rizz_asset atlas_asset);
+        // writes a loaded atlas to a baked binary file (.ratlas) that loads without json parsing
+        // the atlas image is referenced by its full vfs path, so the baked file can be put anywhere
+        bool (*atlas_bake)(rizz_asset atlas_asset, const char* filepath);
 
         // property accessors
         sx_vec2 (*size)(rizz_sprite spr);
@@ -333,6 +367,8 @@ typedef struct rizz_api_2d
         rizz_sprite_animclip (*animclip_clone)(rizz_sprite_animclip clip);
     
         void (*animclip_update)(rizz_sprite_animclip clip, float dt);
+        // clips of a batch are updated in parallel, so a clip must appear only once in `clips`
+        // batches in creation order (neighbour handles) are the fastest to update
         void (*animclip_update_batch)(const rizz_sprite_animclip* clips, int num_clips, float dt);
 
         float (*animclip_fps)(rizz_sprite_animclip clip);
@@ -348,6 +384,8 @@ typedef struct rizz_api_2d
         rizz_sprite_animctrl (*animctrl_create)(const rizz_sprite_animctrl_desc* desc);
         void (*animctrl_destroy)(rizz_sprite_animctrl ctrl);
         void (*animctrl_update)(rizz_sprite_animctrl ctrl, float dt);
+        // the current clips of `ctrls` are updated with animclip_update_batch, so controllers of a
+        // batch must be unique and must not share clips
         void (*animctrl_update_batch)(const rizz_sprite_animctrl* ctrls, int num_ctrls, float dt);
 
         void (*animctrl_set_paramb)(rizz_sprite_animctrl ctrl, const char* name, bool b);
@@ -32,6 +32,15 @@ typedef struct rizz_3d_debug_line {
     sx_vec3 p1;
 } rizz_3d_debug_line;
 
+// per-frame counters, including both immediate (draw_xxx) and deferred (queue_xxx) calls
+typedef struct rizz_3d_debug_stats {
+    int num_primitives;    // number of shapes/lines/paths submitted
+    int num_draws;         // number of draw calls issued
+    int num_instances;
+    int num_verts;
+    int num_indices;
+} rizz_3d_debug_stats;
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // @material
 typedef struct rizz_material_texture {
@@ -141,22 +150,61 @@ typedef struct rizz_model_geometry_layout {
     int buffer_strides[SG_MAX_SHADERSTAGE_BUFFERS];
 } rizz_model_geometry_layout;
 
+#define RIZZ_MODEL_MAX_LODS 4
+
+// import-time mesh optimizations, applied to glTF models only (baked models are stored optimized)
+typedef enum rizz_model_optimize_flags_ {
+    RIZZ_MODEL_OPTIMIZE_NONE = 0,
+    RIZZ_MODEL_OPTIMIZE_VERTEX_CACHE = 0x1,    // reorder triangles for post-transform vertex cache
+    RIZZ_MODEL_OPTIMIZE_OVERDRAW = 0x2,        // reorder triangle clusters to reduce overdraw
+    RIZZ_MODEL_OPTIMIZE_VERTEX_FETCH = 0x4,    // reorder vertices by first use, remove unused vertices
+    RIZZ_MODEL_OPTIMIZE_ALL = 0x7
+} rizz_model_optimize_flags_;
+typedef uint32_t rizz_model_optimize_flags;
+
 // provide this for loading "model" asset
 // if layout is zero initialized, default layout will be used (same as rizz_prims3d_vertex):
 //      buffer #1: position/normal/uv/color
 //      if you, leave ibuff_usage/vbuff_usage = default (=0), no gpu buffers will be created
+// vertex attributes are quantized to the formats declared in the layout, for example:
+//      NORMAL/TANGENT: SG_VERTEXFORMAT_BYTE4N, TEXCOORD: SG_VERTEXFORMAT_SHORT2N, COLOR: SG_VERTEXFORMAT_UBYTE4N
+//      normalized formats are clamped to [-1, 1] (signed) or [0, 1] (unsigned)
+// num_lods: number of simplified LODs that are generated for each submesh (max = RIZZ_MODEL_MAX_LODS-1)
+//           each LOD has `lod_ratio` times the triangles of the previous one (default = 0.5)
 typedef struct rizz_model_load_params {
     rizz_model_geometry_layout layout;
     sg_usage vbuff_usage;
     sg_usage ibuff_usage;
+    rizz_model_optimize_flags optimize_flags;
+    int num_lods;
+    float lod_ratio;
 } rizz_model_load_params;
 
+// LODs index into the same vertex buffer of the mesh
+typedef struct rizz_model_lod {
+    int start_index;
+    int num_indices;
+} rizz_model_lod;
+
 typedef struct rizz_model_submesh {
     int start_index;
     int num_indices;
     rizz_material mtl;
+    int num_lods;                               // lods[0] is the full detail submesh (start_index/num_indices)
+    rizz_model_lod lods[RIZZ_MODEL_MAX_LODS];
 } rizz_model_submesh;
 
+// import stats of the mesh, before (src_) and after optimization
+// acmr: average cache miss ratio (vertex transforms per triangle), simulated on a 16 entry FIFO cache
+typedef struct rizz_model_mesh_stats {
+    int src_num_indices;
+    int num_indices;
+    float src_acmr;
+    float acmr;
+    int src_vertex_bytes;
+    int vertex_bytes;
+} rizz_model_mesh_stats;
+
 typedef struct rizz_model_mesh {
     char name[32];
     int num_submeshes;
@@ -165,6 +213,7 @@ typedef struct rizz_model_mesh {
     int num_vbuffs;
     sg_index_type index_type;
     rizz_model_submesh* submeshes;
+    rizz_model_mesh_stats stats;
 
     struct cpu_t {
         void* vbuffs[SG_MAX_SHADERSTAGE_BUFFERS];      // arbitary struct for each vbuff (count=num_vbuffs)
@@ -204,6 +253,12 @@ typedef struct rizz_model {
     rizz_material_lib* mtllib;
 } rizz_model;
 
+// flattened transform hierarchy for instances of a model
+// nodes are sorted by depth, so parents are always updated before their children. local/world
+// transforms and bounds are stored in separate arrays per instance and are indexed by node_id
+// only dirty nodes (and their subtrees) are recomputed on update, instances are updated in parallel
+typedef struct rizz_3d_hierarchy rizz_3d_hierarchy;
+
 typedef struct rizz_api_3d 
 {
     struct {
@@ -249,13 +304,57 @@ typedef struct rizz_api_3d
         void (*set_max_instances)(int max_instances);
         void (*set_max_vertices)(int max_verts);
         void (*set_max_indices)(int max_indices);
+
+        // deferred drawing: queue_xxx functions are thread-safe and can be called from any job
+        // thread during the frame. queued primitives are merged by pipeline/shape and drawn with a
+        // few instanced draws on `flush`, which must be called within a render pass
+        // wireframe primitives (aabbs/lines/paths/axis) are all merged into a single line-list draw
+        // solid/alpha-blended shapes are split automatically by tint alpha
+        void (*queue_boxes)(const sx_box* boxes, int num_boxes, rizz_3d_debug_map_type map_type,
+                            const sx_color* tints);
+        void (*queue_spheres)(const sx_vec3* centers, const float* radiuss, int count,
+                              rizz_3d_debug_map_type map_type, const sx_color* tints);
+        void (*queue_cones)(const float* radiuss, const float* depths, const sx_tx3d* txs, int count,
+                            const sx_color* tints);
+        void (*queue_aabbs)(const sx_aabb* aabbs, int num_aabbs, const sx_color* tints);
+        void (*queue_lines)(int num_lines, const rizz_3d_debug_line* lines, const sx_color* colors);
+        void (*queue_path)(const sx_vec3* points, int num_points, sx_color color);
+        void (*queue_axis)(const sx_mat4* mat, float scale);
+        void (*flush)(const sx_mat4* viewproj_mat);
+        void (*get_stats)(rizz_3d_debug_stats* stats);
     } debug;
 
     struct {
         const rizz_model* (*get)(rizz_asset model_asset);
         void (*set_material_lib)(rizz_material_lib* mtllib);
+
+        // writes a loaded model to a baked binary file (.rmdl), which loads with a single copy and
+        // pointer fixups instead of parsing glTF. baked files must be loaded with the same geometry
+        // layout (rizz_model_load_params.layout) as the source model
+        bool (*bake)(rizz_asset model_asset, const char* filepath);
     } model;
 
+    struct {
+        // model must be kept alive while the hierarchy is in use
+        rizz_3d_hierarchy* (*create)(const rizz_model* model, int init_capacity, const sx_alloc* alloc);
+        void (*destroy)(rizz_3d_hierarchy* h);
+
+        // adding instances and setting transforms are not thread-safe, returns instance index
+        int (*add_instance)(rizz_3d_hierarchy* h, const sx_tx3d* root_tx);
+        int (*num_instances)(const rizz_3d_hierarchy* h);
+        void (*set_root_tx)(rizz_3d_hierarchy* h, int instance, const sx_tx3d* root_tx);
+        void (*set_local_tx)(rizz_3d_hierarchy* h, int instance, int node_id, const sx_tx3d* local_tx);
+
+        // recomputes world transforms and bounds of dirty nodes, dispatches jobs and waits for them
+        // must be called from the main thread or a job thread
+        void (*update)(rizz_3d_hierarchy* h);
+
+        // results are valid after `update`, arrays are indexed by node_id (count = model->num_nodes)
+        const sx_tx3d* (*world_txs)(const rizz_3d_hierarchy* h, int instance);
+        const sx_aabb* (*world_bounds)(const rizz_3d_hierarchy* h, int instance);
+        sx_aabb (*instance_bounds)(const rizz_3d_hierarchy* h, int instance);
+    } hierarchy;
+
     struct {
         rizz_material_lib* (*create_lib)(const sx_alloc* alloc, int init_capacity);
         void (*destroy_lib)(rizz_material_lib* lib);
@@ -22,8 +22,31 @@ typedef struct rizz_astar_path {
     /* sx_array */ sx_vec2* array;
 } rizz_astar_path;
 
+// flow-field: integration (cost-to-goal) and direction fields of the whole world for a single goal
+// useful when many units share the same destination, instead of calling findpath for each unit
+typedef struct { uint32_t id; } rizz_astar_flowfield;
+
 typedef struct rizz_api_astar {
     void (*set_maxsearch)(uint32_t value);
     bool (*findpath)(const rizz_astar_world* world, const rizz_astar_agent* agent, sx_vec2 start,
                   sx_vec2 end, rizz_astar_path* path);
+
+    // flowfield_get: returns a flow-field for the world/agent/goal combination. fields are cached
+    //                and ref-counted, so requesting the same goal (same cell) again returns the same
+    //                field. build is done in parallel over tiles with job threads. (not thread-safe)
+    // flowfield_release: decreases ref-count and frees the field when it reaches zero
+    // flowfield_dir: returns normalized direction to the next cell towards the goal, or zero vector
+    //                if the position is at the goal or unreachable. fields are rebuilt in place on
+    //                update, so call it from the main thread, or from jobs that are finished before
+    //                the next update of astar plugin
+    // flowfield_cost: returns integrated cost from position to the goal, -1 if unreachable
+    // invalidate_cells: call this when you change `world->cells` in the given rectangle (in cells).
+    //                   fields that are affected by the change are rebuilt on the next frame or
+    //                   the next `flowfield_get` call
+    rizz_astar_flowfield (*flowfield_get)(const rizz_astar_world* world,
+                                          const rizz_astar_agent* agent, sx_vec2 goal);
+    void (*flowfield_release)(rizz_astar_flowfield field);
+    sx_vec2 (*flowfield_dir)(rizz_astar_flowfield field, sx_vec2 pos);
+    int (*flowfield_cost)(rizz_astar_flowfield field, sx_vec2 pos);
+    void (*invalidate_cells)(const rizz_astar_world* world, int x, int y, int width, int height);
 } rizz_api_astar;
\ No newline at end of file
@@ -108,8 +108,25 @@
 #    define RIZZ_CONFIG_ASSET_POOL_SIZE 256
 #endif
 
+// Initial capacity of http requests, also the maximum number of open http connections
 #ifndef RIZZ_CONFIG_MAX_HTTP_REQUESTS
-#    define RIZZ_CONFIG_MAX_HTTP_REQUESTS 32
+#    define RIZZ_CONFIG_MAX_HTTP_REQUESTS 256
+#endif
+
+// Maximum number of simultaneous keep-alive connections to a single host
+#ifndef RIZZ_CONFIG_HTTP_MAX_HOST_CONNECTIONS
+#    define RIZZ_CONFIG_HTTP_MAX_HOST_CONNECTIONS 8
+#endif
+
+// Downloads are written and checksummed in chunks of this size, it's also the resume granularity
+#ifndef RIZZ_CONFIG_HTTP_DOWNLOAD_CHUNK_SIZE
+#    define RIZZ_CONFIG_HTTP_DOWNLOAD_CHUNK_SIZE 1048576
+#endif
+
+// Maximum number of download chunks that are waiting to be written, per download
+// receiving is paused when reached, so memory usage of each download is bounded
+#ifndef RIZZ_CONFIG_HTTP_DOWNLOAD_MAX_CHUNKS
+#    define RIZZ_CONFIG_HTTP_DOWNLOAD_MAX_CHUNKS 4
 #endif
 
 #ifndef RIZZ_CONFIG_DEBUG_MEMORY
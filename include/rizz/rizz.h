@@ -503,6 +503,25 @@ typedef enum rizz_camera_view_plane {
     _RIZZ_CAMERA_VIEWPLANE_COUNT
 } rizz_camera_view_plane;
 
+// SoA bounds for `cull_spheres_soa` and `cull_aabbs_soa`, every array holds `count` floats and must be
+// 16 byte aligned. keep them next to your objects and update them when objects move, so the culler
+// loads 4 objects per register instead of gathering them from the AoS layout
+typedef struct rizz_camera_spheres_soa {
+    const float* x;
+    const float* y;
+    const float* z;
+    const float* r;
+} rizz_camera_spheres_soa;
+
+typedef struct rizz_camera_aabbs_soa {
+    const float* xmin;
+    const float* ymin;
+    const float* zmin;
+    const float* xmax;
+    const float* ymax;
+    const float* zmax;
+} rizz_camera_aabbs_soa;
+
 typedef struct rizz_api_camera {
     void (*init)(rizz_camera* cam, float fov_deg, sx_rect viewport, float fnear, float ffar);
     void (*lookat)(rizz_camera* cam, sx_vec3 pos, sx_vec3 target, sx_vec3 up);
@@ -513,6 +532,23 @@ typedef struct rizz_api_camera {
     void (*calc_frustum_points)(const rizz_camera* cam, sx_vec3 frustum[8]);
     void (*calc_frustum_points_range)(const rizz_camera* cam, sx_vec3 frustum[8], float fnear, float ffar);
     void (*calc_frustum_planes)(sx_plane frustum[_RIZZ_CAMERA_VIEWPLANE_COUNT], const sx_mat4* viewproj_mat);
+
+    // batched frustum culling against the planes from `calc_frustum_planes`, objects are tested 4 at a 
+    // time with SIMD and big batches are split between job threads (call from main or job threads)
+    //   visibility (optional): visibility bitmask, one bit per object. needs (count+31)/32 words
+    //   visible_indices (optional): compacted list of visible object indices. needs `count` items
+    // returns the number of visible objects
+    int (*cull_spheres)(const sx_plane frustum[_RIZZ_CAMERA_VIEWPLANE_COUNT], const sx_vec3* centers,
+                        const float* radiuss, int count, uint32_t* visibility, int* visible_indices);
+    int (*cull_aabbs)(const sx_plane frustum[_RIZZ_CAMERA_VIEWPLANE_COUNT], const sx_aabb* aabbs, int count,
+                      uint32_t* visibility, int* visible_indices);
+    // same as above, but takes SoA bounds (see rizz_camera_spheres_soa), which is the faster path
+    int (*cull_spheres_soa)(const sx_plane frustum[_RIZZ_CAMERA_VIEWPLANE_COUNT],
+                            const rizz_camera_spheres_soa* spheres, int count, uint32_t* visibility,
+                            int* visible_indices);
+    int (*cull_aabbs_soa)(const sx_plane frustum[_RIZZ_CAMERA_VIEWPLANE_COUNT],
+                          const rizz_camera_aabbs_soa* aabbs, int count, uint32_t* visibility,
+                          int* visible_indices);
     void (*fps_init)(rizz_camera_fps* cam, float fov_deg, sx_rect viewport, float fnear, float ffar);
     void (*fps_lookat)(rizz_camera_fps* cam, sx_vec3 pos, sx_vec3 target, sx_vec3 up);
     void (*fps_pitch)(rizz_camera_fps* cam, float pitch);
@@ -549,7 +585,8 @@ enum rizz_core_flags_ {
     RIZZ_CORE_FLAG_DETECT_LEAKS = 0x10,         // Detect memory leaks (default on in _DEBUG builds)
     RIZZ_CORE_FLAG_HEAP_TEMP_ALLOCATOR = 0x20,  // Replace temp allocator backends with heap, so we can better trace out-of-bounds and corruption
     RIZZ_CORE_FLAG_HOT_RELOAD_PLUGINS = 0x40,   // Enables hot reloading for all modules and plugins including the game itself
-    RIZZ_CORE_FLAG_TRACE_TEMP_ALLOCATOR = 0x80  // Enable memory tracing on temp allocators, slows them down, but provides more insight on temp allocations
+    RIZZ_CORE_FLAG_TRACE_TEMP_ALLOCATOR = 0x80, // Enable memory tracing on temp allocators, slows them down, but provides more insight on temp allocations
+    RIZZ_CORE_FLAG_LOG_BINARY = 0x100           // Write compact binary log to `app_name.rlog`, decode with `--decode-log`
 };
 typedef uint32_t rizz_core_flags;
 
@@ -596,6 +633,7 @@ typedef struct rizz_config {
     sg_filter texture_filter_min;   // default = SG_FILTER_LINEAR_MIP_LINEAR
     sg_filter texture_filter_mag;   // default = SG_FILTER_LINEAR
     int texture_aniso;              // default = 0, texture anisotropy quality              
+    int texture_stream_budget;      // default = 0 (unlimited), video memory budget of streamed textures (in megabytes)
 
     rizz_app_event_cb* event_cb;
 
@@ -700,6 +738,15 @@ typedef struct rizz_api_core {
                          void* (*init_cb)(int thread_idx, uint32_t thread_id, void* user));
     void* (*tls_var)(const char* name);
 
+    // Slot versions of the TLS functions, prefer these for variables that are fetched frequently
+    // tls_register_slot: same as `tls_register`, but returns a slot Id (>0) for `tls_slot` (not thread-safe)
+    //                    registering the same name again returns the same slot, returns 0 on failure
+    // tls_slot: gets pointer to variable by it's slot, there is no name lookup (thread-safe)
+    //           returns NULL if the slot is invalid
+    int (*tls_register_slot)(const char* name, void* user,
+                             void* (*init_cb)(int thread_idx, uint32_t thread_id, void* user));
+    void* (*tls_slot)(int slot);
+
     sx_alloc* (*trace_alloc_create)(const char* name, rizz_mem_options mem_opts, const char* parent, const sx_alloc* alloc);
     void (*trace_alloc_destroy)(sx_alloc* alloc);
     void (*trace_alloc_clear)(sx_alloc* alloc);
@@ -743,6 +790,24 @@ typedef struct rizz_api_core {
     void (*coro_wait)(void* pfrom, int msecs);
     void (*coro_yield)(void* pfrom, int nframes);
 
+    // awaitables: suspend the coroutine until the result is ready, the coroutine is not updated while
+    //             it's suspended. subsystems resume it when the work completes (no per-frame polling),
+    //             and it continues in the next coroutine update, which runs every frame after the
+    //             engine subsystems (asset, vfs, http) are updated and before plugins are updated
+    //             returns immediately if the result is already available
+    // coro_await_asset: waits for the asset to finish loading, returns the final state
+    // coro_await_group: waits for all assets in the group to finish loading
+    // coro_await_job:   waits for the job to finish, the job is deleted afterwards
+    // coro_await_read:  reads the file asynchronously (vfs.read_async), returns the data or NULL on failure
+    //                   returned memory must be freed by `sx_mem_destroy_block`
+    // coro_await_http:  waits for the http request (created by http.get/post) to complete
+    rizz_asset_state (*coro_await_asset)(void* pfrom, rizz_asset asset);
+    void (*coro_await_group)(void* pfrom, rizz_asset_group group);
+    void (*coro_await_job)(void* pfrom, sx_job_t job);
+    sx_mem_block* (*coro_await_read)(void* pfrom, const char* path, rizz_vfs_flags flags,
+                                     const sx_alloc* alloc);
+    const struct rizz_http_state* (*coro_await_http)(void* pfrom, rizz_http handle);
+
     void (*register_log_backend)(const char* name,
                                  void (*log_cb)(const rizz_log_entry* entry, void* user), void* user);
     void (*unregister_log_backend)(const char* name);
@@ -802,6 +867,12 @@ typedef struct rizz_api_core {
 #define rizz_coro_yieldn(_n)             (RIZZ_CORE_API_VARNAME)->coro_yield(&__transfer.from, (_n))
 #define rizz_coro_end()                  (RIZZ_CORE_API_VARNAME)->coro_end(&__transfer.from)
 #define rizz_coro_invoke(_name, _user)   (RIZZ_CORE_API_VARNAME)->coro_invoke(coro__##_name, (_user))
+#define rizz_coro_await_asset(_asset)    (RIZZ_CORE_API_VARNAME)->coro_await_asset(&__transfer.from, (_asset))
+#define rizz_coro_await_group(_group)    (RIZZ_CORE_API_VARNAME)->coro_await_group(&__transfer.from, (_group))
+#define rizz_coro_await_job(_job)        (RIZZ_CORE_API_VARNAME)->coro_await_job(&__transfer.from, (_job))
+#define rizz_coro_await_read(_path, _flags, _alloc) \
+    (RIZZ_CORE_API_VARNAME)->coro_await_read(&__transfer.from, (_path), (_flags), (_alloc))
+#define rizz_coro_await_http(_http)      (RIZZ_CORE_API_VARNAME)->coro_await_http(&__transfer.from, (_http))
 
 // using these macros are preferred to begin_profile_sample() and end_profile_sample()
 // because They provide cache variables for name hashing and also somewhat emulates C++ RAII
@@ -963,6 +1034,8 @@ typedef struct rizz_texture_load_params {
     sg_pixel_format fmt;    // request image format. only valid for basis files
     int aniso;
     bool srgb;
+    bool stream;            // load the low-detail mips first and stream the rest on demand (2d dds/ktx only)
+                            // the sg_image of streamed textures changes with residency, always get it from texture_get
 } rizz_texture_load_params;
 
 // texture metadata
@@ -1020,6 +1093,14 @@ typedef struct rizz_gfx_trace_info {
 
     int64_t render_target_size;
     int64_t render_target_peak;
+
+    // texture streaming
+    int num_streamed_textures;
+    int num_stream_reads;               // in-flight mip reads
+    int64_t stream_resident_size;
+    int64_t stream_budget;              // =0 if unlimited
+    int64_t num_stream_ins;             // total number of mip upgrades
+    int64_t num_stream_evicts;          // total number of mip evictions
     // end: persistent stats
 } rizz_gfx_trace_info;
 
@@ -1289,6 +1370,15 @@ typedef struct rizz_api_gfx {
     void (*texture_default_quality)(sg_filter* min_filter, sg_filter* mag_filter, int* aniso, int* first_mip);
     uint32_t (*texture_surface_pitch)(sg_pixel_format fmt, uint32_t width, uint32_t height, uint32_t row_align);
 
+    // texture streaming: only affects textures that are loaded with `rizz_texture_load_params.stream`
+    // requests must be made on the main thread, each frame that the texture is visible.
+    // screen_size: largest dimension of the texture on the screen, in pixels.
+    //              it is converted to the mip level that has matching detail
+    // mip: most detailed mip that is needed, 0 is the full resolution (after first_mip)
+    void (*texture_stream_request)(rizz_asset texture_asset, float screen_size);
+    void (*texture_stream_request_mip)(rizz_asset texture_asset, int mip);
+    void (*texture_stream_set_budget)(int64_t budget_bytes);
+
     // info
     const rizz_gfx_trace_info* (*trace_info)(void);
 } rizz_api_gfx;
@@ -1477,26 +1567,46 @@ typedef struct rizz_http_state {
     void* response_data;
 } rizz_http_state;
 
+// cumulative counters since the start, sample them twice and take the difference
+typedef struct rizz_http_stats {
+    uint32_t num_connects;    // new connections to hosts
+    uint32_t num_reuses;      // requests sent over an existing keep-alive connection
+} rizz_http_stats;
+
 typedef void(rizz_http_cb)(const rizz_http_state* http, void* user);
+typedef void(rizz_http_progress_cb)(const char* url, int64_t downloaded, int64_t total, void* user);
 
 typedef struct rizz_api_http {
     const sx_alloc* (*alloc)(void);
     
-    // normal requests: returns immediately (async sockets)
-    // check `status_code` for retrieved http object to determine if it's finished or failed
+    // normal requests: returns immediately, requests are sent and received on a background thread
+    // connections to the same host are kept alive and reused between requests (http only, no https)
+    // check `status` for retrieved http object to determine if it's finished or failed
     // call `free` if http data is not needed any more. if not freed by the user, it will be freed
-    // when engine exits and throws a warning
+    // when engine exits and throws a warning. freeing a pending request cancels it
     rizz_http (*get)(const char* url);
     rizz_http (*post)(const char* url, const void* data, size_t size);
     void (*free)(rizz_http handle);
 
-    // return can be NULL (if it is not even started)
+    // status stays RIZZ_HTTP_PENDING until the response is received in the main thread
     const rizz_http_state* (*state)(rizz_http handle);
 
     // callback requests: triggers the callback when get/post is complete
     // NOTE: do not call `free` in the callback functions, the request will be freed automatically
     void (*get_cb)(const char* url, rizz_http_cb* callback, void* user);
     void (*post_cb)(const char* url, const void* data, size_t size, rizz_http_cb* callback, void* user);
+
+    // downloads: streams the response body into `filepath` (vfs path), without keeping it in memory
+    // data is written to "filepath.part" and checksums of each chunk to "filepath.partsum", the file
+    // is renamed to `filepath` when complete. if a previous download of the same url was interrupted,
+    // the valid part of the file is kept and the rest is requested with a Range header.
+    // `progress_cb` (optional) is called when a chunk is written, `total` is -1 if the size is unknown
+    // if `callback` is set, the request is freed automatically after it's called, like `get_cb`
+    // the state's `response_size` is the file size and `response_data` is always NULL
+    rizz_http (*download)(const char* url, const char* filepath, rizz_vfs_flags flags,
+                          rizz_http_progress_cb* progress_cb, rizz_http_cb* callback, void* user);
+
+    void (*get_stats)(rizz_http_stats* stats);
 } rizz_api_http;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
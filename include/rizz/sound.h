@@ -8,6 +8,9 @@
 //                            each of them.
 //                            Also, keep in mind that, the total lanes of all buses should not
 //                            exceed RIZZ_SND_DEVICE_MAX_LANES
+// RIZZ_SND_DEVICE_MAX_STREAMS: maximum number of streaming sound instances that can be decoded at
+//                              the same time
+// RIZZ_SND_STREAM_BUFFER_FRAMES: size of decoded (mono) ring-buffer for each streaming instance
 // NOTE: audio sources must be all mono. If they are something else they will be downmixed to mono
 //       on load time
 //
@@ -18,6 +21,8 @@
 #define RIZZ_SND_DEVICE_BUFFER_FRAMES 2048
 #define RIZZ_SND_DEVICE_MAX_LANES 32
 #define RIZZ_SND_DEVICE_MAX_BUSES 8
+#define RIZZ_SND_DEVICE_MAX_STREAMS 16
+#define RIZZ_SND_STREAM_BUFFER_FRAMES 16384
 
 // clang-format off
 typedef struct { uint32_t id; } rizz_snd_source;
@@ -29,8 +34,21 @@ typedef struct rizz_snd_load_params {
     float volume;
     bool looping;
     bool singleton;
+    bool stream;    // keep compressed data in memory and decode it on a worker thread while playing
+                    // recommended for long sounds like music tracks
 } rizz_snd_load_params;
 
+// cumulative counters since the sound system started, sample them twice and take the difference
+// to profile a period of time
+typedef struct rizz_snd_stats {
+    uint64_t mix_ticks;          // time spent in the mixer (sx_tm ticks)
+    int64_t mix_frames;          // device frames mixed
+    int64_t mix_voice_frames;    // sum of playing voices x frames, for every mix
+    uint64_t decode_ticks;       // time spent decoding streams on the stream thread (sx_tm ticks)
+    int64_t decoded_frames;      // device frames produced by stream decoders (after resampling)
+    int sample_rate;             // device sample-rate
+} rizz_snd_stats;
+
 // thread-safe queued API
 // this api is async and can be used in worker threads
 // all calls are queued for execution on sound-system update
@@ -55,6 +73,8 @@ typedef struct rizz_api_snd {
     void (*resume)(rizz_snd_instance inst);
 
     void (*bus_set_max_lanes)(int bus, int max_lanes);
+    void (*bus_set_volume)(int bus, float volume);
+    void (*bus_set_lowpass)(int bus, float cutoff);    // cutoff in Hz, 0 disables the filter
     void (*bus_stop)(int bus);
 
     float (*master_volume)(void);
@@ -72,5 +92,6 @@ typedef struct rizz_api_snd {
 
     rizz_snd_source (*source_get)(rizz_asset snd_asset);
 
+    void (*get_stats)(rizz_snd_stats* stats);
     void (*show_debugger)(bool* p_open);
 } rizz_api_snd;
\ No newline at end of file
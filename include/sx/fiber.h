@@ -83,6 +83,18 @@
 //                                 In the game this should be called on each frame
 //      sx_coro_end                Exits the fiber execution and returns to program,
 //                                 This function MUST be called whenever you want to exit the coro
+//      sx_coro_await              suspends the current coroutine until `sx_coro_resume` is called
+//                                 with the handle that is returned by `sx_coro_current`.
+//                                 suspended coroutines are not visited by `sx_coro_update`, and are
+//                                 continued on the first update after they are resumed
+//
+//      sx_coro_current            returns a handle to the running coroutine, call it before
+//                                 `sx_coro_await` and pass it to the code that completes the wait
+//      sx_coro_resume             resumes the coroutine that is suspended by `sx_coro_await`
+//                                 if the coroutine is not suspended yet, the next await returns
+//                                 immediately. stale handles (ended or restarted coroutines) are ignored
+//      sx_coro_valid              returns true if the handle is not resumed yet and it's coroutine
+//                                 is not ended or restarted. use it to check if the waiter is still there
 // Example:
 //
 //        sx_coro_declare(my_test) {
@@ -112,6 +124,7 @@
 #include "macros.h"
 
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef struct sx_alloc sx_alloc;
 
@@ -131,6 +144,11 @@ typedef struct sx_fiber_stack {
 
 typedef void(sx_fiber_cb)(sx_fiber_transfer transfer);
 
+typedef struct sx_coro_handle {
+    struct sx__coro_state* state;
+    uint32_t id;
+} sx_coro_handle;
+
 // High level context API
 typedef struct sx_coro_context sx_coro_context;
 
@@ -144,6 +162,10 @@ SX_API void sx__coro_invoke(sx_coro_context* ctx, sx_fiber_cb* callback, void* u
 SX_API void sx__coro_end(sx_coro_context* ctx, sx_fiber_t* pfrom);
 SX_API void sx__coro_wait(sx_coro_context* ctx, sx_fiber_t* pfrom, int msecs);
 SX_API void sx__coro_yield(sx_coro_context* ctx, sx_fiber_t* pfrom, int nupdates sx_default(1));
+SX_API void sx__coro_await(sx_coro_context* ctx, sx_fiber_t* pfrom);
+SX_API sx_coro_handle sx_coro_current(sx_coro_context* ctx);
+SX_API void sx_coro_resume(sx_coro_context* ctx, sx_coro_handle handle);
+SX_API bool sx_coro_valid(sx_coro_context* ctx, sx_coro_handle handle);
 
 // coroutines macros (use these instead of above sx__coro functions)
 #define sx_coro_declare(_name) static void coro__##_name(sx_fiber_transfer __transfer)
@@ -152,6 +174,7 @@ SX_API void sx__coro_yield(sx_coro_context* ctx, sx_fiber_t* pfrom, int nupdates
 #define sx_coro_wait(_ctx, _msecs) sx__coro_wait((_ctx), &__transfer.from, (_msecs))
 #define sx_coro_yield(_ctx) sx__coro_yield((_ctx), &__transfer.from, 1)
 #define sx_coro_yieldn(_ctx, _n) sx__coro_yield((_ctx), &__transfer.from, (_n))
+#define sx_coro_await(_ctx) sx__coro_await((_ctx), &__transfer.from)
 #define sx_coro_invoke(_ctx, _name, _user) sx__coro_invoke((_ctx), coro__##_name, (_user))
 
 // Low-level functions
@@ -38,6 +38,24 @@
 //          sx_handle_gen               use this macro to fetch generation from the handle. Mainly
 //                                      for debugging purposes
 //
+//  sx_handle_pool_mt: Thread-safe variant of the handle pool, new/del are lock-free and can be
+//                     called from any thread. The pool grows by adding chunks (each one double the
+//                     size of the previous one), so the memory never moves and readers don't
+//                     need to be in sync with the allocating threads. Optionally, it also holds
+//                     `item_sz` bytes of data for each handle in the same chunks
+//          sx_handle_create_pool_mt    allocate and create the pool, capacity is the size of the
+//                                      first chunk. allocator must be thread-safe, because grows
+//                                      happen on the thread that calls sx_handle_new_mt
+//          sx_handle_destroy_pool_mt   destroy the pool
+//          sx_handle_new_mt            returns a new handle, returns 0 if max handles is reached
+//          sx_handle_del_mt            deletes the handle and puts it back to the pool
+//          sx_handle_valid_mt          checks if handle is valid by comparing generation
+//          sx_handle_data_mt           returns pointer to the item data of the handle
+//          sx_handle_count_mt          returns number of alive handles
+//          sx_handle_capacity_mt       returns number of reserved slots, use with sx_handle_at_mt
+//          sx_handle_at_mt             returns handle of slot index, or 0 if the slot is not alive
+//                                      (for iteration)
+//
 //  CAUTION: In case you have to grow the handle-pool, make sure NOT to have multiple pointers
 //           to the pool object.
 //           Because on grow, it may change the pointer to the handle_pool itself and
@@ -101,6 +119,18 @@ SX_INLINE bool        sx_handle_valid(const sx_handle_pool* pool, sx_handle_t ha
 SX_INLINE sx_handle_t sx_handle_at(const sx_handle_pool* pool, int index);
 SX_INLINE bool        sx_handle_full(const sx_handle_pool* pool);
 
+typedef struct sx_handle_pool_mt sx_handle_pool_mt;
+
+SX_API sx_handle_pool_mt* sx_handle_create_pool_mt(const sx_alloc* alloc, int capacity, int item_sz);
+SX_API void               sx_handle_destroy_pool_mt(sx_handle_pool_mt* pool, const sx_alloc* alloc);
+SX_API sx_handle_t        sx_handle_new_mt(sx_handle_pool_mt* pool);
+SX_API void               sx_handle_del_mt(sx_handle_pool_mt* pool, sx_handle_t handle);
+SX_API bool               sx_handle_valid_mt(const sx_handle_pool_mt* pool, sx_handle_t handle);
+SX_API void*              sx_handle_data_mt(const sx_handle_pool_mt* pool, sx_handle_t handle);
+SX_API int                sx_handle_count_mt(const sx_handle_pool_mt* pool);
+SX_API int                sx_handle_capacity_mt(const sx_handle_pool_mt* pool);
+SX_API sx_handle_t        sx_handle_at_mt(const sx_handle_pool_mt* pool, int index);
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // internal/impl
 SX_API const uint32_t k__handle_index_mask;
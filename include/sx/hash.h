@@ -72,6 +72,29 @@
 //                  integer anymore. It can be any POD type. you just define the size of your type
 //      The function are pretty much the same as sx_hashtbl, but with `sx_hashtbltval_` prefix.
 //
+// sx_hashmap: open-addressing hash-table with 64bit keys (swiss-table style)
+//             every slot has a control byte that is either empty, deleted or 7 bits of the key's hash
+//             slots are probed in groups of 16, and control bytes of a group are matched all at once
+//             with SSE2/NEON, so probes stay short, even for keys that are not in the table.
+//             removing keys leaves tombstones only when needed, so probe chains stay correct
+//             unlike sx_hashtbl, keys can be any value (including 0) and duplicate keys are not added
+//
+//      sx_hashmap_create            create and allocate hash-table from allocator,
+//                                   capacity will be rounded to power of 2 (minimum of 16)
+//      sx_hashmap_destroy           destroy hash-table that is created with sx_hashmap_create
+//      sx_hashmap_grow              grows hash-table (NOTE: pointer to hash-table will change),
+//                                   if the table is mostly filled with tombstones, it's rehashed with
+//                                   the same capacity instead
+//      sx_hashmap_add               adds a key to the table, or replaces the value if key exists
+//                                   returns index of the key
+//      sx_hashmap_find              tries to find the key and returns index, -1 if not found
+//      sx_hashmap_remove            removes the key at index
+//      sx_hashmap_full              returns true if table needs to grow before adding (7/8 load)
+//      sx_hashmap_valid             returns true if there is a key at index, for iterating the table
+//      sx_hashmap_get               returns the value of an index, similiar to tbl->values[index]
+//      sx_hashmap_find_get          combines 'find' and 'get'
+//      sx_hashmap_clear             clears the table
+//
 // NOTE for C++ users:
 //      Take a look at `sx_hashtable_t` struct and it's members (C++ only) in this file. It is a very 
 //      thin template wrapper over sx_hashtbl_tval for more convenient C++ usage
@@ -248,6 +271,64 @@ SX_INLINE bool sx_hashtbltval_full(const sx_hashtbl_tval* tbl)
     (sx_hashtbltval_full(_tbl) ? sx_hashtbltval_grow(&(_tbl), _alloc) : 0, \
      sx_hashtbltval_add(_tbl, _key, _value))
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Hash map (swiss-table style)
+#define SX_HASHMAP_GROUP_SIZE 16
+
+typedef struct sx_hashmap {
+    uint8_t* ctrls;     // control bytes: 0x80 = empty, 0xfe = deleted, 0..0x7f = 7 bits of hash
+    uint64_t* keys;
+    int* values;
+    int _bitshift;
+    int count;
+    int num_deleted;
+    int capacity;       // power of 2, multiple of SX_HASHMAP_GROUP_SIZE
+} sx_hashmap;
+
+SX_API sx_hashmap* sx_hashmap_create(const sx_alloc* alloc, int capacity);
+SX_API void sx_hashmap_destroy(sx_hashmap* tbl, const sx_alloc* alloc);
+SX_API bool sx_hashmap_grow(sx_hashmap** ptbl, const sx_alloc* alloc);
+
+SX_API int sx_hashmap_add(sx_hashmap* tbl, uint64_t key, int value);
+SX_API int sx_hashmap_find(const sx_hashmap* tbl, uint64_t key);
+SX_API void sx_hashmap_remove(sx_hashmap* tbl, int index);
+SX_API void sx_hashmap_clear(sx_hashmap* tbl);
+
+SX_INLINE bool sx_hashmap_valid(const sx_hashmap* tbl, int index)
+{
+    sx_assert(index >= 0 && index < tbl->capacity);
+    return (tbl->ctrls[index] & 0x80) == 0;
+}
+
+SX_INLINE int sx_hashmap_get(const sx_hashmap* tbl, int index)
+{
+    sx_assert(index >= 0 && index < tbl->capacity);
+    return tbl->values[index];
+}
+
+SX_INLINE int sx_hashmap_find_get(const sx_hashmap* tbl, uint64_t key, int not_found_val)
+{
+    int index = sx_hashmap_find(tbl, key);
+    return index != -1 ? tbl->values[index] : not_found_val;
+}
+
+SX_INLINE void sx_hashmap_remove_if_found(sx_hashmap* tbl, uint64_t key)
+{
+    int index = sx_hashmap_find(tbl, key);
+    if (index != -1)
+        sx_hashmap_remove(tbl, index);
+}
+
+// tombstones are counted, because they make probe chains longer too
+SX_INLINE bool sx_hashmap_full(const sx_hashmap* tbl)
+{
+    return (tbl->count + tbl->num_deleted) >= (tbl->capacity - (tbl->capacity >> 3));
+}
+
+#define sx_hashmap_add_and_grow(_tbl, _key, _value, _alloc)        \
+    (sx_hashmap_full(_tbl) ? sx_hashmap_grow(&(_tbl), _alloc) : 0, \
+     sx_hashmap_add(_tbl, _key, _value))
+
 // cplusplus minimal template wrapper over hashtbltval
 #ifdef __cplusplus
 template <typename _T>
@@ -108,6 +108,7 @@ typedef void(sx_job_thread_init_cb)(sx_job_context* ctx, int thread_index, unsig
                                     void* user);
 typedef void(sx_job_thread_shutdown_cb)(sx_job_context* ctx, int thread_index,
                                         unsigned int thread_id, void* user);
+typedef void(sx_job_done_cb)(sx_job_context* ctx, sx_job_t job, void* user);
 
 typedef enum sx_job_priority {
     SX_JOB_PRIORITY_HIGH = 0,
@@ -124,6 +125,9 @@ typedef struct sx_job_context_desc {
                                                       // initiaslization of each worker thread
     sx_job_thread_shutdown_cb* thread_shutdown_cb;    // callback functions that will be called on
                                                       // the shutdown of each worker thread
+    sx_job_done_cb* job_done_cb;    // called on the thread that finishes the last sub-job of a
+                                    // dispatch. the handle is still alive, but it may be deleted
+                                    // by other threads right after, so only compare it
     void* thread_user_data;    // user-data to be passed to callback functions above
 } sx_job_context_desc;
 
@@ -55,6 +55,27 @@ SX_API bool sx_queue_spsc_full(const sx_queue_spsc* queue);
 #define sx_queue_spsc_produce_and_grow(_queue, _data, _alloc)             \
     (sx_queue_spsc_full(_queue) ? sx_queue_spsc_grow(_queue, _alloc) : 0, sx_queue_spsc_produce(_queue, (_data)))
 
+// multi-producer / multi-consumer
+// bounded (capacity is rounded to power of 2), produce returns false if the queue is full
+// and consume returns false if it's empty
+typedef struct sx_queue_mpmc sx_queue_mpmc;
+SX_API sx_queue_mpmc* sx_queue_mpmc_create(const sx_alloc* alloc, int item_sz, int capacity);
+SX_API void sx_queue_mpmc_destroy(sx_queue_mpmc* queue, const sx_alloc* alloc);
+
+SX_API bool sx_queue_mpmc_produce(sx_queue_mpmc* queue, const void* data);
+SX_API bool sx_queue_mpmc_consume(sx_queue_mpmc* queue, void* data);
+
+// multi-producer / single-consumer
+// unbounded: producers add new chunks of nodes when they run out, so `alloc` must be thread-safe
+// produce only fails if the allocator fails. consume can return false for a short while, when a
+// producer is preempted in the middle of pushing an item, so the consumer should just retry later
+typedef struct sx_queue_mpsc sx_queue_mpsc;
+SX_API sx_queue_mpsc* sx_queue_mpsc_create(const sx_alloc* alloc, int item_sz, int capacity);
+SX_API void sx_queue_mpsc_destroy(sx_queue_mpsc* queue, const sx_alloc* alloc);
+
+SX_API bool sx_queue_mpsc_produce(sx_queue_mpsc* queue, const void* data);
+SX_API bool sx_queue_mpsc_consume(sx_queue_mpsc* queue, void* data);
+
 //--------------------------------------------------------------------------------------------------
 SX_FORCE_INLINE void sx_lock_enter(sx_lock_t* lock)
 {
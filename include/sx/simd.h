@@ -342,6 +342,12 @@ SX_SIMD_INLINE sx_simd_t sx_simd_xor(sx_simd_t _a, sx_simd_t _b)
     return _mm_xor_ps(_a, _b);
 }
 
+// returns sign bits of the 4 lanes as a 4bit mask (x = bit0, w = bit3)
+SX_SIMD_INLINE int sx_simd_movemask(sx_simd_t _a)
+{
+    return _mm_movemask_ps(_a);
+}
+
 #elif SX_SIMD_NEON
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Neon
@@ -812,6 +818,12 @@ SX_SIMD_INLINE sx_simd_t sx_simd_xor(sx_simd_t _a, sx_simd_t _b)
     result.uxyzw[3] = _a.uxyzw[3] ^ _b.uxyzw[3];
     return result;
 }
+
+SX_SIMD_INLINE int sx_simd_movemask(sx_simd_t _a)
+{
+    return (int)(((_a.uxyzw[3] >> 31) << 3) | ((_a.uxyzw[2] >> 31) << 2) | 
+                 ((_a.uxyzw[1] >> 31) << 1) | (_a.uxyzw[0] >> 31));
+}
 #endif        // SX_SIMD_SSE/NEON
 
 SX_SIMD_INLINE sx_simd_t simd_shuffle_xAzC(sx_simd_t _xyzw, sx_simd_t _ABCD)
@@ -113,3 +113,28 @@ SX_API int sx_strpool_len(const sx_strpool* sp, sx_str_t handle);
 
 SX_API sx_strpool_collate_data sx_strpool_collate(const sx_strpool* sp);
 SX_API void sx_strpool_collate_free(const sx_strpool* sp, sx_strpool_collate_data data);
+
+// strintern: thread-safe string interning with stable 64bit ids (xxhash64 of the string)
+// ids only depend on the string contents, so they can be compared across subsystems and runs,
+// and also computed without the table (sx_strintern_hash)
+// lookups are lock-free, inserts lock one of the shards. strings are kept in arenas and never
+// move or get removed until the table is destroyed, so returned pointers are always valid
+// `alloc` must be thread-safe, because inserts on any thread may allocate memory
+//      sx_strintern_add        interns the string and returns it's id, len=-1 calculates the length
+//                              returns 0 if out of memory, or if a different string with the same
+//                              id is already interned (hash collision, reported in all builds)
+//      sx_strintern_find       returns the id if string is already interned, 0 otherwise
+//      sx_strintern_cstr       reverse lookup (mainly for debugging), NULL if id is not interned
+//      sx_strintern_hash       returns the id of the string, without touching the table
+typedef uint64_t sx_strid_t;
+typedef struct sx_strintern sx_strintern;
+
+SX_API sx_strintern* sx_strintern_create(const sx_alloc* alloc, int capacity);
+SX_API void sx_strintern_destroy(sx_strintern* si, const sx_alloc* alloc);
+
+SX_API sx_strid_t sx_strintern_add(sx_strintern* si, const char* str, int len sx_default(-1));
+SX_API sx_strid_t sx_strintern_find(const sx_strintern* si, const char* str, int len sx_default(-1));
+SX_API const char* sx_strintern_cstr(const sx_strintern* si, sx_strid_t id);
+SX_API int sx_strintern_len(const sx_strintern* si, sx_strid_t id);
+SX_API int sx_strintern_count(const sx_strintern* si);
+SX_API sx_strid_t sx_strintern_hash(const char* str, int len sx_default(-1));
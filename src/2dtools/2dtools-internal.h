@@ -16,6 +16,7 @@ rizz_sprite sprite__create(const rizz_sprite_desc* desc);
 void sprite__destroy(rizz_sprite handle);
 rizz_sprite sprite__clone(rizz_sprite src_handle, rizz_sprite_animclip clip_handle);
 const rizz_atlas* sprite__atlas_get(rizz_asset atlas_asset);
+bool sprite__atlas_bake(rizz_asset atlas_asset, const char* filepath);
 sx_vec2 sprite__size(rizz_sprite handle);
 sx_vec2 sprite__origin(rizz_sprite handle);
 sx_color sprite__color(rizz_sprite handle);
@@ -96,4 +97,9 @@ rizz_font_vert_metrics font__vert_metrics(const rizz_font* fnt);
 bool font__resize_draw_limits(int max_verts);
 rizz_font_iter font__iter_init(const rizz_font* fnt, sx_vec2 pos, const char* text);
 bool font__iter_next(const rizz_font* fnt, rizz_font_iter* iter, rizz_font_quad* quad);
-void font__set_draw_api(rizz_api_gfx_draw* draw_api);
\ No newline at end of file
+void font__set_draw_api(rizz_api_gfx_draw* draw_api);
+void font__clear_atlas(const rizz_font* fnt);
+void font__batch_draw(const rizz_font* fnt, sx_vec2 pos, const char* text);
+void font__batch_drawf(const rizz_font* fnt, sx_vec2 pos, const char* fmt, ...);
+void font__batch_flush(void);
+void font__batch_stats(rizz_font_batch_stats* stats);
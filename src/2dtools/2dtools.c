@@ -28,18 +28,24 @@ static rizz_api_2d the__2d = {
         .set_scissor = font__set_scissor,
         .set_viewproj_mat = font__set_viewproj_mat,
         .clear_state = font__clear_state,
+        .clear_atlas = font__clear_atlas,
         .bounds = font__bounds,
         .line_bounds = font__line_bounds,
         .vert_metrics = font__vert_metrics,
         .resize_draw_limits = font__resize_draw_limits,
         .set_draw_api = font__set_draw_api,
         .iter_init = font__iter_init,
-        .iter_next = font__iter_next },
+        .iter_next = font__iter_next,
+        .batch_draw = font__batch_draw,
+        .batch_drawf = font__batch_drawf,
+        .batch_flush = font__batch_flush,
+        .batch_stats = font__batch_stats },
     .sprite = { 
         .create = sprite__create,
         .destroy = sprite__destroy,
         .clone = sprite__clone,
         .atlas_get = sprite__atlas_get,
+        .atlas_bake = sprite__atlas_bake,
         .size = sprite__size,
         .origin = sprite__origin,
         .bounds = sprite__bounds,
@@ -1,9 +1,11 @@
 #include "2dtools-internal.h"
 
 #include "sx/array.h"
+#include "sx/hash.h"
 #include "sx/math-scalar.h"
 #include "sx/os.h"
 #include "sx/string.h"
+#include "sx/timer.h"
 
 #include "rizz/imgui.h"
 
@@ -21,22 +23,87 @@ SX_PRAGMA_DIAGNOSTIC_POP()
 
 #include rizz_shader_path(shaders_h, font.vert.h)
 #include rizz_shader_path(shaders_h, font.frag.h)
+#include rizz_shader_path(shaders_h, font_sdf.vert.h)
+#include rizz_shader_path(shaders_h, font_sdf.frag.h)
 
 #define MAX_VERTICES 4000
 #define MAX_INDICES 12000
 
+// cached layouts that are not drawn for this many frames are evicted in font__update
+#define LAYOUT_CACHE_MAX_UNUSED_FRAMES 120
+#define LAYOUT_CACHE_INIT_CAPACITY 64
+
+#define SDF_DEFAULT_SIZE 48.0f
+#define SDF_DEFAULT_PADDING 6
+#define SDF_MAX_PADDING 32
+#define SDF_ONEDGE_VALUE 128
+// below this many new glyphs, sdf rasterization stays on the calling thread
+#define SDF_MIN_JOB_GLYPHS 8
+
 RIZZ_STATE static rizz_api_core* the_core;
 RIZZ_STATE static rizz_api_asset* the_asset;
 RIZZ_STATE static rizz_api_gfx* the_gfx;
 RIZZ_STATE static rizz_api_imgui* the_imgui;
 RIZZ_STATE static rizz_api_app* the_app;
 
+// font state that affects layout, color is applied when the layout is drawn
+typedef struct font__layout_key {
+    int font;
+    int align;
+    float size;
+    float blur;
+    float spacing;
+} font__layout_key;
+
+// glyph quad of a cached layout, relative to the draw position
+typedef struct font__glyph {
+    float x0, y0, x1, y1;
+    float s0, t0, s1, t1;
+} font__glyph;
+
+typedef struct font__layout {
+    font__layout_key key;
+    uint32_t hash;
+    int num_glyphs;
+    int text_len;
+    float advance;
+    int64_t last_frame;
+    font__glyph* glyphs;    // count = num_glyphs
+    char* text;             // count = text_len+1
+} font__layout;
+
+// glyph rasterized into the atlas as distance field, metrics are in pixels of the reference size
+typedef struct font__sdf_glyph {
+    int x, y, w, h;    // rect in atlas
+    float xoff, yoff;
+    float advance;     // unscaled font units
+    int index;         // glyph index in the font, used for kerning
+} font__sdf_glyph;
+
+// range of batched vertices that share the same state matrix and scissor
+typedef struct font__batch {
+    int start_vertex;
+    int num_verts;
+    int scissor[4];
+    float mat[16];
+} font__batch;
+
 typedef struct font__fons {
     rizz_font f;
     FONScontext* ctx;
     char name[32];
     bool img_dirty;
     bool ignore_dpiscale;
+    bool sdf;
+    float sdf_size;
+    int sdf_padding;
+    sx_hashtbl* sdf_glyph_tbl;                // key: font__sdf_key, value: index-to-sdf_glyphs
+    font__sdf_glyph* SX_ARRAY sdf_glyphs;
+    int atlas_gen;                            // incremented when the atlas is resized or reset
+    sx_hashtbl* layout_tbl;                   // key: font__layout.hash, value: index-to-layouts
+    font__layout** SX_ARRAY layouts;
+    rizz_font_vertex* SX_ARRAY batch_verts;
+    font__batch* SX_ARRAY batches;
 } font__fons;
 
 typedef struct font__context {
@@ -44,10 +111,17 @@ typedef struct font__context {
     rizz_api_gfx_draw* draw_api;
     font__fons** SX_ARRAY fonts;
     sg_pipeline pip;
+    sg_pipeline pip_sdf;
     sg_buffer vbuff;
     sg_shader shader;
+    sg_shader shader_sdf;
+    int max_verts;
+    int vbuff_used;           // vertices appended to vbuff in vbuff_frame, by batches and immediate draws
+    int64_t vbuff_frame;
     font__fons font_async;
     font__fons font_failed;
+    rizz_font_batch_stats stats;         // accumulated since the last batch_flush
+    rizz_font_batch_stats last_stats;
 } font__context;
 
 static rizz_vertex_layout k_font_vertex_layout = {
@@ -60,6 +134,10 @@ static rizz_vertex_layout k_font_vertex_layout = {
 
 RIZZ_STATE static font__context g_font;
 
+static const font__layout* font__get_layout(font__fons* fons, const char* text);
+static void font__layout_verts(const font__layout* layout, sx_vec2 pos, sx_color color,
+                               rizz_font_vertex* verts);
+
 static int fons__create_fn(void* user_ptr, int width, int height)
 {
     font__fons* fons = user_ptr;
@@ -81,10 +159,51 @@ static int fons__create_fn(void* user_ptr, int width, int height)
     return 1;
 }
 
+static void font__clear_layouts(font__fons* fons)
+{
+    for (int i = 0, c = sx_array_count(fons->layouts); i < c; i++) {
+        sx_free(g_font.alloc, fons->layouts[i]);
+    }
+    sx_array_clear(fons->layouts);
+    if (fons->layout_tbl) {
+        sx_hashtbl_clear(fons->layout_tbl);
+    }
+}
+
+static void font__destroy_layouts(font__fons* fons)
+{
+    font__clear_layouts(fons);
+    sx_array_free(g_font.alloc, fons->layouts);
+    if (fons->layout_tbl) {
+        sx_hashtbl_destroy(fons->layout_tbl, g_font.alloc);
+        fons->layout_tbl = NULL;
+    }
+    if (fons->sdf_glyph_tbl) {
+        sx_hashtbl_destroy(fons->sdf_glyph_tbl, g_font.alloc);
+        fons->sdf_glyph_tbl = NULL;
+    }
+    sx_array_free(g_font.alloc, fons->sdf_glyphs);
+    sx_array_free(g_font.alloc, fons->batch_verts);
+    sx_array_free(g_font.alloc, fons->batches);
+}
+
 static int fons__resize_fn(void* user_ptr, int width, int height)
 {
     font__fons* fons = user_ptr;
 
+    // glyph texcoords are normalized, so cached layouts are invalid after resize. glyphs that are
+    // already batched keep their pixel position in the atlas when it's expanded, rescale them
+    if (fons->f.img_width > 0 && fons->f.img_height > 0) {
+        float su = (float)fons->f.img_width / (float)width;
+        float sv = (float)fons->f.img_height / (float)height;
+        for (int i = 0, c = sx_array_count(fons->batch_verts); i < c; i++) {
+            fons->batch_verts[i].uv.x *= su;
+            fons->batch_verts[i].uv.y *= sv;
+        }
+    }
+    font__clear_layouts(fons);
+    ++fons->atlas_gen;
+
     if (fons->f.img_atlas.id) {
         the_gfx->destroy_image(fons->f.img_atlas);
         fons->f.img_atlas.id = 0;
@@ -109,10 +228,54 @@ static void fons__update_fn(void* user_ptr, int* rect, const unsigned char* data
     fons->img_dirty = true;
 }
 
+// all fonts, batched and immediate, append to the same stream buffer, so the space is tracked per
+// frame across all of them. returns the number of vertices that fit, rounded down to `granularity`
+static int font__reserve_verts(const font__fons* fons, int num_verts, int granularity)
+{
+    int64_t frame = the_core->frame_index();
+    if (g_font.vbuff_frame != frame) {
+        g_font.vbuff_frame = frame;
+        g_font.vbuff_used = 0;
+    }
+
+    int count = sx_min(num_verts, g_font.max_verts - g_font.vbuff_used);
+    count -= count % granularity;
+    if (count < num_verts) {
+        rizz_log_warn("font: '%s' exceeds maximum vertices (%d) for this frame, increase it with "
+                      "resize_draw_limits", fons->name, g_font.max_verts);
+    }
+    g_font.vbuff_used += count;
+    return count;
+}
+
+static void font__draw_verts(const font__fons* fons, const rizz_font_vertex* verts, int nverts,
+                             const FONSstate* state)
+{
+    nverts = font__reserve_verts(fons, nverts, 3);
+    if (nverts == 0) {
+        return;
+    }
+
+    rizz_api_gfx_draw* draw_api = g_font.draw_api;
+    int vb_offset = draw_api->append_buffer(g_font.vbuff, verts, sizeof(rizz_font_vertex) * nverts);
+
+    sg_bindings bindings = { .vertex_buffers[0] = g_font.vbuff,
+                             .vertex_buffer_offsets[0] = vb_offset,
+                             .fs_images[0] = fons->f.img_atlas };
+
+    draw_api->apply_pipeline(fons->sdf ? g_font.pip_sdf : g_font.pip);
+    draw_api->apply_bindings(&bindings);
+    if (state->scissor[2] > 0 && state->scissor[3] > 0) {
+        draw_api->apply_scissor_rect(state->scissor[0], state->scissor[1], state->scissor[2],
+                                     state->scissor[3], !the_gfx->GL_family());
+    }
+    draw_api->apply_uniforms(SG_SHADERSTAGE_VS, 0, state->mat, sizeof(state->mat));
+    draw_api->draw(0, nverts, 1);
+}
+
 static void fons__draw_fn(void* user_ptr, const float* poss, const float* tcoords, const unsigned int* colors, int nverts)
 {
     font__fons* fons = user_ptr;
-    rizz_api_gfx_draw* draw_api = g_font.draw_api;
 
     const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
     sx_scope(the_core->tmp_alloc_pop()) {
@@ -143,22 +306,7 @@ static void fons__draw_fn(void* user_ptr, const float* poss, const float* tcoord
             verts[vindex].color = sx_colorn(colors[i]);
         }
 
-        int vb_offset = draw_api->append_buffer(g_font.vbuff, verts, sizeof(rizz_font_vertex) * nverts);
-
-        sg_bindings bindings = { .vertex_buffers[0] = g_font.vbuff,
-                                 .vertex_buffer_offsets[0] = vb_offset,
-                                 .fs_images[0] = fons->f.img_atlas };
-
-        FONSstate* state = fons__getState(fons->ctx);
-
-        draw_api->apply_pipeline(g_font.pip);
-        draw_api->apply_bindings(&bindings);
-        if (state->scissor[2] > 0 && state->scissor[3] > 0) {
-            draw_api->apply_scissor_rect(state->scissor[0], state->scissor[1], state->scissor[2],
-                                         state->scissor[3], !the_gfx->GL_family());
-        }
-        draw_api->apply_uniforms(SG_SHADERSTAGE_VS, 0, state->mat, sizeof(state->mat));
-        draw_api->draw(0, nverts, 1);
+        font__draw_verts(fons, verts, nverts, fons__getState(fons->ctx));
     } // scope
 }
 
@@ -209,6 +357,7 @@ static rizz_asset_load_data font__fons_on_prepare(const rizz_asset_load_params*
         sx_out_of_memory();
         return (rizz_asset_load_data){ .obj = { 0 } };
     }
+    sx_memset(fons, 0x0, sizeof(font__fons));
 
     float dpiscale = fparams->ignore_dpiscale ? 1.0f : the_app->dpiscale();
     int atlas_width = fparams->atlas_width > 0
@@ -221,6 +370,10 @@ static rizz_asset_load_data font__fons_on_prepare(const rizz_asset_load_params*
     fons->f.img_height = atlas_height;
     fons->f.img_atlas.id = 0;
     fons->ignore_dpiscale = fparams->ignore_dpiscale;
+    fons->sdf = fparams->sdf;
+    fons->sdf_size = fparams->sdf_size > 0 ? fparams->sdf_size : SDF_DEFAULT_SIZE;
+    fons->sdf_padding = fparams->sdf_padding > 0 ? sx_min(fparams->sdf_padding, SDF_MAX_PADDING)
+                                                 : SDF_DEFAULT_PADDING;
 
     char name[64];
     sx_os_path_basename(name, sizeof(name), params->path);
@@ -251,6 +404,33 @@ static rizz_asset_load_data font__fons_on_prepare(const rizz_asset_load_params*
     return (rizz_asset_load_data){ .obj = { .ptr = fons }, .user1 = buffer };
 }
 
+// sdf glyphs are rasterized into fontstash scratch memory (FONS_SCRATCH_BUF_SIZE) along with their
+// outlines, and stb_truetype doesn't check the allocation. so sdf_size is clamped to make the largest
+// glyph bitmap take half of the scratch memory at most
+static void font__sdf_clamp_size(font__fons* fons, FONSfont* font, const char* path)
+{
+    int bx0, by0, bx1, by1;
+    stbtt_GetFontBoundingBox(&font->font.font, &bx0, &by0, &bx1, &by1);
+
+    float sdf_size = fons->sdf_size;
+    int pad = fons->sdf_padding * 2 + 2;
+    for (;;) {
+        float scale = fons__tt_getPixelHeightScale(&font->font, sdf_size);
+        int w = (int)((float)(bx1 - bx0) * scale) + pad;
+        int h = (int)((float)(by1 - by0) * scale) + pad;
+        if (w * h <= FONS_SCRATCH_BUF_SIZE / 2 || sdf_size <= 1.0f) {
+            break;
+        }
+        sdf_size = sx_max(sx_floor(sdf_size * 0.9f), 1.0f);
+    }
+
+    if (sdf_size < fons->sdf_size) {
+        rizz_log_warn("font: sdf_size of '%s' is too large for scratch memory, clamped to %.0f", path,
+                      sdf_size);
+        fons->sdf_size = sdf_size;
+    }
+}
+
 static bool font__fons_on_load(rizz_asset_load_data* data, const rizz_asset_load_params* params,
                                const sx_mem_block* mem)
 {
@@ -269,6 +449,10 @@ static bool font__fons_on_load(rizz_asset_load_data* data, const rizz_asset_load
         return false;
     }
 
+    if (fons->sdf) {
+        font__sdf_clamp_size(fons, fons->ctx->fonts[fons_id], params->path);
+    }
+
     fonsSetFont(fons->ctx, fons_id);
     fonsSetSize(fons->ctx, 12.0f * (fons->ignore_dpiscale ? 1.0f : the_app->dpiscale()));
 
@@ -304,6 +488,7 @@ static void font__fons_on_release(rizz_asset_obj obj, const sx_alloc* alloc)
     }
 
     fonsDeleteInternal(fons->ctx);
+    font__destroy_layouts(fons);
 
     // remove from font database, so we don't have to update it anymore
     for (int i = 0, c = sx_array_count(g_font.fonts); i < c; i++) {
@@ -324,6 +509,8 @@ bool font__resize_draw_limits(int max_verts)
     if (g_font.vbuff.id)
         the_gfx->destroy_buffer(g_font.vbuff);
 
+    g_font.max_verts = max_verts;
+    g_font.vbuff_used = 0;
     if (max_verts == 0) {
         g_font.vbuff = (sg_buffer){ 0 };
         return true;
@@ -339,12 +526,44 @@ bool font__resize_draw_limits(int max_verts)
     return g_font.vbuff.id;
 }
 
+static void font__remove_layout(font__fons* fons, int layout_idx)
+{
+    font__layout* layout = fons->layouts[layout_idx];
+    sx_hashtbl_remove_if_found(fons->layout_tbl, layout->hash);
+    sx_free(g_font.alloc, layout);
+
+    // swap with the last layout and fix it's index in the table
+    int last = sx_array_count(fons->layouts) - 1;
+    if (layout_idx != last) {
+        fons->layouts[layout_idx] = fons->layouts[last];
+        int index = sx_hashtbl_find(fons->layout_tbl, fons->layouts[layout_idx]->hash);
+        sx_assert(index != -1);
+        fons->layout_tbl->values[index] = layout_idx;
+    }
+    sx_array_pop_last(fons->layouts);
+}
+
+static void font__evict_layouts(font__fons* fons, int64_t frame)
+{
+    for (int i = 0; i < sx_array_count(fons->layouts);) {
+        if ((frame - fons->layouts[i]->last_frame) > LAYOUT_CACHE_MAX_UNUSED_FRAMES) {
+            font__remove_layout(fons, i);
+        } else {
+            ++i;
+        }
+    }
+}
+
 void font__update(void)
 {
+    int64_t frame = the_core->frame_index();
     for (int i = 0, c = sx_array_count(g_font.fonts); i < c; i++) {
         font__fons* font = g_font.fonts[i];
+        font__evict_layouts(font, frame);
+
         if (font->img_dirty) {
             font->img_dirty = false;
+            ++g_font.stats.num_atlas_updates;
             the_gfx->imm.update_image(
                 font->f.img_atlas,
                 &(sg_image_content){ .subimage[0][0].ptr = font->ctx->texData,
@@ -383,6 +602,16 @@ bool font__init(rizz_api_core* core, rizz_api_asset* asset, rizz_api_gfx* gfx, r
 
         g_font.pip = the_gfx->make_pipeline(
             the_gfx->shader_bindto_pipeline(&shader, &pip_desc, &k_font_vertex_layout));
+
+        rizz_shader shader_sdf = the_gfx->shader_make_with_data(
+            tmp_alloc, k_font_sdf_vs_size, k_font_sdf_vs_data, k_font_sdf_vs_refl_size,
+            k_font_sdf_vs_refl_data, k_font_sdf_fs_size, k_font_sdf_fs_data,
+            k_font_sdf_fs_refl_size, k_font_sdf_fs_refl_data);
+        g_font.shader_sdf = shader_sdf.shd;
+
+        pip_desc.label = "rizz_font_sdf";
+        g_font.pip_sdf = the_gfx->make_pipeline(
+            the_gfx->shader_bindto_pipeline(&shader_sdf, &pip_desc, &k_font_vertex_layout));
     } // scope
 
 
@@ -458,6 +687,8 @@ void font__release(void)
     if (g_font.font_failed.ctx) {
         fonsDeleteInternal(g_font.font_failed.ctx);
     }
+    font__destroy_layouts(&g_font.font_async);
+    font__destroy_layouts(&g_font.font_failed);
 
     // destroy gfx objects
     if (g_font.vbuff.id)
@@ -466,6 +697,10 @@ void font__release(void)
         the_gfx->destroy_shader(g_font.shader);
     if (g_font.pip.id)
         the_gfx->destroy_pipeline(g_font.pip);
+    if (g_font.shader_sdf.id)
+        the_gfx->destroy_shader(g_font.shader_sdf);
+    if (g_font.pip_sdf.id)
+        the_gfx->destroy_pipeline(g_font.pip_sdf);
 
     sx_array_free(g_font.alloc, g_font.fonts);
 }
@@ -480,8 +715,27 @@ const rizz_font* font__get(rizz_asset font_asset)
 
 void font__draw(const rizz_font* fnt, sx_vec2 pos, const char* text)
 {
-    const font__fons* fons = (const font__fons*)fnt;
-    fonsDrawText(fons->ctx, pos.x, pos.y, text, NULL);
+    font__fons* fons = (font__fons*)fnt;
+    if (!fons->sdf) {
+        fonsDrawText(fons->ctx, pos.x, pos.y, text, NULL);
+        return;
+    }
+
+    // sdf glyphs are not in fontstash's glyph cache, they are drawn with cached layouts
+    const font__layout* layout = font__get_layout(fons, text);
+    if (!layout || layout->num_glyphs == 0) {
+        return;
+    }
+
+    const FONSstate* state = fons__getState(fons->ctx);
+    const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
+    sx_scope(the_core->tmp_alloc_pop()) {
+        int num_verts = layout->num_glyphs * 6;
+        rizz_font_vertex* verts = sx_malloc(tmp_alloc, sizeof(rizz_font_vertex) * num_verts);
+        sx_assert_always(verts);
+        font__layout_verts(layout, pos, sx_colorn(state->color), verts);
+        font__draw_verts(fons, verts, num_verts, state);
+    }
 }
 
 void font__drawf(const rizz_font* fnt, sx_vec2 pos, const char* fmt, ...)
@@ -514,7 +768,26 @@ void font__clear_state(const rizz_font* fnt)
 
 rizz_font_bounds font__bounds(const rizz_font* fnt, sx_vec2 pos, const char* text)
 {
-    const font__fons* fons = (const font__fons*)fnt;
+    font__fons* fons = (font__fons*)fnt;
+    if (fons->sdf) {
+        // bounds of the sdf glyph quads, vertically extended to line bounds like fontstash does
+        const font__layout* layout = font__get_layout(fons, text);
+        if (!layout) {
+            return (rizz_font_bounds){ .rect = sx_rectf(pos.x, pos.y, pos.x, pos.y) };
+        }
+
+        float ox = sx_floor(pos.x), oy = sx_floor(pos.y);
+        float minx = ox, maxx = ox;
+        for (int i = 0; i < layout->num_glyphs; i++) {
+            minx = sx_min(minx, layout->glyphs[i].x0 + ox);
+            maxx = sx_max(maxx, layout->glyphs[i].x1 + ox);
+        }
+        float miny = 0, maxy = 0;
+        fonsLineBounds(fons->ctx, oy, &miny, &maxy);
+        return (rizz_font_bounds){ .rect = sx_rectf(minx, miny, maxx, maxy),
+                                   .advance = layout->advance };
+    }
+
     float bounds[4] = { 0 };
     float advance = fonsTextBounds(fons->ctx, pos.x, pos.y, text, NULL, bounds);
     return (rizz_font_bounds){ .rect = sx_rectf(bounds[0], bounds[1], bounds[2], bounds[3]),
@@ -660,4 +933,517 @@ void font__set_draw_api(rizz_api_gfx_draw* api)
 {
     sx_assert(api);
     g_font.draw_api = api;
-}
\ No newline at end of file
+}
+
+void font__clear_atlas(const rizz_font* fnt)
+{
+    font__fons* fons = (font__fons*)fnt;
+    fonsResetAtlas(fons->ctx, fons->f.img_width, fons->f.img_height);
+
+    sx_array_clear(fons->sdf_glyphs);
+    if (fons->sdf_glyph_tbl) {
+        sx_hashtbl_clear(fons->sdf_glyph_tbl);
+    }
+
+    // glyphs are re-rasterized after reset, so batched vertices point to the old glyph locations
+    sx_array_clear(fons->batch_verts);
+    sx_array_clear(fons->batches);
+}
+
+static inline uint32_t font__sdf_key(int font_id, uint32_t codepoint)
+{
+    return ((uint32_t)font_id << 21) | codepoint;
+}
+
+typedef struct font__sdf_rasterize_data {
+    const stbtt_fontinfo* info;
+    FONScontext* scratch_ctxs;    // one per thread, stb_truetype only uses their scratch memory
+    const int* glyph_indices;
+    font__sdf_glyph* glyphs;
+    uint8_t* bitmaps;             // (bitmap_w*bitmap_h) bytes per glyph
+    int bitmap_w;
+    int bitmap_h;
+    int padding;
+    float scale;
+} font__sdf_rasterize_data;
+
+static void font__sdf_rasterize_job_cb(int start, int end, int thrd_index, void* user)
+{
+    font__sdf_rasterize_data* data = user;
+    FONScontext* scratch_ctx = &data->scratch_ctxs[thrd_index];
+
+    // fontinfo is copied, so allocations of this thread go to it's own scratch buffer
+    stbtt_fontinfo info = *data->info;
+    info.userdata = scratch_ctx;
+
+    for (int i = start; i < end; i++) {
+        int glyph_index = data->glyph_indices[i];
+        font__sdf_glyph* g = &data->glyphs[i];
+        int advance, lsb, w = 0, h = 0, xoff = 0, yoff = 0;
+
+        scratch_ctx->nscratch = 0;
+        stbtt_GetGlyphHMetrics(&info, glyph_index, &advance, &lsb);
+        uint8_t* sdf = stbtt_GetGlyphSDF(&info, data->scale, glyph_index, data->padding,
+                                         SDF_ONEDGE_VALUE,
+                                         (float)SDF_ONEDGE_VALUE / (float)data->padding, &w, &h,
+                                         &xoff, &yoff);
+
+        *g = (font__sdf_glyph){ .xoff = (float)xoff,
+                                .yoff = (float)yoff,
+                                .advance = (float)advance,
+                                .index = glyph_index };
+
+        // glyphs without shape (space) have no bitmap
+        if (sdf) {
+            g->w = sx_min(w, data->bitmap_w);
+            g->h = sx_min(h, data->bitmap_h);
+            uint8_t* dst = data->bitmaps + (size_t)i * data->bitmap_w * data->bitmap_h;
+            for (int y = 0; y < g->h; y++) {
+                sx_memcpy(dst + y * g->w, sdf + y * w, g->w);
+            }
+        }
+    }
+}
+
+// rasterizes new sdf glyphs in parallel and packs them into the atlas
+static void font__sdf_rasterize(font__fons* fons, FONSfont* font, const int* new_ids,
+                                const int* glyph_indices, int num_new)
+{
+    FONScontext* ctx = fons->ctx;
+    const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
+    sx_scope(the_core->tmp_alloc_pop()) {
+        uint64_t start_tm = sx_tm_now();
+        float scale = fons__tt_getPixelHeightScale(&font->font, fons->sdf_size);
+        int bx0, by0, bx1, by1;
+        stbtt_GetFontBoundingBox(&font->font.font, &bx0, &by0, &bx1, &by1);
+
+        font__sdf_rasterize_data data = {
+            .info = &font->font.font,
+            .glyph_indices = glyph_indices,
+            .bitmap_w = (int)((float)(bx1 - bx0) * scale) + fons->sdf_padding * 2 + 2,
+            .bitmap_h = (int)((float)(by1 - by0) * scale) + fons->sdf_padding * 2 + 2,
+            .padding = fons->sdf_padding,
+            .scale = scale
+        };
+
+        bool use_jobs = num_new >= SDF_MIN_JOB_GLYPHS;
+        int num_scratch_ctxs = use_jobs ? (the_core->job_num_threads() + 1) : 1;
+        data.glyphs = sx_malloc(tmp_alloc, sizeof(font__sdf_glyph) * num_new);
+        data.bitmaps = sx_malloc(tmp_alloc, (size_t)data.bitmap_w * data.bitmap_h * num_new);
+        data.scratch_ctxs = sx_malloc(tmp_alloc, (sizeof(FONScontext) + FONS_SCRATCH_BUF_SIZE) * num_scratch_ctxs);
+        sx_assert_always(data.glyphs && data.bitmaps && data.scratch_ctxs);
+
+        uint8_t* scratch_buff = (uint8_t*)(data.scratch_ctxs + num_scratch_ctxs);
+        for (int i = 0; i < num_scratch_ctxs; i++) {
+            sx_memset(&data.scratch_ctxs[i], 0x0, sizeof(FONScontext));
+            data.scratch_ctxs[i].scratch = scratch_buff + (size_t)i * FONS_SCRATCH_BUF_SIZE;
+        }
+
+        if (use_jobs) {
+            sx_job_t job = the_core->job_dispatch(num_new, font__sdf_rasterize_job_cb, &data,
+                                                  SX_JOB_PRIORITY_HIGH, 0);
+            the_core->job_wait_and_del(job);
+        } else {
+            font__sdf_rasterize_job_cb(0, num_new, 0, &data);
+        }
+
+        // pack into the atlas on this thread, fontstash atlas and texture data are not thread-safe
+        for (int i = 0; i < num_new; i++) {
+            font__sdf_glyph* g = &data.glyphs[i];
+            if (g->w > 0 && g->h > 0) {
+                int gx, gy;
+                int added = fons__atlasAddRect(ctx->atlas, g->w, g->h, &gx, &gy, ctx->params.allocPtr);
+                if (!added && ctx->handleError) {
+                    ctx->handleError(ctx->errorUptr, FONS_ATLAS_FULL, 0);
+                    added = fons__atlasAddRect(ctx->atlas, g->w, g->h, &gx, &gy, ctx->params.allocPtr);
+                }
+
+                if (added) {
+                    const uint8_t* src = data.bitmaps + (size_t)i * data.bitmap_w * data.bitmap_h;
+                    for (int y = 0; y < g->h; y++) {
+                        sx_memcpy(&ctx->texData[(gy + y) * ctx->params.width + gx], src + y * g->w, g->w);
+                    }
+                    g->x = gx;
+                    g->y = gy;
+                } else {
+                    g->w = g->h = 0;
+                }
+            }
+            fons->sdf_glyphs[new_ids[i]] = *g;
+        }
+
+        fons->img_dirty = true;
+        rizz_log_debug("font: '%s' rasterized %d sdf glyphs (%.2f ms)", fons->name, num_new,
+                       sx_tm_ms(sx_tm_since(start_tm)));
+    }
+}
+
+// makes sure all codepoints have sdf glyphs in the atlas, new glyphs are rasterized in parallel
+// glyph_ids receives the index to fons->sdf_glyphs for each codepoint
+static void font__sdf_add_glyphs(font__fons* fons, int font_id, const uint32_t* codepoints,
+                                 int count, int* glyph_ids)
+{
+    FONScontext* ctx = fons->ctx;
+    FONSfont* font = ctx->fonts[font_id];
+
+    if (!fons->sdf_glyph_tbl) {
+        fons->sdf_glyph_tbl = sx_hashtbl_create(g_font.alloc, LAYOUT_CACHE_INIT_CAPACITY);
+        sx_assert_always(fons->sdf_glyph_tbl);
+    }
+
+    const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
+    sx_scope(the_core->tmp_alloc_pop()) {
+        int* new_ids = sx_malloc(tmp_alloc, sizeof(int) * count);
+        int* glyph_indices = sx_malloc(tmp_alloc, sizeof(int) * count);
+        sx_assert_always(new_ids && glyph_indices);
+
+        // new glyphs are added to the table right away, so duplicates in the text are rasterized once
+        int num_new = 0;
+        for (int i = 0; i < count; i++) {
+            uint32_t key = font__sdf_key(font_id, codepoints[i]);
+            int id = sx_hashtbl_find_get(fons->sdf_glyph_tbl, key, -1);
+            if (id == -1) {
+                id = sx_array_count(fons->sdf_glyphs);
+                sx_array_push(g_font.alloc, fons->sdf_glyphs, (font__sdf_glyph){ .index = -1 });
+                if (sx_hashtbl_full(fons->sdf_glyph_tbl)) {
+                    sx_hashtbl_grow(&fons->sdf_glyph_tbl, g_font.alloc);
+                }
+                sx_hashtbl_add(fons->sdf_glyph_tbl, key, id);
+                new_ids[num_new] = id;
+                glyph_indices[num_new] = fons__tt_getGlyphIndex(&font->font, (int)codepoints[i]);
+                ++num_new;
+            }
+            glyph_ids[i] = id;
+        }
+
+        if (num_new > 0) {
+            font__sdf_rasterize(fons, font, new_ids, glyph_indices, num_new);
+        }
+    }
+}
+
+static int font__sdf_layout(font__fons* fons, const char* text, int text_len, font__glyph* glyphs,
+                            float* padvance)
+{
+    FONScontext* ctx = fons->ctx;
+    const FONSstate* state = fons__getState(ctx);
+    *padvance = 0;
+    if (state->font < 0 || state->font >= ctx->nfonts || !ctx->fonts[state->font]->data) {
+        return 0;
+    }
+    FONSfont* font = ctx->fonts[state->font];
+
+    int num_glyphs = 0;
+    const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
+    sx_scope(the_core->tmp_alloc_pop()) {
+        uint32_t* codepoints = sx_malloc(tmp_alloc, sizeof(uint32_t) * (text_len + 1));
+        int* glyph_ids = sx_malloc(tmp_alloc, sizeof(int) * (text_len + 1));
+        sx_assert_always(codepoints && glyph_ids);
+
+        int num_codepoints = 0;
+        uint32_t utf8state = 0, codepoint;
+        for (int i = 0; i < text_len; i++) {
+            if (!fons__decutf8(&utf8state, &codepoint, (uint8_t)text[i])) {
+                codepoints[num_codepoints++] = codepoint;
+            }
+        }
+        font__sdf_add_glyphs(fons, state->font, codepoints, num_codepoints, glyph_ids);
+
+        // glyph metrics are in reference size pixels, kerning and advances in font units
+        float scale = fons__tt_getPixelHeightScale(&font->font, state->size);
+        float sdf_scale = state->size / fons->sdf_size;
+        float itw = 1.0f / (float)ctx->params.width;
+        float ith = 1.0f / (float)ctx->params.height;
+        float x = 0;
+        float y = fons__getVertAlign(ctx, font, state->align, (short)(state->size * 10.0f));
+        int prev_index = -1;
+
+        for (int i = 0; i < num_codepoints; i++) {
+            const font__sdf_glyph* g = &fons->sdf_glyphs[glyph_ids[i]];
+            if (prev_index != -1) {
+                x += (float)fons__tt_getGlyphKernAdvance(&font->font, prev_index, g->index) * scale +
+                     state->spacing;
+            }
+
+            if (g->w > 0) {
+                float x0 = x + g->xoff * sdf_scale;
+                float y0 = y + g->yoff * sdf_scale;
+                glyphs[num_glyphs++] = (font__glyph){ .x0 = x0,
+                                                      .y0 = y0,
+                                                      .x1 = x0 + (float)g->w * sdf_scale,
+                                                      .y1 = y0 + (float)g->h * sdf_scale,
+                                                      .s0 = (float)g->x * itw,
+                                                      .t0 = (float)g->y * ith,
+                                                      .s1 = (float)(g->x + g->w) * itw,
+                                                      .t1 = (float)(g->y + g->h) * ith };
+            }
+            x += g->advance * scale;
+            prev_index = g->index;
+        }
+
+        float align_offset = 0;
+        if (state->align & FONS_ALIGN_RIGHT) {
+            align_offset = -x;
+        } else if (state->align & FONS_ALIGN_CENTER) {
+            align_offset = -x * 0.5f;
+        }
+        if (!(state->align & FONS_ALIGN_LEFT) && align_offset != 0) {
+            for (int i = 0; i < num_glyphs; i++) {
+                glyphs[i].x0 += align_offset;
+                glyphs[i].x1 += align_offset;
+            }
+        }
+        *padvance = x;
+    }
+
+    return num_glyphs;
+}
+
+static font__layout* font__create_layout(font__fons* fons, const font__layout_key* key,
+                                         uint32_t hash, const char* text, int text_len)
+{
+    const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
+    font__layout* layout = NULL;
+    sx_scope(the_core->tmp_alloc_pop()) {
+        font__glyph* glyphs = sx_malloc(tmp_alloc, sizeof(font__glyph) * (text_len + 1));
+        sx_assert_always(glyphs);
+
+        // rasterizing new glyphs may resize the atlas, which invalidates the texcoords of the
+        // previous glyphs in the run, so lay it out again. glyphs are in the atlas the second time
+        int num_glyphs = 0;
+        float advance = 0;
+        for (int retry = 0; retry < 2; retry++) {
+            int atlas_gen = fons->atlas_gen;
+            if (fons->sdf) {
+                num_glyphs = font__sdf_layout(fons, text, text_len, glyphs, &advance);
+            } else {
+                FONStextIter iter;
+                num_glyphs = 0;
+                if (fonsTextIterInit(fons->ctx, &iter, 0, 0, text, text + text_len)) {
+                    float startx = iter.x;
+                    FONSquad q;
+                    sx_memset(&q, 0x0, sizeof(q));
+                    while (fonsTextIterNext(fons->ctx, &iter, &q)) {
+                        // iterator doesn't touch the quad if the glyph is missing
+                        if (q.x1 > q.x0 && q.y1 > q.y0) {
+                            glyphs[num_glyphs++] = (font__glyph){ .x0 = q.x0, .y0 = q.y0,
+                                                                  .x1 = q.x1, .y1 = q.y1,
+                                                                  .s0 = q.s0, .t0 = q.t0,
+                                                                  .s1 = q.s1, .t1 = q.t1 };
+                        }
+                        sx_memset(&q, 0x0, sizeof(q));
+                    }
+                    advance = iter.nextx - startx;
+                }
+            }
+
+            if (atlas_gen == fons->atlas_gen) {
+                break;
+            }
+        }
+
+        layout = sx_malloc(g_font.alloc, sizeof(font__layout) + sizeof(font__glyph) * num_glyphs +
+                                             text_len + 1);
+        if (layout) {
+            *layout = (font__layout){ .key = *key,
+                                      .hash = hash,
+                                      .num_glyphs = num_glyphs,
+                                      .text_len = text_len,
+                                      .advance = advance,
+                                      .glyphs = (font__glyph*)(layout + 1) };
+            layout->text = (char*)(layout->glyphs + num_glyphs);
+            sx_memcpy(layout->glyphs, glyphs, sizeof(font__glyph) * num_glyphs);
+            sx_memcpy(layout->text, text, text_len);
+            layout->text[text_len] = '\0';
+        } else {
+            sx_out_of_memory();
+        }
+    }
+
+    return layout;
+}
+
+static const font__layout* font__get_layout(font__fons* fons, const char* text)
+{
+    const FONSstate* state = fons__getState(fons->ctx);
+    font__layout_key key = { .font = state->font,
+                             .align = state->align,
+                             .size = state->size,
+                             .blur = state->blur,
+                             .spacing = state->spacing };
+    int text_len = sx_strlen(text);
+    uint32_t hash = sx_hash_xxh32(text, (size_t)text_len, sx_hash_xxh32(&key, sizeof(key), 0));
+    hash = hash ? hash : 1;    // zero is the empty key in the hash table
+
+    if (!fons->layout_tbl) {
+        fons->layout_tbl = sx_hashtbl_create(g_font.alloc, LAYOUT_CACHE_INIT_CAPACITY);
+        sx_assert_always(fons->layout_tbl);
+    }
+
+    int64_t frame = the_core->frame_index();
+    int index = sx_hashtbl_find(fons->layout_tbl, hash);
+    if (index != -1) {
+        int layout_idx = sx_hashtbl_get(fons->layout_tbl, index);
+        font__layout* layout = fons->layouts[layout_idx];
+        if (layout->text_len == text_len && sx_memcmp(&layout->key, &key, sizeof(key)) == 0 &&
+            sx_memcmp(layout->text, text, text_len) == 0) {
+            layout->last_frame = frame;
+            ++g_font.stats.cache_hits;
+            return layout;
+        }
+
+        // hash collision, the new layout replaces the old one
+        font__remove_layout(fons, layout_idx);
+    }
+
+    font__layout* layout = font__create_layout(fons, &key, hash, text, text_len);
+    if (!layout) {
+        return NULL;
+    }
+    layout->last_frame = frame;
+
+    if (sx_hashtbl_full(fons->layout_tbl)) {
+        sx_hashtbl_grow(&fons->layout_tbl, g_font.alloc);
+    }
+    sx_hashtbl_add(fons->layout_tbl, hash, sx_array_count(fons->layouts));
+    sx_array_push(g_font.alloc, fons->layouts, layout);
+    ++g_font.stats.cache_misses;
+    return layout;
+}
+
+// writes 6 vertices per glyph of the layout
+static void font__layout_verts(const font__layout* layout, sx_vec2 pos, sx_color color,
+                               rizz_font_vertex* verts)
+{
+    // layouts are made at the origin, translating by whole pixels keeps fontstash's glyph snapping
+    float ox = sx_floor(pos.x);
+    float oy = sx_floor(pos.y);
+
+    // same triangle order as fons__draw_fn, which is flipped for the reversed Y
+    for (int i = 0; i < layout->num_glyphs; i++) {
+        const font__glyph* g = &layout->glyphs[i];
+        float x0 = g->x0 + ox, y0 = g->y0 + oy;
+        float x1 = g->x1 + ox, y1 = g->y1 + oy;
+
+        rizz_font_vertex* v = &verts[i * 6];
+        v[0] = (rizz_font_vertex){ .pos = sx_vec2f(x1, y0), .uv = sx_vec2f(g->s1, g->t0), .color = color };
+        v[1] = (rizz_font_vertex){ .pos = sx_vec2f(x1, y1), .uv = sx_vec2f(g->s1, g->t1), .color = color };
+        v[2] = (rizz_font_vertex){ .pos = sx_vec2f(x0, y0), .uv = sx_vec2f(g->s0, g->t0), .color = color };
+        v[3] = (rizz_font_vertex){ .pos = sx_vec2f(x1, y1), .uv = sx_vec2f(g->s1, g->t1), .color = color };
+        v[4] = (rizz_font_vertex){ .pos = sx_vec2f(x0, y1), .uv = sx_vec2f(g->s0, g->t1), .color = color };
+        v[5] = (rizz_font_vertex){ .pos = sx_vec2f(x0, y0), .uv = sx_vec2f(g->s0, g->t0), .color = color };
+    }
+}
+
+void font__batch_draw(const rizz_font* fnt, sx_vec2 pos, const char* text)
+{
+    uint64_t start_tm = sx_tm_now();
+    font__fons* fons = (font__fons*)fnt;
+
+    const font__layout* layout = font__get_layout(fons, text);
+    if (!layout || layout->num_glyphs == 0) {
+        return;
+    }
+
+    const FONSstate* state = fons__getState(fons->ctx);
+
+    int num_batches = sx_array_count(fons->batches);
+    font__batch* batch = num_batches > 0 ? &fons->batches[num_batches - 1] : NULL;
+    if (!batch || sx_memcmp(batch->mat, state->mat, sizeof(state->mat)) != 0 ||
+        sx_memcmp(batch->scissor, state->scissor, sizeof(state->scissor)) != 0) {
+        batch = sx_array_add(g_font.alloc, fons->batches, 1);
+        batch->start_vertex = sx_array_count(fons->batch_verts);
+        batch->num_verts = 0;
+        sx_memcpy(batch->scissor, state->scissor, sizeof(state->scissor));
+        sx_memcpy(batch->mat, state->mat, sizeof(state->mat));
+    }
+
+    int num_verts = layout->num_glyphs * 6;
+    rizz_font_vertex* verts = sx_array_add(g_font.alloc, fons->batch_verts, num_verts);
+    sx_assert_always(verts);
+    font__layout_verts(layout, pos, sx_colorn(state->color), verts);
+    batch->num_verts += num_verts;
+
+    g_font.stats.num_glyphs += layout->num_glyphs;
+    g_font.stats.draw_ms += (float)sx_tm_ms(sx_tm_since(start_tm));
+}
+
+void font__batch_drawf(const rizz_font* fnt, sx_vec2 pos, const char* fmt, ...)
+{
+    char text[1024];
+    va_list args;
+    va_start(args, fmt);
+    sx_vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+    font__batch_draw(fnt, pos, text);
+}
+
+void font__batch_flush(void)
+{
+    uint64_t start_tm = sx_tm_now();
+    rizz_api_gfx_draw* draw_api = g_font.draw_api;
+
+    for (int i = 0, c = sx_array_count(g_font.fonts); i < c; i++) {
+        font__fons* fons = g_font.fonts[i];
+        int num_verts = sx_array_count(fons->batch_verts);
+        if (num_verts == 0) {
+            continue;
+        }
+
+        // batches that don't fit into the remaining space are truncated (glyph quads are 6 verts)
+        num_verts = font__reserve_verts(fons, num_verts, 6);
+        if (num_verts == 0) {
+            sx_array_clear(fons->batch_verts);
+            sx_array_clear(fons->batches);
+            continue;
+        }
+
+        // all batches of the font are uploaded at once and drawn with a single pipeline/binding
+        int vb_offset = draw_api->append_buffer(g_font.vbuff, fons->batch_verts,
+                                                sizeof(rizz_font_vertex) * num_verts);
+        sg_bindings bindings = { .vertex_buffers[0] = g_font.vbuff,
+                                 .vertex_buffer_offsets[0] = vb_offset,
+                                 .fs_images[0] = fons->f.img_atlas };
+        draw_api->apply_pipeline(fons->sdf ? g_font.pip_sdf : g_font.pip);
+        draw_api->apply_bindings(&bindings);
+
+        for (int b = 0, bc = sx_array_count(fons->batches); b < bc; b++) {
+            const font__batch* batch = &fons->batches[b];
+            int count = sx_min(batch->num_verts, num_verts - batch->start_vertex);
+            if (count <= 0) {
+                break;
+            }
+
+            if (batch->scissor[2] > 0 && batch->scissor[3] > 0) {
+                draw_api->apply_scissor_rect(batch->scissor[0], batch->scissor[1], batch->scissor[2],
+                                             batch->scissor[3], !the_gfx->GL_family());
+            }
+            draw_api->apply_uniforms(SG_SHADERSTAGE_VS, 0, batch->mat, sizeof(batch->mat));
+            draw_api->draw(batch->start_vertex, count, 1);
+            ++g_font.stats.num_draws;
+        }
+
+        sx_array_clear(fons->batch_verts);
+        sx_array_clear(fons->batches);
+    }
+
+    g_font.stats.flush_ms = (float)sx_tm_ms(sx_tm_since(start_tm));
+    g_font.stats.num_layouts = 0;
+    for (int i = 0, c = sx_array_count(g_font.fonts); i < c; i++) {
+        g_font.stats.num_layouts += sx_array_count(g_font.fonts[i]->layouts);
+    }
+
+    g_font.stats.atlas_bytes = 0;
+    for (int i = 0, c = sx_array_count(g_font.fonts); i < c; i++) {
+        g_font.stats.atlas_bytes += g_font.fonts[i]->f.img_width * g_font.fonts[i]->f.img_height;
+    }
+
+    g_font.last_stats = g_font.stats;
+    sx_memset(&g_font.stats, 0x0, sizeof(g_font.stats));
+}
+
+void font__batch_stats(rizz_font_batch_stats* stats)
+{
+    sx_assert(stats);
+    *stats = g_font.last_stats;
+}
@@ -8,6 +8,13 @@ layout (location = SV_Target0) out vec4 frag_color;
 layout (binding = 0) uniform sampler2D tex_font_atlas;
 
 void main() {
+#ifdef SDF
+    // atlas holds distance to glyph edge (0.5 = edge), antialias over one screen pixel
+    float dist = texture(tex_font_atlas, f_uv).r;
+    float w = max(fwidth(dist) * 0.7, 0.001);
+    vec4 color = vec4(1.0, 1.0, 1.0, smoothstep(0.5 - w, 0.5 + w, dist));
+#else
     vec4 color = vec4(1.0, 1.0, 1.0, texture(tex_font_atlas, f_uv).r);
+#endif
     frag_color = color * f_color;
 }
\ No newline at end of file
@@ -4,11 +4,14 @@
 #include "sx/array.h"
 #include "sx/handle.h"
 #include "sx/hash.h"
+#include "sx/io.h"
 #include "sx/linear-buffer.h"
 #include "sx/math-vec.h"
 #include "sx/os.h"
 #include "sx/pool.h"
+#include "sx/simd.h"
 #include "sx/string.h"
+#include "sx/timer.h"
 
 #include "rizz/imgui.h"
 #include "rizz/json.h"
@@ -26,6 +29,15 @@
 #define MAX_INDICES 6000
 #define ANIMCTRL_PARAM_ID_END INT_MAX
 
+// clips are updated in SoA blocks of this size, batches below the job threshold stay on the
+// calling thread, because dispatching jobs costs more than updating them
+#define ANIMCLIP_BLOCK_SIZE 256
+#define ANIMCLIP_MIN_JOB_CLIPS 4096
+
+// per-clip event bits, written by update jobs and flushed into event queues on the calling thread
+#define ANIMCLIP_EVENTBIT_END 0x1
+#define ANIMCLIP_EVENTBIT_FRAME 0x2
+
 RIZZ_STATE static rizz_api_core* the_core;
 RIZZ_STATE static rizz_api_asset* the_asset;
 RIZZ_STATE static rizz_api_gfx* the_gfx;
@@ -62,6 +74,7 @@ typedef struct atlas__data {
     sx_hashtbl sprite_tbl;    // key: name, value:index-to-sprites
     rizz_sprite_vertex* vertices;
     uint16_t* indices;
+    uint64_t prepare_tm;    // ticks spent in on_prepare, logged with the load time
 } atlas__data;
 
 typedef struct sprite__animclip_frame {
@@ -73,9 +86,7 @@ typedef struct sprite__animclip_frame {
 typedef struct sprite__animclip {
     rizz_asset atlas;
     int num_frames;
-    float tm;
     float fps;
-    float len;
     int frame_id;
     rizz_sprite_flip flip;
     bool trigger_end_event;
@@ -132,6 +143,7 @@ typedef struct sprite__animctrl {
     sprite__animctrl_param params[RIZZ_SPRITE_ANIMCTRL_MAX_PARAMS];
     rizz_event_queue equeue;
     void* buff;
+    bool params_dirty;    // param transitions are only evaluated when a param or the state has changed
 } sprite__animctrl;
 
 typedef struct sprite__draw_context {
@@ -152,10 +164,22 @@ typedef struct sprite__context {
     sprite__draw_context drawctx;
     sx_handle_pool* animclip_handles;
     sprite__animclip* animclips;
+    // time and length of clips in SoA form, indexed like `animclips`. clip functions keep them up
+    // to date, so batch updates read and write them in place. arrays are 16 byte aligned
+    float* animclip_tms;
+    float* animclip_lens;
+    int animclip_soa_capacity;
     sx_handle_pool* animctrl_handles;
     sprite__animctrl* animctrls;
 } sprite__context;
 
+typedef struct sprite__animclip_update_data {
+    int* indices;
+    uint8_t* event_bits;
+    int num_clips;
+    float dt;
+} sprite__animclip_update_data;
+
 typedef struct sprite__sort_key {
     uint64_t key;
     int orig_index;
@@ -227,9 +251,34 @@ RIZZ_STATE static sprite__context g_spr;
 void sprite__animclip_restart(rizz_sprite_animclip handle)
 {
     sx_assert_always(sx_handle_valid(g_spr.animclip_handles, handle.id));
-    sprite__animclip* clip = &g_spr.animclips[sx_handle_index(handle.id)];
-    clip->frame_id = 0;
-    clip->tm = 0;
+    int index = sx_handle_index(handle.id);
+    g_spr.animclips[index].frame_id = 0;
+    g_spr.animclip_tms[index] = 0;
+}
+
+// grows SoA arrays to hold clip `index`, new clips are reset to zero time
+static bool sprite__animclip_soa_reserve(int index)
+{
+    if (index < g_spr.animclip_soa_capacity) {
+        return true;
+    }
+
+    int capacity = sx_max(g_spr.animclip_soa_capacity << 1, sx_align_mask(index + 1, 255));
+    float* tms = sx_aligned_realloc(g_spr.alloc, g_spr.animclip_tms, sizeof(float) * capacity, 16);
+    if (!tms) {
+        sx_out_of_memory();
+        return false;
+    }
+    g_spr.animclip_tms = tms;
+
+    float* lens = sx_aligned_realloc(g_spr.alloc, g_spr.animclip_lens, sizeof(float) * capacity, 16);
+    if (!lens) {
+        sx_out_of_memory();
+        return false;
+    }
+    g_spr.animclip_lens = lens;
+    g_spr.animclip_soa_capacity = capacity;
+    return true;
 }
 
 rizz_sprite_animclip sprite__animclip_create(const rizz_sprite_animclip_desc* desc)
@@ -258,9 +307,9 @@ rizz_sprite_animclip sprite__animclip_create(const rizz_sprite_animclip_desc* de
     sprite__animclip clip = { .atlas = desc->atlas,
                               .num_frames = num_frames,
                               .fps = desc->fps,
-                              .len = desc->length,
                               .trigger_end_event = desc->trigger_end_event,
                               .alloc = alloc };
+    float len = desc->length;
 
     if (clip.num_frames < desc->num_frames) {
         rizz_log_warn("num_frames exceeded maximum amount (%d) for sprite-animclip: 0x%x",
@@ -268,9 +317,9 @@ rizz_sprite_animclip sprite__animclip_create(const rizz_sprite_animclip_desc* de
     }
 
     if (clip.fps > 0) {
-        clip.len = (float)clip.num_frames / clip.fps;
-    } else if (clip.len > 0) {
-        clip.fps = (float)clip.num_frames / clip.len;
+        len = (float)clip.num_frames / clip.fps;
+    } else if (len > 0) {
+        clip.fps = (float)clip.num_frames / len;
     } else {
         sx_assertf(0, "must define either 'fps' or 'length'");
     }
@@ -285,6 +334,8 @@ rizz_sprite_animclip sprite__animclip_create(const rizz_sprite_animclip_desc* de
         sx_malloc(alloc, sizeof(sprite__animclip_frame) * clip.num_frames);
     if (!frames) {
         sx_out_of_memory();
+        the_asset->unload(desc->atlas);
+        sx_handle_del(g_spr.animclip_handles, handle);
         return (rizz_sprite_animclip){ 0 };
     }
     clip.frames = frames;
@@ -306,7 +357,18 @@ rizz_sprite_animclip sprite__animclip_create(const rizz_sprite_animclip_desc* de
         frame->e = frame_desc->event;
     }
 
-    sx_array_push_byindex(g_spr.alloc, g_spr.animclips, clip, sx_handle_index(handle));
+    int index = sx_handle_index(handle);
+    if (!sprite__animclip_soa_reserve(index)) {
+#if RIZZ_SPRITE_ANIMCLIP_MAX_FRAMES == 0
+        sx_free(alloc, frames);
+#endif
+        the_asset->unload(desc->atlas);
+        sx_handle_del(g_spr.animclip_handles, handle);
+        return (rizz_sprite_animclip){ 0 };
+    }
+    g_spr.animclip_tms[index] = 0;
+    g_spr.animclip_lens[index] = len;
+    sx_array_push_byindex(g_spr.alloc, g_spr.animclips, clip, index);
 
     return (rizz_sprite_animclip){ handle };
 }
@@ -323,7 +385,6 @@ rizz_sprite_animclip sprite__animclip_clone(rizz_sprite_animclip src_handle)
     sprite__animclip clip = { .atlas = src->atlas,
                               .num_frames = src->num_frames,
                               .fps = src->fps,
-                              .len = src->len,
                               .trigger_end_event = src->trigger_end_event,
                               .alloc = src->alloc };
 
@@ -333,6 +394,7 @@ rizz_sprite_animclip sprite__animclip_clone(rizz_sprite_animclip src_handle)
         sx_malloc(clip.alloc, sizeof(sprite__animclip_frame) * clip.num_frames);
     if (!frames) {
         sx_out_of_memory();
+        sx_handle_del(g_spr.animclip_handles, handle);
         return (rizz_sprite_animclip){ 0 };
     }
     clip.frames = frames;
@@ -341,7 +403,18 @@ rizz_sprite_animclip sprite__animclip_clone(rizz_sprite_animclip src_handle)
     sx_memcpy(clip.frames, src->frames, sizeof(sprite__animclip_frame) * clip.num_frames);
     the_asset->ref_add(clip.atlas);
 
-    sx_array_push_byindex(g_spr.alloc, g_spr.animclips, clip, sx_handle_index(handle));
+    int index = sx_handle_index(handle);
+    if (!sprite__animclip_soa_reserve(index)) {
+#if RIZZ_SPRITE_ANIMCLIP_MAX_FRAMES == 0
+        sx_free(clip.alloc, clip.frames);
+#endif
+        the_asset->unload(clip.atlas);
+        sx_handle_del(g_spr.animclip_handles, handle);
+        return (rizz_sprite_animclip){ 0 };
+    }
+    g_spr.animclip_tms[index] = 0;
+    g_spr.animclip_lens[index] = g_spr.animclip_lens[sx_handle_index(src_handle.id)];
+    sx_array_push_byindex(g_spr.alloc, g_spr.animclips, clip, index);
 
     return (rizz_sprite_animclip){ handle };
 }
@@ -362,34 +435,135 @@ void sprite__animclip_destroy(rizz_sprite_animclip handle)
     sx_handle_del(g_spr.animclip_handles, handle.id);
 }
 
-void sprite__animclip_update_batch(const rizz_sprite_animclip* handles, int num_clips, float dt)
-{
-    for (int i = 0; i < num_clips; i++) {
-        sx_assert_always(sx_handle_valid(g_spr.animclip_handles, handles[i].id));
+// updates a block of clips (count <= ANIMCLIP_BLOCK_SIZE): time is advanced and wrapped 4 clips at a
+// time in the SoA arrays, events are only recorded as bits in `event_bits`
+// groups of 4 neighbour clips (batches in creation order) are loaded and stored in place, others are
+// gathered and scattered
+static void sprite__animclip_update_block(const int* indices, uint8_t* event_bits, int count, float dt)
+{
+    float* tms = g_spr.animclip_tms;
+    float* lens = g_spr.animclip_lens;
+    sx_align_decl(16, float t4[4]);
+    sx_align_decl(16, float wrap4[4]);
+    sx_assert(count <= ANIMCLIP_BLOCK_SIZE);
+
+    // t = mod(tm + dt, len), floor is emulated with round for positive values
+    const sx_simd_t dt4 = sx_simd_splat1(dt);
+    const sx_simd_t one4 = sx_simd_splat1(1.0f);
+    const sx_simd_t eps4 = sx_simd_splat1(0.0001f);
+    for (int i = 0; i < count; i += 4) {
+        const int* idx = &indices[i];
+        int n = sx_min(4, count - i);
+        bool direct = n == 4 && (idx[0] & 3) == 0 && idx[1] == idx[0] + 1 && idx[2] == idx[0] + 2 &&
+                      idx[3] == idx[0] + 3;
+
+        sx_simd_t tm, len;
+        if (direct) {
+            tm = sx_simd_load(&tms[idx[0]]);
+            len = sx_simd_load(&lens[idx[0]]);
+        } else {
+            // the last group is padded with the last clip, padded lanes are not written back
+            int i1 = idx[sx_min(1, n - 1)], i2 = idx[sx_min(2, n - 1)], i3 = idx[n - 1];
+            tm = sx_simd_load4(tms[idx[0]], tms[i1], tms[i2], tms[i3]);
+            len = sx_simd_load4(lens[idx[0]], lens[i1], lens[i2], lens[i3]);
+        }
 
-        sprite__animclip* clip = &g_spr.animclips[sx_handle_index(handles[i].id)];
-        clip->end_triggered = false;
-        float tadvance = clip->tm + dt;
-        float t = sx_mod(tadvance, clip->len);    // progress time and wrap it onto time length
+        sx_simd_t tadvance = sx_simd_add(tm, dt4);
+        sx_simd_t q = sx_simd_div(tadvance, len);
+        sx_simd_t qr = sx_simd_round(q);
+        sx_simd_t qf = sx_simd_sub(qr, sx_simd_and(sx_simd_cmpgt(qr, q), one4));
+        sx_simd_t t = sx_simd_sub(tadvance, sx_simd_mul(len, qf));
 
         // detect timeline end
-        if (t < (tadvance - 0.0001f)) {
-            if (clip->trigger_end_event) {
-                rizz_event_push(&clip->equeue, RIZZ_SPRITE_ANIMCLIP_EVENT_END, NULL);
+        sx_simd_t wrap = sx_simd_and(sx_simd_cmplt(t, sx_simd_sub(tadvance, eps4)), one4);
+        sx_simd_store(t4, t);
+        sx_simd_store(wrap4, wrap);
+        if (direct) {
+            sx_simd_store(&tms[idx[0]], t);
+        }
+
+        for (int k = 0; k < n; k++) {
+            sprite__animclip* clip = &g_spr.animclips[idx[k]];
+            uint8_t bits = 0;
+            if (!direct) {
+                tms[idx[k]] = t4[k];
+            }
+
+            clip->end_triggered = wrap4[k] != 0;
+            if (clip->end_triggered && clip->trigger_end_event) {
+                bits |= ANIMCLIP_EVENTBIT_END;
             }
-            clip->end_triggered = true;
+
+            int frame_id = (int)(clip->fps * t4[k]);
+            frame_id = sx_min(frame_id, clip->num_frames - 1);
+
+            if (clip->frames[frame_id].trigger && frame_id != clip->frame_id) {
+                bits |= ANIMCLIP_EVENTBIT_FRAME;
+            }
+
+            clip->frame_id = frame_id;
+            event_bits[i + k] = bits;
         }
+    }
+}
+
+// job items are blocks, so a block is never split between threads
+static void sprite__animclip_update_job_cb(int start, int end, int thrd_index, void* user)
+{
+    sx_unused(thrd_index);
+    sprite__animclip_update_data* data = user;
+
+    for (int b = start; b < end; b++) {
+        int i = b * ANIMCLIP_BLOCK_SIZE;
+        sprite__animclip_update_block(&data->indices[i], &data->event_bits[i],
+                                      sx_min(ANIMCLIP_BLOCK_SIZE, data->num_clips - i), data->dt);
+    }
+}
+
+// NOTE: handles must be unique within a batch, because clips are updated in parallel (see 2dtools.h)
+void sprite__animclip_update_batch(const rizz_sprite_animclip* handles, int num_clips, float dt)
+{
+    if (num_clips <= 0) {
+        return;
+    }
+
+    const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
+    sx_scope(the_core->tmp_alloc_pop()) {
+        int* indices = sx_malloc(tmp_alloc, sizeof(int) * num_clips);
+        uint8_t* event_bits = sx_malloc(tmp_alloc, num_clips);
+        sx_assert_always(indices && event_bits);
 
-        int frame_id = (int)(clip->fps * t);
-        frame_id = sx_min(frame_id, clip->num_frames - 1);
+        for (int i = 0; i < num_clips; i++) {
+            sx_assert_always(sx_handle_valid(g_spr.animclip_handles, handles[i].id));
+            indices[i] = sx_handle_index(handles[i].id);
+        }
 
-        const sprite__animclip_frame* frame = &clip->frames[frame_id];
-        if (frame->trigger && frame_id != clip->frame_id) {
-            rizz_event_push(&clip->equeue, frame->e.e, frame->e.user);
+        sprite__animclip_update_data data = {
+            .indices = indices, .event_bits = event_bits, .num_clips = num_clips, .dt = dt
+        };
+        int num_blocks = (num_clips + ANIMCLIP_BLOCK_SIZE - 1) / ANIMCLIP_BLOCK_SIZE;
+        if (num_clips >= ANIMCLIP_MIN_JOB_CLIPS) {
+            sx_job_t job = the_core->job_dispatch(num_blocks, sprite__animclip_update_job_cb, &data,
+                                                  SX_JOB_PRIORITY_HIGH, 0);
+            the_core->job_wait_and_del(job);
+        } else {
+            sprite__animclip_update_job_cb(0, num_blocks, 0, &data);
         }
 
-        clip->frame_id = frame_id;
-        clip->tm = t;
+        // event queues are not thread-safe, flush recorded events in batch order
+        for (int i = 0; i < num_clips; i++) {
+            uint8_t bits = event_bits[i];
+            if (bits) {
+                sprite__animclip* clip = &g_spr.animclips[indices[i]];
+                if (bits & ANIMCLIP_EVENTBIT_END) {
+                    rizz_event_push(&clip->equeue, RIZZ_SPRITE_ANIMCLIP_EVENT_END, NULL);
+                }
+                if (bits & ANIMCLIP_EVENTBIT_FRAME) {
+                    const sprite__animclip_frame* frame = &clip->frames[clip->frame_id];
+                    rizz_event_push(&clip->equeue, frame->e.e, frame->e.user);
+                }
+            }
+        }
     }
 }
 
@@ -408,8 +582,7 @@ float sprite__animclip_fps(rizz_sprite_animclip handle)
 float sprite__animclip_len(rizz_sprite_animclip handle)
 {
     sx_assert_always(sx_handle_valid(g_spr.animclip_handles, handle.id));
-    sprite__animclip* clip = &g_spr.animclips[sx_handle_index(handle.id)];
-    return clip->len;
+    return g_spr.animclip_lens[sx_handle_index(handle.id)];
 }
 
 rizz_sprite_flip sprite__animclip_flip(rizz_sprite_animclip handle)
@@ -432,7 +605,7 @@ void sprite__animclip_set_fps(rizz_sprite_animclip handle, float fps)
     sprite__animclip* clip = &g_spr.animclips[sx_handle_index(handle.id)];
     sx_assert(clip->num_frames > 0);
     sx_assert(fps > 0);
-    clip->len = (float)clip->num_frames / fps;
+    g_spr.animclip_lens[sx_handle_index(handle.id)] = (float)clip->num_frames / fps;
     clip->fps = fps;
 }
 
@@ -443,7 +616,7 @@ void sprite__animclip_set_len(rizz_sprite_animclip handle, float length)
     sx_assert(clip->num_frames > 0);
     sx_assert(length > 0);
     clip->fps = (float)clip->num_frames / length;
-    clip->len = length;
+    g_spr.animclip_lens[sx_handle_index(handle.id)] = length;
 }
 
 void animclip_set_flip(rizz_sprite_animclip handle, rizz_sprite_flip flip)
@@ -488,7 +661,10 @@ void sprite__animctrl_set_paramb(rizz_sprite_animctrl handle, const char* name,
     sprite__animctrl* ctrl = &g_spr.animctrls[sx_handle_index(handle.id)];
     sprite__animctrl_param* p = sprite__animctrl_find_param(name, ctrl);
     sx_assert(p->type == RIZZ_SPRITE_PARAMTYPE_BOOL || p->type == RIZZ_SPRITE_PARAMTYPE_BOOL_AUTO);
-    p->value.b = b;
+    if (p->value.b != b) {
+        p->value.b = b;
+        ctrl->params_dirty = true;
+    }
 }
 
 void sprite__animctrl_set_parami(rizz_sprite_animctrl handle, const char* name, int i)
@@ -497,7 +673,10 @@ void sprite__animctrl_set_parami(rizz_sprite_animctrl handle, const char* name,
     sprite__animctrl* ctrl = &g_spr.animctrls[sx_handle_index(handle.id)];
     sprite__animctrl_param* p = sprite__animctrl_find_param(name, ctrl);
     sx_assert(p->type == RIZZ_SPRITE_PARAMTYPE_INT);
-    p->value.i = i;
+    if (p->value.i != i) {
+        p->value.i = i;
+        ctrl->params_dirty = true;
+    }
 }
 
 void sprite__animctrl_set_paramf(rizz_sprite_animctrl handle, const char* name, float f)
@@ -506,7 +685,10 @@ void sprite__animctrl_set_paramf(rizz_sprite_animctrl handle, const char* name,
     sprite__animctrl* ctrl = &g_spr.animctrls[sx_handle_index(handle.id)];
     sprite__animctrl_param* p = sprite__animctrl_find_param(name, ctrl);
     sx_assert(p->type == RIZZ_SPRITE_PARAMTYPE_FLOAT);
-    p->value.f = f;
+    if (p->value.f != f) {
+        p->value.f = f;
+        ctrl->params_dirty = true;
+    }
 }
 
 bool sprite__animctrl_param_valueb(rizz_sprite_animctrl handle, const char* name)
@@ -561,6 +743,7 @@ void sprite__animctrl_restart(rizz_sprite_animctrl handle)
     sx_assert_always(sx_handle_valid(g_spr.animctrl_handles, handle.id));
     sprite__animctrl* ctrl = &g_spr.animctrls[sx_handle_index(handle.id)];
     ctrl->state = ctrl->start_state;
+    ctrl->params_dirty = true;
     sprite__animclip_restart(ctrl->state->clip);
 }
 
@@ -696,7 +879,8 @@ rizz_sprite_animctrl sprite__animctrl_create(const rizz_sprite_animctrl_desc* de
         sprite__animctrl ctrl = (sprite__animctrl){
             .alloc = alloc,
             .start_state = states[sprite__animctrl_find_state(desc->start_state, hashes, num_states)],
-            .buff = _buff
+            .buff = _buff,
+            .params_dirty = true
         };
 
         ctrl.state = ctrl.start_state;
@@ -835,6 +1019,7 @@ static void sprite__animctrl_trigger_transition(sprite__animctrl* ctrl, int tran
     sprite__animctrl_transition* transition = &state->transitions[transition_id];
 
     ctrl->state = transition->target;
+    ctrl->params_dirty = true;    // transitions of the new state are evaluated on the next update
     if (transition->trigger_event) {
         rizz_event_push(&ctrl->equeue, transition->event.e, transition->event.user);
     }
@@ -864,31 +1049,41 @@ void sprite__animctrl_update_batch(const rizz_sprite_animctrl* handles, int num_
         for (int i = 0; i < num_ctrls; i++) {
             sprite__animctrl* ctrl = ctrls[i];
             sprite__animctrl_state* state = ctrl->state;
+            sx_assert(sx_handle_valid(g_spr.animclip_handles, state->clip.id));
+            bool clip_ended = g_spr.animclips[sx_handle_index(state->clip.id)].end_triggered;
+
+            // nothing that transitions depend on has changed since the last evaluation
+            if (!ctrl->params_dirty && !clip_ended) {
+                continue;
+            }
+
+            bool params_dirty = ctrl->params_dirty;
+            ctrl->params_dirty = false;
 
             // check parameterized transitions
             for (int t = 0, c = state->num_transitions; t < c; t++) {
                 sprite__animctrl_transition* transition = &state->transitions[t];
                 if (transition->trigger.param_id != ANIMCTRL_PARAM_ID_END) {
-                    bool r = k_compare_funcs[transition->trigger.func](
-                        (sprite__animctrl_value){ .i = transition->trigger.value.i },
-                        &ctrl->params[transition->trigger.param_id]);
-                    if (r) {
-                        sprite__animctrl_trigger_transition(ctrl, t);
-                        break;
-                    }
-                } else {
-                    sx_assert(sx_handle_valid(g_spr.animclip_handles, state->clip.id));
-                    sprite__animclip* clip = &g_spr.animclips[sx_handle_index(state->clip.id)];
-                    if (clip->end_triggered) {
+                    if (params_dirty &&
+                        k_compare_funcs[transition->trigger.func](
+                            (sprite__animctrl_value){ .i = transition->trigger.value.i },
+                            &ctrl->params[transition->trigger.param_id])) {
                         sprite__animctrl_trigger_transition(ctrl, t);
                         break;
                     }
+                } else if (clip_ended) {
+                    sprite__animctrl_trigger_transition(ctrl, t);
+                    break;
                 }
             }    // foreach: transition
 
-            for (sprite__animctrl_param* p = &ctrl->params[0]; p->name_hash; ++p) {
-                if (p->type == RIZZ_SPRITE_PARAMTYPE_BOOL_AUTO && p->value.b)
-                    p->value.b = false;
+            if (params_dirty) {
+                for (sprite__animctrl_param* p = &ctrl->params[0]; p->name_hash; ++p) {
+                    if (p->type == RIZZ_SPRITE_PARAMTYPE_BOOL_AUTO && p->value.b) {
+                        p->value.b = false;
+                        ctrl->params_dirty = true;
+                    }
+                }
             }
         }
     } // scope
@@ -980,10 +1175,232 @@ static void sprite__update_bounds(sprite__data* spr)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // atlas
+// baked atlas format (.ratlas) is a binary image of the loaded atlas data:
+//  header | name hashes (num_sprites) | sprites (num_sprites) | vertices (num_vertices) | indices (num_indices)
+//  positions and uvs are stored normalized, so loading is a single copy per blob
+//  image is stored as the full vfs path of the atlas texture, so the baked file can be written to
+//  any directory
+#define ATLAS_BAKED_FOURCC sx_makefourcc('R', 'A', 'T', 'L')
+#define ATLAS_BAKED_VERSION 2
+
+typedef struct atlas__baked_header {
+    uint32_t fourcc;
+    uint32_t version;
+    char image[RIZZ_MAX_PATH];
+    int img_width;
+    int img_height;
+    int num_sprites;
+    int num_vertices;
+    int num_indices;
+} atlas__baked_header;
+
+static atlas__data* atlas__create(const rizz_asset_load_params* params, const char* img_filepath, 
+                                  int num_sprites, int num_vertices, int num_indices)
+{
+    const sx_alloc* alloc = params->alloc ? params->alloc : g_spr.alloc;
+
+    // allocate memory in one go
+    int hashtbl_cap = sx_hashtbl_valid_capacity(num_sprites);
+    sx_linear_buffer atlas_buff;
+    uint32_t* keys;
+    int* values;
+
+    sx_linear_buffer_init(&atlas_buff, atlas__data, 0);
+    sx_linear_buffer_addtype(&atlas_buff, atlas__data, atlas__sprite, sprites, num_sprites, 0);
+    sx_linear_buffer_addptr(&atlas_buff, &keys, uint32_t, hashtbl_cap, 0);
+    sx_linear_buffer_addptr(&atlas_buff, &values, int, hashtbl_cap, 0);
+    sx_linear_buffer_addtype(&atlas_buff, atlas__data, rizz_sprite_vertex, vertices, num_vertices, 0);
+    sx_linear_buffer_addtype(&atlas_buff, atlas__data, uint16_t, indices, num_indices, 0);
+    atlas__data* atlas = sx_linear_buffer_calloc(&atlas_buff, alloc);
+    if (!atlas) {
+        sx_out_of_memory();
+        return NULL;
+    }
+    sx_hashtbl_init(&atlas->sprite_tbl, hashtbl_cap, keys, values);
+
+    const rizz_atlas_load_params* aparams = params->params;
+    rizz_asset_load_flags flags = params->flags & ~RIZZ_ASSET_LOAD_FLAG_WAIT_ON_LOAD;
+    rizz_texture_load_params tparams = { .min_filter = aparams->min_filter,
+                                         .mag_filter = aparams->mag_filter,
+                                         .wrap_u = SG_WRAP_CLAMP_TO_EDGE,
+                                         .wrap_v = SG_WRAP_CLAMP_TO_EDGE };
+    atlas->a.texture = the_asset->load("texture", img_filepath, &tparams, flags, alloc, params->tags);
+
+    return atlas;
+}
+
+// checks everything that `atlas__load_baked` and sprite drawing read from the file, so corrupt or
+// truncated files can't make them read out of bounds. expects `size >= sizeof(atlas__baked_header)`
+static bool atlas__validate_baked(const atlas__baked_header* header, size_t size)
+{
+    bool terminated = false;
+    for (int i = 0; i < RIZZ_MAX_PATH && !terminated; i++) {
+        terminated = header->image[i] == '\0';
+    }
+    if (!terminated) {
+        return false;
+    }
+
+    if (header->num_sprites < 0 || header->num_vertices < 0 || header->num_indices < 0) {
+        return false;
+    }
+
+    // check each blob against the remaining size, so the multiplications can't overflow
+    size_t remain = size - sizeof(atlas__baked_header);
+    const size_t sprite_size = sizeof(uint32_t) + sizeof(atlas__sprite);
+    if ((size_t)header->num_sprites > remain / sprite_size) {
+        return false;
+    }
+    remain -= sprite_size * (size_t)header->num_sprites;
+    if ((size_t)header->num_vertices > remain / sizeof(rizz_sprite_vertex)) {
+        return false;
+    }
+    remain -= sizeof(rizz_sprite_vertex) * (size_t)header->num_vertices;
+    if ((size_t)header->num_indices > remain / sizeof(uint16_t)) {
+        return false;
+    }
+
+    const uint8_t* buff = (const uint8_t*)(header + 1);
+    const atlas__sprite* sprites = (const atlas__sprite*)(buff + sizeof(uint32_t) * (size_t)header->num_sprites);
+    const uint16_t* indices = (const uint16_t*)((const uint8_t*)(sprites + header->num_sprites) +
+                                                sizeof(rizz_sprite_vertex) * (size_t)header->num_vertices);
+    for (int i = 0; i < header->num_sprites; i++) {
+        const atlas__sprite* spr = &sprites[i];
+        if (spr->num_verts < 0 || spr->vb_index < 0 || spr->num_indices < 0 || spr->ib_index < 0 ||
+            spr->num_verts > header->num_vertices - spr->vb_index ||
+            spr->num_indices > header->num_indices - spr->ib_index) {
+            return false;
+        }
+
+        // index values are relative to the sprite's first vertex
+        for (int k = 0; k < spr->num_indices; k++) {
+            if (indices[spr->ib_index + k] >= spr->num_verts) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static rizz_asset_load_data atlas__prepare_baked(const rizz_asset_load_params* params,
+                                                 const sx_mem_block* mem)
+{
+    const atlas__baked_header* header = mem->data;
+    if (mem->size < (int64_t)sizeof(atlas__baked_header) || header->fourcc != ATLAS_BAKED_FOURCC) {
+        rizz_log_warn("loading atlas '%s' failed: not a valid baked atlas", params->path);
+        return (rizz_asset_load_data){ {0} };
+    }
+
+    if (header->version != ATLAS_BAKED_VERSION) {
+        rizz_log_warn("loading atlas '%s' failed: baked atlas version mismatch (%u != %u), bake it again",
+                      params->path, header->version, ATLAS_BAKED_VERSION);
+        return (rizz_asset_load_data){ {0} };
+    }
+
+    if (!atlas__validate_baked(header, (size_t)mem->size)) {
+        rizz_log_warn("loading atlas '%s' failed: baked atlas is truncated or corrupt", params->path);
+        return (rizz_asset_load_data){ {0} };
+    }
+
+    atlas__data* atlas = atlas__create(params, header->image, header->num_sprites, header->num_vertices,
+                                       header->num_indices);
+    return (rizz_asset_load_data){ .obj = { .ptr = atlas } };
+}
+
+static bool atlas__load_baked(atlas__data* atlas, const sx_mem_block* mem)
+{
+    const atlas__baked_header* header = mem->data;
+    const uint8_t* buff = (const uint8_t*)(header + 1);
+
+    const uint32_t* name_hashes = (const uint32_t*)buff;
+    buff += sizeof(uint32_t)*header->num_sprites;
+    sx_memcpy(atlas->sprites, buff, sizeof(atlas__sprite)*header->num_sprites);
+    buff += sizeof(atlas__sprite)*header->num_sprites;
+    sx_memcpy(atlas->vertices, buff, sizeof(rizz_sprite_vertex)*header->num_vertices);
+    buff += sizeof(rizz_sprite_vertex)*header->num_vertices;
+    sx_memcpy(atlas->indices, buff, sizeof(uint16_t)*header->num_indices);
+
+    for (int i = 0; i < header->num_sprites; i++) {
+        sx_hashtbl_add(&atlas->sprite_tbl, name_hashes[i], i);
+    }
+
+    atlas->a.info.img_width = header->img_width;
+    atlas->a.info.img_height = header->img_height;
+    atlas->a.info.num_sprites = header->num_sprites;
+    return true;
+}
+
+bool sprite__atlas_bake(rizz_asset atlas_asset, const char* filepath)
+{
+    if (the_asset->state(atlas_asset) != RIZZ_ASSET_STATE_OK) {
+        rizz_log_warn("atlas: '%s' is not loaded, cannot bake", the_asset->path(atlas_asset));
+        return false;
+    }
+
+    const atlas__data* atlas = the_asset->obj(atlas_asset).ptr;
+    int num_sprites = atlas->a.info.num_sprites;
+    atlas__baked_header header = { .fourcc = ATLAS_BAKED_FOURCC,
+                                   .version = ATLAS_BAKED_VERSION,
+                                   .img_width = atlas->a.info.img_width,
+                                   .img_height = atlas->a.info.img_height,
+                                   .num_sprites = num_sprites };
+    sx_strcpy(header.image, sizeof(header.image), the_asset->path(atlas->a.texture));
+    if (num_sprites > 0) {
+        const atlas__sprite* last = &atlas->sprites[num_sprites - 1];
+        header.num_vertices = last->vb_index + last->num_verts;
+        header.num_indices = last->ib_index + last->num_indices;
+    }
+
+    bool r = false;
+    const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
+    sx_scope(the_core->tmp_alloc_pop()) {
+        // name hashes are only stored in the hash table, map them back to sprite indices
+        uint32_t* name_hashes = sx_calloc(tmp_alloc, sizeof(uint32_t)*(num_sprites + 1));
+        sx_assert_always(name_hashes);
+        const sx_hashtbl* tbl = &atlas->sprite_tbl;
+        for (int i = 0; i < tbl->capacity; i++) {
+            if (tbl->keys[i]) {
+                sx_assert(tbl->values[i] < num_sprites);
+                name_hashes[tbl->values[i]] = tbl->keys[i];
+            }
+        }
+
+        sx_file f;
+        if (sx_file_open(&f, filepath, SX_FILE_WRITE)) {
+            int64_t size = sx_file_write_var(&f, header);
+            size += sx_file_write(&f, name_hashes, sizeof(uint32_t)*num_sprites);
+            size += sx_file_write(&f, atlas->sprites, sizeof(atlas__sprite)*num_sprites);
+            size += sx_file_write(&f, atlas->vertices, sizeof(rizz_sprite_vertex)*header.num_vertices);
+            size += sx_file_write(&f, atlas->indices, sizeof(uint16_t)*header.num_indices);
+            sx_file_close(&f);
+
+            r = size == (int64_t)sizeof(header) + (int64_t)(sizeof(uint32_t) + sizeof(atlas__sprite))*num_sprites +
+                        (int64_t)sizeof(rizz_sprite_vertex)*header.num_vertices + 
+                        (int64_t)sizeof(uint16_t)*header.num_indices;
+        }
+    }
+
+    if (!r) {
+        rizz_log_warn("atlas: writing baked atlas '%s' failed", filepath);
+    }
+    return r;
+}
+
 static rizz_asset_load_data atlas__on_prepare(const rizz_asset_load_params* params,
                                               const sx_mem_block* mem)
 {
-    const sx_alloc* alloc = params->alloc ? params->alloc : g_spr.alloc;
+    uint64_t start_tm = sx_tm_now();
+    char ext[32];
+    sx_os_path_ext(ext, sizeof(ext), params->path);
+    if (sx_strequalnocase(ext, ".ratlas")) {
+        rizz_asset_load_data r = atlas__prepare_baked(params, mem);
+        if (r.obj.ptr) {
+            ((atlas__data*)r.obj.ptr)->prepare_tm = sx_tm_since(start_tm);
+        }
+        return r;
+    }
+
     char img_filepath[RIZZ_MAX_PATH];
     int num_sprites = 0;
     int num_indices = 0;
@@ -1042,54 +1459,27 @@ static rizz_asset_load_data atlas__on_prepare(const rizz_asset_load_params* para
         ++num_sprites;
     }
 
-    // allocate memory in one go
-    int hashtbl_cap = sx_hashtbl_valid_capacity(num_sprites);
-    sx_linear_buffer atlas_buff;
-    uint32_t* keys;
-    int* values;
-
-    sx_linear_buffer_init(&atlas_buff, atlas__data, 0);
-    sx_linear_buffer_addtype(&atlas_buff, atlas__data, atlas__sprite, sprites, num_sprites, 0);
-    sx_linear_buffer_addptr(&atlas_buff, &keys, uint32_t, hashtbl_cap, 0);
-    sx_linear_buffer_addptr(&atlas_buff, &values, int, hashtbl_cap, 0);
-    sx_linear_buffer_addtype(&atlas_buff, atlas__data, rizz_sprite_vertex, vertices, num_vertices, 0);
-    sx_linear_buffer_addtype(&atlas_buff, atlas__data, uint16_t, indices, num_indices, 0);
-    atlas__data* atlas = sx_linear_buffer_calloc(&atlas_buff, alloc);
+    atlas__data* atlas = atlas__create(params, img_filepath, num_sprites, num_vertices, num_indices);
     if (!atlas) {
         sx_free(g_spr.alloc, tokens);
-        sx_out_of_memory();
         return (rizz_asset_load_data){ .obj = { 0 } };
     }
-    sx_hashtbl_init(&atlas->sprite_tbl, hashtbl_cap, keys, values);
-
-    const rizz_atlas_load_params* aparams = params->params;
-    rizz_asset_load_flags flags = params->flags & ~RIZZ_ASSET_LOAD_FLAG_WAIT_ON_LOAD;
-    rizz_texture_load_params tparams = { .min_filter = aparams->min_filter,
-                                         .mag_filter = aparams->mag_filter,
-                                         .wrap_u = SG_WRAP_CLAMP_TO_EDGE,
-                                         .wrap_v = SG_WRAP_CLAMP_TO_EDGE };
-    atlas->a.texture = the_asset->load("texture", img_filepath, &tparams, flags, alloc, params->tags);
 
     cj5_result* predata = sx_malloc(g_spr.alloc, sizeof(cj5_result));
     if (!predata) {
-        sx_free(alloc, atlas);
+        sx_free(params->alloc ? params->alloc : g_spr.alloc, atlas);
         sx_free(g_spr.alloc, tokens);
         sx_out_of_memory();
         return (rizz_asset_load_data){ .obj = { 0 } };
     }
     sx_memcpy(predata, &jres, sizeof(jres));
 
+    atlas->prepare_tm = sx_tm_since(start_tm);
     return (rizz_asset_load_data){ .obj = { .ptr = atlas }, .user1 = predata };
 }
 
-static bool atlas__on_load(rizz_asset_load_data* data, const rizz_asset_load_params* params,
-                           const sx_mem_block* mem)
+static bool atlas__load_json(atlas__data* atlas, cj5_result* jres)
 {
-    sx_unused(mem);
-    sx_unused(params);
-
-    atlas__data* atlas = data->obj.ptr;
-    cj5_result* jres = data->user1;
 
     int sprite_idx = 0;
     atlas->a.info.img_width = cj5_seekget_int(jres, 0, "image_width", 0);
@@ -1190,6 +1580,23 @@ static bool atlas__on_load(rizz_asset_load_data* data, const rizz_asset_load_par
     return true;
 }
 
+static bool atlas__on_load(rizz_asset_load_data* data, const rizz_asset_load_params* params,
+                           const sx_mem_block* mem)
+{
+    atlas__data* atlas = data->obj.ptr;
+    uint64_t start_tm = sx_tm_now();
+
+    // baked atlases don't have json data (see atlas__prepare_baked)
+    bool r = data->user1 ? atlas__load_json(atlas, data->user1) : atlas__load_baked(atlas, mem);
+
+    // compare the load times of baked (.ratlas) and json atlases. json parsing happens in on_prepare,
+    // so report prepare + load for both
+    uint64_t load_tm = sx_tm_since(start_tm);
+    rizz_log_debug("atlas: '%s' loaded in %.2f ms (prepare: %.2f ms, load: %.2f ms)", params->path,
+                   sx_tm_ms(atlas->prepare_tm + load_tm), sx_tm_ms(atlas->prepare_tm), sx_tm_ms(load_tm));
+    return r;
+}
+
 static void atlas__on_finalize(rizz_asset_load_data* data, const rizz_asset_load_params* params,
                                const sx_mem_block* mem)
 {
@@ -1197,10 +1604,12 @@ static void atlas__on_finalize(rizz_asset_load_data* data, const rizz_asset_load
     sx_unused(params);
 
     cj5_result* jres = data->user1;
-    if (jres->tokens) {
-        sx_free(g_spr.alloc, (cj5_token*)jres->tokens);
+    if (jres) {
+        if (jres->tokens) {
+            sx_free(g_spr.alloc, (cj5_token*)jres->tokens);
+        }
+        sx_free(g_spr.alloc, jres);
     }
-    sx_free(g_spr.alloc, jres);
 }
 
 static void atlas__on_reload(rizz_asset handle, rizz_asset_obj prev_obj, const sx_alloc* alloc)
@@ -1290,6 +1699,7 @@ bool sprite__init(rizz_api_core* core, rizz_api_asset* asset, rizz_api_gfx* gfx)
     g_spr.animctrl_handles = sx_handle_create_pool(g_spr.alloc, 128);
     sx_assert(g_spr.animctrl_handles);
 
+    // atlas loads are always blocking, because sprites read the atlas data when they are created
     the_asset->register_asset_type("atlas",
                                    (rizz_asset_callbacks){ .on_prepare = atlas__on_prepare,
                                                            .on_load = atlas__on_load,
@@ -1394,6 +1804,12 @@ void sprite__release(void)
     sx_array_free(g_spr.alloc, g_spr.sprites);
     sx_array_free(g_spr.alloc, g_spr.animctrls);
     sx_array_free(g_spr.alloc, g_spr.animclips);
+    if (g_spr.animclip_tms) {
+        sx_aligned_free(g_spr.alloc, g_spr.animclip_tms, 16);
+    }
+    if (g_spr.animclip_lens) {
+        sx_aligned_free(g_spr.alloc, g_spr.animclip_lens, 16);
+    }
 
     the_asset->unregister_asset_type("atlas");
 }
@@ -2137,7 +2553,8 @@ static void sprite__show_animclip_tab_contents(sprite__data* spr)
     sx_assert(spr->clip.id);
     sx_assert(sx_handle_valid(g_spr.animclip_handles, spr->clip.id));
 
-    sprite__animclip* clip = &g_spr.animclips[sx_handle_index(spr->clip.id)];
+    int clip_index = sx_handle_index(spr->clip.id);
+    sprite__animclip* clip = &g_spr.animclips[clip_index];
 
     the_imgui->Columns(2, "animclip_cols", true);
 
@@ -2151,7 +2568,7 @@ static void sprite__show_animclip_tab_contents(sprite__data* spr)
     the_imgui->NextColumn();
     the_imgui->Text("time");
     the_imgui->NextColumn();
-    the_imgui->Text("%.3f", clip->tm);
+    the_imgui->Text("%.3f", g_spr.animclip_tms[clip_index]);
     the_imgui->NextColumn();
     the_imgui->Text("frame");
     the_imgui->NextColumn();
@@ -2159,12 +2576,12 @@ static void sprite__show_animclip_tab_contents(sprite__data* spr)
     the_imgui->NextColumn();
     the_imgui->Text("duration");
     the_imgui->NextColumn();
-    the_imgui->Text("%.2f", clip->len);
+    the_imgui->Text("%.2f", g_spr.animclip_lens[clip_index]);
     the_imgui->NextColumn();
     the_imgui->Text("fps");
     the_imgui->NextColumn();
     if (the_imgui->DragFloat("", &clip->fps, 0.1f, 0.1f, 200.0f, "%.1f", 0)) {
-        clip->len = (float)clip->num_frames / clip->fps;
+        g_spr.animclip_lens[clip_index] = (float)clip->num_frames / clip->fps;
     }
     the_imgui->NextColumn();
 
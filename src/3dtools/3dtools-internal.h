@@ -49,14 +49,50 @@ void debug3d__set_max_instances(int max_instances);
 void debug3d__set_max_vertices(int max_verts);
 void debug3d__set_max_indices(int max_indices);
 
+void debug3d__queue_boxes(const sx_box* boxes, int num_boxes, rizz_3d_debug_map_type map_type,
+                          const sx_color* tints);
+void debug3d__queue_spheres(const sx_vec3* centers, const float* radiuss, int count,
+                            rizz_3d_debug_map_type map_type, const sx_color* tints);
+void debug3d__queue_cones(const float* radiuss, const float* depths, const sx_tx3d* txs, int count,
+                          const sx_color* tints);
+void debug3d__queue_aabbs(const sx_aabb* aabbs, int num_aabbs, const sx_color* tints);
+void debug3d__queue_lines(int num_lines, const rizz_3d_debug_line* lines, const sx_color* colors);
+void debug3d__queue_path(const sx_vec3* points, int num_points, sx_color color);
+void debug3d__queue_axis(const sx_mat4* mat, float scale);
+void debug3d__flush(const sx_mat4* viewproj_mat);
+void debug3d__get_stats(rizz_3d_debug_stats* stats);
+
 bool model__init(rizz_api_core* core, rizz_api_asset* asset, rizz_api_gfx* gfx, rizz_api_imgui* imgui);
 void model__release(void);
 void model__set_imgui(rizz_api_imgui* imgui);
 const rizz_model* model__get(rizz_asset model_asset);
 void model__set_material_lib(rizz_material_lib* mtllib);
+bool model__bake(rizz_asset model_asset, const char* filepath);
+
+void hierarchy__init(rizz_api_core* core);
+rizz_3d_hierarchy* hierarchy__create(const rizz_model* model, int init_capacity, const sx_alloc* alloc);
+void hierarchy__destroy(rizz_3d_hierarchy* h);
+int hierarchy__add_instance(rizz_3d_hierarchy* h, const sx_tx3d* root_tx);
+int hierarchy__num_instances(const rizz_3d_hierarchy* h);
+void hierarchy__set_root_tx(rizz_3d_hierarchy* h, int instance, const sx_tx3d* root_tx);
+void hierarchy__set_local_tx(rizz_3d_hierarchy* h, int instance, int node_id, const sx_tx3d* local_tx);
+void hierarchy__update(rizz_3d_hierarchy* h);
+const sx_tx3d* hierarchy__world_txs(const rizz_3d_hierarchy* h, int instance);
+const sx_aabb* hierarchy__world_bounds(const rizz_3d_hierarchy* h, int instance);
+sx_aabb hierarchy__instance_bounds(const rizz_3d_hierarchy* h, int instance);
+
+float meshopt__acmr(const uint32_t* indices, int num_indices, int num_verts, const sx_alloc* alloc);
+void meshopt__optimize_vertex_cache(uint32_t* dst, const uint32_t* indices, int num_indices, int num_verts,
+                                    const sx_alloc* alloc);
+void meshopt__optimize_overdraw(uint32_t* indices, int num_indices, const sx_vec3* positions, int num_verts,
+                                const sx_alloc* alloc);
+int meshopt__optimize_vertex_fetch_remap(uint32_t* remap, uint32_t* indices, int num_indices, int num_verts);
+int meshopt__simplify(uint32_t* dst, const uint32_t* indices, int num_indices, int target_indices,
+                      const sx_vec3* positions, const sx_alloc* alloc);
 
 rizz_material material__add(rizz_material_lib* lib, const rizz_material_data* mtldata);
 void material__remove(rizz_material_lib* lib, rizz_material mtl);
 rizz_material_lib* material__create_lib(const sx_alloc* alloc, int init_capacity);
 void material__destroy_lib(rizz_material_lib* lib);
 rizz_material material__get_blank(const rizz_material_lib* lib);
+const rizz_material_data* material__get_data(const rizz_material_lib* lib, rizz_material mtl);
@@ -334,11 +334,33 @@ static rizz_api_3d the__3d = {
         .grid_xyplane_cam = debug3d__grid_xyplane_cam,
         .set_max_instances = debug3d__set_max_instances,
         .set_max_vertices = debug3d__set_max_vertices,
-        .set_max_indices = debug3d__set_max_indices 
+        .set_max_indices = debug3d__set_max_indices,
+        .queue_boxes = debug3d__queue_boxes,
+        .queue_spheres = debug3d__queue_spheres,
+        .queue_cones = debug3d__queue_cones,
+        .queue_aabbs = debug3d__queue_aabbs,
+        .queue_lines = debug3d__queue_lines,
+        .queue_path = debug3d__queue_path,
+        .queue_axis = debug3d__queue_axis,
+        .flush = debug3d__flush,
+        .get_stats = debug3d__get_stats
     },
     .model = {
         .get = model__get,
-        .set_material_lib = model__set_material_lib
+        .set_material_lib = model__set_material_lib,
+        .bake = model__bake
+    },
+    .hierarchy = {
+        .create = hierarchy__create,
+        .destroy = hierarchy__destroy,
+        .add_instance = hierarchy__add_instance,
+        .num_instances = hierarchy__num_instances,
+        .set_root_tx = hierarchy__set_root_tx,
+        .set_local_tx = hierarchy__set_local_tx,
+        .update = hierarchy__update,
+        .world_txs = hierarchy__world_txs,
+        .world_bounds = hierarchy__world_bounds,
+        .instance_bounds = hierarchy__instance_bounds
     },
     .material = {
         .create_lib = material__create_lib,
@@ -384,6 +406,8 @@ rizz_plugin_decl_main(3dtools, plugin, e)
             return -1;
         }
 
+        hierarchy__init(core);
+
         the_plugin->inject_api("3dtools", 0, &the__3d);
     } break;
 
@@ -2,7 +2,9 @@
 #include "rizz/rizz.h"
 
 #include "sx/allocator.h"
+#include "sx/array.h"
 #include "sx/linear-buffer.h"
+#include "sx/lockless.h"
 #include "sx/math-vec.h"
 
 #include "3dtools-internal.h"
@@ -34,6 +36,23 @@ typedef struct debug3d__uniforms {
     sx_mat4 viewproj_mat;
 } debug3d__uniforms;
 
+// instanced shapes are merged into one draw per batch (shape + map type)
+typedef enum debug3d__batch {
+    DEBUG3D_BATCH_BOX_WHITE = 0,
+    DEBUG3D_BATCH_BOX_CHECKER,
+    DEBUG3D_BATCH_SPHERE_WHITE,
+    DEBUG3D_BATCH_SPHERE_CHECKER,
+    DEBUG3D_BATCH_CONE,
+    _DEBUG3D_BATCH_COUNT
+} debug3d__batch;
+
+// primitives collected by queue_xxx functions, drawn and cleared on `flush`
+typedef struct debug3d__queue {
+    debug3d__instance* instances[_DEBUG3D_BATCH_COUNT][2];    // sx_array: [batch][solid, alpha-blend]
+    rizz_3d_debug_vertex* line_verts;                         // sx_array: line-list vertices
+    int num_primitives;
+} debug3d__queue;
+
 typedef struct debug3d__context {
     const sx_alloc* alloc;
     rizz_api_gfx_draw* draw_api;
@@ -61,6 +80,10 @@ typedef struct debug3d__context {
     int num_instances;
     int num_verts;
     int num_indices;
+    int num_draws;
+    int num_primitives;
+    sx_lock_t queue_lk;
+    debug3d__queue queue;
 } debug3d__context;
 
 typedef struct debug3d__instance_depth {
@@ -204,7 +227,7 @@ bool debug3d__init(rizz_api_core* core, rizz_api_gfx* gfx, rizz_api_camera* cam)
         g_debug3d.dyn_ibuff = the_gfx->make_buffer(&(sg_buffer_desc){
             .type = SG_BUFFERTYPE_INDEXBUFFER,
             .usage = SG_USAGE_STREAM,
-            .size = sizeof(rizz_3d_debug_vertex) * MAX_DYN_INDICES,
+            .size = sizeof(uint16_t) * MAX_DYN_INDICES,
             .label = "debug3d_ibuffer"});
         g_debug3d.instance_buff = the_gfx->make_buffer(&(sg_buffer_desc) {
             .size = sizeof(debug3d__instance) * MAX_INSTANCES,
@@ -308,6 +331,13 @@ static void prims3d__destroy_shape(debug3d__shape* shape)
 
 void debug3d__release(void)
 {
+    debug3d__queue* queue = &g_debug3d.queue;
+    for (int i = 0; i < _DEBUG3D_BATCH_COUNT; i++) {
+        sx_array_free(g_debug3d.alloc, queue->instances[i][0]);
+        sx_array_free(g_debug3d.alloc, queue->instances[i][1]);
+    }
+    sx_array_free(g_debug3d.alloc, queue->line_verts);
+
     prims3d__destroy_shape(&g_debug3d.unit_box);
     prims3d__destroy_shape(&g_debug3d.unit_sphere);
     prims3d__destroy_shape(&g_debug3d.unit_cone);
@@ -334,194 +364,247 @@ static inline void debug3d__reset_stats(void)
     if (frame != g_debug3d.updated_stats_frame) {
         g_debug3d.updated_stats_frame = frame;
         g_debug3d.num_indices = g_debug3d.num_verts = g_debug3d.num_instances = 0;
+        g_debug3d.num_draws = g_debug3d.num_primitives = 0;
     }
 }
 
-void debug3d__draw_box(const sx_box* box, const sx_mat4* viewproj_mat,
-                       rizz_3d_debug_map_type map_type, sx_color tint)
+// stream buffers are recreated with a larger size instead of failing when the frame's data doesn't
+// fit. old buffers are destroyed with a delay by gfx, so the draws already submitted stay valid
+static void debug3d__grow_instances(int count)
 {
-    debug3d__draw_boxes(box, 1, viewproj_mat, map_type, &tint);
+    int required = g_debug3d.num_instances + count;
+    if (required > g_debug3d.max_instances) {
+        debug3d__set_max_instances(sx_max(required, g_debug3d.max_instances << 1));
+    }
 }
 
-void debug3d__draw_sphere(sx_vec3 center, float radius, const sx_mat4* viewproj_mat,
-                          rizz_3d_debug_map_type map_type, sx_color tint)
+static void debug3d__grow_vertices(int count)
 {
-    debug3d__draw_spheres(&center, &radius, 1, viewproj_mat, map_type, &tint);
+    int required = g_debug3d.num_verts + count;
+    if (required > g_debug3d.max_verts) {
+        debug3d__set_max_vertices(sx_max(required, g_debug3d.max_verts << 1));
+    }
 }
 
-void debug3d__draw_spheres(const sx_vec3* centers, const float* radiuss, int count, 
-                           const sx_mat4* viewproj_mat, rizz_3d_debug_map_type map_type, 
-                           const sx_color* tints)
+static void debug3d__grow_indices(int count)
 {
-    rizz_api_gfx_draw* draw_api = g_debug3d.draw_api;
+    int required = g_debug3d.num_indices + count;
+    if (required > g_debug3d.max_indices) {
+        debug3d__set_max_indices(sx_max(required, g_debug3d.max_indices << 1));
+    }
+}
 
-    debug3d__uniforms uniforms = {
-        .viewproj_mat = *viewproj_mat
+static inline debug3d__instance debug3d__box_instance(const sx_box* box, sx_color tint)
+{
+    const sx_tx3d* tx = &box->tx;
+    return (debug3d__instance) {
+        .tx1 = sx_vec4f(tx->pos.x, tx->pos.y, tx->pos.z, tx->rot.m11),
+        .tx2 = sx_vec4f(tx->rot.m21, tx->rot.m31, tx->rot.m12, tx->rot.m22),
+        .tx3 = sx_vec4f(tx->rot.m32, tx->rot.m13, tx->rot.m23, tx->rot.m33),
+        .scale = sx_vec3_mulf(box->e, 2.0f),
+        .color = tint
     };
+}
+
+static inline debug3d__instance debug3d__sphere_instance(sx_vec3 center, float radius, sx_color tint)
+{
+    return (debug3d__instance) {
+        .tx1 = sx_vec4f(center.x, center.y, center.z, 1.0f),
+        .tx2 = sx_vec4f(0, 0, 0, 1.0f),
+        .tx3 = sx_vec4f(0, 0, 0, 1.0f),
+        .scale = sx_vec3splat(radius),
+        .color = tint
+    };
+}
 
+static inline debug3d__instance debug3d__cone_instance(const sx_tx3d* tx, float radius, float depth,
+                                                       sx_color tint)
+{
+    return (debug3d__instance) {
+        .tx1 = sx_vec4f(tx->pos.x, tx->pos.y, tx->pos.z, tx->rot.m11),
+        .tx2 = sx_vec4f(tx->rot.m21, tx->rot.m31, tx->rot.m12, tx->rot.m22),
+        .tx3 = sx_vec4f(tx->rot.m32, tx->rot.m13, tx->rot.m23, tx->rot.m33),
+        .scale = sx_vec3f(radius, radius, depth),
+        .color = tint
+    };
+}
+
+static sg_image debug3d__map_image(rizz_3d_debug_map_type map_type)
+{
     // clang-format off
-    sg_image map = {0};
     switch (map_type) {
-    case RIZZ_3D_DEBUG_MAPTYPE_WHITE:        map = the_gfx->texture_white(); break;
-    case RIZZ_3D_DEBUG_MAPTYPE_CHECKER:      map = g_debug3d.checker_tex.img; break;
+    case RIZZ_3D_DEBUG_MAPTYPE_WHITE:        return the_gfx->texture_white();
+    case RIZZ_3D_DEBUG_MAPTYPE_CHECKER:      return g_debug3d.checker_tex.img;
     }
     // clang-format on
+    return the_gfx->texture_white();
+}
 
-    const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
-    sx_scope(the_core->tmp_alloc_pop()) {
-        debug3d__reset_stats();
-        sx_assert_always((g_debug3d.num_instances + count) <= g_debug3d.max_instances);
-        debug3d__instance* instances = sx_malloc(tmp_alloc, sizeof(debug3d__instance)*count);
-        if (!instances) {
-            sx_out_of_memory();
-            return;
-        }
+// draws a batch of instances with a single instanced draw call
+// in alpha-blend mode (transparent shapes), instances are sorted back-to-front before submitting
+static void debug3d__draw_instances(debug3d__batch batch, const debug3d__instance* instances, int count,
+                                    bool alpha_blend, const sx_mat4* viewproj_mat)
+{
+    sx_assert(count > 0);
 
-        bool alpha_blend = false;
+    rizz_api_gfx_draw* draw_api = g_debug3d.draw_api;
+    const debug3d__shape* shape;
+    sg_image map;
+    bool box_shader = false;
+
+    switch (batch) {
+    case DEBUG3D_BATCH_BOX_WHITE:
+    case DEBUG3D_BATCH_BOX_CHECKER:
+        shape = &g_debug3d.unit_box;
+        box_shader = true;
+        map = debug3d__map_image(batch == DEBUG3D_BATCH_BOX_CHECKER ? RIZZ_3D_DEBUG_MAPTYPE_CHECKER
+                                                                    : RIZZ_3D_DEBUG_MAPTYPE_WHITE);
+        break;
+    case DEBUG3D_BATCH_SPHERE_WHITE:
+    case DEBUG3D_BATCH_SPHERE_CHECKER:
+        shape = &g_debug3d.unit_sphere;
+        map = debug3d__map_image(batch == DEBUG3D_BATCH_SPHERE_CHECKER ? RIZZ_3D_DEBUG_MAPTYPE_CHECKER
+                                                                       : RIZZ_3D_DEBUG_MAPTYPE_WHITE);
+        break;
+    default:
+        shape = &g_debug3d.unit_cone;
+        map = the_gfx->texture_white();
+        break;
+    }
 
-        for (int i = 0; i < count; i++) {
-            sx_vec3 pos = centers[i];
-            float radius = radiuss[i];
-            debug3d__instance* instance = &instances[i];
-            instance->tx1 = sx_vec4f(pos.x, pos.y, pos.z, 1.0f);
-            instance->tx2 = sx_vec4f(0, 0, 0,             1.0f);
-            instance->tx3 = sx_vec4f(0, 0, 0,             1.0f);
-            instance->scale = sx_vec3splat(radius);
-            if (tints) {
-                instance->color = tints[i];
-                alpha_blend = alpha_blend || tints[i].a < 255;
-            }
-            else {
-                instance->color = SX_COLOR_WHITE;
-            }
-        }
+    debug3d__uniforms uniforms = {
+        .viewproj_mat = *viewproj_mat
+    };
 
-        // in alpha-blend mode (transparent boxes), sort the boxes from back-to-front
+    const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
+    sx_scope(the_core->tmp_alloc_pop()) {
         if (alpha_blend) {
             debug3d__instance_depth* sort_items = sx_malloc(tmp_alloc, sizeof(debug3d__instance_depth)*count);
-            if (!sort_items) {
-                sx_out_of_memory();
-                return;
-            }
-            for (int i = 0; i < count; i++) {
-                sort_items[i].index = i;
-                sort_items[i].z = sx_mat4_mul_vec3(viewproj_mat, centers[i]).z;
-            }
+            debug3d__instance* sorted = sx_malloc(tmp_alloc, sizeof(debug3d__instance)*count);
+            if (sort_items && sorted) {
+                for (int i = 0; i < count; i++) {
+                    sort_items[i].index = i;
+                    sort_items[i].z = sx_mat4_mul_vec3(viewproj_mat, sx_vec3fv(instances[i].tx1.f)).z;
+                }
 
-            debug3d__instance_tim_sort(sort_items, count);
+                debug3d__instance_tim_sort(sort_items, count);
 
-            debug3d__instance* sorted = sx_malloc(tmp_alloc, sizeof(debug3d__instance)*count);
-            if (!sorted) {
+                for (int i = 0; i < count; i++) {
+                    sorted[i] = instances[sort_items[i].index];
+                }
+                instances = sorted;
+            } else {
                 sx_out_of_memory();
-                return;
-            }
-            for (int i = 0; i < count; i++) {
-                sorted[i] = instances[sort_items[i].index];
             }
-            instances = sorted;
         }
 
+        debug3d__grow_instances(count);
         int inst_offset = draw_api->append_buffer(g_debug3d.instance_buff, instances,
                                                   sizeof(debug3d__instance) * count);
         g_debug3d.num_instances += count;
+        g_debug3d.num_draws++;
 
-        draw_api->apply_pipeline(!alpha_blend ? g_debug3d.pip_solid : g_debug3d.pip_alphablend);
+        if (box_shader) {
+            draw_api->apply_pipeline(!alpha_blend ? g_debug3d.pip_solid_box : g_debug3d.pip_alphablend_box);
+        } else {
+            draw_api->apply_pipeline(!alpha_blend ? g_debug3d.pip_solid : g_debug3d.pip_alphablend);
+        }
         draw_api->apply_uniforms(SG_SHADERSTAGE_VS, 0, &uniforms, sizeof(uniforms));
         draw_api->apply_bindings(&(sg_bindings) {
-            .vertex_buffers[0] = g_debug3d.unit_sphere.vb,
+            .vertex_buffers[0] = shape->vb,
             .vertex_buffers[1] = g_debug3d.instance_buff,
             .vertex_buffer_offsets[1] = inst_offset,
-            .index_buffer = g_debug3d.unit_sphere.ib,
+            .index_buffer = shape->ib,
             .fs_images[0] = map
         });
-        draw_api->draw(0, g_debug3d.unit_sphere.num_indices, count);
+        draw_api->draw(0, shape->num_indices, count);
     } // scope
-}                           
+}
 
-void debug3d__draw_boxes(const sx_box* boxes, int num_boxes, const sx_mat4* viewproj_mat,
-                         rizz_3d_debug_map_type map_type, const sx_color* tints)
+// draws non-indexed wireframe vertices (line-list or line-strip, depending on `pip`)
+static void debug3d__draw_wire(const rizz_3d_debug_vertex* verts, int num_verts, sg_pipeline pip,
+                               const sx_mat4* viewproj_mat)
 {
-    sx_assert(num_boxes > 0);
-
     rizz_api_gfx_draw* draw_api = g_debug3d.draw_api;
 
-    debug3d__uniforms uniforms = {
-        .viewproj_mat = *viewproj_mat
-    };
+    debug3d__grow_vertices(num_verts);
+    int offset = draw_api->append_buffer(g_debug3d.dyn_vbuff, verts, num_verts * sizeof(rizz_3d_debug_vertex));
+    g_debug3d.num_verts += num_verts;
+    g_debug3d.num_draws++;
 
-    sg_image map = {0};
-    switch (map_type) {
-    case RIZZ_3D_DEBUG_MAPTYPE_WHITE:        map = the_gfx->texture_white(); break;
-    case RIZZ_3D_DEBUG_MAPTYPE_CHECKER:      map = g_debug3d.checker_tex.img; break;
-    }
+    sg_bindings bind = { 
+        .vertex_buffers[0] = g_debug3d.dyn_vbuff, 
+        .vertex_buffer_offsets[0] = offset };
 
-    sx_with(const sx_alloc* tmp_alloc = the_core->tmp_alloc_push(), the_core->tmp_alloc_pop()) {
-        debug3d__reset_stats();
-        sx_assert_always((g_debug3d.num_instances + num_boxes) <= g_debug3d.max_instances);
-        debug3d__instance* instances = sx_malloc(tmp_alloc, sizeof(debug3d__instance)*num_boxes);
-        if (!instances) {
-            sx_out_of_memory();
-            return;
-        }
-
-        bool alpha_blend = false;
+    draw_api->apply_pipeline(pip);
+    draw_api->apply_uniforms(SG_SHADERSTAGE_VS, 0, viewproj_mat, sizeof(*viewproj_mat));
+    draw_api->apply_bindings(&bind);
+    draw_api->draw(0, num_verts, 1);
+}
 
-        for (int i = 0; i < num_boxes; i++) {
-            const sx_tx3d* tx = &boxes[i].tx;
-            debug3d__instance* instance = &instances[i];
-            instance->tx1 = sx_vec4f(tx->pos.x, tx->pos.y, tx->pos.z, tx->rot.m11);
-            instance->tx2 = sx_vec4f(tx->rot.m21, tx->rot.m31, tx->rot.m12, tx->rot.m22);
-            instance->tx3 = sx_vec4f(tx->rot.m32, tx->rot.m13, tx->rot.m23, tx->rot.m33);
-            instance->scale = sx_vec3_mulf(boxes[i].e, 2.0f);
-            instance->color = tints ? tints[i] : SX_COLOR_WHITE;
-            if (tints) {
-                instance->color = tints[i];
-                alpha_blend = alpha_blend || tints[i].a < 255;
-            } else {
-                instance->color = SX_COLOR_WHITE;
-            }
-        }
+void debug3d__draw_box(const sx_box* box, const sx_mat4* viewproj_mat,
+                       rizz_3d_debug_map_type map_type, sx_color tint)
+{
+    debug3d__draw_boxes(box, 1, viewproj_mat, map_type, &tint);
+}
 
-        // in alpha-blend mode (transparent boxes), sort the boxes from back-to-front
-        if (alpha_blend) {
-            debug3d__instance_depth* sort_items = sx_malloc(tmp_alloc, sizeof(debug3d__instance_depth)*num_boxes);
-            if (!sort_items) {
-                sx_out_of_memory();
-                return;
-            }
-            for (int i = 0; i < num_boxes; i++) {
-                sort_items[i].index = i;
-                sort_items[i].z = sx_mat4_mul_vec3(viewproj_mat, boxes[i].tx.pos).z;
-            }
+void debug3d__draw_sphere(sx_vec3 center, float radius, const sx_mat4* viewproj_mat,
+                          rizz_3d_debug_map_type map_type, sx_color tint)
+{
+    debug3d__draw_spheres(&center, &radius, 1, viewproj_mat, map_type, &tint);
+}
 
-            debug3d__instance_tim_sort(sort_items, num_boxes);
+void debug3d__draw_spheres(const sx_vec3* centers, const float* radiuss, int count, 
+                           const sx_mat4* viewproj_mat, rizz_3d_debug_map_type map_type, 
+                           const sx_color* tints)
+{
+    sx_assert(count > 0);
 
-            debug3d__instance* sorted = sx_malloc(tmp_alloc, sizeof(debug3d__instance)*num_boxes);
-            if (!sorted) {
-                sx_out_of_memory();
-                return;
-            }
-            for (int i = 0; i < num_boxes; i++) {
-                sorted[i] = instances[sort_items[i].index];
+    const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
+    sx_scope(the_core->tmp_alloc_pop()) {
+        debug3d__instance* instances = sx_malloc(tmp_alloc, sizeof(debug3d__instance)*count);
+        if (instances) {
+            bool alpha_blend = false;
+            for (int i = 0; i < count; i++) {
+                sx_color tint = tints ? tints[i] : SX_COLOR_WHITE;
+                instances[i] = debug3d__sphere_instance(centers[i], radiuss[i], tint);
+                alpha_blend = alpha_blend || tint.a < 255;
             }
-            instances = sorted;
+
+            debug3d__reset_stats();
+            g_debug3d.num_primitives += count;
+            debug3d__draw_instances(map_type == RIZZ_3D_DEBUG_MAPTYPE_CHECKER ? DEBUG3D_BATCH_SPHERE_CHECKER
+                                                                              : DEBUG3D_BATCH_SPHERE_WHITE,
+                                    instances, count, alpha_blend, viewproj_mat);
+        } else {
+            sx_out_of_memory();
         }
+    } // scope
+}                           
 
-        int inst_offset = draw_api->append_buffer(g_debug3d.instance_buff, instances,
-                                                  sizeof(debug3d__instance) * num_boxes);
-        g_debug3d.num_instances += num_boxes;
+void debug3d__draw_boxes(const sx_box* boxes, int num_boxes, const sx_mat4* viewproj_mat,
+                         rizz_3d_debug_map_type map_type, const sx_color* tints)
+{
+    sx_assert(num_boxes > 0);
 
-        draw_api->apply_pipeline(!alpha_blend ? g_debug3d.pip_solid_box : g_debug3d.pip_alphablend_box);
-        draw_api->apply_uniforms(SG_SHADERSTAGE_VS, 0, &uniforms, sizeof(uniforms));
-        draw_api->apply_bindings(&(sg_bindings) {
-            .vertex_buffers[0] = g_debug3d.unit_box.vb,
-            .vertex_buffers[1] = g_debug3d.instance_buff,
-            .vertex_buffer_offsets[1] = inst_offset,
-            .index_buffer = g_debug3d.unit_box.ib,
-            .fs_images[0] = map
-        });
+    sx_with(const sx_alloc* tmp_alloc = the_core->tmp_alloc_push(), the_core->tmp_alloc_pop()) {
+        debug3d__instance* instances = sx_malloc(tmp_alloc, sizeof(debug3d__instance)*num_boxes);
+        if (instances) {
+            bool alpha_blend = false;
+            for (int i = 0; i < num_boxes; i++) {
+                sx_color tint = tints ? tints[i] : SX_COLOR_WHITE;
+                instances[i] = debug3d__box_instance(&boxes[i], tint);
+                alpha_blend = alpha_blend || tint.a < 255;
+            }
 
-        draw_api->draw(0, g_debug3d.unit_box.num_indices, num_boxes);
+            debug3d__reset_stats();
+            g_debug3d.num_primitives += num_boxes;
+            debug3d__draw_instances(map_type == RIZZ_3D_DEBUG_MAPTYPE_CHECKER ? DEBUG3D_BATCH_BOX_CHECKER
+                                                                              : DEBUG3D_BATCH_BOX_WHITE,
+                                    instances, num_boxes, alpha_blend, viewproj_mat);
+        } else {
+            sx_out_of_memory();
+        }
     } // sx_with (temp_alloc)
 }
 
@@ -917,8 +1000,8 @@ void debug3d__draw_aabbs(const sx_aabb* aabbs, int num_aabbs, const sx_mat4* vie
     sx_vec3 corners[8];
 
     debug3d__reset_stats();
-    sx_assert_always((g_debug3d.num_verts + num_verts) <= g_debug3d.max_verts);
-    sx_assert_always((g_debug3d.num_verts + num_indices) <= g_debug3d.max_indices);
+    debug3d__grow_vertices(num_verts);
+    debug3d__grow_indices(num_indices);
 
     const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
     sx_scope(the_core->tmp_alloc_pop()) {
@@ -966,6 +1049,8 @@ void debug3d__draw_aabbs(const sx_aabb* aabbs, int num_aabbs, const sx_mat4* vie
         int ib_offset = draw_api->append_buffer(g_debug3d.dyn_ibuff, indices, num_indices * sizeof(uint16_t));
         g_debug3d.num_verts += num_verts;
         g_debug3d.num_indices += num_indices;
+        g_debug3d.num_primitives += num_aabbs;
+        g_debug3d.num_draws++;
 
         sg_bindings bind = { 
             .vertex_buffers[0] = g_debug3d.dyn_vbuff, 
@@ -985,8 +1070,6 @@ void debug3d__grid_xzplane(float spacing, float spacing_bold, const sx_mat4* vp,
     static const sx_color color = { { 170, 170, 170, 255 } };
     static const sx_color bold_color = { { 255, 255, 255, 255 } };
 
-    rizz_api_gfx_draw* draw_api = g_debug3d.draw_api;
-
     spacing = sx_ceil(sx_max(spacing, 0.0001f));
     sx_aabb bb = sx_aabb_empty();
 
@@ -1017,7 +1100,7 @@ void debug3d__grid_xzplane(float spacing, float spacing_bold, const sx_mat4* vp,
     int num_verts = (xlines + ylines) * 2;
 
     debug3d__reset_stats();
-    sx_assert_always((g_debug3d.num_verts + num_verts) <= g_debug3d.max_verts);
+    g_debug3d.num_primitives++;
 
     // draw
     int data_size = num_verts * sizeof(rizz_3d_debug_vertex);
@@ -1061,17 +1144,7 @@ void debug3d__grid_xzplane(float spacing, float spacing_bold, const sx_mat4* vp,
                     : SX_COLOR_BLUE;
         }
 
-        int offset = draw_api->append_buffer(g_debug3d.dyn_vbuff, verts, data_size);
-        g_debug3d.num_verts += num_verts;
-
-        sg_bindings bind = { 
-            .vertex_buffers[0] = g_debug3d.dyn_vbuff, 
-            .vertex_buffer_offsets[0] = offset };
-
-        draw_api->apply_pipeline(g_debug3d.pip_wire);
-        draw_api->apply_uniforms(SG_SHADERSTAGE_VS, 0, vp, sizeof(*vp));
-        draw_api->apply_bindings(&bind);
-        draw_api->draw(0, num_verts, 1);
+        debug3d__draw_wire(verts, num_verts, g_debug3d.pip_wire, vp);
     } // sx_scope
 }
 
@@ -1080,8 +1153,6 @@ void debug3d__grid_xyplane(float spacing, float spacing_bold, const sx_mat4* vp,
     static const sx_color color = { { 170, 170, 170, 255 } };
     static const sx_color bold_color = { { 255, 255, 255, 255 } };
 
-    rizz_api_gfx_draw* draw_api = g_debug3d.draw_api;
-
     spacing = sx_ceil(sx_max(spacing, 0.0001f));
     sx_aabb bb = sx_aabb_empty();
 
@@ -1112,7 +1183,7 @@ void debug3d__grid_xyplane(float spacing, float spacing_bold, const sx_mat4* vp,
     int num_verts = (xlines + ylines) * 2;
 
     debug3d__reset_stats();
-    sx_assert_always((g_debug3d.num_verts + num_verts) <= g_debug3d.max_verts);
+    g_debug3d.num_primitives++;
 
     // draw
     int data_size = num_verts * sizeof(rizz_3d_debug_vertex);
@@ -1156,17 +1227,7 @@ void debug3d__grid_xyplane(float spacing, float spacing_bold, const sx_mat4* vp,
                     : SX_COLOR_GREEN;
         }
 
-        int offset = draw_api->append_buffer(g_debug3d.dyn_vbuff, verts, data_size);
-        g_debug3d.num_verts += num_verts;
-
-        sg_bindings bind = { 
-            .vertex_buffers[0] = g_debug3d.dyn_vbuff, 
-            .vertex_buffer_offsets[0] = offset };
-
-        draw_api->apply_pipeline(g_debug3d.pip_wire);
-        draw_api->apply_uniforms(SG_SHADERSTAGE_VS, 0, vp, sizeof(*vp));
-        draw_api->apply_bindings(&bind);
-        draw_api->draw(0, num_verts, 1);
+        debug3d__draw_wire(verts, num_verts, g_debug3d.pip_wire, vp);
     } // scope
 }
 
@@ -1211,7 +1272,7 @@ void debug3d__set_max_vertices(int max_verts)
         .size = sizeof(rizz_3d_debug_vertex) * max_verts,
         .label = "debug3d_vbuff" });
 
-    sx_assert_always(g_debug3d.instance_buff.id);
+    sx_assert_always(g_debug3d.dyn_vbuff.id);
     g_debug3d.max_verts = max_verts;
 }
 
@@ -1226,7 +1287,7 @@ void debug3d__set_max_indices(int max_indices)
     g_debug3d.dyn_ibuff = the_gfx->make_buffer(&(sg_buffer_desc){
         .type = SG_BUFFERTYPE_INDEXBUFFER,
         .usage = SG_USAGE_STREAM,
-        .size = sizeof(rizz_3d_debug_vertex) * max_indices,
+        .size = sizeof(uint16_t) * max_indices,
         .label = "debug3d_ibuff" });
 
     sx_assert_always(g_debug3d.dyn_ibuff.id);
@@ -1237,30 +1298,20 @@ void debug3d__draw_path(const sx_vec3* points, int num_points, const sx_mat4* vi
 {
     int const num_verts = num_points;
     int const data_size = num_verts * sizeof(rizz_3d_debug_vertex);
-    rizz_api_gfx_draw* draw_api = g_debug3d.draw_api;
-
-    debug3d__reset_stats();
-    sx_assert_always((g_debug3d.num_verts + num_verts) <= g_debug3d.max_verts);
 
     const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
     sx_scope(the_core->tmp_alloc_pop()) {
         rizz_3d_debug_vertex* verts = sx_malloc(tmp_alloc, data_size);
+        sx_assert_always(verts);
 
         for (int i = 0; i < num_points; i++) {
             verts[i].pos = points[i];
             verts[i].color = color;
         }
 
-        int offset = draw_api->append_buffer(g_debug3d.dyn_vbuff, verts, data_size);
-        g_debug3d.num_verts += num_verts;
-        sg_bindings bind = { 
-            .vertex_buffers[0] = g_debug3d.dyn_vbuff, 
-            .vertex_buffer_offsets[0] = offset };
-
-        draw_api->apply_pipeline(g_debug3d.pip_wire_strip);
-        draw_api->apply_uniforms(SG_SHADERSTAGE_VS, 0, viewproj_mat, sizeof(*viewproj_mat));
-        draw_api->apply_bindings(&bind);
-        draw_api->draw(0, num_verts, 1);
+        debug3d__reset_stats();
+        g_debug3d.num_primitives++;
+        debug3d__draw_wire(verts, num_verts, g_debug3d.pip_wire_strip, viewproj_mat);
     } // sx_scope
 }
 
@@ -1269,14 +1320,11 @@ void debug3d__draw_lines(int num_lines, const rizz_3d_debug_line* lines, const s
 {
     const int num_verts = 2*num_lines;
     const int data_size = num_verts * sizeof(rizz_3d_debug_vertex);
-    rizz_api_gfx_draw* draw_api = g_debug3d.draw_api;
-
-    debug3d__reset_stats();
-    sx_assert_always((g_debug3d.num_verts + num_verts) <= g_debug3d.max_verts);
 
     const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
     sx_scope(the_core->tmp_alloc_pop()) {
         rizz_3d_debug_vertex* verts = sx_malloc(tmp_alloc, data_size);
+        sx_assert_always(verts);
 
         for (int i = 0; i < num_lines; i++) {
             sx_color c = colors ? colors[i] : sx_colorn(0xffffffff);
@@ -1289,16 +1337,9 @@ void debug3d__draw_lines(int num_lines, const rizz_3d_debug_line* lines, const s
             verts[index+1].color = c;
         }
 
-        int offset = draw_api->append_buffer(g_debug3d.dyn_vbuff, verts, data_size);
-        g_debug3d.num_verts += num_verts;
-        sg_bindings bind = { 
-            .vertex_buffers[0] = g_debug3d.dyn_vbuff, 
-            .vertex_buffer_offsets[0] = offset };
-
-        draw_api->apply_pipeline(g_debug3d.pip_wire);
-        draw_api->apply_uniforms(SG_SHADERSTAGE_VS, 0, viewproj_mat, sizeof(*viewproj_mat));
-        draw_api->apply_bindings(&bind);
-        draw_api->draw(0, num_verts, 1);
+        debug3d__reset_stats();
+        g_debug3d.num_primitives += num_lines;
+        debug3d__draw_wire(verts, num_verts, g_debug3d.pip_wire, viewproj_mat);
     } // sx_scope
 }
 
@@ -1310,80 +1351,23 @@ void debug3d__draw_line(const sx_vec3 p0, const sx_vec3 p1, const sx_mat4* viewp
 void debug3d__draw_cones(const float* radiuss, const float* depths, const sx_tx3d* txs, int count, 
                          const sx_mat4* viewproj_mat, const sx_color* tints)
 {
-    rizz_api_gfx_draw* draw_api = g_debug3d.draw_api;
-
-    debug3d__uniforms uniforms = {
-        .viewproj_mat = *viewproj_mat
-    };
+    sx_assert(count > 0);
 
     const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
     sx_scope(the_core->tmp_alloc_pop()) {
-
-        debug3d__reset_stats();
-        sx_assert_always((g_debug3d.num_instances + count) <= g_debug3d.max_instances);
         debug3d__instance* instances = sx_malloc(tmp_alloc, sizeof(debug3d__instance)*count);
         sx_assert_always(instances);
 
         bool alpha_blend = false;
-
         for (int i = 0; i < count; i++) {
-            const sx_tx3d* tx = &txs[i];
-            float radius = radiuss[i];
-            float depth = depths[i];
-
-            debug3d__instance* instance = &instances[i];
-            instance->tx1 = sx_vec4f(tx->pos.x, tx->pos.y, tx->pos.z, tx->rot.m11);
-            instance->tx2 = sx_vec4f(tx->rot.m21, tx->rot.m31, tx->rot.m12, tx->rot.m22);
-            instance->tx3 = sx_vec4f(tx->rot.m23, tx->rot.m13, tx->rot.m23, tx->rot.m33);
-            instance->scale = sx_vec3f(radius, radius, depth);
-            if (tints) {
-                instance->color = tints[i];
-                alpha_blend = alpha_blend || tints[i].a < 255;
-            }
-            else {
-                instance->color = SX_COLOR_WHITE;
-            }
+            sx_color tint = tints ? tints[i] : SX_COLOR_WHITE;
+            instances[i] = debug3d__cone_instance(&txs[i], radiuss[i], depths[i], tint);
+            alpha_blend = alpha_blend || tint.a < 255;
         }
 
-        // in alpha-blend mode (transparent boxes), sort the boxes from back-to-front
-        if (alpha_blend) {
-            debug3d__instance_depth* sort_items = sx_malloc(tmp_alloc, sizeof(debug3d__instance_depth)*count);
-            if (!sort_items) {
-                sx_out_of_memory();
-                return;
-            }
-            for (int i = 0; i < count; i++) {
-                sort_items[i].index = i;
-                sort_items[i].z = sx_mat4_mul_vec3(viewproj_mat, txs[i].pos).z;
-            }
-
-            debug3d__instance_tim_sort(sort_items, count);
-
-            debug3d__instance* sorted = sx_malloc(tmp_alloc, sizeof(debug3d__instance)*count);
-            if (!sorted) {
-                sx_out_of_memory();
-                return;
-            }
-            for (int i = 0; i < count; i++) {
-                sorted[i] = instances[sort_items[i].index];
-            }
-            instances = sorted;
-        }
-
-        int inst_offset = draw_api->append_buffer(g_debug3d.instance_buff, instances,
-                                                  sizeof(debug3d__instance) * count);
-        g_debug3d.num_instances += count;
-
-        draw_api->apply_pipeline(!alpha_blend ? g_debug3d.pip_solid : g_debug3d.pip_alphablend);
-        draw_api->apply_uniforms(SG_SHADERSTAGE_VS, 0, &uniforms, sizeof(uniforms));
-        draw_api->apply_bindings(&(sg_bindings) {
-            .vertex_buffers[0] = g_debug3d.unit_cone.vb,
-            .vertex_buffers[1] = g_debug3d.instance_buff,
-            .vertex_buffer_offsets[1] = inst_offset,
-            .index_buffer = g_debug3d.unit_cone.ib,
-            .fs_images[0] = the_gfx->texture_white()
-        });
-        draw_api->draw(0, g_debug3d.unit_cone.num_indices, count);
+        debug3d__reset_stats();
+        g_debug3d.num_primitives += count;
+        debug3d__draw_instances(DEBUG3D_BATCH_CONE, instances, count, alpha_blend, viewproj_mat);
     } // sx_scope
 }
 
@@ -1480,4 +1464,202 @@ void debug3d__draw_camera(const rizz_camera* cam, const sx_mat4* viewproj_mat)
 
 }
 
+static void debug3d__queue_instances(debug3d__batch batch, const debug3d__instance* instances, int count)
+{
+    const sx_alloc* alloc = g_debug3d.alloc;
+    debug3d__queue* queue = &g_debug3d.queue;
+
+    sx_lock(g_debug3d.queue_lk) {
+        for (int i = 0; i < count; i++) {
+            int alpha_blend = instances[i].color.a < 255 ? 1 : 0;
+            sx_array_push(alloc, queue->instances[batch][alpha_blend], instances[i]);
+        }
+        queue->num_primitives += count;
+    }
+}
+
+void debug3d__queue_boxes(const sx_box* boxes, int num_boxes, rizz_3d_debug_map_type map_type,
+                          const sx_color* tints)
+{
+    sx_assert(num_boxes > 0);
+
+    debug3d__batch batch = map_type == RIZZ_3D_DEBUG_MAPTYPE_CHECKER ? DEBUG3D_BATCH_BOX_CHECKER
+                                                                     : DEBUG3D_BATCH_BOX_WHITE;
+    const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
+    sx_scope(the_core->tmp_alloc_pop()) {
+        debug3d__instance* instances = sx_malloc(tmp_alloc, sizeof(debug3d__instance)*num_boxes);
+        sx_assert_always(instances);
+        for (int i = 0; i < num_boxes; i++) {
+            instances[i] = debug3d__box_instance(&boxes[i], tints ? tints[i] : SX_COLOR_WHITE);
+        }
+        debug3d__queue_instances(batch, instances, num_boxes);
+    }
+}
+
+void debug3d__queue_spheres(const sx_vec3* centers, const float* radiuss, int count,
+                            rizz_3d_debug_map_type map_type, const sx_color* tints)
+{
+    sx_assert(count > 0);
+
+    debug3d__batch batch = map_type == RIZZ_3D_DEBUG_MAPTYPE_CHECKER ? DEBUG3D_BATCH_SPHERE_CHECKER
+                                                                     : DEBUG3D_BATCH_SPHERE_WHITE;
+    const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
+    sx_scope(the_core->tmp_alloc_pop()) {
+        debug3d__instance* instances = sx_malloc(tmp_alloc, sizeof(debug3d__instance)*count);
+        sx_assert_always(instances);
+        for (int i = 0; i < count; i++) {
+            instances[i] = debug3d__sphere_instance(centers[i], radiuss[i], tints ? tints[i] : SX_COLOR_WHITE);
+        }
+        debug3d__queue_instances(batch, instances, count);
+    }
+}
+
+void debug3d__queue_cones(const float* radiuss, const float* depths, const sx_tx3d* txs, int count,
+                          const sx_color* tints)
+{
+    sx_assert(count > 0);
+
+    const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
+    sx_scope(the_core->tmp_alloc_pop()) {
+        debug3d__instance* instances = sx_malloc(tmp_alloc, sizeof(debug3d__instance)*count);
+        sx_assert_always(instances);
+        for (int i = 0; i < count; i++) {
+            instances[i] = debug3d__cone_instance(&txs[i], radiuss[i], depths[i], 
+                                                  tints ? tints[i] : SX_COLOR_WHITE);
+        }
+        debug3d__queue_instances(DEBUG3D_BATCH_CONE, instances, count);
+    }
+}
 
+void debug3d__queue_aabbs(const sx_aabb* aabbs, int num_aabbs, const sx_color* tints)
+{
+    sx_assert(aabbs);
+    sx_assert(num_aabbs > 0);
+
+    // aabb edges as corner index pairs, see `sx_aabb_corners`
+    static const int k_edges[24] = { 0, 1,  1, 3,  3, 2,  2, 0,  5, 4,  4, 6,
+                                     6, 7,  7, 5,  5, 1,  7, 3,  0, 4,  2, 6 };
+    debug3d__queue* queue = &g_debug3d.queue;
+    sx_vec3 corners[8];
+
+    sx_lock(g_debug3d.queue_lk) {
+        rizz_3d_debug_vertex* verts = sx_array_add(g_debug3d.alloc, queue->line_verts, 24*num_aabbs);
+        for (int i = 0; i < num_aabbs; i++) {
+            sx_color c = tints ? tints[i] : SX_COLOR_WHITE;
+            sx_aabb_corners(corners, &aabbs[i]);
+            for (int k = 0; k < 24; k++) {
+                verts[k].pos = corners[k_edges[k]];
+                verts[k].color = c;
+            }
+            verts += 24;
+        }
+        queue->num_primitives += num_aabbs;
+    }
+}
+
+void debug3d__queue_lines(int num_lines, const rizz_3d_debug_line* lines, const sx_color* colors)
+{
+    sx_assert(num_lines > 0);
+
+    debug3d__queue* queue = &g_debug3d.queue;
+    sx_lock(g_debug3d.queue_lk) {
+        rizz_3d_debug_vertex* verts = sx_array_add(g_debug3d.alloc, queue->line_verts, 2*num_lines);
+        for (int i = 0; i < num_lines; i++) {
+            sx_color c = colors ? colors[i] : SX_COLOR_WHITE;
+            verts[0].pos = lines[i].p0;
+            verts[0].color = c;
+            verts[1].pos = lines[i].p1;
+            verts[1].color = c;
+            verts += 2;
+        }
+        queue->num_primitives += num_lines;
+    }
+}
+
+// paths are converted to line-lists, so they can be merged with other wireframe primitives
+void debug3d__queue_path(const sx_vec3* points, int num_points, sx_color color)
+{
+    if (num_points < 2) {
+        return;
+    }
+
+    const int num_segments = num_points - 1;
+    debug3d__queue* queue = &g_debug3d.queue;
+    sx_lock(g_debug3d.queue_lk) {
+        rizz_3d_debug_vertex* verts = sx_array_add(g_debug3d.alloc, queue->line_verts, 2*num_segments);
+        for (int i = 0; i < num_segments; i++) {
+            verts[0].pos = points[i];
+            verts[0].color = color;
+            verts[1].pos = points[i + 1];
+            verts[1].color = color;
+            verts += 2;
+        }
+        queue->num_primitives++;
+    }
+}
+
+void debug3d__queue_axis(const sx_mat4* mat, float scale)
+{
+    if (scale <= 0) {
+        scale = 1.0f;
+    }
+
+    sx_vec3 p = sx_vec3fv(mat->fc4);
+    rizz_3d_debug_line lines[3] = {
+        { .p0 = p, .p1 = sx_vec3_add(p, sx_vec3_mulf(sx_vec3fv(mat->fc1), scale)) },
+        { .p0 = p, .p1 = sx_vec3_add(p, sx_vec3_mulf(sx_vec3fv(mat->fc2), scale)) },
+        { .p0 = p, .p1 = sx_vec3_add(p, sx_vec3_mulf(sx_vec3fv(mat->fc3), scale)) }
+    };
+    const sx_color colors[3] = {
+        sx_color4u(255, 0, 0, 255),
+        sx_color4u(0, 255, 0, 255),
+        sx_color4u(0, 0, 255, 255)
+    };
+
+    debug3d__queue_lines(3, lines, colors);
+}
+
+// draw order: all wireframe primitives in one line-list draw, then solid batches, and alpha-blended
+// batches at the end, so they are blended on top of everything else
+void debug3d__flush(const sx_mat4* viewproj_mat)
+{
+    debug3d__queue* queue = &g_debug3d.queue;
+
+    sx_lock(g_debug3d.queue_lk) {
+        debug3d__reset_stats();
+        g_debug3d.num_primitives += queue->num_primitives;
+
+        int num_line_verts = sx_array_count(queue->line_verts);
+        if (num_line_verts > 0) {
+            debug3d__draw_wire(queue->line_verts, num_line_verts, g_debug3d.pip_wire, viewproj_mat);
+        }
+
+        for (int alpha_blend = 0; alpha_blend < 2; alpha_blend++) {
+            for (int i = 0; i < _DEBUG3D_BATCH_COUNT; i++) {
+                const debug3d__instance* instances = queue->instances[i][alpha_blend];
+                int count = sx_array_count(instances);
+                if (count > 0) {
+                    debug3d__draw_instances((debug3d__batch)i, instances, count, alpha_blend != 0,
+                                            viewproj_mat);
+                }
+                sx_array_clear(queue->instances[i][alpha_blend]);
+            }
+        }
+
+        sx_array_clear(queue->line_verts);
+        queue->num_primitives = 0;
+    }
+}
+
+void debug3d__get_stats(rizz_3d_debug_stats* stats)
+{
+    sx_assert(stats);
+
+    *stats = (rizz_3d_debug_stats) {
+        .num_primitives = g_debug3d.num_primitives,
+        .num_draws = g_debug3d.num_draws,
+        .num_instances = g_debug3d.num_instances,
+        .num_verts = g_debug3d.num_verts,
+        .num_indices = g_debug3d.num_indices
+    };
+}
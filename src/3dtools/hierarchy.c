@@ -0,0 +1,284 @@
+#include "rizz/3dtools.h"
+#include "rizz/rizz.h"
+
+#include "sx/allocator.h"
+#include "sx/array.h"
+#include "sx/math-vec.h"
+#include "sx/string.h"
+
+#include "3dtools-internal.h"
+
+// instances below this count are updated on the calling thread, dispatching jobs costs more
+#define HIERARCHY_MIN_JOB_INSTANCES 64
+
+RIZZ_STATE static rizz_api_core* the_core;
+
+typedef struct rizz_3d_hierarchy {
+    const sx_alloc* alloc;
+    int num_nodes;
+    int num_instances;
+
+    // topology, shared between instances
+    int* order;                     // depth-sorted node_ids, parents come before their children
+    int* parents;                   // parent node_id of each node (=-1 for roots)
+    sx_aabb* local_bounds;          // mesh bounds of each node (empty if not renderable)
+    sx_tx3d* default_txs;           // initial local transforms of new instances (from the model)
+
+    // per-instance data, each array has (num_instances*num_nodes) items, indexed by node_id
+    sx_tx3d* SX_ARRAY local_txs;
+    sx_tx3d* SX_ARRAY world_txs;
+    sx_aabb* SX_ARRAY world_bounds;
+    uint8_t* SX_ARRAY dirty;
+
+    // per-instance
+    sx_tx3d* SX_ARRAY root_txs;
+    sx_aabb* SX_ARRAY instance_bounds;
+    uint8_t* SX_ARRAY instance_dirty;
+} rizz_3d_hierarchy;
+
+typedef struct hierarchy__update_data {
+    rizz_3d_hierarchy* h;
+    const int* instances;
+} hierarchy__update_data;
+
+void hierarchy__init(rizz_api_core* core)
+{
+    the_core = core;
+}
+
+static sx_aabb hierarchy__transform_aabb(const sx_aabb* aabb, const sx_tx3d* tx)
+{
+    sx_vec3 vmin = sx_vec3fv(aabb->vmin);
+    sx_vec3 vmax = sx_vec3fv(aabb->vmax);
+    sx_vec3 center = sx_tx3d_mul_vec3(tx, sx_vec3_mulf(sx_vec3_add(vmin, vmax), 0.5f));
+    sx_vec3 extents = sx_vec3_mulf(sx_vec3_sub(vmax, vmin), 0.5f);
+
+    sx_vec3 world_extents = sx_vec3_add(
+        sx_vec3_add(sx_vec3_mulf(sx_vec3_abs(sx_vec3fv(tx->rot.fc1)), extents.x),
+                    sx_vec3_mulf(sx_vec3_abs(sx_vec3fv(tx->rot.fc2)), extents.y)),
+        sx_vec3_mulf(sx_vec3_abs(sx_vec3fv(tx->rot.fc3)), extents.z));
+    return sx_aabbv(sx_vec3_sub(center, world_extents), sx_vec3_add(center, world_extents));
+}
+
+rizz_3d_hierarchy* hierarchy__create(const rizz_model* model, int init_capacity, const sx_alloc* alloc)
+{
+    sx_assert(model);
+    sx_assert(model->num_nodes > 0);
+
+    int num_nodes = model->num_nodes;
+    rizz_3d_hierarchy* h = sx_malloc(alloc, sizeof(rizz_3d_hierarchy) +
+                                     (sizeof(sx_tx3d) + sizeof(sx_aabb) + sizeof(int)*2)*num_nodes);
+    if (!h) {
+        sx_out_of_memory();
+        return NULL;
+    }
+    sx_memset(h, 0x0, sizeof(rizz_3d_hierarchy));
+    h->alloc = alloc;
+    h->num_nodes = num_nodes;
+    h->default_txs = (sx_tx3d*)(h + 1);
+    h->local_bounds = (sx_aabb*)(h->default_txs + num_nodes);
+    h->order = (int*)(h->local_bounds + num_nodes);
+    h->parents = h->order + num_nodes;
+
+    // counting sort of nodes by depth, keeps the original order for nodes with the same depth
+    const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
+    sx_scope(the_core->tmp_alloc_pop()) {
+        int* depths = sx_malloc(tmp_alloc, sizeof(int)*num_nodes);
+        int* depth_offsets = sx_calloc(tmp_alloc, sizeof(int)*(num_nodes + 1));
+        sx_assert_always(depths && depth_offsets);
+
+        for (int i = 0; i < num_nodes; i++) {
+            const rizz_model_node* node = &model->nodes[i];
+            int depth = 0;
+            for (int parent_id = node->parent_id; parent_id != -1; parent_id = model->nodes[parent_id].parent_id) {
+                ++depth;
+            }
+            sx_assert(depth < num_nodes);
+            depths[i] = depth;
+            depth_offsets[depth + 1]++;
+
+            h->parents[i] = node->parent_id;
+            h->default_txs[i] = node->local_tx;
+            h->local_bounds[i] = node->mesh_id != -1 ? node->bounds : sx_aabb_empty();
+        }
+
+        for (int i = 0; i < num_nodes; i++) {
+            depth_offsets[i + 1] += depth_offsets[i];
+        }
+
+        for (int i = 0; i < num_nodes; i++) {
+            h->order[depth_offsets[depths[i]]++] = i;
+        }
+    }
+
+    if (init_capacity > 0) {
+        sx_array_reserve(alloc, h->local_txs, init_capacity*num_nodes);
+        sx_array_reserve(alloc, h->world_txs, init_capacity*num_nodes);
+        sx_array_reserve(alloc, h->world_bounds, init_capacity*num_nodes);
+        sx_array_reserve(alloc, h->dirty, init_capacity*num_nodes);
+        sx_array_reserve(alloc, h->root_txs, init_capacity);
+        sx_array_reserve(alloc, h->instance_bounds, init_capacity);
+        sx_array_reserve(alloc, h->instance_dirty, init_capacity);
+    }
+
+    return h;
+}
+
+void hierarchy__destroy(rizz_3d_hierarchy* h)
+{
+    if (h) {
+        const sx_alloc* alloc = h->alloc;
+        sx_array_free(alloc, h->local_txs);
+        sx_array_free(alloc, h->world_txs);
+        sx_array_free(alloc, h->world_bounds);
+        sx_array_free(alloc, h->dirty);
+        sx_array_free(alloc, h->root_txs);
+        sx_array_free(alloc, h->instance_bounds);
+        sx_array_free(alloc, h->instance_dirty);
+        sx_free(alloc, h);
+    }
+}
+
+int hierarchy__add_instance(rizz_3d_hierarchy* h, const sx_tx3d* root_tx)
+{
+    sx_assert(h);
+    const sx_alloc* alloc = h->alloc;
+    int num_nodes = h->num_nodes;
+    int instance = h->num_instances;
+
+    sx_memcpy(sx_array_add(alloc, h->local_txs, num_nodes), h->default_txs, sizeof(sx_tx3d)*num_nodes);
+    sx_array_add(alloc, h->world_txs, num_nodes);
+    sx_array_add(alloc, h->world_bounds, num_nodes);
+    sx_memset(sx_array_add(alloc, h->dirty, num_nodes), 0x1, num_nodes);
+
+    sx_array_push(alloc, h->root_txs, root_tx ? *root_tx : sx_tx3d_ident());
+    sx_array_push(alloc, h->instance_bounds, sx_aabb_empty());
+    sx_array_push(alloc, h->instance_dirty, 1);
+
+    ++h->num_instances;
+    return instance;
+}
+
+int hierarchy__num_instances(const rizz_3d_hierarchy* h)
+{
+    return h->num_instances;
+}
+
+void hierarchy__set_root_tx(rizz_3d_hierarchy* h, int instance, const sx_tx3d* root_tx)
+{
+    sx_assert(instance >= 0 && instance < h->num_instances);
+    h->root_txs[instance] = *root_tx;
+    h->instance_dirty[instance] = 1;
+
+    // root nodes are marked dirty, children are updated through propagation
+    uint8_t* dirty = &h->dirty[instance*h->num_nodes];
+    for (int i = 0; i < h->num_nodes; i++) {
+        if (h->parents[i] == -1) {
+            dirty[i] = 1;
+        }
+    }
+}
+
+void hierarchy__set_local_tx(rizz_3d_hierarchy* h, int instance, int node_id, const sx_tx3d* local_tx)
+{
+    sx_assert(instance >= 0 && instance < h->num_instances);
+    sx_assert(node_id >= 0 && node_id < h->num_nodes);
+
+    int index = instance*h->num_nodes + node_id;
+    h->local_txs[index] = *local_tx;
+    h->dirty[index] = 1;
+    h->instance_dirty[instance] = 1;
+}
+
+static void hierarchy__update_instance(rizz_3d_hierarchy* h, int instance)
+{
+    int num_nodes = h->num_nodes;
+    int base = instance*num_nodes;
+    const sx_tx3d* local_txs = &h->local_txs[base];
+    sx_tx3d* world_txs = &h->world_txs[base];
+    sx_aabb* world_bounds = &h->world_bounds[base];
+    uint8_t* dirty = &h->dirty[base];
+    const sx_tx3d* root_tx = &h->root_txs[instance];
+
+    sx_aabb bounds = sx_aabb_empty();
+    for (int i = 0; i < num_nodes; i++) {
+        int node_id = h->order[i];
+        int parent_id = h->parents[node_id];
+
+        // parents are always visited first, so dirty flags propagate down the subtree
+        if (parent_id != -1 && dirty[parent_id]) {
+            dirty[node_id] = 1;
+        }
+
+        if (dirty[node_id]) {
+            const sx_tx3d* parent_tx = parent_id != -1 ? &world_txs[parent_id] : root_tx;
+            world_txs[node_id] = sx_tx3d_mul(parent_tx, &local_txs[node_id]);
+            world_bounds[node_id] = sx_aabb_isempty(&h->local_bounds[node_id]) ?
+                sx_aabb_empty() : hierarchy__transform_aabb(&h->local_bounds[node_id], &world_txs[node_id]);
+        }
+
+        if (!sx_aabb_isempty(&world_bounds[node_id])) {
+            bounds = sx_aabb_add(&bounds, &world_bounds[node_id]);
+        }
+    }
+
+    // dirty flags are cleared after the whole pass, children still need them during propagation
+    sx_memset(dirty, 0x0, num_nodes);
+    h->instance_bounds[instance] = bounds;
+    h->instance_dirty[instance] = 0;
+}
+
+static void hierarchy__update_job_cb(int start, int end, int thrd_index, void* user)
+{
+    sx_unused(thrd_index);
+    hierarchy__update_data* data = user;
+
+    for (int i = start; i < end; i++) {
+        hierarchy__update_instance(data->h, data->instances[i]);
+    }
+}
+
+void hierarchy__update(rizz_3d_hierarchy* h)
+{
+    sx_assert(h);
+
+    const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
+    sx_scope(the_core->tmp_alloc_pop()) {
+        int* instances = sx_malloc(tmp_alloc, sizeof(int)*(h->num_instances + 1));
+        sx_assert_always(instances);
+
+        int num_dirty = 0;
+        for (int i = 0; i < h->num_instances; i++) {
+            if (h->instance_dirty[i]) {
+                instances[num_dirty++] = i;
+            }
+        }
+
+        hierarchy__update_data data = { .h = h, .instances = instances };
+        if (num_dirty >= HIERARCHY_MIN_JOB_INSTANCES) {
+            sx_job_t job = the_core->job_dispatch(num_dirty, hierarchy__update_job_cb, &data,
+                                                  SX_JOB_PRIORITY_HIGH, 0);
+            the_core->job_wait_and_del(job);
+        } else if (num_dirty > 0) {
+            hierarchy__update_job_cb(0, num_dirty, 0, &data);
+        }
+    }
+}
+
+const sx_tx3d* hierarchy__world_txs(const rizz_3d_hierarchy* h, int instance)
+{
+    sx_assert(instance >= 0 && instance < h->num_instances);
+    return &h->world_txs[instance*h->num_nodes];
+}
+
+const sx_aabb* hierarchy__world_bounds(const rizz_3d_hierarchy* h, int instance)
+{
+    sx_assert(instance >= 0 && instance < h->num_instances);
+    return &h->world_bounds[instance*h->num_nodes];
+}
+
+sx_aabb hierarchy__instance_bounds(const rizz_3d_hierarchy* h, int instance)
+{
+    sx_assert(instance >= 0 && instance < h->num_instances);
+    return h->instance_bounds[instance];
+}
@@ -0,0 +1,437 @@
+#include "rizz/3dtools.h"
+#include "rizz/rizz.h"
+
+#include "sx/allocator.h"
+#include "sx/math-scalar.h"
+#include "sx/math-vec.h"
+#include "sx/string.h"
+
+#include "3dtools-internal.h"
+
+#include <float.h>
+
+// mesh optimization routines, used by model importer (see model__optimize_mesh)
+// all functions work on 32bit triangle-list indices and allocate their temp memory from `alloc`
+#define MESHOPT_CACHE_SIZE 32            // vertex cache size that forsyth's algorithm optimizes for
+#define MESHOPT_FIFO_CACHE_SIZE 16       // fifo cache size that is simulated for acmr and overdraw clusters
+#define MESHOPT_MIN_CLUSTER_TRIS 32
+#define MESHOPT_MAX_GRID_SIZE 1024
+
+typedef struct meshopt__cluster {
+    int start;
+    int count;
+    float sort_key;
+} meshopt__cluster;
+
+#define SORT_NAME meshopt__cluster
+#define SORT_TYPE meshopt__cluster
+#define SORT_CMP(x, y) ((y).sort_key < (x).sort_key ? -1 : ((y).sort_key > (x).sort_key ? 1 : 0))
+SX_PRAGMA_DIAGNOSTIC_PUSH()
+SX_PRAGMA_DIAGNOSTIC_IGNORED_MSVC(4267)
+SX_PRAGMA_DIAGNOSTIC_IGNORED_MSVC(4244)
+SX_PRAGMA_DIAGNOSTIC_IGNORED_MSVC(4146)
+SX_PRAGMA_DIAGNOSTIC_IGNORED_CLANG_GCC("-Wunused-function")
+SX_PRAGMA_DIAGNOSTIC_IGNORED_CLANG("-Wshorten-64-to-32")
+#include "sort/sort.h"
+SX_PRAGMA_DIAGNOSTIC_POP()
+
+float meshopt__acmr(const uint32_t* indices, int num_indices, int num_verts, const sx_alloc* alloc)
+{
+    if (num_indices < 3) {
+        return 0;
+    }
+
+    uint32_t* timestamps = sx_calloc(alloc, sizeof(uint32_t)*num_verts);
+    sx_assert_always(timestamps);
+
+    uint32_t time = MESHOPT_FIFO_CACHE_SIZE + 1;
+    int num_misses = 0;
+    for (int i = 0; i < num_indices; i++) {
+        uint32_t v = indices[i];
+        if (time - timestamps[v] > MESHOPT_FIFO_CACHE_SIZE) {
+            timestamps[v] = time++;
+            num_misses++;
+        }
+    }
+
+    sx_free(alloc, timestamps);
+    return (float)num_misses / (float)(num_indices / 3);
+}
+
+// https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+static float meshopt__vertex_score(int cache_pos, int num_live_tris)
+{
+    if (num_live_tris == 0) {
+        return -1.0f;
+    }
+
+    float score = 0;
+    if (cache_pos >= 0) {
+        // the last triangle's vertices get a fixed score, so the next triangle doesn't prefer them
+        score = cache_pos < 3 ? 0.75f :
+            sx_pow(1.0f - (float)(cache_pos - 3) / (float)(MESHOPT_CACHE_SIZE - 3), 1.5f);
+    }
+
+    // bonus for vertices with few remaining triangles, to get rid of lone triangles early
+    return score + 2.0f / sx_sqrt((float)num_live_tris);
+}
+
+void meshopt__optimize_vertex_cache(uint32_t* dst, const uint32_t* indices, int num_indices, int num_verts,
+                                    const sx_alloc* alloc)
+{
+    sx_assert(dst != indices);
+    int num_tris = num_indices / 3;
+    if (num_tris == 0) {
+        return;
+    }
+
+    int* live_tris = sx_calloc(alloc, sizeof(int)*num_verts);
+    int* adj_offsets = sx_malloc(alloc, sizeof(int)*(num_verts + 1));
+    int* adj_tris = sx_malloc(alloc, sizeof(int)*num_indices);
+    int* cache_pos = sx_malloc(alloc, sizeof(int)*num_verts);
+    float* vertex_scores = sx_malloc(alloc, sizeof(float)*num_verts);
+    float* tri_scores = sx_malloc(alloc, sizeof(float)*num_tris);
+    uint8_t* emitted = sx_calloc(alloc, num_tris);
+    sx_assert_always(live_tris && adj_offsets && adj_tris && cache_pos && vertex_scores && tri_scores && emitted);
+
+    // vertex -> triangles adjacency
+    for (int i = 0; i < num_indices; i++) {
+        live_tris[indices[i]]++;
+    }
+    adj_offsets[0] = 0;
+    for (int i = 0; i < num_verts; i++) {
+        adj_offsets[i + 1] = adj_offsets[i] + live_tris[i];
+        cache_pos[i] = -1;
+        vertex_scores[i] = meshopt__vertex_score(-1, live_tris[i]);
+    }
+    sx_memset(live_tris, 0x0, sizeof(int)*num_verts);
+    for (int i = 0; i < num_indices; i++) {
+        uint32_t v = indices[i];
+        adj_tris[adj_offsets[v] + live_tris[v]++] = i / 3;
+    }
+
+    int best_tri = 0;
+    float best_score = -1.0f;
+    for (int i = 0; i < num_tris; i++) {
+        const uint32_t* tri = &indices[i*3];
+        tri_scores[i] = vertex_scores[tri[0]] + vertex_scores[tri[1]] + vertex_scores[tri[2]];
+        if (tri_scores[i] > best_score) {
+            best_score = tri_scores[i];
+            best_tri = i;
+        }
+    }
+
+    uint32_t cache[MESHOPT_CACHE_SIZE + 3];
+    int cache_count = 0;
+    int scan_cursor = 0;
+
+    for (int out = 0; out < num_tris; out++) {
+        if (best_tri < 0) {
+            // no candidates in cache, continue with the next non-emitted triangle
+            while (emitted[scan_cursor]) {
+                scan_cursor++;
+            }
+            best_tri = scan_cursor;
+        }
+
+        const uint32_t* tri = &indices[best_tri*3];
+        dst[out*3] = tri[0];
+        dst[out*3 + 1] = tri[1];
+        dst[out*3 + 2] = tri[2];
+        emitted[best_tri] = 1;
+
+        // remove triangle from adjacency of it's vertices
+        for (int k = 0; k < 3; k++) {
+            uint32_t v = tri[k];
+            int* vtris = &adj_tris[adj_offsets[v]];
+            for (int j = 0, c = live_tris[v]; j < c; j++) {
+                if (vtris[j] == best_tri) {
+                    vtris[j] = vtris[c - 1];
+                    live_tris[v]--;
+                    break;
+                }
+            }
+        }
+
+        // push triangle's vertices to the front of the cache (LRU)
+        uint32_t new_cache[MESHOPT_CACHE_SIZE + 3];
+        int new_count = 0;
+        for (int k = 0; k < 3; k++) {
+            if (k == 0 || (tri[k] != tri[0] && (k == 1 || tri[k] != tri[1]))) {
+                new_cache[new_count++] = tri[k];
+            }
+        }
+        for (int i = 0; i < cache_count; i++) {
+            uint32_t v = cache[i];
+            if (v != tri[0] && v != tri[1] && v != tri[2]) {
+                new_cache[new_count++] = v;
+            }
+        }
+
+        for (int i = 0; i < new_count; i++) {
+            uint32_t v = new_cache[i];
+            cache_pos[v] = i < MESHOPT_CACHE_SIZE ? i : -1;
+            vertex_scores[v] = meshopt__vertex_score(cache_pos[v], live_tris[v]);
+        }
+        cache_count = sx_min(new_count, MESHOPT_CACHE_SIZE);
+        sx_memcpy(cache, new_cache, sizeof(uint32_t)*cache_count);
+
+        // update triangle scores of affected vertices and pick the best one for the next round
+        best_tri = -1;
+        best_score = -1.0f;
+        for (int i = 0; i < new_count; i++) {
+            uint32_t v = new_cache[i];
+            const int* vtris = &adj_tris[adj_offsets[v]];
+            for (int j = 0, c = live_tris[v]; j < c; j++) {
+                int t = vtris[j];
+                const uint32_t* ttri = &indices[t*3];
+                float score = vertex_scores[ttri[0]] + vertex_scores[ttri[1]] + vertex_scores[ttri[2]];
+                tri_scores[t] = score;
+                if (score > best_score) {
+                    best_score = score;
+                    best_tri = t;
+                }
+            }
+        }
+    }
+
+    sx_free(alloc, emitted);
+    sx_free(alloc, tri_scores);
+    sx_free(alloc, vertex_scores);
+    sx_free(alloc, cache_pos);
+    sx_free(alloc, adj_tris);
+    sx_free(alloc, adj_offsets);
+    sx_free(alloc, live_tris);
+}
+
+// indices should already be optimized for vertex cache. triangles are split into clusters at the points
+// where the cache is restarted, then clusters are sorted so the ones that face outwards from the
+// center of the mesh are drawn first and are more likely to occlude the rest
+void meshopt__optimize_overdraw(uint32_t* indices, int num_indices, const sx_vec3* positions, int num_verts,
+                                const sx_alloc* alloc)
+{
+    int num_tris = num_indices / 3;
+    if (num_tris < MESHOPT_MIN_CLUSTER_TRIS * 2) {
+        return;
+    }
+
+    uint32_t* timestamps = sx_calloc(alloc, sizeof(uint32_t)*num_verts);
+    meshopt__cluster* clusters = sx_malloc(alloc, sizeof(meshopt__cluster)*num_tris);
+    uint32_t* tmp_indices = sx_malloc(alloc, sizeof(uint32_t)*num_indices);
+    sx_assert_always(timestamps && clusters && tmp_indices);
+
+    int num_clusters = 0;
+    int cluster_start = 0;
+    uint32_t time = MESHOPT_FIFO_CACHE_SIZE + 1;
+    for (int t = 0; t < num_tris; t++) {
+        int num_misses = 0;
+        for (int k = 0; k < 3; k++) {
+            uint32_t v = indices[t*3 + k];
+            if (time - timestamps[v] > MESHOPT_FIFO_CACHE_SIZE) {
+                timestamps[v] = time++;
+                num_misses++;
+            }
+        }
+
+        if (num_misses == 3 && (t - cluster_start) >= MESHOPT_MIN_CLUSTER_TRIS) {
+            clusters[num_clusters++] = (meshopt__cluster){ .start = cluster_start, .count = t - cluster_start };
+            cluster_start = t;
+        }
+    }
+    clusters[num_clusters++] = (meshopt__cluster){ .start = cluster_start, .count = num_tris - cluster_start };
+
+    if (num_clusters > 1) {
+        sx_vec3 mesh_center = SX_VEC3_ZERO;
+        for (int i = 0; i < num_indices; i++) {
+            mesh_center = sx_vec3_add(mesh_center, positions[indices[i]]);
+        }
+        mesh_center = sx_vec3_mulf(mesh_center, 1.0f / (float)num_indices);
+
+        for (int i = 0; i < num_clusters; i++) {
+            meshopt__cluster* cluster = &clusters[i];
+            sx_vec3 center = SX_VEC3_ZERO;
+            sx_vec3 normal = SX_VEC3_ZERO;
+            float area = 0;
+            for (int t = cluster->start, tc = cluster->start + cluster->count; t < tc; t++) {
+                sx_vec3 p0 = positions[indices[t*3]];
+                sx_vec3 p1 = positions[indices[t*3 + 1]];
+                sx_vec3 p2 = positions[indices[t*3 + 2]];
+                sx_vec3 n = sx_vec3_cross(sx_vec3_sub(p1, p0), sx_vec3_sub(p2, p0));
+                float tri_area = sx_vec3_len(n);
+                sx_vec3 tri_center = sx_vec3_mulf(sx_vec3_add(sx_vec3_add(p0, p1), p2), 1.0f/3.0f);
+                center = sx_vec3_add(center, sx_vec3_mulf(tri_center, tri_area));
+                normal = sx_vec3_add(normal, n);
+                area += tri_area;
+            }
+
+            if (area > 0) {
+                center = sx_vec3_mulf(center, 1.0f / area);
+                float normal_len = sx_vec3_len(normal);
+                normal = normal_len > 0 ? sx_vec3_mulf(normal, 1.0f / normal_len) : SX_VEC3_ZERO;
+            }
+            cluster->sort_key = sx_vec3_dot(sx_vec3_sub(center, mesh_center), normal);
+        }
+
+        meshopt__cluster_tim_sort(clusters, num_clusters);
+
+        sx_memcpy(tmp_indices, indices, sizeof(uint32_t)*num_indices);
+        int offset = 0;
+        for (int i = 0; i < num_clusters; i++) {
+            const meshopt__cluster* cluster = &clusters[i];
+            sx_memcpy(&indices[offset], &tmp_indices[cluster->start*3], sizeof(uint32_t)*cluster->count*3);
+            offset += cluster->count*3;
+        }
+        sx_assert(offset == num_indices);
+    }
+
+    sx_free(alloc, tmp_indices);
+    sx_free(alloc, clusters);
+    sx_free(alloc, timestamps);
+}
+
+// remaps vertices in the order of their first use in the index buffer, and updates indices in place
+// unused vertices are mapped to UINT32_MAX. returns number of remaining vertices
+int meshopt__optimize_vertex_fetch_remap(uint32_t* remap, uint32_t* indices, int num_indices, int num_verts)
+{
+    sx_memset(remap, 0xff, sizeof(uint32_t)*num_verts);
+
+    uint32_t next_vertex = 0;
+    for (int i = 0; i < num_indices; i++) {
+        uint32_t v = indices[i];
+        if (remap[v] == UINT32_MAX) {
+            remap[v] = next_vertex++;
+        }
+        indices[i] = remap[v];
+    }
+
+    return (int)next_vertex;
+}
+
+typedef struct meshopt__grid_cell {
+    uint64_t key;       // =0: empty slot
+    sx_vec3 sum;
+    int count;
+    int rep_vertex;
+    float rep_dist;
+} meshopt__grid_cell;
+
+static inline uint64_t meshopt__cell_key(sx_vec3 pos, sx_vec3 bmin, sx_vec3 inv_cell, int grid_size)
+{
+    int x = sx_clamp((int)((pos.x - bmin.x) * inv_cell.x), 0, grid_size - 1);
+    int y = sx_clamp((int)((pos.y - bmin.y) * inv_cell.y), 0, grid_size - 1);
+    int z = sx_clamp((int)((pos.z - bmin.z) * inv_cell.z), 0, grid_size - 1);
+    return ((uint64_t)x | ((uint64_t)y << 21) | ((uint64_t)z << 42)) + 1;
+}
+
+static meshopt__grid_cell* meshopt__find_cell(meshopt__grid_cell* cells, uint32_t mask, uint64_t key)
+{
+    uint32_t index = (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+    while (cells[index].key != 0 && cells[index].key != key) {
+        index = (index + 1) & mask;
+    }
+    cells[index].key = key;
+    return &cells[index];
+}
+
+// collapses all vertices within each grid cell to a single representative vertex (closest to the
+// center of the cell's vertices) and removes degenerate triangles.
+// returns the number of output indices, or -1 if the output exceeds `max_indices`
+static int meshopt__simplify_grid(uint32_t* dst, int max_indices, const uint32_t* indices, int num_indices,
+                                  const sx_vec3* positions, const sx_aabb* bounds, int grid_size,
+                                  meshopt__grid_cell* cells, uint32_t mask, uint32_t* remap)
+{
+    sx_vec3 bmin = sx_vec3fv(bounds->vmin);
+    sx_vec3 extents = sx_vec3_sub(sx_vec3fv(bounds->vmax), bmin);
+    sx_vec3 inv_cell = sx_vec3f((float)grid_size / sx_max(extents.x, 1e-6f),
+                                (float)grid_size / sx_max(extents.y, 1e-6f),
+                                (float)grid_size / sx_max(extents.z, 1e-6f));
+
+    sx_memset(cells, 0x0, sizeof(meshopt__grid_cell)*(mask + 1));
+    for (int i = 0; i < num_indices; i++) {
+        sx_vec3 pos = positions[indices[i]];
+        uint64_t key = meshopt__cell_key(pos, bmin, inv_cell, grid_size);
+        meshopt__grid_cell* cell = meshopt__find_cell(cells, mask, key);
+        cell->sum = sx_vec3_add(cell->sum, pos);
+        cell->count++;
+        cell->rep_dist = FLT_MAX;
+    }
+
+    for (int i = 0; i < num_indices; i++) {
+        uint32_t v = indices[i];
+        sx_vec3 pos = positions[v];
+        uint64_t key = meshopt__cell_key(pos, bmin, inv_cell, grid_size);
+        meshopt__grid_cell* cell = meshopt__find_cell(cells, mask, key);
+        sx_vec3 center = sx_vec3_mulf(cell->sum, 1.0f / (float)cell->count);
+        sx_vec3 d = sx_vec3_sub(pos, center);
+        float dist = sx_vec3_dot(d, d);
+        if (dist < cell->rep_dist) {
+            cell->rep_dist = dist;
+            cell->rep_vertex = (int)v;
+        }
+        remap[i] = (uint32_t)(cell - cells);
+    }
+
+    int count = 0;
+    for (int i = 0; i < num_indices; i += 3) {
+        uint32_t a = (uint32_t)cells[remap[i]].rep_vertex;
+        uint32_t b = (uint32_t)cells[remap[i + 1]].rep_vertex;
+        uint32_t c = (uint32_t)cells[remap[i + 2]].rep_vertex;
+        if (a != b && b != c && a != c) {
+            if (count + 3 > max_indices) {
+                return -1;
+            }
+            dst[count++] = a;
+            dst[count++] = b;
+            dst[count++] = c;
+        }
+    }
+
+    return count;
+}
+
+// vertex clustering simplification: searches for the finest grid that brings the index count
+// below `target_indices`. output references the same vertices as the source. returns number of indices
+int meshopt__simplify(uint32_t* dst, const uint32_t* indices, int num_indices, int target_indices,
+                      const sx_vec3* positions, const sx_alloc* alloc)
+{
+    if (num_indices <= target_indices) {
+        sx_memcpy(dst, indices, sizeof(uint32_t)*num_indices);
+        return num_indices;
+    }
+
+    sx_aabb bounds = sx_aabb_empty();
+    for (int i = 0; i < num_indices; i++) {
+        sx_aabb_add_point(&bounds, positions[indices[i]]);
+    }
+
+    uint32_t capacity = 64;
+    while (capacity < (uint32_t)num_indices * 2) {
+        capacity <<= 1;
+    }
+
+    meshopt__grid_cell* cells = sx_malloc(alloc, sizeof(meshopt__grid_cell)*capacity);
+    uint32_t* remap = sx_malloc(alloc, sizeof(uint32_t)*num_indices);
+    uint32_t* tmp = sx_malloc(alloc, sizeof(uint32_t)*target_indices);
+    sx_assert_always(cells && remap && tmp);
+
+    // triangle count grows (almost) monotonically with grid size, so binary search for the best fit
+    int lo = 1, hi = MESHOPT_MAX_GRID_SIZE;
+    int result = 0;
+    while (lo <= hi) {
+        int grid_size = (lo + hi) / 2;
+        int count = meshopt__simplify_grid(tmp, target_indices, indices, num_indices, positions, &bounds,
+                                           grid_size, cells, capacity - 1, remap);
+        if (count >= 0) {
+            sx_memcpy(dst, tmp, sizeof(uint32_t)*count);
+            result = count;
+            lo = grid_size + 1;
+        } else {
+            hi = grid_size - 1;
+        }
+    }
+
+    sx_free(alloc, tmp);
+    sx_free(alloc, remap);
+    sx_free(alloc, cells);
+    return result;
+}
@@ -13,6 +13,7 @@
 #include "sx/handle.h"
 #include "sx/array.h"
 #include "sx/io.h"
+#include "sx/timer.h"
 
 #define SX_MAX_BUFFER_FIELDS 128
 #include "sx/linear-buffer.h"
@@ -227,11 +228,168 @@ static int model__get_stride(sg_vertex_format fmt)
     case SG_VERTEXFORMAT_SHORT4:    return sizeof(int16_t)*4;
     case SG_VERTEXFORMAT_SHORT4N:   return sizeof(int16_t)*4;
     case SG_VERTEXFORMAT_USHORT4N:  return sizeof(uint16_t)*4;
-    case SG_VERTEXFORMAT_UINT10_N2: return 2;
+    case SG_VERTEXFORMAT_UINT10_N2: return sizeof(uint32_t);
     default:                        return 0;
     }
 }
 
+static int model__get_num_components(sg_vertex_format fmt)
+{
+    switch (fmt) {
+    case SG_VERTEXFORMAT_FLOAT:     return 1;
+    case SG_VERTEXFORMAT_FLOAT2:    
+    case SG_VERTEXFORMAT_SHORT2:    
+    case SG_VERTEXFORMAT_SHORT2N:   
+    case SG_VERTEXFORMAT_USHORT2N:  return 2;
+    case SG_VERTEXFORMAT_FLOAT3:    return 3;
+    case SG_VERTEXFORMAT_FLOAT4:    
+    case SG_VERTEXFORMAT_BYTE4:     
+    case SG_VERTEXFORMAT_BYTE4N:    
+    case SG_VERTEXFORMAT_UBYTE4:    
+    case SG_VERTEXFORMAT_UBYTE4N:   
+    case SG_VERTEXFORMAT_SHORT4:    
+    case SG_VERTEXFORMAT_SHORT4N:   
+    case SG_VERTEXFORMAT_USHORT4N:  
+    case SG_VERTEXFORMAT_UINT10_N2: return 4;
+    default:                        return 0;
+    }
+}
+
+static inline int32_t model__quantize_snorm(float v, float max_value)
+{
+    return (int32_t)sx_round(sx_clamp(v, -1.0f, 1.0f) * max_value);
+}
+
+static inline uint32_t model__quantize_unorm(float v, float max_value)
+{
+    return (uint32_t)sx_round(sx_clamp(v, 0.0f, 1.0f) * max_value);
+}
+
+// quantizes float values to the vertex format (see rizz_model_load_params for normalized formats)
+static void model__encode_attr(uint8_t* dst, sg_vertex_format fmt, const float v[4])
+{
+    switch (fmt) {
+    case SG_VERTEXFORMAT_FLOAT:     
+    case SG_VERTEXFORMAT_FLOAT2:    
+    case SG_VERTEXFORMAT_FLOAT3:    
+    case SG_VERTEXFORMAT_FLOAT4:    
+        sx_memcpy(dst, v, sizeof(float)*model__get_num_components(fmt));
+        break;
+    case SG_VERTEXFORMAT_BYTE4:
+        for (int i = 0; i < 4; i++) {
+            ((int8_t*)dst)[i] = (int8_t)sx_clamp(sx_round(v[i]), -128.0f, 127.0f);
+        }
+        break;
+    case SG_VERTEXFORMAT_BYTE4N:
+        for (int i = 0; i < 4; i++) {
+            ((int8_t*)dst)[i] = (int8_t)model__quantize_snorm(v[i], 127.0f);
+        }
+        break;
+    case SG_VERTEXFORMAT_UBYTE4:
+        for (int i = 0; i < 4; i++) {
+            dst[i] = (uint8_t)sx_clamp(sx_round(v[i]), 0.0f, 255.0f);
+        }
+        break;
+    case SG_VERTEXFORMAT_UBYTE4N:
+        for (int i = 0; i < 4; i++) {
+            dst[i] = (uint8_t)model__quantize_unorm(v[i], 255.0f);
+        }
+        break;
+    case SG_VERTEXFORMAT_SHORT2:
+    case SG_VERTEXFORMAT_SHORT4:
+        for (int i = 0, c = model__get_num_components(fmt); i < c; i++) {
+            ((int16_t*)dst)[i] = (int16_t)sx_clamp(sx_round(v[i]), -32768.0f, 32767.0f);
+        }
+        break;
+    case SG_VERTEXFORMAT_SHORT2N:
+    case SG_VERTEXFORMAT_SHORT4N:
+        for (int i = 0, c = model__get_num_components(fmt); i < c; i++) {
+            ((int16_t*)dst)[i] = (int16_t)model__quantize_snorm(v[i], 32767.0f);
+        }
+        break;
+    case SG_VERTEXFORMAT_USHORT2N:
+    case SG_VERTEXFORMAT_USHORT4N:
+        for (int i = 0, c = model__get_num_components(fmt); i < c; i++) {
+            ((uint16_t*)dst)[i] = (uint16_t)model__quantize_unorm(v[i], 65535.0f);
+        }
+        break;
+    case SG_VERTEXFORMAT_UINT10_N2:
+        *((uint32_t*)dst) = model__quantize_unorm(v[0], 1023.0f) | 
+                            (model__quantize_unorm(v[1], 1023.0f) << 10) |
+                            (model__quantize_unorm(v[2], 1023.0f) << 20) |
+                            (model__quantize_unorm(v[3], 3.0f) << 30);
+        break;
+    default:
+        sx_assertf(0, "unknown vertex format");
+        break;
+    }
+}
+
+// reads vertex attribute as floats, missing components are filled with (0, 0, 0, 1)
+static void model__decode_attr(float v[4], const uint8_t* src, sg_vertex_format fmt)
+{
+    v[0] = v[1] = v[2] = 0;
+    v[3] = 1.0f;
+
+    switch (fmt) {
+    case SG_VERTEXFORMAT_FLOAT:     
+    case SG_VERTEXFORMAT_FLOAT2:    
+    case SG_VERTEXFORMAT_FLOAT3:    
+    case SG_VERTEXFORMAT_FLOAT4:    
+        sx_memcpy(v, src, sizeof(float)*model__get_num_components(fmt));
+        break;
+    case SG_VERTEXFORMAT_BYTE4:
+        for (int i = 0; i < 4; i++) {
+            v[i] = (float)((const int8_t*)src)[i];
+        }
+        break;
+    case SG_VERTEXFORMAT_BYTE4N:
+        for (int i = 0; i < 4; i++) {
+            v[i] = sx_max((float)((const int8_t*)src)[i] / 127.0f, -1.0f);
+        }
+        break;
+    case SG_VERTEXFORMAT_UBYTE4:
+        for (int i = 0; i < 4; i++) {
+            v[i] = (float)src[i];
+        }
+        break;
+    case SG_VERTEXFORMAT_UBYTE4N:
+        for (int i = 0; i < 4; i++) {
+            v[i] = (float)src[i] / 255.0f;
+        }
+        break;
+    case SG_VERTEXFORMAT_SHORT2:
+    case SG_VERTEXFORMAT_SHORT4:
+        for (int i = 0, c = model__get_num_components(fmt); i < c; i++) {
+            v[i] = (float)((const int16_t*)src)[i];
+        }
+        break;
+    case SG_VERTEXFORMAT_SHORT2N:
+    case SG_VERTEXFORMAT_SHORT4N:
+        for (int i = 0, c = model__get_num_components(fmt); i < c; i++) {
+            v[i] = sx_max((float)((const int16_t*)src)[i] / 32767.0f, -1.0f);
+        }
+        break;
+    case SG_VERTEXFORMAT_USHORT2N:
+    case SG_VERTEXFORMAT_USHORT4N:
+        for (int i = 0, c = model__get_num_components(fmt); i < c; i++) {
+            v[i] = (float)((const uint16_t*)src)[i] / 65535.0f;
+        }
+        break;
+    case SG_VERTEXFORMAT_UINT10_N2: {
+        uint32_t packed = *((const uint32_t*)src);
+        v[0] = (float)(packed & 0x3ff) / 1023.0f;
+        v[1] = (float)((packed >> 10) & 0x3ff) / 1023.0f;
+        v[2] = (float)((packed >> 20) & 0x3ff) / 1023.0f;
+        v[3] = (float)(packed >> 30) / 3.0f;
+        break;
+    }
+    default:
+        sx_assertf(0, "unknown vertex format");
+        break;
+    }
+}
+
 static bool model__map_attributes_to_buffer(rizz_model_mesh* mesh, 
                                             const rizz_model_geometry_layout* vertex_layout, 
                                             cgltf_attribute* srcatt, int start_vertex)
@@ -242,20 +400,33 @@ static bool model__map_attributes_to_buffer(rizz_model_mesh* mesh,
     while (attr->semantic) {
         if (sx_strequal(attr->semantic, mapped_att.semantic) && attr->semantic_idx == mapped_att.index) {
             int vertex_stride = vertex_layout->buffer_strides[attr->buffer_index];
-            uint8_t* src_buff = (uint8_t*)access->buffer_view->buffer->data;
             uint8_t* dst_buff = (uint8_t*)mesh->cpu.vbuffs[attr->buffer_index];
             int dst_offset =  start_vertex * vertex_stride + attr->offset;
-            int src_offset = (int)(access->offset + access->buffer_view->offset);
-
             int count = (int)access->count;
-            int src_data_size = (int)access->stride; 
             int dst_data_size = model__get_stride(attr->format);
             sx_assertf(dst_data_size != 0, "you must explicitly declare formats for vertex_layout attributes");
-            int stride = sx_min(dst_data_size, src_data_size);
-            for (int i = 0; i < count; i++) {
-                sx_memcpy(dst_buff + dst_offset + vertex_stride*i, 
-                          src_buff + src_offset + src_data_size*i, 
-                          stride);
+
+            int num_components = (int)cgltf_num_components(access->type);
+            if (access->component_type == cgltf_component_type_r_32f && !access->is_sparse &&
+                attr->format >= SG_VERTEXFORMAT_FLOAT && attr->format <= SG_VERTEXFORMAT_FLOAT4 && 
+                num_components == model__get_num_components(attr->format)) {
+                // formats match, copy directly
+                uint8_t* src_buff = (uint8_t*)access->buffer_view->buffer->data;
+                int src_offset = (int)(access->offset + access->buffer_view->offset);
+                int src_data_size = (int)access->stride; 
+                for (int i = 0; i < count; i++) {
+                    sx_memcpy(dst_buff + dst_offset + vertex_stride*i, 
+                              src_buff + src_offset + src_data_size*i, 
+                              dst_data_size);
+                }
+            } else {
+                // convert and quantize to the destination format
+                sx_assertf(num_components <= 4, "matrix attributes are not supported");
+                for (int i = 0; i < count; i++) {
+                    float v[4] = { 0, 0, 0, 1.0f };
+                    cgltf_accessor_read_float(access, (cgltf_size)i, v, (cgltf_size)num_components);
+                    model__encode_attr(dst_buff + dst_offset + vertex_stride*i, attr->format, v);
+                }
             }
 
             return true;
@@ -290,13 +461,15 @@ static bool model__gltf_has_tangents(const cgltf_primitive* prim)
 }
 
 static uint8_t* model__layout_get_attr(rizz_model_mesh* mesh, const rizz_model_geometry_layout* vertex_layout, 
-                                       const char* semantic, int semantic_idx, int* pvertex_stride)
+                                       const char* semantic, int semantic_idx, int* pvertex_stride, 
+                                       sg_vertex_format* pformat)
 {
     const rizz_vertex_attr* attr = &vertex_layout->attrs[0];
     
     while (attr->semantic) {
         if (sx_strequal(attr->semantic, semantic) && attr->semantic_idx == semantic_idx) {
             *pvertex_stride = vertex_layout->buffer_strides[attr->buffer_index];
+            *pformat = attr->format;
             uint8_t* dst_buff = (uint8_t*)mesh->cpu.vbuffs[attr->buffer_index];
             return dst_buff + attr->offset;
         }
@@ -306,11 +479,32 @@ static uint8_t* model__layout_get_attr(rizz_model_mesh* mesh, const rizz_model_g
     return NULL;
 }
 
+static inline sx_vec3 model__decode_vec3(const uint8_t* src, sg_vertex_format fmt)
+{
+    float v[4];
+    model__decode_attr(v, src, fmt);
+    return sx_vec3fv(v);
+}
+
 static void model__calculate_tangents(rizz_model_mesh* mesh, const rizz_model_geometry_layout* vertex_layout)
 {
     sg_index_type index_type = mesh->index_type;
     void* ibuff = mesh->cpu.ibuff;
 
+    int pos_stride = 0, uv_stride = 0, normal_stride = 0, tangent_stride = 0, bitangent_stride = 0;
+    sg_vertex_format pos_fmt = SG_VERTEXFORMAT_INVALID, uv_fmt = SG_VERTEXFORMAT_INVALID, 
+                     normal_fmt = SG_VERTEXFORMAT_INVALID, tangent_fmt = SG_VERTEXFORMAT_INVALID,
+                     bitangent_fmt = SG_VERTEXFORMAT_INVALID;
+    uint8_t* pos_ptr = model__layout_get_attr(mesh, vertex_layout, "POSITION", 0, &pos_stride, &pos_fmt);
+    uint8_t* uv_ptr = model__layout_get_attr(mesh, vertex_layout, "TEXCOORD", 0, &uv_stride, &uv_fmt);
+    uint8_t* normal_ptr = model__layout_get_attr(mesh, vertex_layout, "NORMAL", 0, &normal_stride, &normal_fmt);
+    uint8_t* tangent_ptr = model__layout_get_attr(mesh, vertex_layout, "TANGENT", 0, &tangent_stride, &tangent_fmt);
+    uint8_t* bitangent_ptr = model__layout_get_attr(mesh, vertex_layout, "BINORMAL", 0, &bitangent_stride, &bitangent_fmt);
+    if (!pos_ptr || !uv_ptr || !normal_ptr || !tangent_ptr) {
+        rizz_log_warn("model: mesh '%s' needs POSITION, NORMAL and TEXCOORD to calculate tangents", mesh->name);
+        return;
+    }
+
     const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
     sx_scope(the_core->tmp_alloc_pop()) {
 
@@ -335,17 +529,13 @@ static void model__calculate_tangents(rizz_model_mesh* mesh, const rizz_model_ge
                 i3 = indices[i+2];
             }
 
-            int pos_stride = 0, uv_stride = 0;
-            uint8_t* pos_ptr = model__layout_get_attr(mesh, vertex_layout, "POSITION", 0, &pos_stride);
-            uint8_t* uv_ptr = model__layout_get_attr(mesh, vertex_layout, "TEXCOORD", 0, &uv_stride);
+            sx_vec3 v1 = model__decode_vec3(pos_ptr + pos_stride*i1, pos_fmt);
+            sx_vec3 v2 = model__decode_vec3(pos_ptr + pos_stride*i2, pos_fmt);
+            sx_vec3 v3 = model__decode_vec3(pos_ptr + pos_stride*i3, pos_fmt);
 
-            sx_vec3 v1 = *((sx_vec3*)(pos_ptr + pos_stride*i1));
-            sx_vec3 v2 = *((sx_vec3*)(pos_ptr + pos_stride*i2));
-            sx_vec3 v3 = *((sx_vec3*)(pos_ptr + pos_stride*i3));
-
-            sx_vec2 w1 = *((sx_vec2*)(uv_ptr + uv_stride*i1));
-            sx_vec2 w2 = *((sx_vec2*)(uv_ptr + uv_stride*i2));
-            sx_vec2 w3 = *((sx_vec2*)(uv_ptr + uv_stride*i3));
+            sx_vec3 w1 = model__decode_vec3(uv_ptr + uv_stride*i1, uv_fmt);
+            sx_vec3 w2 = model__decode_vec3(uv_ptr + uv_stride*i2, uv_fmt);
+            sx_vec3 w3 = model__decode_vec3(uv_ptr + uv_stride*i3, uv_fmt);
 
             float x1 = v2.x - v1.x;
             float x2 = v3.x - v1.x;
@@ -374,22 +564,22 @@ static void model__calculate_tangents(rizz_model_mesh* mesh, const rizz_model_ge
         }
 
         for (int i = 0, num_verts = mesh->num_vertices; i < num_verts; i++) {
-            int normal_stride = 0, tangent_stride = 0, bitangent_stride = 0;
-            uint8_t* normal_ptr = model__layout_get_attr(mesh, vertex_layout, "NORMAL", 0, &normal_stride);
-            uint8_t* tangent_ptr = model__layout_get_attr(mesh, vertex_layout, "TANGENT", 0, &tangent_stride);
-            uint8_t* bitangent_ptr = model__layout_get_attr(mesh, vertex_layout, "BINORMAL", 0, &bitangent_stride);
-
-            sx_vec3 n = *((sx_vec3*)(normal_ptr + normal_stride*i));
+            sx_vec3 n = model__decode_vec3(normal_ptr + normal_stride*i, normal_fmt);
             sx_vec3 t = tan1[i];
         
             if (sx_vec3_dot(t, t) != 0) {
                 sx_vec3 tangent = sx_vec3_norm(sx_vec3_sub(t, sx_vec3_mulf(n, sx_vec3_dot(n, t))));
-                *((sx_vec3*)(tangent_ptr + tangent_stride*i)) = tangent;
         
                 // (Dot(Cross(n, t), tan2[a]) < 0.0F) ? -1.0F : 1.0F;
                 float handedness = (sx_vec3_dot(sx_vec3_cross(n, t), tan2[i]) < 0.0f) ? -1.0f : 1.0f;
+                model__encode_attr(tangent_ptr + tangent_stride*i, tangent_fmt, 
+                                   (float[4]) { tangent.x, tangent.y, tangent.z, handedness });
 
-                *((sx_vec3*)(bitangent_ptr + bitangent_stride*i)) = sx_vec3_mulf(sx_vec3_cross(n, tangent), -handedness);
+                if (bitangent_ptr) {
+                    sx_vec3 bitangent = sx_vec3_mulf(sx_vec3_cross(n, tangent), -handedness);
+                    model__encode_attr(bitangent_ptr + bitangent_stride*i, bitangent_fmt,
+                                       (float[4]) { bitangent.x, bitangent.y, bitangent.z, 1.0f });
+                }
             }
         }
     }   // scope
@@ -482,6 +672,167 @@ static void model__setup_buffers(rizz_model_mesh* mesh, const rizz_model_geometr
     }
 }
 
+static inline float model__lod_ratio(const rizz_model_load_params* lparams)
+{
+    return (lparams->lod_ratio > 0 && lparams->lod_ratio < 1.0f) ? lparams->lod_ratio : 0.5f;
+}
+
+static inline int model__num_lods(const rizz_model_load_params* lparams)
+{
+    int num_lods = lparams->num_lods;
+    return sx_clamp(num_lods, 0, RIZZ_MODEL_MAX_LODS - 1);
+}
+
+// maximum index count of the mesh, including all generated LODs
+static int model__max_lod_indices(int num_indices, const rizz_model_load_params* lparams)
+{
+    float lod_ratio = model__lod_ratio(lparams);
+    float scale = 1.0f;
+    int max_indices = num_indices;
+    for (int i = 0, c = model__num_lods(lparams); i < c; i++) {
+        scale *= lod_ratio;
+        max_indices += (int)((float)num_indices * scale) + 3;
+    }
+    return max_indices;
+}
+
+// vertex size if all the attributes were stored as 32bit floats
+static int model__get_float_vertex_size(const rizz_model_geometry_layout* vertex_layout)
+{
+    int size = 0;
+    const rizz_vertex_attr* attr = &vertex_layout->attrs[0];
+    while (attr->semantic) {
+        size += (int)sizeof(float) * model__get_num_components(attr->format);
+        ++attr;
+    }
+    return size;
+}
+
+// runs the optimizations that are set in load params and generates LODs for each submesh
+// full detail submeshes keep their index ranges, LOD indices are appended to the end of the index buffer
+static void model__optimize_mesh(rizz_model_mesh* mesh, const rizz_model_geometry_layout* vertex_layout,
+                                 const rizz_model_load_params* lparams)
+{
+    int num_indices = mesh->num_indices;
+    int num_vertices = mesh->num_vertices;
+    int num_lods = model__num_lods(lparams);
+    int max_indices = model__max_lod_indices(num_indices, lparams);
+    float lod_ratio = model__lod_ratio(lparams);
+    rizz_model_optimize_flags flags = lparams->optimize_flags;
+
+    int pos_stride = 0;
+    sg_vertex_format pos_fmt = SG_VERTEXFORMAT_INVALID;
+    const uint8_t* pos_ptr = model__layout_get_attr(mesh, vertex_layout, "POSITION", 0, &pos_stride, &pos_fmt);
+    sx_assert_always(pos_ptr);
+
+    const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
+    sx_scope(the_core->tmp_alloc_pop()) {
+        sx_vec3* positions = sx_malloc(tmp_alloc, sizeof(sx_vec3)*num_vertices);
+        uint32_t* indices = sx_malloc(tmp_alloc, sizeof(uint32_t)*max_indices);
+        uint32_t* tmp_indices = sx_malloc(tmp_alloc, sizeof(uint32_t)*num_indices);
+        sx_assert_always(positions && indices && tmp_indices);
+
+        for (int i = 0; i < num_vertices; i++) {
+            positions[i] = model__decode_vec3(pos_ptr + pos_stride*i, pos_fmt);
+        }
+
+        if (mesh->index_type == SG_INDEXTYPE_UINT16) {
+            const uint16_t* src_indices = mesh->cpu.ibuff;
+            for (int i = 0; i < num_indices; i++) {
+                indices[i] = src_indices[i];
+            }
+        } else {
+            sx_memcpy(indices, mesh->cpu.ibuff, sizeof(uint32_t)*num_indices);
+        }
+
+        mesh->stats.src_num_indices = num_indices;
+        mesh->stats.src_acmr = meshopt__acmr(indices, num_indices, num_vertices, tmp_alloc);
+        mesh->stats.src_vertex_bytes = num_vertices * model__get_float_vertex_size(vertex_layout);
+
+        int lod_offset = num_indices;
+        for (int i = 0; i < mesh->num_submeshes; i++) {
+            rizz_model_submesh* submesh = &mesh->submeshes[i];
+            uint32_t* sub_indices = indices + submesh->start_index;
+
+            if (flags & RIZZ_MODEL_OPTIMIZE_VERTEX_CACHE) {
+                meshopt__optimize_vertex_cache(tmp_indices, sub_indices, submesh->num_indices, num_vertices,
+                                               tmp_alloc);
+                sx_memcpy(sub_indices, tmp_indices, sizeof(uint32_t)*submesh->num_indices);
+            }
+
+            if (flags & RIZZ_MODEL_OPTIMIZE_OVERDRAW) {
+                meshopt__optimize_overdraw(sub_indices, submesh->num_indices, positions, num_vertices, tmp_alloc);
+            }
+
+            submesh->num_lods = 1;
+            submesh->lods[0] = (rizz_model_lod) { .start_index = submesh->start_index, 
+                                                  .num_indices = submesh->num_indices };
+
+            for (int k = 1; k <= num_lods; k++) {
+                int target_indices = (int)((float)submesh->lods[k - 1].num_indices * lod_ratio) / 3 * 3;
+                if (target_indices < 3 || lod_offset + target_indices > max_indices) {
+                    break;
+                }
+
+                uint32_t* lod_indices = indices + lod_offset;
+                int count = meshopt__simplify(lod_indices, sub_indices, submesh->num_indices, target_indices,
+                                              positions, tmp_alloc);
+                if (count == 0) {
+                    break;
+                }
+
+                if (flags & RIZZ_MODEL_OPTIMIZE_VERTEX_CACHE) {
+                    meshopt__optimize_vertex_cache(tmp_indices, lod_indices, count, num_vertices, tmp_alloc);
+                    sx_memcpy(lod_indices, tmp_indices, sizeof(uint32_t)*count);
+                }
+
+                submesh->lods[k] = (rizz_model_lod) { .start_index = lod_offset, .num_indices = count };
+                submesh->num_lods++;
+                lod_offset += count;
+            }
+        }
+
+        if (flags & RIZZ_MODEL_OPTIMIZE_VERTEX_FETCH) {
+            uint32_t* remap = sx_malloc(tmp_alloc, sizeof(uint32_t)*num_vertices);
+            sx_assert_always(remap);
+            int new_num_vertices = meshopt__optimize_vertex_fetch_remap(remap, indices, lod_offset, num_vertices);
+
+            for (int i = 0; i < mesh->num_vbuffs; i++) {
+                int vertex_stride = vertex_layout->buffer_strides[i];
+                uint8_t* vbuff = mesh->cpu.vbuffs[i];
+                uint8_t* src_vbuff = sx_malloc(tmp_alloc, (size_t)vertex_stride*num_vertices);
+                sx_assert_always(src_vbuff);
+                sx_memcpy(src_vbuff, vbuff, (size_t)vertex_stride*num_vertices);
+                for (int v = 0; v < num_vertices; v++) {
+                    if (remap[v] != UINT32_MAX) {
+                        sx_memcpy(vbuff + remap[v]*vertex_stride, src_vbuff + v*vertex_stride, vertex_stride);
+                    }
+                }
+            }
+            mesh->num_vertices = new_num_vertices;
+        }
+
+        if (mesh->index_type == SG_INDEXTYPE_UINT16) {
+            uint16_t* dst_indices = mesh->cpu.ibuff;
+            for (int i = 0; i < lod_offset; i++) {
+                dst_indices[i] = (uint16_t)indices[i];
+            }
+        } else {
+            sx_memcpy(mesh->cpu.ibuff, indices, sizeof(uint32_t)*lod_offset);
+        }
+        mesh->num_indices = lod_offset;
+
+        int vertex_size = 0;
+        for (int i = 0; i < mesh->num_vbuffs; i++) {
+            vertex_size += vertex_layout->buffer_strides[i];
+        }
+
+        mesh->stats.num_indices = lod_offset;
+        mesh->stats.acmr = meshopt__acmr(indices, num_indices, mesh->num_vertices, tmp_alloc);
+        mesh->stats.vertex_bytes = mesh->num_vertices * vertex_size;
+    } // scope
+}
+
 static bool model__setup_gpu_buffers(rizz_model* model, sg_usage vbuff_usage, sg_usage ibuff_usage, const char* name) 
 {
     rizz_model_geometry_layout* layout = &model->layout;
@@ -525,17 +876,6 @@ static bool model__setup_gpu_buffers(rizz_model* model, sg_usage vbuff_usage, sg
 }
 
 
-static int model__find_node_byname(const rizz_model* model, const char* name)
-{
-    for (int ni = 0; ni < model->num_nodes; ni++) {
-        if (sx_strequal(model->nodes[ni].name, name)) {
-            return ni;
-        }
-    }
-    return -1;
-}
-
-
 static const rizz_vertex_attr* model__find_attribute(const rizz_model_geometry_layout* layout, 
                                                      const char* semantic, int semantic_index)
 {
@@ -589,6 +929,514 @@ static void model__cgltf_release(const struct cgltf_memory_options* memory_optio
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// baked models (.rmdl)
+// file layout: header | materials[num_materials] | textures[num_textures] | data
+//  - data is a relocatable image of rizz_model with all of it's arrays and cpu buffers, pointers are
+//    stored as offsets from the start of the data (0 = NULL) and fixed up after loading
+//  - vertex streams are already laid out with the geometry layout that the model was baked with and
+//    include the calculated tangents, bounds and hierarchy indices
+//  - materials are stored one per submesh (in mesh order), textures are referenced by their paths
+#define MODEL_BAKED_FOURCC sx_makefourcc('R', 'M', 'D', 'L')
+#define MODEL_BAKED_VERSION 2
+#define MODEL_MAX_MATERIAL_TEXTURES 9
+
+typedef struct model__baked_header {
+    uint32_t fourcc;
+    uint32_t version;
+    uint16_t model_size;        // struct sizes are checked to reject files baked with a different ABI
+    uint16_t node_size;
+    uint16_t mesh_size;
+    uint16_t material_size;
+    int num_materials;
+    int num_textures;
+    uint32_t data_offset;
+    uint32_t data_size;
+} model__baked_header;
+
+typedef struct model__baked_texture {
+    char path[RIZZ_MAX_PATH];
+    rizz_texture_load_params params;
+} model__baked_texture;
+
+typedef struct model__blob_writer {
+    uint8_t* data;              // =NULL: only calculates the size
+    uintptr_t offset;
+} model__blob_writer;
+
+#define model__reloc(_base, _ptr) \
+    if (_ptr) (_ptr) = (void*)((uint8_t*)(_base) + (uintptr_t)(_ptr))
+
+// in baked materials, texture handles are replaced by (index + 1) to the texture table
+static int model__material_textures(rizz_material_data* mtl, rizz_asset* textures[MODEL_MAX_MATERIAL_TEXTURES])
+{
+    textures[0] = &mtl->pbr_metallic_roughness.base_color_tex.tex_asset;
+    textures[1] = &mtl->pbr_metallic_roughness.metallic_roughness_tex.tex_asset;
+    textures[2] = &mtl->pbr_specular_glossiness.diffuse_tex.tex_asset;
+    textures[3] = &mtl->pbr_specular_glossiness.specular_glossiness_tex.tex_asset;
+    textures[4] = &mtl->clearcoat.clearcoat_tex;
+    textures[5] = &mtl->clearcoat.clearcoat_roughness_tex;
+    textures[6] = &mtl->clearcoat.clearcoat_normal_tex;
+    textures[7] = &mtl->normal_tex.tex_asset;
+    textures[8] = &mtl->occlusion_tex.tex_asset;
+    return MODEL_MAX_MATERIAL_TEXTURES;
+}
+
+static uintptr_t model__blob_write(model__blob_writer* w, const void* data, size_t size)
+{
+    uintptr_t offset = w->offset;
+    if (w->data && data) {
+        sx_memcpy(w->data + offset, data, size);
+    }
+    w->offset += sx_align_16(size);
+    return offset;
+}
+
+// writes the relocatable image of the model to `blob`, returns the size of the image
+// if `blob` is NULL, only calculates the size
+static uintptr_t model__bake_data(uint8_t* blob, const rizz_model* model)
+{
+    model__blob_writer w = { .data = blob };
+    uintptr_t model_offset = model__blob_write(&w, NULL, sizeof(rizz_model));
+    uintptr_t nodes_offset = model__blob_write(&w, model->nodes, sizeof(rizz_model_node)*model->num_nodes);
+    uintptr_t meshes_offset = model__blob_write(&w, model->meshes, sizeof(rizz_model_mesh)*model->num_meshes);
+    sx_assert(model_offset == 0);
+
+    for (int i = 0; i < model->num_nodes; i++) {
+        const rizz_model_node* node = &model->nodes[i];
+        uintptr_t children_offset = node->num_childs > 0 ? 
+            model__blob_write(&w, node->children, sizeof(int)*node->num_childs) : 0;
+        if (blob) {
+            ((rizz_model_node*)(blob + nodes_offset))[i].children = (int*)children_offset;
+        }
+    }
+
+    for (int i = 0; i < model->num_meshes; i++) {
+        const rizz_model_mesh* mesh = &model->meshes[i];
+        rizz_model_mesh* baked_mesh = blob ? &((rizz_model_mesh*)(blob + meshes_offset))[i] : NULL;
+
+        uintptr_t submeshes_offset = model__blob_write(&w, mesh->submeshes, 
+                                                       sizeof(rizz_model_submesh)*mesh->num_submeshes);
+        uintptr_t vbuff_offsets[SG_MAX_SHADERSTAGE_BUFFERS] = {0};
+        for (int k = 0; k < mesh->num_vbuffs; k++) {
+            if (mesh->cpu.vbuffs[k]) {
+                vbuff_offsets[k] = model__blob_write(&w, mesh->cpu.vbuffs[k], 
+                                                     model->layout.buffer_strides[k]*mesh->num_vertices);
+            }
+        }
+        int index_stride = mesh->index_type == SG_INDEXTYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+        uintptr_t ibuff_offset = model__blob_write(&w, mesh->cpu.ibuff, index_stride*mesh->num_indices);
+
+        if (baked_mesh) {
+            rizz_model_submesh* submeshes = (rizz_model_submesh*)(blob + submeshes_offset);
+            for (int k = 0; k < mesh->num_submeshes; k++) {
+                submeshes[k].mtl.id = 0;
+            }
+            baked_mesh->submeshes = (rizz_model_submesh*)submeshes_offset;
+            for (int k = 0; k < SG_MAX_SHADERSTAGE_BUFFERS; k++) {
+                baked_mesh->cpu.vbuffs[k] = (void*)vbuff_offsets[k];
+            }
+            baked_mesh->cpu.ibuff = (void*)ibuff_offset;
+            sx_memset(&baked_mesh->gpu, 0x0, sizeof(baked_mesh->gpu));
+        }
+    }
+
+    uintptr_t semantic_offsets[SG_MAX_VERTEX_ATTRIBUTES] = {0};
+    for (int i = 0; i < SG_MAX_VERTEX_ATTRIBUTES && model->layout.attrs[i].semantic; i++) {
+        const char* semantic = model->layout.attrs[i].semantic;
+        semantic_offsets[i] = model__blob_write(&w, semantic, sx_strlen(semantic) + 1);
+    }
+
+    if (blob) {
+        rizz_model* baked = (rizz_model*)(blob + model_offset);
+        *baked = *model;
+        baked->nodes = (rizz_model_node*)nodes_offset;
+        baked->meshes = (rizz_model_mesh*)meshes_offset;
+        baked->mtllib = NULL;
+        for (int i = 0; i < SG_MAX_VERTEX_ATTRIBUTES; i++) {
+            baked->layout.attrs[i].semantic = (const char*)semantic_offsets[i];
+        }
+    }
+
+    return w.offset;
+}
+
+static void model__relocate_baked(rizz_model* model)
+{
+    model__reloc(model, model->nodes);
+    model__reloc(model, model->meshes);
+    for (int i = 0; i < SG_MAX_VERTEX_ATTRIBUTES; i++) {
+        model__reloc(model, model->layout.attrs[i].semantic);
+    }
+
+    for (int i = 0; i < model->num_nodes; i++) {
+        model__reloc(model, model->nodes[i].children);
+    }
+
+    for (int i = 0; i < model->num_meshes; i++) {
+        rizz_model_mesh* mesh = &model->meshes[i];
+        model__reloc(model, mesh->submeshes);
+        for (int k = 0; k < SG_MAX_SHADERSTAGE_BUFFERS; k++) {
+            model__reloc(model, mesh->cpu.vbuffs[k]);
+        }
+        model__reloc(model, mesh->cpu.ibuff);
+    }
+}
+
+// `baked` is not relocated yet, so semantic names are resolved relative to it
+static bool model__baked_layout_equal(const rizz_model* baked, const rizz_model_geometry_layout* layout)
+{
+    const rizz_model_geometry_layout* baked_layout = &baked->layout;
+    for (int i = 0; i < SG_MAX_SHADERSTAGE_BUFFERS; i++) {
+        if (baked_layout->buffer_strides[i] != layout->buffer_strides[i]) {
+            return false;
+        }
+    }
+
+    for (int i = 0; i < SG_MAX_VERTEX_ATTRIBUTES; i++) {
+        const rizz_vertex_attr* a = &baked_layout->attrs[i];
+        const rizz_vertex_attr* b = &layout->attrs[i];
+        if ((a->semantic == NULL) != (b->semantic == NULL)) {
+            return false;
+        }
+        if (!b->semantic) {
+            break;
+        }
+
+        const char* semantic = (const char*)baked + (uintptr_t)a->semantic;
+        if (!sx_strequal(semantic, b->semantic) || a->semantic_idx != b->semantic_idx ||
+            a->offset != b->offset || a->format != b->format || a->buffer_index != b->buffer_index) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// checks that `count` elements of `elem_size` starting at `offset` are inside the data blob
+static bool model__baked_range(uintptr_t offset, size_t count, size_t elem_size, size_t data_size)
+{
+    if (offset > data_size) {
+        return false;
+    }
+    return elem_size == 0 || count <= (data_size - offset) / elem_size;
+}
+
+// checks that the string is null-terminated before `size`
+static bool model__baked_terminated(const char* str, size_t size)
+{
+    for (size_t i = 0; i < size; i++) {
+        if (str[i] == '\0') {
+            return true;
+        }
+    }
+    return false;
+}
+
+// validates the tables and every offset of the relocatable image before anything is read from them,
+// so truncated or corrupt files are rejected instead of reading out of bounds
+static bool model__validate_baked(const model__baked_header* header, size_t size)
+{
+    if (header->num_materials < 0 || header->num_textures < 0) {
+        return false;
+    }
+
+    // material and texture tables must fit between the header and the data blob
+    if (header->data_offset < sizeof(model__baked_header)) {
+        return false;
+    }
+    size_t tables_size = header->data_offset - sizeof(model__baked_header);
+    if ((size_t)header->num_materials > tables_size / sizeof(rizz_material_data)) {
+        return false;
+    }
+    tables_size -= sizeof(rizz_material_data) * (size_t)header->num_materials;
+    if ((size_t)header->num_textures > tables_size / sizeof(model__baked_texture)) {
+        return false;
+    }
+    if (header->data_offset > size || header->data_size > size - header->data_offset ||
+        header->data_size < sizeof(rizz_model)) {
+        return false;
+    }
+
+    const model__baked_texture* texs = (const model__baked_texture*)
+        ((const uint8_t*)(header + 1) + sizeof(rizz_material_data) * (size_t)header->num_materials);
+    for (int i = 0; i < header->num_textures; i++) {
+        if (!model__baked_terminated(texs[i].path, sizeof(texs[i].path))) {
+            return false;
+        }
+    }
+
+    const uint8_t* data = (const uint8_t*)header + header->data_offset;
+    const size_t data_size = header->data_size;
+    const rizz_model* model = (const rizz_model*)data;
+    if (model->num_nodes < 0 || model->num_meshes < 0 ||
+        !model__baked_range((uintptr_t)model->nodes, (size_t)model->num_nodes, sizeof(rizz_model_node), data_size) ||
+        !model__baked_range((uintptr_t)model->meshes, (size_t)model->num_meshes, sizeof(rizz_model_mesh), data_size)) {
+        return false;
+    }
+
+    for (int i = 0; i < SG_MAX_VERTEX_ATTRIBUTES; i++) {
+        uintptr_t semantic = (uintptr_t)model->layout.attrs[i].semantic;
+        if (semantic && (semantic >= data_size ||
+                         !model__baked_terminated((const char*)data + semantic, data_size - semantic))) {
+            return false;
+        }
+    }
+    for (int i = 0; i < SG_MAX_SHADERSTAGE_BUFFERS; i++) {
+        if (model->layout.buffer_strides[i] < 0) {
+            return false;
+        }
+    }
+
+    const rizz_model_node* nodes = (const rizz_model_node*)(data + (uintptr_t)model->nodes);
+    for (int i = 0; i < model->num_nodes; i++) {
+        const rizz_model_node* node = &nodes[i];
+        if (node->num_childs < 0 || node->mesh_id < -1 || node->mesh_id >= model->num_meshes ||
+            node->parent_id < -1 || node->parent_id >= model->num_nodes ||
+            !model__baked_range((uintptr_t)node->children, (size_t)node->num_childs, sizeof(int), data_size)) {
+            return false;
+        }
+        const int* children = (const int*)(data + (uintptr_t)node->children);
+        for (int k = 0; k < node->num_childs; k++) {
+            if (children[k] < 0 || children[k] >= model->num_nodes) {
+                return false;
+            }
+        }
+    }
+
+    // materials are stored one per submesh
+    int num_submeshes = 0;
+    const rizz_model_mesh* meshes = (const rizz_model_mesh*)(data + (uintptr_t)model->meshes);
+    for (int i = 0; i < model->num_meshes; i++) {
+        const rizz_model_mesh* mesh = &meshes[i];
+        if (mesh->num_submeshes < 0 || mesh->num_vertices < 0 || mesh->num_indices < 0 ||
+            mesh->num_vbuffs < 0 || mesh->num_vbuffs > SG_MAX_SHADERSTAGE_BUFFERS ||
+            (mesh->index_type != SG_INDEXTYPE_UINT16 && mesh->index_type != SG_INDEXTYPE_UINT32) ||
+            mesh->num_submeshes > header->num_materials - num_submeshes ||
+            !model__baked_range((uintptr_t)mesh->submeshes, (size_t)mesh->num_submeshes,
+                                sizeof(rizz_model_submesh), data_size)) {
+            return false;
+        }
+        num_submeshes += mesh->num_submeshes;
+
+        for (int k = 0; k < SG_MAX_SHADERSTAGE_BUFFERS; k++) {
+            uintptr_t vbuff = (uintptr_t)mesh->cpu.vbuffs[k];
+            if (vbuff && (k >= mesh->num_vbuffs ||
+                          !model__baked_range(vbuff, (size_t)mesh->num_vertices,
+                                              (size_t)model->layout.buffer_strides[k], data_size))) {
+                return false;
+            }
+        }
+
+        uintptr_t ibuff = (uintptr_t)mesh->cpu.ibuff;
+        size_t index_stride = mesh->index_type == SG_INDEXTYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+        if (!ibuff || !model__baked_range(ibuff, (size_t)mesh->num_indices, index_stride, data_size)) {
+            return false;
+        }
+        for (int k = 0; k < mesh->num_indices; k++) {
+            uint32_t index = index_stride == sizeof(uint16_t) ? 
+                (uint32_t)((const uint16_t*)(data + ibuff))[k] : ((const uint32_t*)(data + ibuff))[k];
+            if (index >= (uint32_t)mesh->num_vertices) {
+                return false;
+            }
+        }
+
+        const rizz_model_submesh* submeshes = (const rizz_model_submesh*)(data + (uintptr_t)mesh->submeshes);
+        for (int k = 0; k < mesh->num_submeshes; k++) {
+            const rizz_model_submesh* submesh = &submeshes[k];
+            if (submesh->num_lods < 0 || submesh->num_lods > RIZZ_MODEL_MAX_LODS ||
+                submesh->start_index < 0 || submesh->num_indices < 0 ||
+                submesh->num_indices > mesh->num_indices - submesh->start_index) {
+                return false;
+            }
+            for (int l = 0; l < submesh->num_lods; l++) {
+                const rizz_model_lod* lod = &submesh->lods[l];
+                if (lod->start_index < 0 || lod->num_indices < 0 ||
+                    lod->num_indices > mesh->num_indices - lod->start_index) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return num_submeshes == header->num_materials;
+}
+
+static rizz_asset_load_data model__prepare_baked(const rizz_asset_load_params* params, const sx_mem_block* mem,
+                                                 const sx_alloc* alloc, const rizz_model_geometry_layout* layout)
+{
+    const model__baked_header* header = mem->data;
+    if (mem->size < (int64_t)sizeof(model__baked_header) || header->fourcc != MODEL_BAKED_FOURCC) {
+        rizz_log_warn("model: '%s' is not a valid baked model file", params->path);
+        return (rizz_asset_load_data) { {0} };
+    }
+
+    if (header->version != MODEL_BAKED_VERSION || header->model_size != sizeof(rizz_model) ||
+        header->node_size != sizeof(rizz_model_node) || header->mesh_size != sizeof(rizz_model_mesh) ||
+        header->material_size != sizeof(rizz_material_data)) {
+        rizz_log_warn("model: '%s' is baked with an incompatible version, re-bake the model", params->path);
+        return (rizz_asset_load_data) { {0} };
+    }
+
+    if (!model__validate_baked(header, (size_t)mem->size)) {
+        rizz_log_warn("model: '%s' is truncated or corrupt", params->path);
+        return (rizz_asset_load_data) { {0} };
+    }
+
+    const uint8_t* data = (const uint8_t*)mem->data + header->data_offset;
+    if (!model__baked_layout_equal((const rizz_model*)data, layout)) {
+        rizz_log_warn("model: '%s' is baked with a different geometry layout", params->path);
+        return (rizz_asset_load_data) { {0} };
+    }
+
+    // model data and submesh materials are allocated together. data is copied in `on_load`
+    rizz_model* model = sx_malloc(alloc, header->data_size + sizeof(rizz_material)*header->num_materials);
+    if (!model) {
+        sx_out_of_memory();
+        return (rizz_asset_load_data) { {0} };
+    }
+    rizz_material* mtls = (rizz_material*)((uint8_t*)model + header->data_size);
+
+    const rizz_material_data* baked_mtls = 
+        (const rizz_material_data*)((const uint8_t*)mem->data + sizeof(model__baked_header));
+    const model__baked_texture* baked_texs = 
+        (const model__baked_texture*)(baked_mtls + header->num_materials);
+    for (int i = 0; i < header->num_materials; i++) {
+        rizz_material_data mtl = baked_mtls[i];
+        rizz_asset* textures[MODEL_MAX_MATERIAL_TEXTURES];
+        int num_textures = model__material_textures(&mtl, textures);
+        for (int k = 0; k < num_textures; k++) {
+            uint32_t tex_index = textures[k]->id;
+            if (tex_index > 0 && (int)tex_index <= header->num_textures) {
+                const model__baked_texture* tex = &baked_texs[tex_index - 1];
+                *textures[k] = the_asset->load("texture", tex->path, &tex->params, 0, NULL, 0);
+            } else {
+                textures[k]->id = 0;
+            }
+        }
+        mtls[i] = material__add(g_model.mtllib, &mtl);
+    }
+
+    return (rizz_asset_load_data) { .obj.ptr = model, .user1 = mtls };
+}
+
+static bool model__load_baked(rizz_asset_load_data* data, const sx_mem_block* mem)
+{
+    const model__baked_header* header = mem->data;
+    rizz_model* model = data->obj.ptr;
+    const rizz_material* mtls = data->user1;
+
+    sx_memcpy(model, (const uint8_t*)mem->data + header->data_offset, header->data_size);
+    model__relocate_baked(model);
+    model->mtllib = g_model.mtllib;
+
+    int mtl_index = 0;
+    for (int i = 0; i < model->num_meshes; i++) {
+        rizz_model_mesh* mesh = &model->meshes[i];
+        for (int k = 0; k < mesh->num_submeshes; k++) {
+            sx_assert(mtl_index < header->num_materials);
+            mesh->submeshes[k].mtl = mtls[mtl_index++];
+        }
+    }
+
+    return true;
+}
+
+bool model__bake(rizz_asset model_asset, const char* filepath)
+{
+    const rizz_model* model = model__get(model_asset);
+    if (model == &g_model.failed_model || model == &g_model.blank_model) {
+        rizz_log_warn("model: '%s' is not loaded, cannot bake", the_asset->path(model_asset));
+        return false;
+    }
+
+    const sx_alloc* alloc = g_model.alloc;
+    model__baked_header header = {
+        .fourcc = MODEL_BAKED_FOURCC,
+        .version = MODEL_BAKED_VERSION,
+        .model_size = sizeof(rizz_model),
+        .node_size = sizeof(rizz_model_node),
+        .mesh_size = sizeof(rizz_model_mesh),
+        .material_size = sizeof(rizz_material_data)
+    };
+
+    // materials and their unique textures
+    rizz_material_data* mtls = NULL;
+    model__baked_texture* texs = NULL;
+    rizz_asset* tex_handles = NULL;
+    for (int i = 0; i < model->num_meshes; i++) {
+        const rizz_model_mesh* mesh = &model->meshes[i];
+        for (int k = 0; k < mesh->num_submeshes; k++) {
+            rizz_material_data mtl = *material__get_data(model->mtllib, mesh->submeshes[k].mtl);
+            rizz_asset* textures[MODEL_MAX_MATERIAL_TEXTURES];
+            int num_textures = model__material_textures(&mtl, textures);
+            for (int t = 0; t < num_textures; t++) {
+                if (!textures[t]->id) {
+                    continue;
+                }
+
+                int tex_index = -1;
+                for (int ti = 0, tc = sx_array_count(tex_handles); ti < tc; ti++) {
+                    if (tex_handles[ti].id == textures[t]->id) {
+                        tex_index = ti;
+                        break;
+                    }
+                }
+                if (tex_index == -1) {
+                    const rizz_texture_load_params* tparams = the_asset->params(*textures[t]);
+                    model__baked_texture tex = { .params = tparams ? *tparams : (rizz_texture_load_params){0} };
+                    sx_strcpy(tex.path, sizeof(tex.path), the_asset->path(*textures[t]));
+                    tex_index = sx_array_count(texs);
+                    sx_array_push(alloc, texs, tex);
+                    sx_array_push(alloc, tex_handles, *textures[t]);
+                }
+                textures[t]->id = (uint32_t)tex_index + 1;
+            }
+            sx_array_push(alloc, mtls, mtl);
+        }
+    }
+
+    header.num_materials = sx_array_count(mtls);
+    header.num_textures = sx_array_count(texs);
+    header.data_offset = (uint32_t)sx_align_16(sizeof(header) + sizeof(rizz_material_data)*header.num_materials + 
+                                               sizeof(model__baked_texture)*header.num_textures);
+    header.data_size = (uint32_t)model__bake_data(NULL, model);
+
+    bool r = false;
+    uint8_t* blob = sx_calloc(alloc, header.data_size);
+    if (blob) {
+        model__bake_data(blob, model);
+
+        sx_file f;
+        if (sx_file_open(&f, filepath, SX_FILE_WRITE)) {
+            int64_t pos = sx_file_write_var(&f, header);
+            if (header.num_materials > 0) {
+                pos += sx_file_write(&f, mtls, sizeof(rizz_material_data)*header.num_materials);
+            }
+            if (header.num_textures > 0) {
+                pos += sx_file_write(&f, texs, sizeof(model__baked_texture)*header.num_textures);
+            }
+            uint8_t padding[16] = {0};
+            sx_file_write(&f, padding, (int64_t)header.data_offset - pos);
+            r = sx_file_write(&f, blob, header.data_size) == header.data_size;
+            sx_file_close(&f);
+        } 
+
+        if (!r) {
+            rizz_log_warn("model: writing baked model '%s' failed", filepath);
+        }
+        sx_free(alloc, blob);
+    } else {
+        sx_out_of_memory();
+    }
+
+    sx_array_free(alloc, mtls);
+    sx_array_free(alloc, texs);
+    sx_array_free(alloc, tex_handles);
+    return r;
+}
+
+
 static rizz_asset_load_data model__on_prepare(const rizz_asset_load_params* params, const sx_mem_block* mem)
 {
     const sx_alloc* alloc = params->alloc ? params->alloc : g_model.alloc;
@@ -700,7 +1548,9 @@ static rizz_asset_load_data model__on_prepare(const rizz_asset_load_params* para
 
             index_type = (num_vertices < UINT16_MAX) ? SG_INDEXTYPE_UINT16 : SG_INDEXTYPE_UINT32;
             int index_stride = index_type == SG_INDEXTYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
-            sx_linear_buffer_addptr(&buff, &tmp_meshes[i].cpu.ibuff, uint8_t, index_stride*num_indices, 0);
+            // reserve space for LOD indices, they are appended after the source indices (see model__optimize_mesh)
+            sx_linear_buffer_addptr(&buff, &tmp_meshes[i].cpu.ibuff, uint8_t, 
+                                    index_stride*model__max_lod_indices(num_indices, lparams), 0);
             tmp_meshes[i].index_type = index_type;
         }
 
@@ -737,6 +1587,8 @@ static rizz_asset_load_data model__on_prepare(const rizz_asset_load_params* para
         sx_memcpy(model->meshes, tmp_meshes, sizeof(rizz_model_mesh)*data->meshes_count);
 
         return (rizz_asset_load_data) { .obj.ptr = model, .user1 = data, .user2 = linalloc };
+    } else if (sx_strequalnocase(ext, ".rmdl")) {
+        return model__prepare_baked(params, mem, alloc, layout);
     }
 
     return (rizz_asset_load_data) { {0} };
@@ -751,6 +1603,7 @@ static bool model__on_load(rizz_asset_load_data* data, const rizz_asset_load_par
         &lparams->layout : &g_model.default_layout;
 
     rizz_model* model = data->obj.ptr;
+    uint64_t start_tm = sx_tm_now();
     char ext[32];
     sx_os_path_ext(ext, sizeof(ext), params->path);
     if (sx_strequalnocase(ext, ".gltf") || sx_strequalnocase(ext, ".glb")) {
@@ -777,12 +1630,31 @@ static bool model__on_load(rizz_asset_load_data* data, const rizz_asset_load_par
             }
 
             // meshes
+            const rizz_vertex_attr* pos_attr = model__find_attribute(layout, "POSITION", 0);
+            sx_aabb* mesh_bounds = sx_malloc(tmp_alloc, sizeof(sx_aabb)*(gltf->meshes_count + 1));
+            sx_assert_always(mesh_bounds);
             for (cgltf_size i = 0; i < gltf->meshes_count; i++) {
                 rizz_model_mesh* mesh = &model->meshes[i];
                 cgltf_mesh* _mesh = &gltf->meshes[i];
 
                 sx_strcpy(mesh->name, sizeof(mesh->name), _mesh->name);
                 model__setup_buffers(mesh, layout, _mesh);
+                model__optimize_mesh(mesh, layout, lparams);
+                rizz_log_debug("model: '%s', mesh: '%s' - indices: %d -> %d, acmr: %.3f -> %.3f, "
+                               "vertex bytes: %d -> %d", params->path, mesh->name, 
+                               mesh->stats.src_num_indices, mesh->stats.num_indices, 
+                               mesh->stats.src_acmr, mesh->stats.acmr, 
+                               mesh->stats.src_vertex_bytes, mesh->stats.vertex_bytes);
+
+                // bounds are calculated once per mesh, nodes that share the mesh use the same bounds
+                sx_aabb bounds = sx_aabb_empty();
+                int vertex_stride = layout->buffer_strides[pos_attr->buffer_index];
+                uint8_t* vbuff = mesh->cpu.vbuffs[pos_attr->buffer_index];
+                for (int v = 0; v < mesh->num_vertices; v++) {
+                    sx_vec3 pos = model__decode_vec3(vbuff + v*vertex_stride + pos_attr->offset, pos_attr->format);
+                    sx_aabb_add_point(&bounds, pos);
+                }
+                mesh_bounds[i] = bounds;
             }
 
             // nodes
@@ -810,53 +1682,34 @@ static bool model__on_load(rizz_asset_load_data* data, const rizz_asset_load_par
                     node->local_tx.pos = sx_vec3fv(_node->translation);
                 }
 
-                // assign mesh, find the index of the pointer. it is as same as 
-                node->mesh_id = -1;
-                for (cgltf_size mi = 0; mi < gltf->meshes_count; mi++) {
-                    if (&gltf->meshes[mi] == _node->mesh) {
-                        node->mesh_id = (int)mi;
-                        break;
-                    }
-                }
-
-                // bounds
-                sx_aabb bounds = sx_aabb_empty();
-                if (node->mesh_id != -1) {
-                    rizz_model_mesh* mesh = &model->meshes[node->mesh_id];
-                    const rizz_vertex_attr* attr = model__find_attribute(layout, "POSITION", 0);
-                    int vertex_stride = layout->buffer_strides[attr->buffer_index];
-                    uint8_t* vbuff = mesh->cpu.vbuffs[attr->buffer_index];
-                    for (int v = 0; v < mesh->num_vertices; v++) {
-                        sx_vec3 pos = *((sx_vec3*)(vbuff + v*vertex_stride + attr->offset));
-                        sx_aabb_add_point(&bounds, pos);
-                    }
-                }
-                node->bounds = bounds;
+                // mesh index is resolved from the pointer, bounds are shared between mesh instances
+                node->mesh_id = _node->mesh ? (int)(_node->mesh - gltf->meshes) : -1;
+                node->bounds = node->mesh_id != -1 ? mesh_bounds[node->mesh_id] : sx_aabb_empty();
             }
 
-            // build node hierarchy based on node names
+            // build node hierarchy, nodes are laid out in the same order as gltf nodes, so the index
+            // can be resolved directly from the pointers
             for (cgltf_size i = 0; i < gltf->nodes_count; i++) {
                 rizz_model_node* node = &model->nodes[i];
                 cgltf_node* _node = &gltf->nodes[i];
 
-                if (_node->parent) {
-                    node->parent_id = model__find_node_byname(model, _node->parent->name);
-                } else {
-                    node->parent_id = -1;
-                }
-
+                node->parent_id = _node->parent ? (int)(_node->parent - gltf->nodes) : -1;
                 node->num_childs = (int)_node->children_count;
-                if (_node->children_count > 0) {
-                    for (cgltf_size ci = 0; ci < _node->children_count; ci++) {
-                        node->children[ci] = model__find_node_byname(model, _node->children[ci]->name);
-                    }
-                } 
+                for (cgltf_size ci = 0; ci < _node->children_count; ci++) {
+                    node->children[ci] = (int)(_node->children[ci] - gltf->nodes);
+                }
             }
 
             sx_memcpy(&model->layout, layout, sizeof(rizz_model_geometry_layout));
         }  // scope
-    }   // if glb
+    } else if (sx_strequalnocase(ext, ".rmdl")) {
+        if (!model__load_baked(data, mem)) {
+            return false;
+        }
+    }
 
+    // compare the load times of baked (.rmdl) and glTF models
+    rizz_log_debug("model: '%s' loaded in %.2f ms", params->path, sx_tm_ms(sx_tm_since(start_tm)));
     return true;
 }
 
@@ -870,7 +1723,9 @@ static void model__on_finalize(rizz_asset_load_data* data, const rizz_asset_load
     char basename[64];
     model__setup_gpu_buffers(model, lparams->vbuff_usage, lparams->ibuff_usage, 
                              sx_os_path_basename(basename, sizeof(basename), params->path));
-    sx_linalloc_growable_destroy((sx_linalloc_growable*)data->user2);    // free parse_buffer (see on_prepare for allocation)
+    if (data->user2) {
+        sx_linalloc_growable_destroy((sx_linalloc_growable*)data->user2);    // free parse_buffer (see on_prepare for allocation)
+    }
 }
 
 static void model__on_reload(rizz_asset handle, rizz_asset_obj prev_obj, const sx_alloc* alloc)
@@ -988,6 +1843,8 @@ bool model__init(rizz_api_core* core, rizz_api_asset* asset, rizz_api_gfx* gfx,
             mesh->submeshes[0].start_index = 0;
             mesh->submeshes[0].num_indices = geo.num_indices;
             mesh->submeshes[0].mtl.id = 0;
+            mesh->submeshes[0].num_lods = 1;
+            mesh->submeshes[0].lods[0] = (rizz_model_lod) { .start_index = 0, .num_indices = geo.num_indices };
         } else {
             return false;
         }
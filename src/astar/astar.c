@@ -1,7 +1,10 @@
 #include "rizz/astar.h"
 
+#include "sx/allocator.h"
 #include "sx/array.h"
 #include "sx/bheap.h"
+#include "sx/handle.h"
+#include "sx/hash.h"
 #include "sx/string.h"
 #include "sx/math-vec.h"
 
@@ -9,6 +12,11 @@
 #define ASTAR_DIAGONAL_COST 14
 #define ASTAR_CHANGE_DIR_COST 10
 
+// flow-fields are built in square tiles of cells, each tile is solved by a job
+#define ASTAR_FLOWFIELD_TILE_SIZE 16
+#define ASTAR_FLOWFIELD_INF INT32_MAX
+#define ASTAR_FLOWFIELD_NODIR 0xff
+
 RIZZ_STATE static uint32_t g_maxsearch = 10000;
 static int k_dirs[8][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 },  { -1, 0 },
                             { 1, -1 }, { 1, 1 }, { -1, 1 }, { -1, -1 } };
@@ -16,6 +24,30 @@ static int k_dirs[8][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 },  { -1, 0 },
 RIZZ_STATE static rizz_api_core* the_core;
 RIZZ_STATE static rizz_api_plugin* the_plugin;
 
+typedef struct {
+    const rizz_astar_world* world;
+    rizz_astar_agent agent;
+    uint32_t agent_hash;
+    int refcount;
+    int goal_x, goal_y;
+    int width, height;
+    int tiles_x, tiles_y;
+    uint8_t* costs;          // per-cell costs for the agent, used to detect changes on invalidate
+    int32_t* integration;    // integrated cost to goal, ASTAR_FLOWFIELD_INF if unreachable
+    uint8_t* dirs;           // index to k_dirs, ASTAR_FLOWFIELD_NODIR if there is no direction
+    uint8_t* tile_active;
+    uint8_t* tile_changed;
+    bool dirty;
+} astar__flowfield;
+
+typedef struct {
+    sx_alloc* alloc;
+    sx_handle_pool* flowfield_handles;
+    astar__flowfield* flowfields;    // sx_array
+} astar__context;
+
+RIZZ_STATE static astar__context g_astar;
+
 typedef union {
     int32_t id;
     struct {
@@ -191,20 +223,444 @@ static bool astar__findpath(const rizz_astar_world* world, const rizz_astar_agen
     return ret == 0;
 }
 
+typedef struct {
+    astar__flowfield* ff;
+    int* tiles;    // tile indexes to solve in this pass
+} astar__flowfield_job_data;
+
+// Solves one tile with dijkstra, seeded by current values of the tile and it's surrounding cells
+// tiles that are solved in the same pass never touch each other, so reading neighbour tiles is safe
+static void astar__flowfield_solve_tile_cb(int start, int end, int thrd_index, void* user)
+{
+    sx_unused(thrd_index);
+
+    astar__flowfield_job_data* data = user;
+    astar__flowfield* ff = data->ff;
+    const int width = ff->width;
+    const int height = ff->height;
+    const int max_tile_cells = ASTAR_FLOWFIELD_TILE_SIZE * ASTAR_FLOWFIELD_TILE_SIZE;
+
+    const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
+    sx_scope(the_core->tmp_alloc_pop()) {
+        // every relaxation can push an item, each cell is closed only once
+        sx_bheap* heap = sx_bheap_create(tmp_alloc, max_tile_cells * 9);
+        if (!heap) {
+            sx_out_of_memory();
+        }
+
+        for (int t = start; t < end && heap; t++) {
+            int tile = data->tiles[t];
+            int x0 = (tile % ff->tiles_x) * ASTAR_FLOWFIELD_TILE_SIZE;
+            int y0 = (tile / ff->tiles_x) * ASTAR_FLOWFIELD_TILE_SIZE;
+            int x1 = sx_min(x0 + ASTAR_FLOWFIELD_TILE_SIZE, width);
+            int y1 = sx_min(y0 + ASTAR_FLOWFIELD_TILE_SIZE, height);
+            bool changed = false;
+
+            sx_bheap_clear(heap);
+
+            // seed: pull values from neighbour cells outside of the tile
+            for (int y = y0; y < y1; y++) {
+                for (int x = x0; x < x1; x++) {
+                    int idx = x + y * width;
+                    int32_t cost = ff->costs[idx];
+                    if (cost == 0) {
+                        continue;
+                    }
+
+                    int32_t best = ff->integration[idx];
+                    if (x == x0 || y == y0 || x == x1 - 1 || y == y1 - 1) {
+                        for (int i = 0; i < 8; i++) {
+                            int nx = x + k_dirs[i][0];
+                            int ny = y + k_dirs[i][1];
+                            if (nx < 0 || ny < 0 || nx >= width || ny >= height) {
+                                continue;
+                            }
+                            if (nx >= x0 && nx < x1 && ny >= y0 && ny < y1) {
+                                continue;
+                            }
+
+                            int32_t nval = ff->integration[nx + ny * width];
+                            if (nval != ASTAR_FLOWFIELD_INF) {
+                                int32_t v = nval + cost * (i > 3 ? ASTAR_DIAGONAL_COST : ASTAR_DEFAULT_COST);
+                                best = sx_min(best, v);
+                            }
+                        }
+                    }
+
+                    if (best != ASTAR_FLOWFIELD_INF) {
+                        if (best < ff->integration[idx]) {
+                            ff->integration[idx] = best;
+                            changed = true;
+                        }
+                        sx_bheap_push_min(heap, best, (void*)(uintptr_t)idx);
+                    }
+                }
+            }
+
+            // propagate inside the tile
+            while (!sx_bheap_empty(heap)) {
+                sx_bheap_item item = sx_bheap_pop_min(heap);
+                int idx = (int)(uintptr_t)item.user;
+                if (item.key > ff->integration[idx]) {
+                    continue;    // stale item
+                }
+
+                int x = idx % width;
+                int y = idx / width;
+                for (int i = 0; i < 8; i++) {
+                    int nx = x + k_dirs[i][0];
+                    int ny = y + k_dirs[i][1];
+                    if (nx < x0 || ny < y0 || nx >= x1 || ny >= y1) {
+                        continue;
+                    }
+
+                    int nidx = nx + ny * width;
+                    int32_t cost = ff->costs[nidx];
+                    if (cost == 0) {
+                        continue;
+                    }
+
+                    int32_t v = item.key + cost * (i > 3 ? ASTAR_DIAGONAL_COST : ASTAR_DEFAULT_COST);
+                    if (v < ff->integration[nidx]) {
+                        ff->integration[nidx] = v;
+                        sx_bheap_push_min(heap, v, (void*)(uintptr_t)nidx);
+                        changed = true;
+                    }
+                }
+            }
+
+            ff->tile_changed[tile] = changed ? 1 : 0;
+        }
+    }
+}
+
+static void astar__flowfield_dirs_cb(int start, int end, int thrd_index, void* user)
+{
+    sx_unused(thrd_index);
+
+    astar__flowfield* ff = user;
+    const int width = ff->width;
+    const int height = ff->height;
+
+    for (int y = start; y < end; y++) {
+        for (int x = 0; x < width; x++) {
+            int idx = x + y * width;
+            int32_t best = ff->integration[idx];
+            uint8_t dir = ASTAR_FLOWFIELD_NODIR;
+            if (best != ASTAR_FLOWFIELD_INF) {
+                for (int i = 0; i < 8; i++) {
+                    int nx = x + k_dirs[i][0];
+                    int ny = y + k_dirs[i][1];
+                    if (nx < 0 || ny < 0 || nx >= width || ny >= height) {
+                        continue;
+                    }
+
+                    int32_t nval = ff->integration[nx + ny * width];
+                    if (nval < best) {
+                        best = nval;
+                        dir = (uint8_t)i;
+                    }
+                }
+            }
+            ff->dirs[idx] = dir;
+        }
+    }
+}
+
+static void astar__flowfield_build(astar__flowfield* ff)
+{
+    rizz_profile(astar_flowfield_build) {
+        const int num_cells = ff->width * ff->height;
+        const int num_tiles = ff->tiles_x * ff->tiles_y;
+
+        for (int i = 0; i < num_cells; i++) {
+            ff->integration[i] = ASTAR_FLOWFIELD_INF;
+        }
+        sx_memset(ff->tile_active, 0x0, num_tiles);
+        ff->integration[ff->goal_x + ff->goal_y * ff->width] = 0;
+        ff->tile_active[(ff->goal_x / ASTAR_FLOWFIELD_TILE_SIZE) +
+                        (ff->goal_y / ASTAR_FLOWFIELD_TILE_SIZE) * ff->tiles_x] = 1;
+
+        const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
+        sx_scope(the_core->tmp_alloc_pop()) {
+            astar__flowfield_job_data data = {
+                .ff = ff,
+                .tiles = sx_malloc(tmp_alloc, sizeof(int) * num_tiles),
+            };
+            if (!data.tiles) {
+                sx_out_of_memory();
+            }
+
+            // label-correcting over tiles: keep solving active tiles until nothing changes
+            // tiles are grouped by odd/even coordinates into 4 passes, so no two tiles of the same
+            // pass are adjacent and jobs don't write to the cells that are read by other jobs
+            bool active = data.tiles != NULL;
+            while (active) {
+                active = false;
+                for (int pass = 0; pass < 4; pass++) {
+                    int num_pass_tiles = 0;
+                    for (int ty = (pass >> 1); ty < ff->tiles_y; ty += 2) {
+                        for (int tx = (pass & 1); tx < ff->tiles_x; tx += 2) {
+                            int tile = tx + ty * ff->tiles_x;
+                            if (ff->tile_active[tile]) {
+                                ff->tile_active[tile] = 0;
+                                data.tiles[num_pass_tiles++] = tile;
+                            }
+                        }
+                    }
+
+                    if (num_pass_tiles == 0) {
+                        continue;
+                    }
+
+                    sx_job_t job = the_core->job_dispatch(num_pass_tiles, astar__flowfield_solve_tile_cb,
+                                                          &data, SX_JOB_PRIORITY_HIGH, 0);
+                    the_core->job_wait_and_del(job);
+
+                    for (int i = 0; i < num_pass_tiles; i++) {
+                        int tile = data.tiles[i];
+                        if (!ff->tile_changed[tile]) {
+                            continue;
+                        }
+
+                        int tx = tile % ff->tiles_x;
+                        int ty = tile / ff->tiles_x;
+                        for (int k = 0; k < 8; k++) {
+                            int ntx = tx + k_dirs[k][0];
+                            int nty = ty + k_dirs[k][1];
+                            if (ntx >= 0 && nty >= 0 && ntx < ff->tiles_x && nty < ff->tiles_y) {
+                                ff->tile_active[ntx + nty * ff->tiles_x] = 1;
+                                active = true;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        sx_job_t job = the_core->job_dispatch(ff->height, astar__flowfield_dirs_cb, ff,
+                                              SX_JOB_PRIORITY_HIGH, 0);
+        the_core->job_wait_and_del(job);
+
+        ff->dirty = false;
+    }
+}
+
+static inline uint32_t astar__agent_hash(const rizz_astar_agent* agent)
+{
+    return sx_hash_fnv32(agent->costs, sizeof(agent->costs));
+}
+
+static rizz_astar_flowfield astar__flowfield_get(const rizz_astar_world* world,
+                                                 const rizz_astar_agent* agent, sx_vec2 goal)
+{
+    sx_assert(world->width > 0 && world->height > 0);
+
+    loc gloc;
+    gridcoord(world, goal, &gloc);
+    uint32_t agent_hash = astar__agent_hash(agent);
+
+    // search the cache
+    for (int i = 0, c = g_astar.flowfield_handles->count; i < c; i++) {
+        sx_handle_t handle = sx_handle_at(g_astar.flowfield_handles, i);
+        astar__flowfield* ff = &g_astar.flowfields[sx_handle_index(handle)];
+        if (ff->world == world && ff->goal_x == gloc.x && ff->goal_y == gloc.y &&
+            ff->agent_hash == agent_hash && ff->width == world->width &&
+            ff->height == world->height &&
+            sx_memcmp(ff->agent.costs, agent->costs, sizeof(agent->costs)) == 0) {
+            ++ff->refcount;
+            if (ff->dirty) {
+                astar__flowfield_build(ff);
+            }
+            return (rizz_astar_flowfield){ handle };
+        }
+    }
+
+    const int num_cells = world->width * world->height;
+    const int tiles_x = (world->width + ASTAR_FLOWFIELD_TILE_SIZE - 1) / ASTAR_FLOWFIELD_TILE_SIZE;
+    const int tiles_y = (world->height + ASTAR_FLOWFIELD_TILE_SIZE - 1) / ASTAR_FLOWFIELD_TILE_SIZE;
+    const int num_tiles = tiles_x * tiles_y;
+
+    // allocate everything in one block
+    size_t total_sz = sizeof(int32_t) * num_cells + num_cells * 2 + num_tiles * 2;
+    uint8_t* buff = sx_malloc(g_astar.alloc, total_sz);
+    if (!buff) {
+        sx_out_of_memory();
+        return (rizz_astar_flowfield){ 0 };
+    }
+
+    astar__flowfield ff = {
+        .world = world,
+        .agent = *agent,
+        .agent_hash = agent_hash,
+        .refcount = 1,
+        .goal_x = gloc.x,
+        .goal_y = gloc.y,
+        .width = world->width,
+        .height = world->height,
+        .tiles_x = tiles_x,
+        .tiles_y = tiles_y,
+    };
+    ff.integration = (int32_t*)buff;
+    buff += sizeof(int32_t) * num_cells;
+    ff.costs = buff;
+    buff += num_cells;
+    ff.dirs = buff;
+    buff += num_cells;
+    ff.tile_active = buff;
+    buff += num_tiles;
+    ff.tile_changed = buff;
+
+    for (int i = 0; i < num_cells; i++) {
+        ff.costs[i] = agent->costs[world->cells[i]];
+    }
+
+    sx_handle_t handle = sx_handle_new_and_grow(g_astar.flowfield_handles, g_astar.alloc);
+    sx_assert(handle);
+    sx_array_push_byindex(g_astar.alloc, g_astar.flowfields, ff, sx_handle_index(handle));
+
+    astar__flowfield_build(&g_astar.flowfields[sx_handle_index(handle)]);
+    return (rizz_astar_flowfield){ handle };
+}
+
+static void astar__flowfield_destroy(astar__flowfield* ff)
+{
+    // costs, dirs and tile arrays are allocated in the same block as integration
+    sx_free(g_astar.alloc, ff->integration);
+    sx_memset(ff, 0x0, sizeof(*ff));
+}
+
+static void astar__flowfield_release(rizz_astar_flowfield field)
+{
+    if (!field.id) {
+        return;
+    }
+
+    sx_assert_always(sx_handle_valid(g_astar.flowfield_handles, field.id));
+    astar__flowfield* ff = &g_astar.flowfields[sx_handle_index(field.id)];
+    sx_assert(ff->refcount > 0);
+    if (--ff->refcount == 0) {
+        astar__flowfield_destroy(ff);
+        sx_handle_del(g_astar.flowfield_handles, field.id);
+    }
+}
+
+static sx_vec2 astar__flowfield_dir(rizz_astar_flowfield field, sx_vec2 pos)
+{
+    sx_assert_always(sx_handle_valid(g_astar.flowfield_handles, field.id));
+    const astar__flowfield* ff = &g_astar.flowfields[sx_handle_index(field.id)];
+
+    loc l;
+    gridcoord(ff->world, pos, &l);
+    uint8_t dir = ff->dirs[l.x + l.y * ff->width];
+    if (dir == ASTAR_FLOWFIELD_NODIR) {
+        return SX_VEC2_ZERO;
+    }
+    return sx_vec2_norm(sx_vec2f((float)k_dirs[dir][0], (float)k_dirs[dir][1]));
+}
+
+static int astar__flowfield_cost(rizz_astar_flowfield field, sx_vec2 pos)
+{
+    sx_assert_always(sx_handle_valid(g_astar.flowfield_handles, field.id));
+    const astar__flowfield* ff = &g_astar.flowfields[sx_handle_index(field.id)];
+
+    loc l;
+    gridcoord(ff->world, pos, &l);
+    int32_t value = ff->integration[l.x + l.y * ff->width];
+    return value != ASTAR_FLOWFIELD_INF ? (int)value : -1;
+}
+
+static void astar__invalidate_cells(const rizz_astar_world* world, int x, int y, int width,
+                                    int height)
+{
+    int xmin = sx_max(x, 0);
+    int ymin = sx_max(y, 0);
+    int xmax = sx_min(x + width, (int)world->width);
+    int ymax = sx_min(y + height, (int)world->height);
+
+    for (int i = 0, c = g_astar.flowfield_handles->count; i < c; i++) {
+        sx_handle_t handle = sx_handle_at(g_astar.flowfield_handles, i);
+        astar__flowfield* ff = &g_astar.flowfields[sx_handle_index(handle)];
+        if (ff->world != world) {
+            continue;
+        }
+
+        // only rebuild fields that the change actually affects with their agent costs
+        for (int yy = ymin; yy < ymax; yy++) {
+            for (int xx = xmin; xx < xmax; xx++) {
+                int idx = xx + yy * ff->width;
+                uint8_t cost = ff->agent.costs[world->cells[idx]];
+                if (ff->costs[idx] != cost) {
+                    ff->costs[idx] = cost;
+                    ff->dirty = true;
+                }
+            }
+        }
+    }
+}
+
+static void astar__update(void)
+{
+    for (int i = 0, c = g_astar.flowfield_handles->count; i < c; i++) {
+        astar__flowfield* ff =
+            &g_astar.flowfields[sx_handle_index(sx_handle_at(g_astar.flowfield_handles, i))];
+        if (ff->dirty) {
+            astar__flowfield_build(ff);
+        }
+    }
+}
+
+static bool astar__init(void)
+{
+    g_astar.alloc = the_core->trace_alloc_create("Astar", RIZZ_MEMOPTION_INHERIT, NULL, the_core->heap_alloc());
+    g_astar.flowfield_handles = sx_handle_create_pool(g_astar.alloc, 32);
+    if (!g_astar.flowfield_handles) {
+        sx_out_of_memory();
+        return false;
+    }
+    return true;
+}
+
+static void astar__release(void)
+{
+    if (!g_astar.alloc) {
+        return;
+    }
+
+    if (g_astar.flowfield_handles) {
+        for (int i = 0, c = g_astar.flowfield_handles->count; i < c; i++) {
+            sx_handle_t handle = sx_handle_at(g_astar.flowfield_handles, i);
+            astar__flowfield_destroy(&g_astar.flowfields[sx_handle_index(handle)]);
+        }
+        sx_handle_destroy_pool(g_astar.flowfield_handles, g_astar.alloc);
+    }
+    sx_array_free(g_astar.alloc, g_astar.flowfields);
+    the_core->trace_alloc_destroy(g_astar.alloc);
+}
+
 static rizz_api_astar the__astar = {
     .set_maxsearch = astar__set_maxsearch,
     .findpath = astar__findpath,
+    .flowfield_get = astar__flowfield_get,
+    .flowfield_release = astar__flowfield_release,
+    .flowfield_dir = astar__flowfield_dir,
+    .flowfield_cost = astar__flowfield_cost,
+    .invalidate_cells = astar__invalidate_cells,
 };
 
 rizz_plugin_decl_main(astar, plugin, e)
 {
     switch (e) {
     case RIZZ_PLUGIN_EVENT_STEP:
+        astar__update();
         break;
     case RIZZ_PLUGIN_EVENT_INIT:
         the_plugin = plugin->api;
         the_core = the_plugin->get_api(RIZZ_API_CORE, 0);
 
+        if (!astar__init()) {
+            return -1;
+        }
         the_plugin->inject_api("astar", 0, &the__astar);
         break;
     case RIZZ_PLUGIN_EVENT_LOAD:
@@ -214,6 +670,7 @@ rizz_plugin_decl_main(astar, plugin, e)
         break;
     case RIZZ_PLUGIN_EVENT_SHUTDOWN:
         the_plugin->remove_api("astar", 0);
+        astar__release();
         break;
     }
 
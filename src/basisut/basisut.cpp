@@ -2,6 +2,7 @@
 
 #include "sx/string.h"
 #include "sx/os.h"
+#include "sx/timer.h"
 
 SX_PRAGMA_DIAGNOSTIC_PUSH()
 SX_PRAGMA_DIAGNOSTIC_IGNORED_CLANG_GCC("-Wunused-parameter")
@@ -9,6 +10,8 @@ SX_PRAGMA_DIAGNOSTIC_IGNORED_CLANG_GCC("-Wunused-parameter")
 SX_PRAGMA_DIAGNOSTIC_POP();
 
 #define CHECKER_TEXTURE_SIZE        128
+// textures with less output than this are transcoded on the loading thread, not worth the jobs
+#define MIN_JOB_TRANSCODE_SIZE      (256*1024)
 
 RIZZ_STATE static rizz_api_core* the_core;
 RIZZ_STATE static rizz_api_gfx* the_gfx;
@@ -22,9 +25,25 @@ static rizz_texture g_texture_blank;
 
 typedef struct basisut_transcode_data {
     basist::transcoder_texture_format fmt;
-    int mip_size[SG_MAX_MIPMAPS];
+    int first_mip;
+    int num_mips;
+    int num_images;
+    int total_size;
+    int mip_size[SG_MAX_MIPMAPS];      // size of one image (slice/face) for each level
+    int mip_offset[SG_MAX_MIPMAPS];    // offset of each level in output buffer, images of a level are contiguous
 } basisut_transcode_data;
 
+// shared by transcode jobs, each job item is one (image, level) pair of the output texture
+typedef struct basisut_transcode_job_data {
+    const basist::basisu_transcoder* transcoder;
+    basist::basisu_transcoder_state* states;    // one per thread, transcoder state is not thread-safe
+    const basisut_transcode_data* tdata;
+    uint8_t* buff;
+    const sx_mem_block* mem;
+    int bytes_per_block;
+    bool failed;
+} basisut_transcode_job_data;
+
 static rizz_asset_load_data basisut_on_prepare(const rizz_asset_load_params* params, const sx_mem_block* mem);
 static bool basisut_on_load(rizz_asset_load_data* data, const rizz_asset_load_params* params, const sx_mem_block* mem);
 static void basisut_on_finalize(rizz_asset_load_data* data, const rizz_asset_load_params* params, const sx_mem_block* mem);
@@ -147,16 +166,13 @@ static void* basisut_start_transcoding(void* memptr, const void* data, uint32_t
     }
 }
 
-static bool basisut_transcode_image_level(void* _trans, const void* data, uint32_t data_size,
-                                          uint32_t image_index, uint32_t level_index, void* pOutput_blocks,
-                                          uint32_t output_blocks_buf_size_in_blocks_or_pixels,
-                                          basist::transcoder_texture_format fmt, uint32_t decode_flags)
+static int basisut_first_mip(const rizz_texture_load_params* tparams, int num_mips)
 {
-    basist::basisu_transcoder* transcoder = reinterpret_cast<basist::basisu_transcoder*>(_trans);
-    return transcoder->transcode_image_level(data, data_size, image_index, level_index,
-                                             pOutput_blocks,
-                                             output_blocks_buf_size_in_blocks_or_pixels,
-                                             fmt, decode_flags);
+    int default_first_mip, default_aniso;
+    sg_filter default_min_filter, default_mag_filter;
+    the_gfx->texture_default_quality(&default_min_filter, &default_mag_filter, &default_aniso, &default_first_mip);
+    int first_mip = tparams->first_mip ? tparams->first_mip : default_first_mip;
+    return sx_min(first_mip, num_mips - 1);
 }
 
 static rizz_asset_load_data basisut_on_prepare(const rizz_asset_load_params* params, const sx_mem_block* mem)
@@ -208,33 +224,26 @@ static rizz_asset_load_data basisut_on_prepare(const rizz_asset_load_params* par
     }
 
     tex->info.format = tparams->fmt;
-    int w = tex->info.width;
-    int h = tex->info.height;
-    int num_mips = tex->info.mips;
-    int num_images = tex->info.layers;
-
-    size_t total_sz = sizeof(sg_image_desc) + sizeof(basist::basisu_transcoder) + sizeof(basisut_transcode_data);
-    int mip_size[SG_MAX_MIPMAPS];
-
-    // calculate the buffer sizes needed for holding all the output pixels
-    sx_assert(num_mips < SG_MAX_MIPMAPS);
-
-    for (int i = 0; i < num_images; i++) {
-        for (int mip = 0; mip < num_mips; mip++) {
-            if (mip >= tparams->first_mip) {
-                int image_sz = the_gfx->texture_surface_pitch(tparams->fmt, w, h, 1);
-                mip_size[mip - tparams->first_mip] = image_sz;
-                total_sz += image_sz;
-            }
-
-            w >>= 1;
-            h >>= 1;
-            if (w == 0 || h == 0) {
-                break;
-            }
-        }
+    int first_mip = basisut_first_mip(tparams, tex->info.mips);
+    int num_mips = tex->info.mips - first_mip;
+    int num_images = tex->info.type == SG_IMAGETYPE_2D ? 1 : tex->info.layers;
+
+    // calculate the buffer sizes needed for holding all the output pixels, each mip level has the
+    // same size in all images
+    sx_assert(tex->info.mips <= SG_MAX_MIPMAPS);
+    int mip_size[SG_MAX_MIPMAPS] = { 0 };
+    int mip_offset[SG_MAX_MIPMAPS] = { 0 };
+    int images_size = 0;
+    for (int mip = first_mip; mip < tex->info.mips; mip++) {
+        int w = sx_max(tex->info.width >> mip, 1);
+        int h = sx_max(tex->info.height >> mip, 1);
+        mip_size[mip - first_mip] = the_gfx->texture_surface_pitch(tparams->fmt, w, h, 1);
+        mip_offset[mip - first_mip] = images_size;
+        images_size += mip_size[mip - first_mip] * num_images;
     }
 
+    size_t total_sz = sizeof(sg_image_desc) + sizeof(basist::basisu_transcoder) +
+                      sizeof(basisut_transcode_data) + (size_t)images_size;
     uint8_t* buff = (uint8_t*)sx_malloc(g_basisut_alloc, total_sz);
     if (!buff) {
         sx_out_of_memory();
@@ -245,7 +254,12 @@ static rizz_asset_load_data basisut_on_prepare(const rizz_asset_load_params* par
     buff += sizeof(sg_image_desc) + sizeof(basist::basisu_transcoder);
     basisut_transcode_data* transcode_data = (basisut_transcode_data*)buff;
     transcode_data->fmt = basis_fmt;
+    transcode_data->first_mip = first_mip;
+    transcode_data->num_mips = num_mips;
+    transcode_data->num_images = num_images;
+    transcode_data->total_size = images_size;
     sx_memcpy(transcode_data->mip_size, mip_size, sizeof(mip_size));
+    sx_memcpy(transcode_data->mip_offset, mip_offset, sizeof(mip_offset));
 
     tex->img = the_gfx->alloc_image();
     sx_assert(tex->img.id);
@@ -257,20 +271,43 @@ static rizz_asset_load_data basisut_on_prepare(const rizz_asset_load_params* par
     return ldata;
 }
 
+// items are ordered by level, so the big levels of all images are picked up by the first jobs
+static void basisut_transcode_job_cb(int start, int end, int thrd_index, void* user)
+{
+    auto jdata = (basisut_transcode_job_data*)user;
+    const basisut_transcode_data* tdata = jdata->tdata;
+    basist::basisu_transcoder_state* state = &jdata->states[thrd_index];
+
+    for (int i = start; i < end; i++) {
+        int image = i % tdata->num_images;
+        int mip = i / tdata->num_images;
+        int mip_size = tdata->mip_size[mip];
+        uint8_t* dst = jdata->buff + tdata->mip_offset[mip] + image * mip_size;
+
+        bool r = jdata->transcoder->transcode_image_level(
+            jdata->mem->data, (uint32_t)jdata->mem->size, (uint32_t)image,
+            (uint32_t)(tdata->first_mip + mip), dst, (uint32_t)(mip_size / jdata->bytes_per_block),
+            tdata->fmt, 0, 0, state);
+        if (!r) {
+            jdata->failed = true;
+        }
+    }
+}
+
 static bool basisut_on_load(rizz_asset_load_data* data, const rizz_asset_load_params* params, const sx_mem_block* mem)
 {
     auto tparams = (const rizz_texture_load_params*)params->params;
     auto tex = (rizz_texture*)data->obj.ptr;
     auto desc = (sg_image_desc*)data->user1;
+    auto transcode_data = (const basisut_transcode_data*)((uint8_t*)(desc + 1) + sizeof(basist::basisu_transcoder));
 
     int default_first_mip, default_aniso;
     sg_filter default_min_filter, default_mag_filter;
     the_gfx->texture_default_quality(&default_min_filter, &default_mag_filter, &default_aniso, &default_first_mip);
-    int first_mip = tparams->first_mip ? tparams->first_mip :  default_first_mip;
-    if (first_mip >= tex->info.mips) {
-        first_mip = tex->info.mips - 1;
-    }
-    int num_mips = tex->info.mips - first_mip;
+
+    // mips are decided in on_prepare, output buffers are already allocated for them
+    int first_mip = transcode_data->first_mip;
+    int num_mips = transcode_data->num_mips;
 
     {   // fix width/height/mips of the texture
         int w = tex->info.width;
@@ -343,31 +380,75 @@ static bool basisut_on_load(rizz_asset_load_data* data, const rizz_asset_load_pa
     if (tparams->fmt != _SG_PIXELFORMAT_DEFAULT) {
         auto transcoder_obj_buffer = (uint8_t*)(desc + 1);
         void* trans = basisut_start_transcoding(transcoder_obj_buffer, mem->data, (uint32_t)mem->size);
-        sx_assert(trans);
+        if (!trans) {
+            rizz_log_warn("transcoding texture '%s' failed", params->path);
+            return false;
+        }
 
-        // we have extra buffers for this particular type of file
-        auto transcode_data = (basisut_transcode_data*)(transcoder_obj_buffer + sizeof(basist::basisu_transcoder));
+        // output buffer follows the transcode data, jobs write directly to the subimages
+        // cubemaps have a subimage per face, array and 3d textures have all slices in one subimage
         auto transcode_buff = (uint8_t*)(transcode_data + 1);
+        for (int mip = 0; mip < num_mips; mip++) {
+            uint8_t* level_buff = transcode_buff + transcode_data->mip_offset[mip];
+            int mip_size = transcode_data->mip_size[mip];
+            if (tex->info.type == SG_IMAGETYPE_CUBE) {
+                for (int i = 0; i < transcode_data->num_images; i++) {
+                    desc->content.subimage[i][mip].ptr = level_buff + i * mip_size;
+                    desc->content.subimage[i][mip].size = mip_size;
+                }
+            } else {
+                desc->content.subimage[0][mip].ptr = level_buff;
+                desc->content.subimage[0][mip].size = mip_size * transcode_data->num_images;
+            }
+        }
 
-        int num_images = tex->info.type == SG_IMAGETYPE_2D ? 1 : tex->info.layers;
-        int bytes_per_block = basist::basis_transcoder_format_is_uncompressed(transcode_data->fmt) ? 
-                basist::basis_get_uncompressed_bytes_per_pixel(transcode_data->fmt) : 
+        basisut_transcode_job_data jdata;
+        jdata.transcoder = (const basist::basisu_transcoder*)trans;
+        jdata.tdata = transcode_data;
+        jdata.buff = transcode_buff;
+        jdata.mem = mem;
+        jdata.bytes_per_block = basist::basis_transcoder_format_is_uncompressed(transcode_data->fmt) ? 
+                (int)basist::basis_get_uncompressed_bytes_per_pixel(transcode_data->fmt) : 
                 (int)basist::basis_get_bytes_per_block(transcode_data->fmt);
+        jdata.failed = false;
+
+        uint64_t start_tm = sx_tm_now();
+        int num_items = transcode_data->num_images * num_mips;
+        bool use_jobs = num_items > 1 && transcode_data->total_size >= MIN_JOB_TRANSCODE_SIZE;
+        int num_states = use_jobs ? (the_core->job_num_threads() + 1) : 1;
+        jdata.states = (basist::basisu_transcoder_state*)
+            sx_malloc(g_basisut_alloc, sizeof(basist::basisu_transcoder_state) * num_states);
+        if (!jdata.states) {
+            sx_out_of_memory();
+            return false;
+        }
+        for (int i = 0; i < num_states; i++) {
+            new (&jdata.states[i]) basist::basisu_transcoder_state();
+        }
 
-        for (int i = 0; i < num_images; i++) {
-            for (int mip = first_mip; mip < num_mips; mip++) {
-                int dst_mip = mip - first_mip;
-                int mip_size = transcode_data->mip_size[dst_mip];
-                bool r = basisut_transcode_image_level(
-                    trans, mem->data, (uint32_t)mem->size, 0, mip, transcode_buff,
-                    mip_size / bytes_per_block, transcode_data->fmt, 0);
-                sx_unused(r);
-                sx_assertf(r, "basis transcode failed");
-                desc->content.subimage[i][dst_mip].ptr = transcode_buff;
-                desc->content.subimage[i][dst_mip].size = mip_size;
-                transcode_buff += mip_size;
-            }
+        if (use_jobs) {
+            sx_job_t job = the_core->job_dispatch(num_items, basisut_transcode_job_cb, &jdata,
+                                                  SX_JOB_PRIORITY_HIGH, 0);
+            the_core->job_wait_and_del(job);
+        } else {
+            basisut_transcode_job_cb(0, num_items, 0, &jdata);
+        }
+
+        for (int i = 0; i < num_states; i++) {
+            jdata.states[i].~basisu_transcoder_state();
+        }
+        sx_free(g_basisut_alloc, jdata.states);
+        jdata.transcoder->~basisu_transcoder();
+
+        if (jdata.failed) {
+            rizz_log_warn("transcoding texture '%s' failed", params->path);
+            return false;
         }
+
+        double elapsed_ms = sx_tm_ms(sx_tm_since(start_tm));
+        rizz_log_debug("basisu: transcoded '%s' (%d images, %d mips) in %.2f ms (%.1f MB/s)",
+                       params->path, transcode_data->num_images, num_mips, elapsed_ms,
+                       elapsed_ms > 0 ? ((double)mem->size / (1024.0 * 1024.0)) / (elapsed_ms * 0.001) : 0);
     } else {
         rizz_log_warn("parsing texture '%s' failed", params->path);
         return false;
@@ -0,0 +1,1977 @@
+#include "rizz/2dtools.h"
+#include "rizz/3dtools.h"
+#include "rizz/rizz.h"
+#include "rizz/sound.h"
+
+#include "sx/allocator.h"
+#include "sx/array.h"
+#include "sx/atomic.h"
+#include "sx/handle.h"
+#include "sx/hash.h"
+#include "sx/io.h"
+#include "sx/lockless.h"
+#include "sx/math-vec.h"
+#include "sx/os.h"
+#include "sx/rng.h"
+#include "sx/string.h"
+#include "sx/threads.h"
+#include "sx/timer.h"
+#include "sx/vmem.h"
+
+RIZZ_STATE static rizz_api_core* the_core;
+RIZZ_STATE static rizz_api_plugin* the_plugin;
+RIZZ_STATE static rizz_api_app* the_app;
+RIZZ_STATE static rizz_api_gfx* the_gfx;
+RIZZ_STATE static rizz_api_asset* the_asset;
+
+RIZZ_STATE static rizz_gfx_stage g_bench_stage;
+
+// render stage of the benchmarks that draw from the plugin's step event
+static rizz_gfx_stage bench__stage(void)
+{
+    if (!g_bench_stage.id) {
+        g_bench_stage = the_gfx->stage_register("bench", (rizz_gfx_stage){ .id = 0 });
+    }
+    return g_bench_stage;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// sx string functions
+// scalar reference implementations of the string functions, for str-check and str-bench
+static int bench__ref_strlen(const char* str)
+{
+    int len = 0;
+    while (str[len] != '\0') {
+        ++len;
+    }
+    return len;
+}
+
+static const char* bench__ref_strchar(const char* str, char ch)
+{
+    for (;; ++str) {
+        if (*str == ch) {
+            return str;
+        } else if (*str == '\0') {
+            return NULL;
+        }
+    }
+}
+
+static bool bench__ref_strnequal(const char* a, const char* b, int num, bool nocase)
+{
+    for (int i = 0; i < num; i++) {
+        char ca = nocase ? sx_tolowerchar(a[i]) : a[i];
+        char cb = nocase ? sx_tolowerchar(b[i]) : b[i];
+        if (ca != cb) {
+            return false;
+        } else if (ca == '\0') {
+            return true;
+        }
+    }
+    return true;
+}
+
+// characters around the case ranges and non-ascii bytes, so case-folding edge cases come up often
+static const char k_str_check_chars[] = "aAbBzZyY09_/.-@[`{\x7f\x80\xc3\xa9\xff";
+
+// places a random string of `len` chars in `region` (2 pages, followed by an inaccessible page):
+// right before the guard page, across the boundary of the two pages, or anywhere
+static char* bench__str_check_place(sx_rng* rng, uint8_t* region, int page_sz, int len)
+{
+    char* str;
+    switch (sx_rng_gen_rangei(rng, 0, 2)) {
+    case 0:
+        str = (char*)region + page_sz*2 - len - 1;
+        break;
+    case 1:
+        str = (char*)region + page_sz - sx_rng_gen_rangei(rng, 0, len);
+        break;
+    default:
+        str = (char*)region + sx_rng_gen_rangei(rng, 0, page_sz*2 - len - 1);
+        break;
+    }
+
+    for (int i = 0; i < len; i++) {
+        str[i] = k_str_check_chars[sx_rng_gen(rng) % (sizeof(k_str_check_chars) - 1)];
+    }
+    str[len] = '\0';
+    return str;
+}
+
+// usage: str-check [iterations]
+// fuzz-style equivalence check of the sx string functions against the scalar references
+// strings are placed next to inaccessible pages, so reads that cross pages crash right away
+static int bench__str_check_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    int iterations = argc > 1 ? sx_toint(argv[1]) : 100000;
+    if (iterations <= 0) {
+        return -1;
+    }
+
+    sx_vmem_context vmem_a, vmem_b;
+    if (!sx_vmem_init(&vmem_a, 0, 3)) {
+        return -1;
+    }
+    if (!sx_vmem_init(&vmem_b, 0, 3)) {
+        sx_vmem_release(&vmem_a);
+        return -1;
+    }
+
+    uint8_t* region_a = sx_vmem_commit_pages(&vmem_a, 0, 2);
+    uint8_t* region_b = sx_vmem_commit_pages(&vmem_b, 0, 2);
+    int page_sz = vmem_a.page_size;
+    int num_errors = 0;
+    sx_rng rng;
+    sx_rng_seed(&rng, (uint32_t)sx_tm_now());
+
+    for (int i = 0; i < iterations && region_a && region_b; i++) {
+        int len_a = sx_rng_gen_rangei(&rng, 0, 80);
+        char* a = bench__str_check_place(&rng, region_a, page_sz, len_a);
+
+        // b is mostly derived from a, so the compares don't just fail on the first char
+        int len_b = len_a;
+        int mutation = sx_rng_gen_rangei(&rng, 0, 4);
+        if (mutation == 3) {
+            len_b = sx_rng_gen_rangei(&rng, 0, len_a);
+        } else if (mutation == 4) {
+            len_b = len_a + sx_rng_gen_rangei(&rng, 1, 20);
+        }
+        char* b = bench__str_check_place(&rng, region_b, page_sz, len_b);
+        sx_memcpy(b, a, sx_min(len_a, len_b));
+        if (len_a > 0 && mutation == 1) {
+            int idx = sx_rng_gen_rangei(&rng, 0, len_a - 1);
+            b[idx] = b[idx] == 'x' ? 'y' : 'x';
+        } else if (mutation == 2) {
+            for (int k = 0; k < len_b; k++) {
+                b[k] = sx_rng_gen(&rng) & 1 ? sx_toupperchar(b[k]) : sx_tolowerchar(b[k]);
+            }
+        }
+
+        char ch = len_a > 0 && (sx_rng_gen(&rng) & 1) ? a[sx_rng_gen_rangei(&rng, 0, len_a - 1)]
+                                                     : k_str_check_chars[sx_rng_gen(&rng) % 8];
+        if ((sx_rng_gen(&rng) % 16) == 0) {
+            ch = '\0';
+        }
+        int num = sx_rng_gen_rangei(&rng, -1, sx_max(len_a, len_b) + 2);
+        char tmp[128];
+
+        const char* failed = NULL;
+        if (sx_strlen(a) != bench__ref_strlen(a)) {
+            failed = "sx_strlen";
+        } else if (sx_strchar(a, ch) != bench__ref_strchar(a, ch)) {
+            failed = "sx_strchar";
+        } else if (sx_strequal(a, b) != bench__ref_strnequal(a, b, INT32_MAX, false)) {
+            failed = "sx_strequal";
+        } else if (sx_strequalnocase(a, b) != bench__ref_strnequal(a, b, INT32_MAX, true)) {
+            failed = "sx_strequalnocase";
+        } else if (sx_strnequal(a, b, num) != bench__ref_strnequal(a, b, num, false)) {
+            failed = "sx_strnequal";
+        } else if (sx_strnequalnocase(a, b, num) != bench__ref_strnequal(a, b, num, true)) {
+            failed = "sx_strnequalnocase";
+        } else if (num >= 0 && (sx_strncpy(tmp, sizeof(tmp), a, num) - tmp) != sx_min(len_a, num)) {
+            failed = "sx_strncpy";
+        }
+
+        if (failed) {
+            if (num_errors < 8) {
+                rizz_log_error("str-check: %s failed, a='%s', b='%s', ch=0x%x, num=%d", failed, a,
+                               b, (uint32_t)(uint8_t)ch, num);
+            }
+            ++num_errors;
+        }
+    }
+
+    rizz_log_info("str-check: %d iterations, %d mismatches", iterations, num_errors);
+    sx_vmem_release(&vmem_a);
+    sx_vmem_release(&vmem_b);
+    return num_errors == 0 ? 0 : -1;
+}
+
+// usage: str-bench [count]
+// measures sx string functions against the scalar references, for different string lengths
+// strings are equal and the searched char is missing, so the whole string is always scanned
+// note that optimizing compilers may turn the strlen reference loop into a libc strlen call
+static int bench__str_bench_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    int count = argc > 1 ? sx_toint(argv[1]) : 100000;
+    if (count <= 0) {
+        return -1;
+    }
+
+    const int lens[] = { 7, 31, 127, 1023 };
+    const sx_alloc* alloc = the_core->heap_alloc();
+    char* buff_a = sx_malloc(alloc, 1025);
+    char* buff_b = sx_malloc(alloc, 1025);
+    if (!buff_a || !buff_b) {
+        sx_free(alloc, buff_a);
+        sx_free(alloc, buff_b);
+        return -1;
+    }
+
+    for (int l = 0; l < (int)(sizeof(lens)/sizeof(int)); l++) {
+        int len = lens[l];
+        // off by one, so the strings are not aligned like most of the real strings
+        for (int i = 0; i < len; i++) {
+            buff_a[i + 1] = buff_b[i + 1] = 'a' + (char)(i % 26);
+        }
+        buff_a[len + 1] = buff_b[len + 1] = '\0';
+
+        // volatile pointers keep the compiler from hoisting the calls out of the loops
+        const char* volatile a = buff_a + 1;
+        const char* volatile b = buff_b + 1;
+        volatile int sum = 0;
+        double ns[8];
+
+        uint64_t tm = sx_tm_now();
+        for (int i = 0; i < count; i++) sum += sx_strlen(a);
+        ns[0] = sx_tm_us(sx_tm_since(tm));
+        tm = sx_tm_now();
+        for (int i = 0; i < count; i++) sum += bench__ref_strlen(a);
+        ns[1] = sx_tm_us(sx_tm_since(tm));
+        tm = sx_tm_now();
+        for (int i = 0; i < count; i++) sum += sx_strchar(a, '#') != NULL;
+        ns[2] = sx_tm_us(sx_tm_since(tm));
+        tm = sx_tm_now();
+        for (int i = 0; i < count; i++) sum += bench__ref_strchar(a, '#') != NULL;
+        ns[3] = sx_tm_us(sx_tm_since(tm));
+        tm = sx_tm_now();
+        for (int i = 0; i < count; i++) sum += sx_strequal(a, b);
+        ns[4] = sx_tm_us(sx_tm_since(tm));
+        tm = sx_tm_now();
+        for (int i = 0; i < count; i++) sum += bench__ref_strnequal(a, b, INT32_MAX, false);
+        ns[5] = sx_tm_us(sx_tm_since(tm));
+        tm = sx_tm_now();
+        for (int i = 0; i < count; i++) sum += sx_strequalnocase(a, b);
+        ns[6] = sx_tm_us(sx_tm_since(tm));
+        tm = sx_tm_now();
+        for (int i = 0; i < count; i++) sum += bench__ref_strnequal(a, b, INT32_MAX, true);
+        ns[7] = sx_tm_us(sx_tm_since(tm));
+
+        for (int i = 0; i < 8; i++) {
+            ns[i] = ns[i] * 1000.0 / (double)count;
+        }
+        rizz_log_info("str-bench: len=%d, strlen: %.1f/%.1f, strchar: %.1f/%.1f, strequal: %.1f/%.1f, "
+                      "strequalnocase: %.1f/%.1f ns (sx/scalar)", len, ns[0], ns[1], ns[2], ns[3],
+                      ns[4], ns[5], ns[6], ns[7]);
+    }
+
+    sx_free(alloc, buff_a);
+    sx_free(alloc, buff_b);
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// logging
+static void bench__log_stress_job_cb(int start, int end, int thrd_index, void* user)
+{
+    sx_unused(user);
+    for (int i = start; i < end; i++) {
+        rizz_log_info("log-stress: thread=%d, index=%d, value=%.3f, name=%s", thrd_index, i,
+                      (float)i*0.5f, "stress");
+    }
+}
+
+// usage: log-stress [count]
+// writes logs from all job threads and reports the time that callers spent on logging
+// the number of times that the log rings were full is reported by core on shutdown
+static int bench__log_stress_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    int count = argc > 1 ? sx_toint(argv[1]) : 100000;
+    if (count <= 0) {
+        return -1;
+    }
+
+    uint64_t start_tm = sx_tm_now();
+    sx_job_t job = the_core->job_dispatch(count, bench__log_stress_job_cb, NULL, SX_JOB_PRIORITY_HIGH, 0);
+    the_core->job_wait_and_del(job);
+    double elapsed = sx_tm_sec(sx_tm_since(start_tm));
+
+    rizz_log_info("log-stress: %d messages in %.2f ms (%.0f msgs/sec)", count, elapsed*1000.0,
+                  elapsed > 0 ? (double)count/elapsed : 0.0);
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// tls
+static void* bench__tls_bench_init(int thread_idx, uint32_t thread_id, void* user)
+{
+    sx_unused(thread_idx);
+    sx_unused(thread_id);
+    return user;
+}
+
+// usage: tls-bench [count]
+// measures the per-call cost of `tls_var` (name lookup) against `tls_slot`
+static int bench__tls_bench_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    int count = argc > 1 ? sx_toint(argv[1]) : 1000000;
+    if (count <= 0) {
+        return -1;
+    }
+
+    static int dummy;
+    int slot = the_core->tls_register_slot("bench_tls", &dummy, bench__tls_bench_init);
+    if (!slot) {
+        return -1;
+    }
+
+    void* volatile var;    // keeps the calls from being optimized out
+    uint64_t start_tm = sx_tm_now();
+    for (int i = 0; i < count; i++) {
+        var = the_core->tls_var("bench_tls");
+    }
+    double var_ns = sx_tm_us(sx_tm_since(start_tm)) * 1000.0 / (double)count;
+
+    start_tm = sx_tm_now();
+    for (int i = 0; i < count; i++) {
+        var = the_core->tls_slot(slot);
+    }
+    double slot_ns = sx_tm_us(sx_tm_since(start_tm)) * 1000.0 / (double)count;
+
+    sx_unused(var);
+    rizz_log_info("tls-bench: %d calls, tls_var: %.2f ns/call, tls_slot: %.2f ns/call", count, var_ns,
+                  slot_ns);
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// hash tables
+// usage: hashtbl-bench [capacity]
+// compares sx_hashmap against sx_hashtbl for inserts, lookups of existing keys and lookups of
+// missing keys at different load factors. capacity is the same for both tables and never grows
+static int bench__hashtbl_bench_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    int capacity = sx_hashtbl_valid_capacity(argc > 1 ? sx_toint(argv[1]) : 65536);
+    if (capacity < SX_HASHMAP_GROUP_SIZE) {
+        return -1;
+    }
+
+    // sx_hashtbl probes the whole table for missing keys, so keep the number of misses low
+    const int num_misses = 1000;
+    const float load_factors[] = { 0.25f, 0.5f, 0.75f, 0.875f };
+    const sx_alloc* alloc = the_core->heap_alloc();
+    sx_hashmap* map = sx_hashmap_create(alloc, capacity);
+    sx_hashtbl* tbl = sx_hashtbl_create(alloc, capacity);
+    if (!map || !tbl) {
+        sx_hashmap_destroy(map, alloc);
+        sx_hashtbl_destroy(tbl, alloc);
+        return -1;
+    }
+
+    int volatile sum = 0;    // keeps the lookups from being optimized out
+    for (int l = 0; l < (int)(sizeof(load_factors)/sizeof(float)); l++) {
+        // sx_hash_u32 is a bijection that only maps 61 to zero, so keys are random, unique and
+        // non-zero. misses are taken from the keys after count
+        int count = (int)((float)capacity * load_factors[l]) - 1;
+        sx_hashmap_clear(map);
+        sx_hashtbl_clear(tbl);
+
+        uint64_t start_tm = sx_tm_now();
+        for (int i = 0; i < count; i++) {
+            sx_hashmap_add(map, sx_hash_u32((uint32_t)i + 64), i);
+        }
+        double map_add = sx_tm_us(sx_tm_since(start_tm)) * 1000.0 / (double)count;
+
+        start_tm = sx_tm_now();
+        for (int i = 0; i < count; i++) {
+            sx_hashtbl_add(tbl, sx_hash_u32((uint32_t)i + 64), i);
+        }
+        double tbl_add = sx_tm_us(sx_tm_since(start_tm)) * 1000.0 / (double)count;
+
+        start_tm = sx_tm_now();
+        for (int i = 0; i < count; i++) {
+            sum += sx_hashmap_find(map, sx_hash_u32((uint32_t)i + 64));
+        }
+        double map_hit = sx_tm_us(sx_tm_since(start_tm)) * 1000.0 / (double)count;
+
+        start_tm = sx_tm_now();
+        for (int i = 0; i < count; i++) {
+            sum += sx_hashtbl_find(tbl, sx_hash_u32((uint32_t)i + 64));
+        }
+        double tbl_hit = sx_tm_us(sx_tm_since(start_tm)) * 1000.0 / (double)count;
+
+        start_tm = sx_tm_now();
+        for (int i = 0; i < num_misses; i++) {
+            sum += sx_hashmap_find(map, sx_hash_u32((uint32_t)(count + i) + 64));
+        }
+        double map_miss = sx_tm_us(sx_tm_since(start_tm)) * 1000.0 / (double)num_misses;
+
+        start_tm = sx_tm_now();
+        for (int i = 0; i < num_misses; i++) {
+            sum += sx_hashtbl_find(tbl, sx_hash_u32((uint32_t)(count + i) + 64));
+        }
+        double tbl_miss = sx_tm_us(sx_tm_since(start_tm)) * 1000.0 / (double)num_misses;
+
+        rizz_log_info("hashtbl-bench: load=%.3f (%d keys), add: %.1f/%.1f ns, find: %.1f/%.1f ns, "
+                      "miss: %.1f/%.1f ns (hashmap/hashtbl)", load_factors[l], count, map_add,
+                      tbl_add, map_hit, tbl_hit, map_miss, tbl_miss);
+    }
+
+    sx_hashmap_destroy(map, alloc);
+    sx_hashtbl_destroy(tbl, alloc);
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// queues
+typedef enum bench__queue_bench_mode {
+    BENCH_QUEUE_MUTEX = 0,
+    BENCH_QUEUE_MPMC,
+    BENCH_QUEUE_MPSC,
+    _BENCH_QUEUE_COUNT
+} bench__queue_bench_mode;
+
+typedef struct bench__queue_bench {
+    const sx_alloc* alloc;
+    bench__queue_bench_mode mode;
+    int count;    // items per producer
+    sx_atomic_uint32 go;
+    sx_atomic_uint32 quit;            // producers exit without producing anything
+    sx_atomic_uint32 num_produced;    // added by each producer before it increments num_done
+    sx_atomic_uint32 num_done;
+    sx_atomic_uint32 failed;
+    sx_mutex mtx;
+    uint32_t* SX_ARRAY items;
+    sx_queue_mpmc* mpmc;
+    sx_queue_mpsc* mpsc;
+} bench__queue_bench;
+
+static int bench__queue_bench_producer_cb(void* user_data1, void* user_data2)
+{
+    sx_unused(user_data2);
+    bench__queue_bench* bench = user_data1;
+    while (!sx_atomic_load32(&bench->go)) {
+        sx_thread_yield();
+    }
+
+    uint32_t num_produced = 0;
+    bool failed = false;
+    for (uint32_t i = 0; i < (uint32_t)bench->count && !failed && !sx_atomic_load32(&bench->quit); i++) {
+        switch (bench->mode) {
+        case BENCH_QUEUE_MUTEX:
+            sx_mutex_lock(bench->mtx) {
+                sx_array_push(bench->alloc, bench->items, i);
+            }
+            break;
+        case BENCH_QUEUE_MPMC:
+            while (!sx_queue_mpmc_produce(bench->mpmc, &i)) {
+                sx_thread_yield();
+            }
+            break;
+        case BENCH_QUEUE_MPSC:
+            failed = !sx_queue_mpsc_produce(bench->mpsc, &i);
+            break;
+        default:
+            break;
+        }
+        num_produced += failed ? 0 : 1;
+    }
+
+    if (failed) {
+        sx_atomic_store32(&bench->failed, 1);
+    }
+    sx_atomic_fetch_add32(&bench->num_produced, num_produced);
+    sx_atomic_fetch_add32(&bench->num_done, 1);
+    return 0;
+}
+
+// returns nanoseconds per item, or -1 if a producer thread could not be created or failed to produce
+// consumer is the calling thread and consumes until all producers are done and their items are consumed
+static double bench__queue_bench_run(bench__queue_bench* bench, bench__queue_bench_mode mode,
+                                     int num_producers)
+{
+    sx_thread* threads[32];
+    bench->mode = mode;
+    sx_atomic_store32(&bench->go, 0);
+    sx_atomic_store32(&bench->quit, 0);
+    sx_atomic_store32(&bench->num_produced, 0);
+    sx_atomic_store32(&bench->num_done, 0);
+    sx_atomic_store32(&bench->failed, 0);
+
+    int num_threads = 0;
+    for (int i = 0; i < num_producers; i++) {
+        threads[num_threads] = sx_thread_create(bench->alloc, bench__queue_bench_producer_cb, bench, 0,
+                                                "queue-bench", NULL);
+        if (!threads[num_threads]) {
+            break;
+        }
+        ++num_threads;
+    }
+
+    if (num_threads < num_producers) {
+        sx_atomic_store32(&bench->quit, 1);
+        sx_atomic_store32(&bench->go, 1);
+        for (int i = 0; i < num_threads; i++) {
+            sx_thread_destroy(threads[i], bench->alloc);
+        }
+        return -1.0;
+    }
+
+    uint32_t num_consumed = 0;
+    uint64_t start_tm = sx_tm_now();
+    sx_atomic_store32(&bench->go, 1);
+    for (;;) {
+        int n = 0;
+        uint32_t item;
+        switch (mode) {
+        case BENCH_QUEUE_MUTEX:
+            sx_mutex_lock(bench->mtx) {
+                n = sx_array_count(bench->items);
+                sx_array_clear(bench->items);
+            }
+            break;
+        case BENCH_QUEUE_MPMC:
+            while (sx_queue_mpmc_consume(bench->mpmc, &item)) {
+                ++n;
+            }
+            break;
+        case BENCH_QUEUE_MPSC:
+            while (sx_queue_mpsc_consume(bench->mpsc, &item)) {
+                ++n;
+            }
+            break;
+        default:
+            break;
+        }
+        num_consumed += (uint32_t)n;
+
+        if (n == 0) {
+            // num_produced is final once all producers are done
+            if (sx_atomic_load32(&bench->num_done) == (uint32_t)num_threads &&
+                num_consumed >= sx_atomic_load32(&bench->num_produced)) {
+                break;
+            }
+            sx_thread_yield();
+        }
+    }
+    double elapsed = sx_tm_us(sx_tm_since(start_tm));
+
+    for (int i = 0; i < num_threads; i++) {
+        sx_thread_destroy(threads[i], bench->alloc);
+    }
+
+    if (sx_atomic_load32(&bench->failed) || num_consumed == 0) {
+        return -1.0;
+    }
+    return elapsed * 1000.0 / (double)num_consumed;
+}
+
+// usage: queue-bench [count] [max_producers]
+// pushes `count` items from each producer thread to a single consumer (calling thread), through
+// mutex+array, sx_queue_mpmc and sx_queue_mpsc, for 1..max_producers
+static int bench__queue_bench_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    int count = argc > 1 ? sx_toint(argv[1]) : 100000;
+    int max_producers = argc > 2 ? sx_toint(argv[2]) : sx_max(sx_os_numcores() - 1, 1);
+    if (count <= 0 || max_producers <= 0) {
+        return -1;
+    }
+    max_producers = sx_min(max_producers, 32);
+
+    const sx_alloc* alloc = the_core->heap_alloc();
+    bench__queue_bench bench = { .alloc = alloc, .count = count };
+    sx_mutex_init(&bench.mtx);
+    bench.mpmc = sx_queue_mpmc_create(alloc, sizeof(uint32_t), 1024);
+    bench.mpsc = sx_queue_mpsc_create(alloc, sizeof(uint32_t), 1024);
+    int r = (bench.mpmc && bench.mpsc) ? 0 : -1;
+    for (int i = 1; i <= max_producers && r == 0; i++) {
+        double ns[_BENCH_QUEUE_COUNT];
+        for (int m = 0; m < _BENCH_QUEUE_COUNT && r == 0; m++) {
+            ns[m] = bench__queue_bench_run(&bench, (bench__queue_bench_mode)m, i);
+            if (ns[m] < 0) {
+                rizz_log_error("queue-bench: producers=%d, creating producer threads or producing "
+                               "items failed", i);
+                r = -1;
+            }
+        }
+
+        if (r == 0) {
+            rizz_log_info("queue-bench: producers=%d, %d items, mutex: %.1f ns, mpmc: %.1f ns, "
+                          "mpsc: %.1f ns (per item)", i, count*i, ns[BENCH_QUEUE_MUTEX],
+                          ns[BENCH_QUEUE_MPMC], ns[BENCH_QUEUE_MPSC]);
+        }
+    }
+
+    sx_queue_mpmc_destroy(bench.mpmc, alloc);
+    sx_queue_mpsc_destroy(bench.mpsc, alloc);
+    sx_array_free(alloc, bench.items);
+    sx_mutex_release(&bench.mtx);
+    return r;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// handle-bench
+typedef struct bench__handle_bench {
+    bool mt;
+    int count;    // handles per thread
+    sx_atomic_uint32 go;
+    sx_mutex mtx;
+    sx_handle_pool* pool;
+    sx_handle_pool_mt* pool_mt;
+    const sx_alloc* alloc;
+} bench__handle_bench;
+
+static int bench__handle_bench_thread_cb(void* user_data1, void* user_data2)
+{
+    sx_unused(user_data2);
+    bench__handle_bench* bench = user_data1;
+    sx_handle_t handles[64];
+    while (!sx_atomic_load32(&bench->go)) {
+        sx_thread_yield();
+    }
+
+    // allocate handles in batches and delete them, so the pools are kept busy and also reuse slots
+    for (int i = 0; i < bench->count; i += 64) {
+        int n = sx_min(64, bench->count - i);
+        if (bench->mt) {
+            for (int k = 0; k < n; k++) {
+                handles[k] = sx_handle_new_mt(bench->pool_mt);
+            }
+            for (int k = 0; k < n; k++) {
+                sx_handle_del_mt(bench->pool_mt, handles[k]);
+            }
+        } else {
+            for (int k = 0; k < n; k++) {
+                sx_mutex_lock(bench->mtx) {
+                    handles[k] = sx_handle_new_and_grow(bench->pool, bench->alloc);
+                }
+            }
+            for (int k = 0; k < n; k++) {
+                sx_mutex_lock(bench->mtx) {
+                    sx_handle_del(bench->pool, handles[k]);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// usage: handle-bench [count] [max_threads]
+// creates and deletes `count` handles on each thread, with a mutex guarded sx_handle_pool and with
+// sx_handle_pool_mt, for 1..max_threads
+static int bench__handle_bench_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    int count = argc > 1 ? sx_toint(argv[1]) : 100000;
+    int max_threads = argc > 2 ? sx_toint(argv[2]) : sx_os_numcores();
+    if (count <= 0 || max_threads <= 0) {
+        return -1;
+    }
+    max_threads = sx_min(max_threads, 32);
+
+    const sx_alloc* alloc = the_core->heap_alloc();
+    bench__handle_bench bench = { .count = count, .alloc = alloc };
+    int r = 0;
+    sx_mutex_init(&bench.mtx);
+    bench.pool = sx_handle_create_pool(alloc, 256);
+    bench.pool_mt = sx_handle_create_pool_mt(alloc, 256, 0);
+    if (bench.pool && bench.pool_mt) {
+        for (int i = 1; i <= max_threads && r == 0; i++) {
+            double ns[2];
+            for (int m = 0; m < 2 && r == 0; m++) {
+                sx_thread* threads[32];
+                bench.mt = m == 1;
+                sx_atomic_store32(&bench.go, 0);
+                int num_threads = 0;
+                for (int t = 0; t < i; t++) {
+                    threads[t] = sx_thread_create(alloc, bench__handle_bench_thread_cb, &bench, 0,
+                                                  "handle-bench", NULL);
+                    if (!threads[t]) {
+                        break;
+                    }
+                    num_threads++;
+                }
+
+                uint64_t start_tm = sx_tm_now();
+                sx_atomic_store32(&bench.go, 1);
+                for (int t = 0; t < num_threads; t++) {
+                    sx_thread_destroy(threads[t], alloc);
+                }
+                ns[m] = sx_tm_us(sx_tm_since(start_tm)) * 1000.0 / (double)(count * i);
+                if (num_threads != i) {
+                    rizz_log_error("handle-bench: creating thread failed");
+                    r = -1;
+                }
+            }
+
+            if (r != 0) {
+                break;
+            }
+            rizz_log_info("handle-bench: threads=%d, %d handles, mutex: %.1f ns, mt: %.1f ns "
+                          "(per new+del)", i, count*i, ns[0], ns[1]);
+        }
+    }
+
+    sx_handle_destroy_pool(bench.pool, alloc);
+    sx_handle_destroy_pool_mt(bench.pool_mt, alloc);
+    sx_mutex_release(&bench.mtx);
+    return r;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// strintern-bench
+typedef struct bench__strintern_bench {
+    bool intern;
+    int count;
+    const char (*names)[32];
+    int* lens;
+    sx_atomic_uint32 go;
+    sx_mutex mtx;
+    sx_strpool* pool;
+    sx_strintern* si;
+} bench__strintern_bench;
+
+static int bench__strintern_bench_thread_cb(void* user_data1, void* user_data2)
+{
+    sx_unused(user_data2);
+    bench__strintern_bench* bench = user_data1;
+    while (!sx_atomic_load32(&bench->go)) {
+        sx_thread_yield();
+    }
+
+    // all strings already exist, so this is the common 'get id of a name' case
+    for (int i = 0; i < bench->count; i++) {
+        if (bench->intern) {
+            sx_strintern_add(bench->si, bench->names[i], bench->lens[i]);
+        } else {
+            sx_mutex_lock(bench->mtx) {
+                sx_strpool_add(bench->pool, bench->names[i], bench->lens[i]);
+            }
+        }
+    }
+    return 0;
+}
+
+// usage: strintern-bench [count] [max_threads]
+// adds `count` unique names to sx_strpool and sx_strintern on the calling thread, then adds the same
+// names again from 1..max_threads, with sx_strpool guarded by a mutex
+static int bench__strintern_bench_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    int count = argc > 1 ? sx_toint(argv[1]) : 50000;
+    int max_threads = argc > 2 ? sx_toint(argv[2]) : sx_os_numcores();
+    if (count <= 0 || max_threads <= 0) {
+        return -1;
+    }
+    max_threads = sx_min(max_threads, 32);
+
+    const sx_alloc* alloc = the_core->heap_alloc();
+    bench__strintern_bench bench = { .count = count };
+    int r = 0;
+    char (*names)[32] = sx_malloc(alloc, sizeof(*names) * count);
+    bench.lens = sx_malloc(alloc, sizeof(int) * count);
+    bench.names = (const char (*)[32])names;
+    bench.pool = sx_strpool_create(alloc, NULL);
+    bench.si = sx_strintern_create(alloc, count);
+    sx_mutex_init(&bench.mtx);
+
+    if (names && bench.lens && bench.pool && bench.si) {
+        for (int i = 0; i < count; i++) {
+            bench.lens[i] = sx_snprintf(names[i], sizeof(*names), "entity/sprite_%d.png", i);
+        }
+
+        uint64_t start_tm = sx_tm_now();
+        for (int i = 0; i < count; i++) {
+            sx_strpool_add(bench.pool, names[i], bench.lens[i]);
+        }
+        double pool_ns = sx_tm_us(sx_tm_since(start_tm)) * 1000.0 / (double)count;
+
+        start_tm = sx_tm_now();
+        for (int i = 0; i < count; i++) {
+            sx_strintern_add(bench.si, names[i], bench.lens[i]);
+        }
+        double si_ns = sx_tm_us(sx_tm_since(start_tm)) * 1000.0 / (double)count;
+        rizz_log_info("strintern-bench: insert %d names, strpool: %.1f ns, strintern: %.1f ns",
+                      count, pool_ns, si_ns);
+
+        for (int i = 1; i <= max_threads && r == 0; i++) {
+            double ns[2];
+            for (int m = 0; m < 2 && r == 0; m++) {
+                sx_thread* threads[32];
+                bench.intern = m == 1;
+                sx_atomic_store32(&bench.go, 0);
+                int num_threads = 0;
+                for (int t = 0; t < i; t++) {
+                    threads[t] = sx_thread_create(alloc, bench__strintern_bench_thread_cb, &bench,
+                                                  0, "strintern-bench", NULL);
+                    if (!threads[t]) {
+                        break;
+                    }
+                    num_threads++;
+                }
+
+                start_tm = sx_tm_now();
+                sx_atomic_store32(&bench.go, 1);
+                for (int t = 0; t < num_threads; t++) {
+                    sx_thread_destroy(threads[t], alloc);
+                }
+                ns[m] = sx_tm_us(sx_tm_since(start_tm)) * 1000.0 / (double)(count * i);
+                if (num_threads != i) {
+                    rizz_log_error("strintern-bench: creating thread failed");
+                    r = -1;
+                }
+            }
+
+            if (r != 0) {
+                break;
+            }
+            rizz_log_info("strintern-bench: threads=%d, lookup %d names, strpool+mutex: %.1f ns, "
+                          "strintern: %.1f ns", i, count*i, ns[0], ns[1]);
+        }
+    }
+
+    sx_mutex_release(&bench.mtx);
+    sx_strintern_destroy(bench.si, alloc);
+    if (bench.pool) {
+        sx_strpool_destroy(bench.pool, alloc);
+    }
+    sx_free(alloc, bench.lens);
+    sx_free(alloc, names);
+    return r;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// cull-bench
+typedef struct bench__cull_objects {
+    int count;
+    sx_vec3* centers;
+    float* radiuss;
+    sx_aabb* aabbs;
+    float* soa;    // 10 arrays of `count` floats: x, y, z, r, xmin, ymin, zmin, xmax, ymax, zmax
+    rizz_camera_spheres_soa spheres_soa;
+    rizz_camera_aabbs_soa aabbs_soa;
+    int* visible_indices;
+    uint32_t* visibility;
+} bench__cull_objects;
+
+// scalar reference, same tests as the camera culler without SIMD or jobs
+static int bench__cull_ref(const sx_plane* planes, const bench__cull_objects* objs, bool aabb)
+{
+    int num_visible = 0;
+    for (int i = 0; i < objs->count; i++) {
+        bool visible = true;
+        for (int k = 0; k < _RIZZ_CAMERA_VIEWPLANE_COUNT && visible; k++) {
+            const float* n = planes[k].normal;
+            if (aabb) {
+                const sx_aabb* b = &objs->aabbs[i];
+                float px = n[0] >= 0 ? b->xmax : b->xmin;
+                float py = n[1] >= 0 ? b->ymax : b->ymin;
+                float pz = n[2] >= 0 ? b->zmax : b->zmin;
+                visible = (px*n[0] + py*n[1] + pz*n[2] + planes[k].dist) >= 0;
+            } else {
+                sx_vec3 c = objs->centers[i];
+                visible = (c.x*n[0] + c.y*n[1] + c.z*n[2] + planes[k].dist) >= -objs->radiuss[i];
+            }
+        }
+        num_visible += visible ? 1 : 0;
+    }
+    return num_visible;
+}
+
+static bool bench__cull_create_objects(bench__cull_objects* objs, int count, const sx_alloc* alloc)
+{
+    sx_memset(objs, 0x0, sizeof(*objs));
+    objs->count = count;
+    objs->centers = sx_malloc(alloc, sizeof(sx_vec3) * count);
+    objs->radiuss = sx_malloc(alloc, sizeof(float) * count);
+    objs->aabbs = sx_malloc(alloc, sizeof(sx_aabb) * count);
+    objs->soa = sx_aligned_malloc(alloc, sizeof(float) * count * 10, 16);
+    objs->visible_indices = sx_malloc(alloc, sizeof(int) * count);
+    objs->visibility = sx_malloc(alloc, sizeof(uint32_t) * ((count + 31) / 32));
+    if (!objs->centers || !objs->radiuss || !objs->aabbs || !objs->soa || !objs->visible_indices ||
+        !objs->visibility) {
+        return false;
+    }
+
+    // count is a multiple of 4, so every SoA array stays 16 byte aligned
+    sx_assert((count & 3) == 0);
+    float* soa[10];
+    for (int i = 0; i < 10; i++) {
+        soa[i] = objs->soa + i * count;
+    }
+    objs->spheres_soa = (rizz_camera_spheres_soa){ soa[0], soa[1], soa[2], soa[3] };
+    objs->aabbs_soa = (rizz_camera_aabbs_soa){ soa[4], soa[5], soa[6], soa[7], soa[8], soa[9] };
+
+    // objects are scattered in a box around the camera, so roughly a quarter of them are visible
+    sx_rng rng;
+    sx_rng_seed(&rng, 0x1234);
+    for (int i = 0; i < count; i++) {
+        sx_vec3 c = sx_vec3f(sx_rng_gen_rangef(&rng, -100.0f, 100.0f),
+                             sx_rng_gen_rangef(&rng, -100.0f, 100.0f),
+                             sx_rng_gen_rangef(&rng, -100.0f, 100.0f));
+        float r = sx_rng_gen_rangef(&rng, 0.1f, 2.0f);
+        objs->centers[i] = c;
+        objs->radiuss[i] = r;
+        objs->aabbs[i] = sx_aabbf(c.x - r, c.y - r, c.z - r, c.x + r, c.y + r, c.z + r);
+        soa[0][i] = c.x;
+        soa[1][i] = c.y;
+        soa[2][i] = c.z;
+        soa[3][i] = r;
+        for (int k = 0; k < 6; k++) {
+            soa[4 + k][i] = objs->aabbs[i].f[k];
+        }
+    }
+
+    return true;
+}
+
+static void bench__cull_destroy_objects(bench__cull_objects* objs, const sx_alloc* alloc)
+{
+    sx_free(alloc, objs->centers);
+    sx_free(alloc, objs->radiuss);
+    sx_free(alloc, objs->aabbs);
+    if (objs->soa) {
+        sx_aligned_free(alloc, objs->soa, 16);
+    }
+    sx_free(alloc, objs->visible_indices);
+    sx_free(alloc, objs->visibility);
+}
+
+// usage: cull-bench [count] [iterations]
+// culls `count` spheres and aabbs with the scalar reference, the AoS and the SoA camera culling APIs
+// and checks that all of them return the same number of visible objects
+static int bench__cull_bench_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    int count = argc > 1 ? sx_toint(argv[1]) : 100000;
+    int iters = argc > 2 ? sx_toint(argv[2]) : 20;
+    if (count <= 0 || iters <= 0) {
+        return -1;
+    }
+    count = sx_align_mask(count, 3);
+
+    rizz_api_camera* cam_api = the_plugin->get_api(RIZZ_API_CAMERA, 0);
+    const sx_alloc* alloc = the_core->heap_alloc();
+    bench__cull_objects objs;
+    int r = 0;
+    if (bench__cull_create_objects(&objs, count, alloc)) {
+        rizz_camera cam;
+        cam_api->init(&cam, 60.0f, sx_rectf(0, 0, 1280.0f, 720.0f), 0.1f, 100.0f);
+        cam_api->lookat(&cam, sx_vec3f(0, -10.0f, 0), SX_VEC3_ZERO, SX_VEC3_UNITZ);
+        sx_mat4 proj, view;
+        cam_api->perspective_mat(&cam, &proj);
+        cam_api->view_mat(&cam, &view);
+        sx_mat4 viewproj = sx_mat4_mul(&proj, &view);
+        sx_plane planes[_RIZZ_CAMERA_VIEWPLANE_COUNT];
+        cam_api->calc_frustum_planes(planes, &viewproj);
+
+        for (int aabb = 0; aabb < 2; aabb++) {
+            int num_visible[3] = { 0 };
+            double ns[3];
+
+            uint64_t start_tm = sx_tm_now();
+            for (int i = 0; i < iters; i++) {
+                num_visible[0] = bench__cull_ref(planes, &objs, aabb == 1);
+            }
+            ns[0] = sx_tm_us(sx_tm_since(start_tm)) * 1000.0 / ((double)count * iters);
+
+            start_tm = sx_tm_now();
+            for (int i = 0; i < iters; i++) {
+                num_visible[1] = aabb ? cam_api->cull_aabbs(planes, objs.aabbs, count, objs.visibility,
+                                                             objs.visible_indices)
+                                      : cam_api->cull_spheres(planes, objs.centers, objs.radiuss, count,
+                                                              objs.visibility, objs.visible_indices);
+            }
+            ns[1] = sx_tm_us(sx_tm_since(start_tm)) * 1000.0 / ((double)count * iters);
+
+            start_tm = sx_tm_now();
+            for (int i = 0; i < iters; i++) {
+                num_visible[2] = aabb ? cam_api->cull_aabbs_soa(planes, &objs.aabbs_soa, count,
+                                                                 objs.visibility, objs.visible_indices)
+                                      : cam_api->cull_spheres_soa(planes, &objs.spheres_soa, count,
+                                                                  objs.visibility, objs.visible_indices);
+            }
+            ns[2] = sx_tm_us(sx_tm_since(start_tm)) * 1000.0 / ((double)count * iters);
+
+            const char* name = aabb ? "aabbs" : "spheres";
+            if (num_visible[0] != num_visible[1] || num_visible[0] != num_visible[2]) {
+                rizz_log_error("cull-bench: %s: visible counts do not match (ref: %d, aos: %d, soa: %d)",
+                               name, num_visible[0], num_visible[1], num_visible[2]);
+                r = -1;
+            }
+            rizz_log_info("cull-bench: %s: %d objects (%d visible), scalar: %.2f ns, aos: %.2f ns, "
+                          "soa: %.2f ns (per object)", name, count, num_visible[0], ns[0], ns[1], ns[2]);
+        }
+    } else {
+        r = -1;
+    }
+
+    bench__cull_destroy_objects(&objs, alloc);
+    return r;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// font-bench
+// font drawing needs a render pass, so the benchmark is started by the command and then runs from
+// the plugin's step event: `num_frames` frames with immediate draws, then the same with batch_draw
+typedef struct bench__font_bench {
+    bool running;
+    bool batched;
+    int num_texts;
+    int num_frames;
+    int frame;
+    rizz_asset font;
+    rizz_api_2d* api;
+    double ms[2];    // cpu time of all frames, immediate and batched
+    int num_draws;
+    int cache_hits;
+    int cache_misses;
+} bench__font_bench;
+
+RIZZ_STATE static bench__font_bench g_font_bench;
+
+static void bench__font_bench_step(void)
+{
+    bench__font_bench* fb = &g_font_bench;
+    if (!fb->running) {
+        return;
+    }
+
+    rizz_api_2d* api = fb->api;
+    const rizz_font* font = api->font.get(fb->font);
+    float w = (float)the_app->width();
+    float h = (float)the_app->height();
+    sx_mat4 vp = sx_mat4_ortho_offcenter(0, h, w, 0, -1.0f, 1.0f, 0, the_gfx->GL_family());
+    sg_pass_action pass_action = { .colors[0] = { .action = SG_ACTION_LOAD },
+                                   .depth = { .action = SG_ACTION_LOAD },
+                                   .stencil = { .action = SG_ACTION_LOAD } };
+
+    the_gfx->staged.begin(bench__stage());
+    the_gfx->staged.begin_default_pass(&pass_action, the_app->width(), the_app->height());
+
+    api->font.push_state(font);
+    api->font.set_viewproj_mat(font, &vp);
+    api->font.set_size(font, 16.0f);
+    float lineh = api->font.vert_metrics(font).lineh;
+
+    // the same strings every frame, like a HUD, so batched layouts come from the cache after the
+    // first frame
+    uint64_t start_tm = sx_tm_now();
+    for (int i = 0; i < fb->num_texts; i++) {
+        sx_vec2 pos = sx_vec2f(10.0f + (float)(i & 1) * w * 0.5f, lineh * (float)(1 + (i >> 1)));
+        if (fb->batched) {
+            api->font.batch_drawf(font, pos, "font-bench %d: quick brown fox", i);
+        } else {
+            api->font.drawf(font, pos, "font-bench %d: quick brown fox", i);
+        }
+    }
+    if (fb->batched) {
+        api->font.batch_flush();
+    }
+    fb->ms[fb->batched ? 1 : 0] += sx_tm_ms(sx_tm_since(start_tm));
+    api->font.pop_state(font);
+
+    if (fb->batched) {
+        // stats only cover the last flush, so sum them for all frames
+        rizz_font_batch_stats stats;
+        api->font.batch_stats(&stats);
+        fb->num_draws += stats.num_draws;
+        fb->cache_hits += stats.cache_hits;
+        fb->cache_misses += stats.cache_misses;
+    }
+
+    the_gfx->staged.end_pass();
+    the_gfx->staged.end();
+
+    if (++fb->frame < fb->num_frames) {
+        return;
+    }
+
+    if (!fb->batched) {
+        fb->batched = true;
+        fb->frame = 0;
+    } else {
+        rizz_log_info("font-bench: %d texts, %d frames, immediate: %.3f ms, batched: %.3f ms "
+                      "(per frame), batched: %d draws, %d cache hits, %d cache misses",
+                      fb->num_texts, fb->num_frames, fb->ms[0] / (double)fb->num_frames,
+                      fb->ms[1] / (double)fb->num_frames, fb->num_draws, fb->cache_hits,
+                      fb->cache_misses);
+        the_asset->unload(fb->font);
+        fb->font = (rizz_asset){ 0 };
+        fb->running = false;
+    }
+}
+
+// usage: font-bench font_file [num_texts] [num_frames]
+// draws `num_texts` strings per frame with the immediate font API, then with batch_draw/batch_flush
+// and reports the CPU time per frame. default draw limits of the font API fit about 20 texts
+static int bench__font_bench_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    bench__font_bench* fb = &g_font_bench;
+    if (argc < 2) {
+        rizz_log_error("font-bench: font file is not provided");
+        return -1;
+    }
+    if (fb->running) {
+        rizz_log_error("font-bench: already running");
+        return -1;
+    }
+
+    fb->api = the_plugin->get_api_byname("2dtools", 0);
+    if (!fb->api) {
+        rizz_log_error("font-bench: 2dtools plugin is not loaded");
+        return -1;
+    }
+
+    int num_texts = argc > 2 ? sx_toint(argv[2]) : 20;
+    int num_frames = argc > 3 ? sx_toint(argv[3]) : 100;
+    if (num_texts <= 0 || num_frames <= 0) {
+        return -1;
+    }
+
+    rizz_font_load_params fparams = { 0 };
+    rizz_asset font = the_asset->load("font", argv[1], &fparams, RIZZ_ASSET_LOAD_FLAG_WAIT_ON_LOAD,
+                                      NULL, 0);
+    if (!font.id || the_asset->state(font) != RIZZ_ASSET_STATE_OK) {
+        rizz_log_error("font-bench: loading font '%s' failed", argv[1]);
+        if (font.id) {
+            the_asset->unload(font);
+        }
+        return -1;
+    }
+
+    fb->running = true;
+    fb->batched = false;
+    fb->num_texts = num_texts;
+    fb->num_frames = num_frames;
+    fb->frame = 0;
+    fb->font = font;
+    fb->ms[0] = fb->ms[1] = 0;
+    fb->num_draws = fb->cache_hits = fb->cache_misses = 0;
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// basis-bench
+typedef struct bench__basis_format {
+    const char* name;
+    sg_pixel_format fmt;
+} bench__basis_format;
+
+static const bench__basis_format k_basis_formats[] = { { "rgba8", SG_PIXELFORMAT_RGBA8 },
+                                                       { "bc1", SG_PIXELFORMAT_BC1_RGBA },
+                                                       { "bc3", SG_PIXELFORMAT_BC3_RGBA },
+                                                       { "bc7", SG_PIXELFORMAT_BC7_RGBA },
+                                                       { "etc2", SG_PIXELFORMAT_ETC2_RGBA8 } };
+
+// usage: basis-bench basis_file [iterations] [rgba8|bc1|bc3|bc7|etc2]
+// loads and unloads the texture `iterations` times on the main thread, which includes reading the
+// file, transcoding all images and mips (in parallel, on job threads) and creating the texture
+// needs the basisut plugin. transcode time of each load is also logged by basisut at debug level
+static int bench__basis_bench_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    if (argc < 2) {
+        rizz_log_error("basis-bench: basis file is not provided");
+        return -1;
+    }
+
+    int iters = argc > 2 ? sx_toint(argv[2]) : 10;
+    if (iters <= 0) {
+        return -1;
+    }
+
+    sg_pixel_format fmt = _SG_PIXELFORMAT_DEFAULT;
+    const char* fmt_name = argc > 3 ? argv[3] : "rgba8";
+    for (int i = 0; i < (int)(sizeof(k_basis_formats) / sizeof(bench__basis_format)); i++) {
+        if (sx_strequalnocase(k_basis_formats[i].name, fmt_name)) {
+            fmt = k_basis_formats[i].fmt;
+            break;
+        }
+    }
+    if (fmt == _SG_PIXELFORMAT_DEFAULT) {
+        rizz_log_error("basis-bench: unknown format '%s'", fmt_name);
+        return -1;
+    }
+
+    rizz_texture_load_params tparams = { .fmt = fmt };
+    double total_ms = 0;
+    double min_ms = SX_FLOAT_MAX;
+    int mem_size = 0;
+    for (int i = 0; i < iters; i++) {
+        uint64_t start_tm = sx_tm_now();
+        rizz_asset tex = the_asset->load("texture_basisu", argv[1], &tparams,
+                                         RIZZ_ASSET_LOAD_FLAG_WAIT_ON_LOAD, NULL, 0);
+        double ms = sx_tm_ms(sx_tm_since(start_tm));
+        if (!tex.id || the_asset->state(tex) != RIZZ_ASSET_STATE_OK) {
+            rizz_log_error("basis-bench: loading texture '%s' failed (is basisut plugin loaded?)",
+                           argv[1]);
+            if (tex.id) {
+                the_asset->unload(tex);
+            }
+            return -1;
+        }
+
+        mem_size = ((const rizz_texture*)the_asset->obj(tex).ptr)->info.mem_size_bytes;
+        the_asset->unload(tex);
+        total_ms += ms;
+        min_ms = sx_min(min_ms, ms);
+    }
+
+    double avg_ms = total_ms / (double)iters;
+    rizz_log_info("basis-bench: '%s' (%s), %d loads, avg: %.2f ms, min: %.2f ms (%.1f MB/s of "
+                  "basis data)", argv[1], fmt_name, iters, avg_ms, min_ms,
+                  ((double)mem_size / (1024.0 * 1024.0)) / (min_ms * 0.001));
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// mix-bench, stream-bench
+// mixing runs on sound update (or on the mixer thread), so the voices are started by the command
+// and the sound stats are sampled over the next frames from the plugin's step event. one round of
+// `num_frames` frames for each voice count. voices are played on bus 0, which has all the lanes
+// unless the game has changed it with `bus_set_max_lanes`
+#define BENCH_SND_MAX_ROUNDS 8
+
+typedef struct bench__snd_bench {
+    bool running;
+    bool stream;
+    int voices[BENCH_SND_MAX_ROUNDS];
+    int num_rounds;
+    int round;
+    int num_frames;
+    int frame;
+    rizz_asset snd;
+    rizz_api_snd* api;
+    rizz_snd_stats start_stats;
+} bench__snd_bench;
+
+typedef struct bench__wav_header {
+    char riff[4];
+    uint32_t riff_size;
+    char wave[4];
+    char fmt[4];
+    uint32_t fmt_size;
+    uint16_t format;
+    uint16_t channels;
+    uint32_t sample_rate;
+    uint32_t byte_rate;
+    uint16_t block_align;
+    uint16_t bits;
+    char data[4];
+    uint32_t data_size;
+} bench__wav_header;
+
+RIZZ_STATE static bench__snd_bench g_snd_bench;
+
+// one second of 440hz sine as a 16bit mono wav file, used by mix-bench when no file is provided
+static sx_mem_block* bench__snd_tone_wav(void)
+{
+    const int sample_rate = RIZZ_SND_DEVICE_SAMPLE_RATE;
+    const uint32_t data_size = (uint32_t)(sample_rate * sizeof(int16_t));
+    sx_mem_block* mem = sx_mem_create_block(the_core->heap_alloc(),
+                                            sizeof(bench__wav_header) + data_size, NULL, 0);
+    if (!mem) {
+        return NULL;
+    }
+
+    bench__wav_header* header = mem->data;
+    *header = (bench__wav_header){ .riff = { 'R', 'I', 'F', 'F' },
+                                   .riff_size = sizeof(bench__wav_header) - 8 + data_size,
+                                   .wave = { 'W', 'A', 'V', 'E' },
+                                   .fmt = { 'f', 'm', 't', ' ' },
+                                   .fmt_size = 16,
+                                   .format = 1,    // PCM
+                                   .channels = 1,
+                                   .sample_rate = (uint32_t)sample_rate,
+                                   .byte_rate = (uint32_t)(sample_rate * sizeof(int16_t)),
+                                   .block_align = sizeof(int16_t),
+                                   .bits = 16,
+                                   .data = { 'd', 'a', 't', 'a' },
+                                   .data_size = data_size };
+
+    int16_t* samples = (int16_t*)(header + 1);
+    for (int i = 0; i < sample_rate; i++) {
+        samples[i] = (int16_t)(sx_sin(SX_PI2 * 440.0f * (float)i / (float)sample_rate) * 16000.0f);
+    }
+    return mem;
+}
+
+static void bench__snd_bench_finish(void)
+{
+    bench__snd_bench* sb = &g_snd_bench;
+    sb->api->bus_stop(0);
+    the_asset->unload(sb->snd);
+    sb->snd = (rizz_asset){ 0 };
+    sb->running = false;
+}
+
+static void bench__snd_bench_step(void)
+{
+    bench__snd_bench* sb = &g_snd_bench;
+    if (!sb->running) {
+        return;
+    }
+
+    rizz_api_snd* api = sb->api;
+    int num_voices = sb->voices[sb->round];
+    if (sb->frame == 0) {
+        // spread the voices over the stereo field. volume is scaled so the sum doesn't clip
+        rizz_snd_source src = api->source_get(sb->snd);
+        for (int i = 0; i < num_voices; i++) {
+            float pan = num_voices > 1 ? (-1.0f + 2.0f * (float)i / (float)(num_voices - 1)) : 0;
+            api->play(src, 0, 1.0f / (float)num_voices, pan, false);
+        }
+    } else if (sb->frame == 1) {
+        // skip the first frame, it can include previous sounds and streams still filling buffers
+        api->get_stats(&sb->start_stats);
+    }
+
+    if (++sb->frame <= sb->num_frames) {
+        return;
+    }
+
+    rizz_snd_stats stats;
+    api->get_stats(&stats);
+    double mix_ms = sx_tm_ms(stats.mix_ticks - sb->start_stats.mix_ticks);
+    int64_t mix_frames = stats.mix_frames - sb->start_stats.mix_frames;
+    int64_t voice_frames = stats.mix_voice_frames - sb->start_stats.mix_voice_frames;
+    double mixed_ms = 1000.0 * (double)mix_frames / (double)stats.sample_rate;
+    if (mix_frames == 0) {
+        rizz_log_error("%s: no frames were mixed, is the audio device running?",
+                       sb->stream ? "stream-bench" : "mix-bench");
+        bench__snd_bench_finish();
+        return;
+    }
+
+    // mixed voices can be less than requested when lanes are full or the sound has ended
+    double avg_voices = (double)voice_frames / (double)mix_frames;
+    double us_per_kframe = 1000000.0 * mix_ms / (double)mix_frames;
+    if (!sb->stream) {
+        rizz_log_info("mix-bench: %d voices (%.1f mixed): %.2f us per 1k frames, %.3f us per voice, "
+                      "%.3f%% of real-time", num_voices, avg_voices, us_per_kframe,
+                      avg_voices > 0 ? us_per_kframe / avg_voices : 0, 100.0 * mix_ms / mixed_ms);
+    } else {
+        double decode_ms = sx_tm_ms(stats.decode_ticks - sb->start_stats.decode_ticks);
+        int64_t decoded_frames = stats.decoded_frames - sb->start_stats.decoded_frames;
+        double decoded_ms = 1000.0 * (double)decoded_frames / (double)stats.sample_rate;
+        rizz_log_info("stream-bench: %d streams (%.1f mixed): decode: %.3f ms per second of audio "
+                      "(%.0fx real-time), mix: %.3f%% of real-time", num_voices, avg_voices,
+                      decoded_ms > 0 ? 1000.0 * decode_ms / decoded_ms : 0,
+                      decode_ms > 0 ? decoded_ms / decode_ms : 0, 100.0 * mix_ms / mixed_ms);
+    }
+
+    api->bus_stop(0);
+    sb->frame = 0;
+    if (++sb->round == sb->num_rounds) {
+        bench__snd_bench_finish();
+    }
+}
+
+static int bench__snd_bench_start(const char* name, const char* filepath, int voices,
+                                  int num_frames, bool stream)
+{
+    bench__snd_bench* sb = &g_snd_bench;
+    if (sb->running) {
+        rizz_log_error("%s: already running", name);
+        return -1;
+    }
+
+    sb->api = the_plugin->get_api_byname("sound", 0);
+    if (!sb->api) {
+        rizz_log_error("%s: sound plugin is not loaded", name);
+        return -1;
+    }
+
+    rizz_snd_load_params sparams = { .volume = 1.0f, .looping = true, .stream = stream };
+    rizz_asset snd;
+    if (filepath) {
+        snd = the_asset->load("sound", filepath, &sparams, RIZZ_ASSET_LOAD_FLAG_WAIT_ON_LOAD, NULL,
+                              0);
+    } else {
+        sx_mem_block* mem = bench__snd_tone_wav();
+        if (!mem) {
+            sx_out_of_memory();
+            return -1;
+        }
+        snd = the_asset->load_from_mem("sound", "bench_tone.wav", mem, &sparams,
+                                       RIZZ_ASSET_LOAD_FLAG_WAIT_ON_LOAD, NULL, 0);
+    }
+    if (!snd.id || the_asset->state(snd) != RIZZ_ASSET_STATE_OK) {
+        rizz_log_error("%s: loading sound '%s' failed", name, filepath ? filepath : "bench_tone.wav");
+        if (snd.id) {
+            the_asset->unload(snd);
+        }
+        return -1;
+    }
+
+    // 1, 2, 4, ... voices, always ending with the requested count
+    sb->num_rounds = 0;
+    for (int n = 1; n < voices && sb->num_rounds < BENCH_SND_MAX_ROUNDS - 1; n <<= 1) {
+        sb->voices[sb->num_rounds++] = n;
+    }
+    sb->voices[sb->num_rounds++] = voices;
+
+    sb->running = true;
+    sb->stream = stream;
+    sb->round = 0;
+    sb->num_frames = num_frames;
+    sb->frame = 0;
+    sb->snd = snd;
+    return 0;
+}
+
+// usage: mix-bench [voices] [num_frames] [sound_file]
+// mixer cost for 1, 2, 4, ... up to `voices` looping voices of the sound (a generated sine tone by
+// default), each measured over `num_frames` frames. needs the sound plugin
+static int bench__mix_bench_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    int voices = argc > 1 ? sx_toint(argv[1]) : RIZZ_SND_DEVICE_MAX_LANES;
+    int num_frames = argc > 2 ? sx_toint(argv[2]) : 100;
+    if (voices <= 0 || num_frames <= 0) {
+        return -1;
+    }
+
+    return bench__snd_bench_start("mix-bench", argc > 3 ? argv[3] : NULL,
+                                  sx_min(voices, RIZZ_SND_DEVICE_MAX_LANES), num_frames, false);
+}
+
+// usage: stream-bench sound_file [streams] [num_frames]
+// stream decoding cost on the stream thread, in ms per second of decoded audio, and the mixer cost
+// for 1, 2, 4, ... up to `streams` streaming instances of the sound. needs the sound plugin
+static int bench__stream_bench_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+    if (argc < 2) {
+        rizz_log_error("stream-bench: sound file is not provided");
+        return -1;
+    }
+
+    int streams = argc > 2 ? sx_toint(argv[2]) : RIZZ_SND_DEVICE_MAX_STREAMS;
+    int num_frames = argc > 3 ? sx_toint(argv[3]) : 100;
+    if (streams <= 0 || num_frames <= 0) {
+        return -1;
+    }
+
+    return bench__snd_bench_start("stream-bench", argv[1],
+                                  sx_min(streams, RIZZ_SND_DEVICE_MAX_STREAMS), num_frames, true);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// http-bench
+typedef struct bench__http_bench {
+    uint64_t start_tm;
+    int count;
+    int num_done;
+    int num_failed;
+    int64_t total_size;
+    rizz_http_stats start_stats;
+    rizz_api_http* api;
+} bench__http_bench;
+
+RIZZ_STATE static bench__http_bench g_http_bench;
+
+static void bench__http_bench_cb(const rizz_http_state* http, void* user)
+{
+    sx_unused(user);
+    bench__http_bench* hb = &g_http_bench;
+    if (http->status == RIZZ_HTTP_FAILED || http->status_code != 200) {
+        ++hb->num_failed;
+    }
+    hb->total_size += (int64_t)http->response_size;
+
+    if (++hb->num_done == hb->count) {
+        double elapsed = sx_tm_sec(sx_tm_since(hb->start_tm));
+        rizz_http_stats stats;
+        hb->api->get_stats(&stats);
+        rizz_log_info("http-bench: %d requests in %.1f ms (%.0f req/sec, %.2f MB/s), failed: %d, "
+                      "connections: %u, reused: %u",
+                      hb->count, elapsed * 1000.0, elapsed > 0 ? (double)hb->count / elapsed : 0.0,
+                      elapsed > 0 ? (double)hb->total_size / (1024.0 * 1024.0) / elapsed : 0.0,
+                      hb->num_failed, stats.num_connects - hb->start_stats.num_connects,
+                      stats.num_reuses - hb->start_stats.num_reuses);
+    }
+}
+
+// usage: http-bench url [count]
+// sends `count` GET requests at once and reports the throughput when all of them are finished
+static int bench__http_bench_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    bench__http_bench* hb = &g_http_bench;
+    if (argc < 2) {
+        rizz_log_error("http-bench: url is not provided");
+        return -1;
+    }
+    if (hb->num_done != hb->count) {
+        rizz_log_error("http-bench: already running");
+        return -1;
+    }
+
+    int count = argc > 2 ? sx_toint(argv[2]) : 1000;
+    if (count <= 0) {
+        return -1;
+    }
+
+    rizz_api_http* api = the_plugin->get_api(RIZZ_API_HTTP, 0);
+    *hb = (bench__http_bench){ .start_tm = sx_tm_now(), .count = count, .api = api };
+    api->get_stats(&hb->start_stats);
+    for (int i = 0; i < count; i++) {
+        api->get_cb(argv[1], bench__http_bench_cb, NULL);
+    }
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// http-download
+static void bench__http_download_progress_cb(const char* url, int64_t downloaded, int64_t total,
+                                             void* user)
+{
+    sx_unused(user);
+    if (total > 0) {
+        rizz_log_debug("http-download: %s: %.1f%% (%lld/%lld)", url,
+                       100.0 * (double)downloaded / (double)total, (long long)downloaded,
+                       (long long)total);
+    } else {
+        rizz_log_debug("http-download: %s: %lld", url, (long long)downloaded);
+    }
+}
+
+static void bench__http_download_cb(const rizz_http_state* http, void* user)
+{
+    uint64_t start_tm = (uint64_t)(uintptr_t)user;
+    if (http->status == RIZZ_HTTP_COMPLETED) {
+        double elapsed = sx_tm_sec(sx_tm_since(start_tm));
+        rizz_log_info("http-download: finished in %.2f s, %lld bytes (%.2f MB/s)", elapsed,
+                      (long long)http->response_size,
+                      elapsed > 0 ? (double)http->response_size / (1024.0 * 1024.0) / elapsed : 0.0);
+    } else {
+        rizz_log_error("http-download: failed (%d %s)", http->status_code,
+                       http->reason_phrase ? http->reason_phrase : "");
+    }
+}
+
+// usage: http-download url filepath
+// downloads `url` into `filepath` (vfs path) and reports the throughput. an interrupted download of
+// the same url is resumed
+static int bench__http_download_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    if (argc < 3) {
+        rizz_log_error("http-download: url or file path is not provided");
+        return -1;
+    }
+
+    rizz_api_http* api = the_plugin->get_api(RIZZ_API_HTTP, 0);
+    api->download(argv[1], argv[2], 0, bench__http_download_progress_cb, bench__http_download_cb,
+                  (void*)(uintptr_t)sx_tm_now());
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// debug3d-bench
+// like font-bench, runs from the plugin's step event: `num_frames` frames that draw `count`
+// primitives (boxes, aabbs and lines) with a draw_xxx call for each, then the same primitives with
+// queue_xxx calls and a single flush
+typedef struct bench__debug3d_bench {
+    bool running;
+    bool queued;
+    int count;
+    int num_frames;
+    int frame;
+    rizz_api_3d* api;
+    double ms[2];       // cpu time of all frames, immediate and queued
+    int num_draws[2];
+} bench__debug3d_bench;
+
+RIZZ_STATE static bench__debug3d_bench g_debug3d_bench;
+
+static void bench__debug3d_bench_step(void)
+{
+    bench__debug3d_bench* db = &g_debug3d_bench;
+    if (!db->running) {
+        return;
+    }
+
+    rizz_api_3d* api = db->api;
+    float w = (float)the_app->width();
+    float h = (float)the_app->height();
+    sx_mat4 proj = sx_mat4_perspectiveFOV(sx_torad(60.0f), w / h, 0.1f, 500.0f,
+                                          the_gfx->GL_family());
+    sx_mat4 view = sx_mat4_view_lookat(sx_vec3f(0, -60.0f, 40.0f), SX_VEC3_ZERO, SX_VEC3_UNITZ);
+    sx_mat4 vp = sx_mat4_mul(&proj, &view);
+    sg_pass_action pass_action = { .colors[0] = { .action = SG_ACTION_LOAD },
+                                   .depth = { .action = SG_ACTION_LOAD },
+                                   .stencil = { .action = SG_ACTION_LOAD } };
+
+    the_gfx->staged.begin(bench__stage());
+    the_gfx->staged.begin_default_pass(&pass_action, the_app->width(), the_app->height());
+
+    // primitives on a grid in xy plane, one api call per primitive
+    int side = (int)sx_ceil(sx_sqrt((float)db->count));
+    float half = (float)side * 0.5f;
+    uint64_t start_tm = sx_tm_now();
+    for (int i = 0; i < db->count; i++) {
+        sx_vec3 pos = sx_vec3f((float)(i % side) - half, (float)(i / side) - half, 0);
+        sx_color tint = sx_color4u((uint8_t)(i * 37), (uint8_t)(i * 91), 200, 255);
+        switch (i % 3) {
+        case 0: {
+            sx_box box = sx_box_setpne(pos, sx_vec3splat(0.3f));
+            if (db->queued) {
+                api->debug.queue_boxes(&box, 1, RIZZ_3D_DEBUG_MAPTYPE_WHITE, &tint);
+            } else {
+                api->debug.draw_boxes(&box, 1, &vp, RIZZ_3D_DEBUG_MAPTYPE_WHITE, &tint);
+            }
+            break;
+        }
+        case 1: {
+            sx_aabb aabb = sx_aabbf(pos.x - 0.4f, pos.y - 0.4f, pos.z - 0.4f, pos.x + 0.4f,
+                                    pos.y + 0.4f, pos.z + 0.4f);
+            if (db->queued) {
+                api->debug.queue_aabbs(&aabb, 1, &tint);
+            } else {
+                api->debug.draw_aabbs(&aabb, 1, &vp, &tint);
+            }
+            break;
+        }
+        default: {
+            rizz_3d_debug_line line = { .p0 = pos, .p1 = sx_vec3_add(pos, sx_vec3f(0, 0, 1.0f)) };
+            if (db->queued) {
+                api->debug.queue_lines(1, &line, &tint);
+            } else {
+                api->debug.draw_lines(1, &line, &vp, &tint);
+            }
+            break;
+        }
+        }
+    }
+    if (db->queued) {
+        api->debug.flush(&vp);
+    }
+    db->ms[db->queued ? 1 : 0] += sx_tm_ms(sx_tm_since(start_tm));
+
+    rizz_3d_debug_stats stats;
+    api->debug.get_stats(&stats);
+    db->num_draws[db->queued ? 1 : 0] += stats.num_draws;
+
+    the_gfx->staged.end_pass();
+    the_gfx->staged.end();
+
+    if (++db->frame < db->num_frames) {
+        return;
+    }
+
+    if (!db->queued) {
+        db->queued = true;
+        db->frame = 0;
+    } else {
+        double n = (double)db->num_frames;
+        rizz_log_info("debug3d-bench: %d primitives, %d frames, immediate: %.3f ms (%.0f draws), "
+                      "queued: %.3f ms (%.0f draws) per frame",
+                      db->count, db->num_frames, db->ms[0] / n, (double)db->num_draws[0] / n,
+                      db->ms[1] / n, (double)db->num_draws[1] / n);
+        db->running = false;
+    }
+}
+
+// usage: debug3d-bench [count] [num_frames]
+// CPU time and draw calls per frame of immediate debug3d drawing against the deferred queue
+// needs the 3dtools plugin
+static int bench__debug3d_bench_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    bench__debug3d_bench* db = &g_debug3d_bench;
+    if (db->running) {
+        rizz_log_error("debug3d-bench: already running");
+        return -1;
+    }
+
+    db->api = the_plugin->get_api_byname("3dtools", 0);
+    if (!db->api) {
+        rizz_log_error("debug3d-bench: 3dtools plugin is not loaded");
+        return -1;
+    }
+
+    int count = argc > 1 ? sx_toint(argv[1]) : 3000;
+    int num_frames = argc > 2 ? sx_toint(argv[2]) : 100;
+    if (count <= 0 || num_frames <= 0) {
+        return -1;
+    }
+
+    db->running = true;
+    db->queued = false;
+    db->count = count;
+    db->num_frames = num_frames;
+    db->frame = 0;
+    db->ms[0] = db->ms[1] = 0;
+    db->num_draws[0] = db->num_draws[1] = 0;
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// model-bench
+// loads and unloads the asset `iters` times on the main thread. returns the average load time in ms
+// or -1 if loading failed
+static double bench__asset_load_ms(const char* name, const char* path, const void* params,
+                                   int iters, double* min_ms)
+{
+    double total_ms = 0;
+    *min_ms = SX_FLOAT_MAX;
+    for (int i = 0; i < iters; i++) {
+        uint64_t start_tm = sx_tm_now();
+        rizz_asset asset = the_asset->load(name, path, params, RIZZ_ASSET_LOAD_FLAG_WAIT_ON_LOAD,
+                                           NULL, 0);
+        double ms = sx_tm_ms(sx_tm_since(start_tm));
+        bool ok = asset.id && the_asset->state(asset) == RIZZ_ASSET_STATE_OK;
+        if (asset.id) {
+            the_asset->unload(asset);
+        }
+        if (!ok) {
+            return -1.0;
+        }
+
+        total_ms += ms;
+        *min_ms = sx_min(*min_ms, ms);
+    }
+    return total_ms / (double)iters;
+}
+
+// usage: model-bench gltf_file rmdl_file [iterations]
+// load time of a glTF model against the same model baked to .rmdl. both are loaded with the default
+// layout and without gpu buffers, so bake the model with the default layout (see 3dtools README)
+static int bench__model_bench_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    if (argc < 3) {
+        rizz_log_error("model-bench: gltf or baked model file is not provided");
+        return -1;
+    }
+
+    int iters = argc > 3 ? sx_toint(argv[3]) : 10;
+    if (iters <= 0) {
+        return -1;
+    }
+
+    rizz_model_load_params mparams = { 0 };
+    double gltf_min_ms, baked_min_ms;
+    double gltf_ms = bench__asset_load_ms("model", argv[1], &mparams, iters, &gltf_min_ms);
+    if (gltf_ms < 0) {
+        rizz_log_error("model-bench: loading model '%s' failed (is 3dtools plugin loaded?)",
+                       argv[1]);
+        return -1;
+    }
+    double baked_ms = bench__asset_load_ms("model", argv[2], &mparams, iters, &baked_min_ms);
+    if (baked_ms < 0) {
+        rizz_log_error("model-bench: loading baked model '%s' failed", argv[2]);
+        return -1;
+    }
+
+    rizz_log_info("model-bench: %d loads, gltf: avg: %.2f ms, min: %.2f ms, baked: avg: %.2f ms, "
+                  "min: %.2f ms (%.1fx faster)", iters, gltf_ms, gltf_min_ms, baked_ms,
+                  baked_min_ms, baked_min_ms > 0 ? gltf_min_ms / baked_min_ms : 0);
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// mesh-bench
+// usage: mesh-bench gltf_file [num_lods] [iterations]
+// import cost of the mesh optimizations and LOD generation of a glTF model: load time without
+// optimizations, with all optimizations and with optimizations + `num_lods` LODs. then reports the
+// index counts, ACMR and vertex sizes before/after (summed over meshes) and the index count of LODs
+static int bench__mesh_bench_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    if (argc < 2) {
+        rizz_log_error("mesh-bench: gltf file is not provided");
+        return -1;
+    }
+
+    rizz_api_3d* api = the_plugin->get_api_byname("3dtools", 0);
+    if (!api) {
+        rizz_log_error("mesh-bench: 3dtools plugin is not loaded");
+        return -1;
+    }
+
+    int num_lods = argc > 2 ? sx_toint(argv[2]) : 3;
+    int iters = argc > 3 ? sx_toint(argv[3]) : 5;
+    if (num_lods < 0 || iters <= 0) {
+        return -1;
+    }
+    num_lods = sx_min(num_lods, RIZZ_MODEL_MAX_LODS - 1);
+
+    rizz_model_load_params mparams[3] = {
+        { .optimize_flags = RIZZ_MODEL_OPTIMIZE_NONE },
+        { .optimize_flags = RIZZ_MODEL_OPTIMIZE_ALL },
+        { .optimize_flags = RIZZ_MODEL_OPTIMIZE_ALL, .num_lods = num_lods, .lod_ratio = 0.5f }
+    };
+    double ms[3];
+    for (int i = 0; i < 3; i++) {
+        double min_ms;
+        ms[i] = bench__asset_load_ms("model", argv[1], &mparams[i], iters, &min_ms);
+        if (ms[i] < 0) {
+            rizz_log_error("mesh-bench: loading model '%s' failed", argv[1]);
+            return -1;
+        }
+    }
+
+    // load once more to read the stats of optimized meshes and their LODs
+    rizz_asset asset =
+        the_asset->load("model", argv[1], &mparams[2], RIZZ_ASSET_LOAD_FLAG_WAIT_ON_LOAD, NULL, 0);
+    if (!asset.id || the_asset->state(asset) != RIZZ_ASSET_STATE_OK) {
+        if (asset.id) {
+            the_asset->unload(asset);
+        }
+        return -1;
+    }
+
+    const rizz_model* model = api->model.get(asset);
+    rizz_model_mesh_stats total = { 0 };
+    double src_misses = 0, misses = 0;    // to weight ACMR of meshes by triangle count
+    int lod_indices[RIZZ_MODEL_MAX_LODS] = { 0 };
+    for (int i = 0; i < model->num_meshes; i++) {
+        const rizz_model_mesh* mesh = &model->meshes[i];
+        const rizz_model_mesh_stats* stats = &mesh->stats;
+        total.src_num_indices += stats->src_num_indices;
+        total.num_indices += stats->num_indices;
+        total.src_vertex_bytes += stats->src_vertex_bytes;
+        total.vertex_bytes += stats->vertex_bytes;
+        src_misses += (double)stats->src_acmr * (double)(stats->src_num_indices / 3);
+        misses += (double)stats->acmr * (double)(stats->num_indices / 3);
+
+        for (int k = 0; k < mesh->num_submeshes; k++) {
+            const rizz_model_submesh* submesh = &mesh->submeshes[k];
+            for (int l = 0; l < submesh->num_lods; l++) {
+                lod_indices[l] += submesh->lods[l].num_indices;
+            }
+        }
+    }
+    int num_meshes = model->num_meshes;
+    the_asset->unload(asset);
+
+    rizz_log_info("mesh-bench: '%s', %d meshes, %d loads, load: no optimization: %.2f ms, "
+                  "optimized: %.2f ms, optimized + %d lods: %.2f ms", argv[1], num_meshes, iters,
+                  ms[0], ms[1], num_lods, ms[2]);
+    rizz_log_info("mesh-bench: indices: %d -> %d, acmr: %.3f -> %.3f, vertex bytes: %d -> %d, "
+                  "lod indices: %d, %d, %d, %d", total.src_num_indices, total.num_indices,
+                  total.src_num_indices > 0 ? src_misses / (double)(total.src_num_indices / 3) : 0,
+                  total.num_indices > 0 ? misses / (double)(total.num_indices / 3) : 0,
+                  total.src_vertex_bytes, total.vertex_bytes, lod_indices[0], lod_indices[1],
+                  lod_indices[2], lod_indices[3]);
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// atlas-bench
+// usage: atlas-bench json_file ratlas_file [iterations]
+// load time of a json atlas against the same atlas baked to .ratlas. atlas textures are loaded
+// asynchronously and unloaded before they are read, so only the atlas data is measured
+static int bench__atlas_bench_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    if (argc < 3) {
+        rizz_log_error("atlas-bench: json or baked atlas file is not provided");
+        return -1;
+    }
+
+    int iters = argc > 3 ? sx_toint(argv[3]) : 10;
+    if (iters <= 0) {
+        return -1;
+    }
+
+    rizz_atlas_load_params aparams = { 0 };
+    double json_min_ms, baked_min_ms;
+    double json_ms = bench__asset_load_ms("atlas", argv[1], &aparams, iters, &json_min_ms);
+    if (json_ms < 0) {
+        rizz_log_error("atlas-bench: loading atlas '%s' failed (is 2dtools plugin loaded?)", argv[1]);
+        return -1;
+    }
+    double baked_ms = bench__asset_load_ms("atlas", argv[2], &aparams, iters, &baked_min_ms);
+    if (baked_ms < 0) {
+        rizz_log_error("atlas-bench: loading baked atlas '%s' failed", argv[2]);
+        return -1;
+    }
+
+    rizz_log_info("atlas-bench: %d loads, json: avg: %.2f ms, min: %.2f ms, baked: avg: %.2f ms, "
+                  "min: %.2f ms (%.1fx faster)", iters, json_ms, json_min_ms, baked_ms,
+                  baked_min_ms, baked_min_ms > 0 ? json_min_ms / baked_min_ms : 0);
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+static void bench__register_commands(void)
+{
+    the_core->register_console_command("str-check", bench__str_check_command, NULL, NULL);
+    the_core->register_console_command("str-bench", bench__str_bench_command, NULL, NULL);
+    the_core->register_console_command("log-stress", bench__log_stress_command, NULL, NULL);
+    the_core->register_console_command("tls-bench", bench__tls_bench_command, NULL, NULL);
+    the_core->register_console_command("hashtbl-bench", bench__hashtbl_bench_command, NULL, NULL);
+    the_core->register_console_command("queue-bench", bench__queue_bench_command, NULL, NULL);
+    the_core->register_console_command("handle-bench", bench__handle_bench_command, NULL, NULL);
+    the_core->register_console_command("strintern-bench", bench__strintern_bench_command, NULL,
+                                       NULL);
+    the_core->register_console_command("cull-bench", bench__cull_bench_command, NULL, NULL);
+    the_core->register_console_command("font-bench", bench__font_bench_command, NULL, NULL);
+    the_core->register_console_command("basis-bench", bench__basis_bench_command, NULL, NULL);
+    the_core->register_console_command("mix-bench", bench__mix_bench_command, NULL, NULL);
+    the_core->register_console_command("stream-bench", bench__stream_bench_command, NULL, NULL);
+    the_core->register_console_command("http-bench", bench__http_bench_command, NULL, NULL);
+    the_core->register_console_command("http-download", bench__http_download_command, NULL, NULL);
+    the_core->register_console_command("debug3d-bench", bench__debug3d_bench_command, NULL, NULL);
+    the_core->register_console_command("model-bench", bench__model_bench_command, NULL, NULL);
+    the_core->register_console_command("mesh-bench", bench__mesh_bench_command, NULL, NULL);
+    the_core->register_console_command("atlas-bench", bench__atlas_bench_command, NULL, NULL);
+}
+
+rizz_plugin_decl_main(bench, plugin, e)
+{
+    switch (e) {
+    case RIZZ_PLUGIN_EVENT_STEP:
+        bench__font_bench_step();
+        bench__snd_bench_step();
+        bench__debug3d_bench_step();
+        break;
+    case RIZZ_PLUGIN_EVENT_INIT:
+        the_plugin = plugin->api;
+        the_core = the_plugin->get_api(RIZZ_API_CORE, 0);
+        the_app = the_plugin->get_api(RIZZ_API_APP, 0);
+        the_gfx = the_plugin->get_api(RIZZ_API_GFX, 0);
+        the_asset = the_plugin->get_api(RIZZ_API_ASSET, 0);
+        bench__register_commands();
+        break;
+    case RIZZ_PLUGIN_EVENT_LOAD:
+        // callbacks have moved to the reloaded module, registering again replaces them
+        bench__register_commands();
+        break;
+    case RIZZ_PLUGIN_EVENT_UNLOAD:
+        break;
+    case RIZZ_PLUGIN_EVENT_SHUTDOWN:
+        if (g_font_bench.font.id) {
+            the_asset->unload(g_font_bench.font);
+        }
+        if (g_snd_bench.snd.id) {
+            the_asset->unload(g_snd_bench.snd);
+        }
+        break;
+    }
+
+    return 0;
+}
+
+rizz_plugin_implement_info(bench, 1000, "benchmarks and self-tests as console commands", NULL, 0);
@@ -1857,6 +1857,25 @@ static void imgui__graphics_debugger(const rizz_gfx_trace_info* info, bool* p_op
                     (float)((double)info->buffer_size / (double)info->buffer_peak), 1.0f,
                     sx_vec2f(-1.0f, 14.0f), size_text, peak_text);
 
+                if (info->num_streamed_textures > 0) {
+                    the__imgui.Separator();
+                    sx_snprintf(size_text, sizeof(size_text), "%$.2d", info->stream_resident_size);
+                    if (info->stream_budget > 0) {
+                        sx_snprintf(peak_text, sizeof(peak_text), "%$.2d", info->stream_budget);
+                    } else {
+                        sx_strcpy(peak_text, sizeof(peak_text), "Unlimited");
+                    }
+                    the__imgui.Text("Streaming");
+                    the__imgui.SameLine(100.0f, -1);
+                    imgui__dual_progress_bar(
+                        info->stream_budget > 0 ? (float)((double)info->stream_resident_size / (double)info->stream_budget) : 0, 
+                        1.0f, sx_vec2f(-1.0f, 14.0f), size_text, peak_text);
+                    imgui__label_spacing(text_offset, -1.0f, "Streamed", "%d", info->num_streamed_textures);
+                    imgui__label_spacing(text_offset, -1.0f, "Reads", "%d", info->num_stream_reads);
+                    imgui__label_spacing(text_offset, -1.0f, "Mip ins", "%lld", (long long)info->num_stream_ins);
+                    imgui__label_spacing(text_offset, -1.0f, "Evictions", "%lld", (long long)info->num_stream_evicts);
+                }
+
                 the__imgui.EndTabItem();
             }
 
@@ -126,6 +126,9 @@ static void rizz__app_message_box(const char* text)
 
 static long WINAPI rizz__app_generate_crash_dump(EXCEPTION_POINTERS* except)
 {
+    // write the logs that are still queued, they are usually the most useful ones
+    rizz__log_flush();
+
     if (g_app.crash_cb) {
         g_app.crash_cb(except, g_app.crash_user_data);
     }
@@ -250,6 +253,8 @@ static uint32_t rizz__app_convert_core_flags(const char* value)
         return RIZZ_CORE_FLAG_TRACE_TEMP_ALLOCATOR;
     } else if (sx_strequalnocase(value, "HOT_RELOAD_PLUGINS")) {
         return RIZZ_CORE_FLAG_HOT_RELOAD_PLUGINS;
+    } else if (sx_strequalnocase(value, "LOG_BINARY")) {
+        return RIZZ_CORE_FLAG_LOG_BINARY;
     } else {
         return 0;
     }
@@ -349,6 +354,9 @@ static void rizz__app_load_ini(const char* filename, rizz_config* conf)
                 id = sx_ini_find_property(ini, rizz_id, "texture_aniso", 0);
                 if (id != -1) 
                     conf->texture_aniso = sx_toint(sx_ini_property_value(ini, rizz_id, id));
+                id = sx_ini_find_property(ini, rizz_id, "texture_stream_budget", 0);
+                if (id != -1) 
+                    conf->texture_stream_budget = sx_toint(sx_ini_property_value(ini, rizz_id, id));
                 id = sx_ini_find_property(ini, rizz_id, "texture_filter_min", 0);
                 if (id != -1) 
                     conf->texture_filter_min = rizz__app_convert_sg_filter(sx_ini_property_value(ini, rizz_id, id));
@@ -715,6 +723,7 @@ sapp_desc sokol_main(int argc, char* argv[])
         { "crash-dump", 'd', SX_CMDLINE_OPTYPE_FLAG_SET, &crash_dump, 1, "Create crash dump file on program exceptions", 0x0 },
         { "first-mip", 'M', SX_CMDLINE_OPTYPE_REQUIRED, 0x0, 'M', "Set the first mip of textures. Higher values lower texture sizes (default=0)", 0x0 },
         { "hot-reload-plugins", 'H', SX_CMDLINE_OPTYPE_FLAG_SET, 0x0, 'H', "Hot reload all plugins and game modules", 0x0 },
+        { "decode-log", 'L', SX_CMDLINE_OPTYPE_REQUIRED, 0x0, 'L', "Print a binary log file (LOG_BINARY core flag) and exit", "filepath" },
         { "help", 'h', SX_CMDLINE_OPTYPE_FLAG_SET, &show_help, 1, "Show this help message", 0x0 },
         SX_CMDLINE_OPT_END
     };
@@ -747,6 +756,9 @@ sapp_desc sokol_main(int argc, char* argv[])
         case 'M':
             first_mip = sx_toint(arg);
             break;
+        case 'L':
+            exit(rizz__log_decode_file(arg) ? 0 : -1);
+            break;
         default:
             break;
         }
@@ -52,6 +52,7 @@ typedef struct rizz__asset {
     uint32_t tags;
     rizz_asset_load_flags load_flags;
     rizz_asset_state state;
+    sx_handle_t* SX_ARRAY waiters;  // coroutines that await this asset, handles to g_asset.waiter_handles
 } rizz__asset;
 
 // Resources are the actual files on the file-system
@@ -96,6 +97,15 @@ typedef struct rizz__asset_group {
     rizz_asset* SX_ARRAY assets;   
 } rizz__asset_group;
 
+// coroutine that awaits an asset or group (rizz__asset_await)
+// the waiter is added to every loading asset that it waits for, and is resumed when the last one is
+// finished, failed or unloaded. group waiters are also resumed when the group is unloaded or deleted
+typedef struct rizz__asset_waiter {
+    rizz_asset_group group;     // =0 if the coroutine awaits a single asset
+    sx_coro_handle coro;
+    int num_loading;            // assets that are still loading
+} rizz__asset_waiter;
+
 typedef struct rizz__asset_lib {
     sx_alloc* alloc;    // allocator passed on init
     char asset_db_file[RIZZ_MAX_PATH];
@@ -114,6 +124,8 @@ typedef struct rizz__asset_lib {
     rizz__asset_group* groups;
     sx_handle_pool* group_handles;
     rizz_asset_group cur_group;
+    rizz__asset_waiter* SX_ARRAY waiters;       // indexed by waiter_handles
+    sx_handle_pool* waiter_handles;
     sx_lock_t assets_lk;    // used for locking assets-array
 } rizz__asset_lib;
 
@@ -219,6 +231,39 @@ static bool rizz__asset_checkandfix_asset_type(sx_mem_block* mem, const char* fi
     return true;
 }
 
+static void rizz__asset_resume_waiter(sx_handle_t handle)
+{
+    rizz__coro_resume(g_asset.waiters[sx_handle_index(handle)].coro);
+    sx_handle_del(g_asset.waiter_handles, handle);
+}
+
+// called when the asset is not loading anymore (finished, failed or unloaded)
+static void rizz__asset_loading_done(rizz_asset asset)
+{
+    rizz__asset* a = &g_asset.assets[sx_handle_index(asset.id)];
+    for (int i = 0, c = sx_array_count(a->waiters); i < c; i++) {
+        // group waiters may already be resumed by unloading or deleting the group
+        sx_handle_t handle = a->waiters[i];
+        if (sx_handle_valid(g_asset.waiter_handles, handle) &&
+            --g_asset.waiters[sx_handle_index(handle)].num_loading == 0) {
+            rizz__asset_resume_waiter(handle);
+        }
+    }
+    sx_array_free(g_asset.alloc, a->waiters);
+    a->waiters = NULL;
+}
+
+static void rizz__asset_resume_group_waiters(rizz_asset_group group)
+{
+    for (int i = 0; i < g_asset.waiter_handles->count; i++) {
+        sx_handle_t handle = sx_handle_at(g_asset.waiter_handles, i);
+        if (g_asset.waiters[sx_handle_index(handle)].group.id == group.id) {
+            rizz__asset_resume_waiter(handle);
+            --i;
+        }
+    }
+}
+
 // async callback
 static void rizz__asset_on_read(const char* path, sx_mem_block* mem, void* user)
 {
@@ -241,6 +286,7 @@ static void rizz__asset_on_read(const char* path, sx_mem_block* mem, void* user)
             a->obj = amgr->failed_obj;
 
             sx_array_pop(g_asset.async_reqs, async_req_idx);
+            rizz__asset_loading_done(asset);
         }
         return;
     } else if (async_req_idx == -1) {
@@ -288,6 +334,12 @@ static void rizz__asset_on_read(const char* path, sx_mem_block* mem, void* user)
     if (!load_data.obj.id) {
         rizz__asset_errmsg(res->path, res->real_path, "preparing");
         sx_mem_destroy_block(mem);
+
+        // `on_prepare` may load dependencies and resize the assets array
+        a = &g_asset.assets[sx_handle_index(asset.id)];
+        a->state = RIZZ_ASSET_STATE_FAILED;
+        a->obj = amgr->failed_obj;
+        rizz__asset_loading_done(asset);
         return;
     }
 
@@ -660,6 +712,9 @@ static rizz_asset rizz__asset_load_hashed(uint32_t name_hash, const char* path,
                 }
             }
 
+            // reloads may finish assets that are still loading asynchronously
+            rizz__asset_loading_done(asset);
+
             // do we have extra work in reload?
             if (flags & RIZZ_ASSET_LOAD_FLAG_RELOAD) {
                 amgr->callbacks.on_reload(asset, a->dead_obj, obj_alloc);
@@ -694,6 +749,9 @@ bool rizz__asset_init(const char* dbfile, const char* variation)
     g_asset.group_handles = sx_handle_create_pool(g_asset.alloc, 32);
     sx_assert(g_asset.group_handles);
 
+    g_asset.waiter_handles = sx_handle_create_pool(g_asset.alloc, 32);
+    sx_assert(g_asset.waiter_handles);
+
     g_asset.hasher = sx_hash_create_xxh32(g_asset.alloc);
     sx_assert(g_asset.hasher);
 
@@ -711,6 +769,7 @@ void rizz__asset_release()
         for (int i = 0; i < g_asset.asset_handles->count; i++) {
             sx_handle_t handle = sx_handle_at(g_asset.asset_handles, i);
             rizz__asset* a = &g_asset.assets[sx_handle_index(handle)];
+            sx_array_free(alloc, a->waiters);
             if (a->state == RIZZ_ASSET_STATE_OK) {
                 sx_assert(a->resource_id);
                 rizz__log_warn("un-released asset: %s (ref_count = %d)",
@@ -738,6 +797,7 @@ void rizz__asset_release()
     sx_array_free(alloc, g_asset.asset_name_hashes);
     sx_array_free(alloc, g_asset.resources);
     sx_array_free(alloc, g_asset.groups);
+    sx_array_free(alloc, g_asset.waiters);
     sx_array_free(alloc, g_asset.async_reqs);
 
     if (g_asset.asset_handles)
@@ -748,6 +808,8 @@ void rizz__asset_release()
         sx_hashtbl_destroy(g_asset.resource_tbl, alloc);
     if (g_asset.group_handles)
         sx_handle_destroy_pool(g_asset.group_handles, alloc);
+    if (g_asset.waiter_handles)
+        sx_handle_destroy_pool(g_asset.waiter_handles, alloc);
 
     if (g_asset.hasher)
         sx_hash_destroy_xxh32(g_asset.hasher, g_asset.alloc);
@@ -802,6 +864,7 @@ void rizz__asset_update()
                 sx_assert(!(ajob->lparams.flags & RIZZ_ASSET_LOAD_FLAG_RELOAD));
 
                 sx_mem_destroy_block(ajob->mem);
+                rizz__asset_loading_done(ajob->asset);
 
                 rizz__asset_job_remove_list(&g_asset.async_job_list, &g_asset.async_job_list_last, ajob);
                 sx_free(g_asset.alloc, ajob);
@@ -812,6 +875,50 @@ void rizz__asset_update()
     }
 }
 
+bool rizz__asset_valid(rizz_asset asset)
+{
+    return asset.id && sx_handle_valid(g_asset.asset_handles, asset.id);
+}
+
+// returns true if the coroutine must wait, false if loading is already finished
+// the waiter is only touched again when one of the awaited assets stops loading, or the group is removed
+bool rizz__asset_await(rizz_asset asset, rizz_asset_group group, sx_coro_handle coro)
+{
+    rizz_asset* assets = &asset;
+    int num_assets = 1;
+    if (!asset.id) {
+        if (!sx_handle_valid(g_asset.group_handles, group.id)) {
+            return false;
+        }
+        const rizz__asset_group* g = &g_asset.groups[sx_handle_index(group.id)];
+        assets = g->assets;
+        num_assets = sx_array_count(g->assets);
+    }
+
+    sx_handle_t handle = 0;
+    for (int i = 0; i < num_assets; i++) {
+        // assets of the group may be unloaded one by one
+        if (!sx_handle_valid(g_asset.asset_handles, assets[i].id)) {
+            continue;
+        }
+        rizz__asset* a = &g_asset.assets[sx_handle_index(assets[i].id)];
+        if (a->state != RIZZ_ASSET_STATE_LOADING) {
+            continue;
+        }
+
+        if (!handle) {
+            handle = sx_handle_new_and_grow(g_asset.waiter_handles, g_asset.alloc);
+            sx_assert_always(handle);
+            rizz__asset_waiter waiter = { .group = asset.id ? (rizz_asset_group){ 0 } : group, .coro = coro };
+            sx_array_push_byindex(g_asset.alloc, g_asset.waiters, waiter, sx_handle_index(handle));
+        }
+        ++g_asset.waiters[sx_handle_index(handle)].num_loading;
+        sx_array_push(g_asset.alloc, a->waiters, handle);
+    }
+
+    return handle != 0;
+}
+
 static rizz_asset rizz__asset_load(const char* name, const char* path, const void* params,
                                    rizz_asset_load_flags flags, const sx_alloc* alloc,
                                    uint32_t tags)
@@ -923,6 +1030,9 @@ static rizz_asset rizz__asset_load_from_mem(const char* name, const char* path_a
                 }
             }
 
+            // reloads may finish assets that are still loading asynchronously
+            rizz__asset_loading_done(asset);
+
             // do we have extra work in reload?
             if (flags & RIZZ_ASSET_LOAD_FLAG_RELOAD) {
                 amgr->callbacks.on_reload(asset, a->dead_obj, alloc);
@@ -968,6 +1078,7 @@ static void rizz__asset_unload(rizz_asset asset)
         }
 
         // release internal object
+        rizz__asset_loading_done(asset);
         rizz__asset_mgr* amgr = &g_asset.asset_mgrs[a->asset_mgr_id];
         rizz__asset_destroy_delete(asset, amgr);
     }
@@ -1036,6 +1147,14 @@ static const char* rizz__asset_path(rizz_asset asset)
     return g_asset.resources[rizz_to_index(a->resource_id)].path;
 }
 
+// resolves the path on disk (asset-db and variation) of an asset path, used by loaders that
+// need to read the file again after loading (texture streaming)
+const char* rizz__asset_real_path(const char* path)
+{
+    int res_idx = sx_hashtbl_find_get(g_asset.resource_tbl, sx_hash_fnv32_str(path), -1);
+    return res_idx != -1 ? g_asset.resources[res_idx].real_path : path;
+}
+
 static const char* rizz__asset_typename(rizz_asset asset)
 {
     sx_assert_always(sx_handle_valid(g_asset.asset_handles, asset.id));
@@ -1301,6 +1420,8 @@ static void rizz__asset_group_delete(rizz_asset_group group)
 {
     sx_assert_always(sx_handle_valid(g_asset.group_handles, group.id));
 
+    rizz__asset_resume_group_waiters(group);
+
     int index = sx_handle_index(group.id);
     rizz__asset_group* g = &g_asset.groups[index];
     sx_array_free(g_asset.alloc, g->assets);
@@ -1319,6 +1440,9 @@ static void rizz__asset_group_unload(rizz_asset_group group)
             rizz__asset_unload(asset);
     }
     sx_array_clear(g->assets);
+
+    // assets that are shared with other groups may still be loading
+    rizz__asset_resume_group_waiters(group);
 }
 
 static int rizz__asset_group_gather(rizz_asset_group group, rizz_asset* out_handles,
@@ -3,7 +3,10 @@
 // License: https://github.com/septag/rizz#license-bsd-2-clause
 //
 #include "internal.h"
+#include "sx/allocator.h"
 #include "sx/math-vec.h"
+#include "sx/simd.h"
+#include "sx/string.h"
 
 static void rizz__cam_init(rizz_camera* cam, float fov_deg, sx_rect viewport, float fnear, float ffar)
 {
@@ -194,6 +197,272 @@ static void rizz__cam_fps_strafe(rizz_camera_fps* fps, float strafe)
     fps->cam.pos = sx_vec3_add(fps->cam.pos, sx_vec3_mulf(fps->cam.right, strafe));
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// culling
+#define RIZZ__CULL_BLOCK_SIZE 1024          // objects per job range, must be a multiple of 32 (bitmask word)
+#define RIZZ__CULL_MIN_JOB_OBJECTS 8192     // smaller batches are culled on the calling thread
+
+typedef struct rizz__cull_data {
+    const sx_plane* planes;
+    const sx_vec3* centers;
+    const float* radiuss;
+    const sx_aabb* aabbs;
+    const rizz_camera_spheres_soa* spheres_soa;
+    const rizz_camera_aabbs_soa* aabbs_soa;
+    int count;
+    uint32_t* visibility;
+    int* visible_indices;
+    int* block_counts;
+} rizz__cull_data;
+
+typedef struct rizz__cull_planes {
+    sx_simd_t nx[_RIZZ_CAMERA_VIEWPLANE_COUNT];
+    sx_simd_t ny[_RIZZ_CAMERA_VIEWPLANE_COUNT];
+    sx_simd_t nz[_RIZZ_CAMERA_VIEWPLANE_COUNT];
+    sx_simd_t d[_RIZZ_CAMERA_VIEWPLANE_COUNT];
+    bool pos[_RIZZ_CAMERA_VIEWPLANE_COUNT][3];    // sign of the normal, picks the p-vertex of boxes
+} rizz__cull_planes;
+
+// returns a 4bit mask of the objects that are outside of the frustum
+static inline int rizz__cull_spheres4(const rizz__cull_planes* planes, sx_simd_t cx, sx_simd_t cy,
+                                      sx_simd_t cz, sx_simd_t r)
+{
+    sx_simd_t neg_r = sx_simd_sub(sx_simd_zero(), r);
+    sx_simd_t outside = sx_simd_zero();
+    for (int i = 0; i < _RIZZ_CAMERA_VIEWPLANE_COUNT; i++) {
+        sx_simd_t dist = sx_simd_madd(cx, planes->nx[i], 
+                         sx_simd_madd(cy, planes->ny[i], 
+                         sx_simd_madd(cz, planes->nz[i], planes->d[i])));
+        outside = sx_simd_or(outside, sx_simd_cmplt(dist, neg_r));
+    }
+    return sx_simd_movemask(outside);
+}
+
+// tests the most positive corner of each box against the planes (p-vertex)
+// vmin/vmax: x, y, z of the 4 boxes
+static inline int rizz__cull_aabbs4(const rizz__cull_planes* planes, const sx_simd_t vmin[3],
+                                    const sx_simd_t vmax[3])
+{
+    sx_simd_t outside = sx_simd_zero();
+    sx_simd_t zero = sx_simd_zero();
+    for (int i = 0; i < _RIZZ_CAMERA_VIEWPLANE_COUNT; i++) {
+        sx_simd_t px = planes->pos[i][0] ? vmax[0] : vmin[0];
+        sx_simd_t py = planes->pos[i][1] ? vmax[1] : vmin[1];
+        sx_simd_t pz = planes->pos[i][2] ? vmax[2] : vmin[2];
+        sx_simd_t dist = sx_simd_madd(px, planes->nx[i], 
+                         sx_simd_madd(py, planes->ny[i], 
+                         sx_simd_madd(pz, planes->nz[i], planes->d[i])));
+        outside = sx_simd_or(outside, sx_simd_cmplt(dist, zero));
+    }
+    return sx_simd_movemask(outside);
+}
+
+#define RIZZ__CULL_GATHER4(_arr, _idx) \
+    sx_simd_load4((_arr)[(_idx)[0]], (_arr)[(_idx)[1]], (_arr)[(_idx)[2]], (_arr)[(_idx)[3]])
+#define RIZZ__CULL_GATHER4_FIELD(_arr, _field, _idx)                                                \
+    sx_simd_load4((_arr)[(_idx)[0]]._field, (_arr)[(_idx)[1]]._field, (_arr)[(_idx)[2]]._field, \
+                  (_arr)[(_idx)[3]]._field)
+
+// loads objects idx[0..3] from the input layout and tests them. `i` is the first index of the group,
+// `full` means all 4 lanes are valid objects, so SoA arrays can be read with a single aligned load
+static inline int rizz__cull_test4(const rizz__cull_data* data, const rizz__cull_planes* planes, int i,
+                                   const int idx[4], bool full)
+{
+    if (data->spheres_soa) {
+        const rizz_camera_spheres_soa* soa = data->spheres_soa;
+        if (full) {
+            return rizz__cull_spheres4(planes, sx_simd_load(soa->x + i), sx_simd_load(soa->y + i),
+                                       sx_simd_load(soa->z + i), sx_simd_load(soa->r + i));
+        }
+        return rizz__cull_spheres4(planes, RIZZ__CULL_GATHER4(soa->x, idx),
+                                   RIZZ__CULL_GATHER4(soa->y, idx), RIZZ__CULL_GATHER4(soa->z, idx),
+                                   RIZZ__CULL_GATHER4(soa->r, idx));
+    } else if (data->aabbs_soa) {
+        const rizz_camera_aabbs_soa* soa = data->aabbs_soa;
+        if (full) {
+            sx_simd_t vmin[3] = { sx_simd_load(soa->xmin + i), sx_simd_load(soa->ymin + i),
+                                  sx_simd_load(soa->zmin + i) };
+            sx_simd_t vmax[3] = { sx_simd_load(soa->xmax + i), sx_simd_load(soa->ymax + i),
+                                  sx_simd_load(soa->zmax + i) };
+            return rizz__cull_aabbs4(planes, vmin, vmax);
+        }
+        sx_simd_t vmin[3] = { RIZZ__CULL_GATHER4(soa->xmin, idx), RIZZ__CULL_GATHER4(soa->ymin, idx),
+                              RIZZ__CULL_GATHER4(soa->zmin, idx) };
+        sx_simd_t vmax[3] = { RIZZ__CULL_GATHER4(soa->xmax, idx), RIZZ__CULL_GATHER4(soa->ymax, idx),
+                              RIZZ__CULL_GATHER4(soa->zmax, idx) };
+        return rizz__cull_aabbs4(planes, vmin, vmax);
+    } else if (data->aabbs) {
+        const sx_aabb* aabbs = data->aabbs;
+        sx_simd_t vmin[3] = { RIZZ__CULL_GATHER4_FIELD(aabbs, xmin, idx),
+                              RIZZ__CULL_GATHER4_FIELD(aabbs, ymin, idx),
+                              RIZZ__CULL_GATHER4_FIELD(aabbs, zmin, idx) };
+        sx_simd_t vmax[3] = { RIZZ__CULL_GATHER4_FIELD(aabbs, xmax, idx),
+                              RIZZ__CULL_GATHER4_FIELD(aabbs, ymax, idx),
+                              RIZZ__CULL_GATHER4_FIELD(aabbs, zmax, idx) };
+        return rizz__cull_aabbs4(planes, vmin, vmax);
+    } else {
+        return rizz__cull_spheres4(planes, RIZZ__CULL_GATHER4_FIELD(data->centers, x, idx),
+                                   RIZZ__CULL_GATHER4_FIELD(data->centers, y, idx),
+                                   RIZZ__CULL_GATHER4_FIELD(data->centers, z, idx),
+                                   RIZZ__CULL_GATHER4(data->radiuss, idx));
+    }
+}
+
+// start must be a multiple of 32, so each range owns it's visibility words
+// visible indices are written from `start` and compacted later (see rizz__cull)
+static int rizz__cull_range(const rizz__cull_data* data, int start, int end)
+{
+    sx_assert((start & 31) == 0);
+
+    rizz__cull_planes planes;
+    for (int i = 0; i < _RIZZ_CAMERA_VIEWPLANE_COUNT; i++) {
+        const sx_plane* plane = &data->planes[i];
+        planes.nx[i] = sx_simd_splat1(plane->normal[0]);
+        planes.ny[i] = sx_simd_splat1(plane->normal[1]);
+        planes.nz[i] = sx_simd_splat1(plane->normal[2]);
+        planes.d[i] = sx_simd_splat1(plane->dist);
+        planes.pos[i][0] = plane->normal[0] >= 0;
+        planes.pos[i][1] = plane->normal[1] >= 0;
+        planes.pos[i][2] = plane->normal[2] >= 0;
+    }
+
+    uint32_t* visibility = data->visibility;
+    int* visible_indices = data->visible_indices ? (data->visible_indices + start) : NULL;
+    if (visibility) {
+        sx_memset(&visibility[start >> 5], 0x0, sizeof(uint32_t)*(((end - start) + 31) >> 5));
+    }
+
+    int num_visible = 0;
+    for (int i = start; i < end; i += 4) {
+        // the last group is padded with the last object, padded lanes are masked out
+        int num_lanes = sx_min(4, end - i);
+        int idx[4] = { i, i + sx_min(1, num_lanes - 1), i + sx_min(2, num_lanes - 1), i + sx_min(3, num_lanes - 1) };
+        int outside = rizz__cull_test4(data, &planes, i, idx, num_lanes == 4);
+        uint32_t mask = (uint32_t)(~outside) & ((1u << num_lanes) - 1);
+        if (visibility) {
+            visibility[i >> 5] |= mask << (i & 31);
+        }
+
+        if (visible_indices) {
+            // branchless compaction, always writes the slot and only advances on visible objects
+            // num_visible never gets ahead of i-start, so the writes stay inside the range
+            for (int k = 0; k < num_lanes; k++) {
+                visible_indices[num_visible] = i + k;
+                num_visible += (int)((mask >> k) & 1);
+            }
+        } else {
+            static const int k_bitcount4[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+            num_visible += k_bitcount4[mask];
+        }
+    }
+
+    return num_visible;
+}
+
+static void rizz__cull_job_cb(int start, int end, int thrd_index, void* user)
+{
+    sx_unused(thrd_index);
+    rizz__cull_data* data = user;
+
+    for (int i = start; i < end; i++) {
+        int block_start = i * RIZZ__CULL_BLOCK_SIZE;
+        int block_end = sx_min(block_start + RIZZ__CULL_BLOCK_SIZE, data->count);
+        data->block_counts[i] = rizz__cull_range(data, block_start, block_end);
+    }
+}
+
+static int rizz__cull(rizz__cull_data* data)
+{
+    int count = data->count;
+    if (count <= 0) {
+        return 0;
+    }
+
+    if (count < RIZZ__CULL_MIN_JOB_OBJECTS) {
+        return rizz__cull_range(data, 0, count);
+    }
+
+    int num_visible = 0;
+    int num_blocks = (count + RIZZ__CULL_BLOCK_SIZE - 1) / RIZZ__CULL_BLOCK_SIZE;
+    const sx_alloc* tmp_alloc = the__core.tmp_alloc_push();
+    sx_scope(the__core.tmp_alloc_pop()) {
+        data->block_counts = sx_malloc(tmp_alloc, sizeof(int)*num_blocks);
+        sx_assert_always(data->block_counts);
+
+        sx_job_t job = the__core.job_dispatch(num_blocks, rizz__cull_job_cb, data, SX_JOB_PRIORITY_HIGH, 0);
+        the__core.job_wait_and_del(job);
+
+        // each block wrote it's visible indices from the start of the block, pack them together
+        for (int i = 0; i < num_blocks; i++) {
+            int block_count = data->block_counts[i];
+            if (data->visible_indices && i > 0 && block_count > 0) {
+                sx_memmove(data->visible_indices + num_visible, data->visible_indices + i*RIZZ__CULL_BLOCK_SIZE,
+                           sizeof(int)*block_count);
+            }
+            num_visible += block_count;
+        }
+    }
+
+    return num_visible;
+}
+
+static int rizz__cull_spheres(const sx_plane frustum[_RIZZ_CAMERA_VIEWPLANE_COUNT], const sx_vec3* centers,
+                              const float* radiuss, int count, uint32_t* visibility, int* visible_indices)
+{
+    sx_assert(centers && radiuss);
+    rizz__cull_data data = { .planes = frustum,
+                             .centers = centers,
+                             .radiuss = radiuss,
+                             .count = count,
+                             .visibility = visibility,
+                             .visible_indices = visible_indices };
+    return rizz__cull(&data);
+}
+
+static int rizz__cull_aabbs(const sx_plane frustum[_RIZZ_CAMERA_VIEWPLANE_COUNT], const sx_aabb* aabbs, 
+                            int count, uint32_t* visibility, int* visible_indices)
+{
+    sx_assert(aabbs);
+    rizz__cull_data data = { .planes = frustum,
+                             .aabbs = aabbs,
+                             .count = count,
+                             .visibility = visibility,
+                             .visible_indices = visible_indices };
+    return rizz__cull(&data);
+}
+
+static int rizz__cull_spheres_soa(const sx_plane frustum[_RIZZ_CAMERA_VIEWPLANE_COUNT],
+                                  const rizz_camera_spheres_soa* spheres, int count, uint32_t* visibility,
+                                  int* visible_indices)
+{
+    sx_assert(spheres && spheres->x && spheres->y && spheres->z && spheres->r);
+    sx_assert((((uintptr_t)spheres->x | (uintptr_t)spheres->y | (uintptr_t)spheres->z |
+                (uintptr_t)spheres->r) & 15) == 0 && "SoA arrays must be 16 byte aligned");
+    rizz__cull_data data = { .planes = frustum,
+                             .spheres_soa = spheres,
+                             .count = count,
+                             .visibility = visibility,
+                             .visible_indices = visible_indices };
+    return rizz__cull(&data);
+}
+
+static int rizz__cull_aabbs_soa(const sx_plane frustum[_RIZZ_CAMERA_VIEWPLANE_COUNT],
+                                const rizz_camera_aabbs_soa* aabbs, int count, uint32_t* visibility,
+                                int* visible_indices)
+{
+    sx_assert(aabbs && aabbs->xmin && aabbs->ymin && aabbs->zmin && aabbs->xmax && aabbs->ymax &&
+              aabbs->zmax);
+    sx_assert((((uintptr_t)aabbs->xmin | (uintptr_t)aabbs->ymin | (uintptr_t)aabbs->zmin |
+                (uintptr_t)aabbs->xmax | (uintptr_t)aabbs->ymax | (uintptr_t)aabbs->zmax) & 15) == 0 &&
+              "SoA arrays must be 16 byte aligned");
+    rizz__cull_data data = { .planes = frustum,
+                             .aabbs_soa = aabbs,
+                             .count = count,
+                             .visibility = visibility,
+                             .visible_indices = visible_indices };
+    return rizz__cull(&data);
+}
+
 rizz_api_camera the__camera = { .init = rizz__cam_init,
                                 .lookat = rizz__cam_lookat,
                                 .location = rizz__cam_location,
@@ -203,6 +472,10 @@ rizz_api_camera the__camera = { .init = rizz__cam_init,
                                 .calc_frustum_points = rizz__calc_frustum_points,
                                 .calc_frustum_points_range = rizz__calc_frustum_points_range,
                                 .calc_frustum_planes = rizz__calc_frustum_planes,
+                                .cull_spheres = rizz__cull_spheres,
+                                .cull_aabbs = rizz__cull_aabbs,
+                                .cull_spheres_soa = rizz__cull_spheres_soa,
+                                .cull_aabbs_soa = rizz__cull_aabbs_soa,
                                 .fps_init = rizz__cam_fps_init,
                                 .fps_lookat = rizz__cam_fps_lookat,
                                 .fps_pitch = rizz__cam_fps_pitch,
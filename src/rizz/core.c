@@ -11,6 +11,7 @@
 #include "sx/allocator.h"
 #include "sx/array.h"
 #include "sx/atomic.h"
+#include "sx/handle.h"
 #include "sx/hash.h"
 #include "sx/jobs.h"
 #include "sx/lockless.h"
@@ -50,6 +51,16 @@ __declspec(dllimport) void __stdcall OutputDebugStringA(const char* lpOutputStri
 
 #define DEFAULT_TMP_SIZE    0xA00000    // 10mb
 
+#define MAX_TLS_SLOTS           64
+#define LOG_RING_SIZE           0x40000     // 256kb per-thread log ring, must be power of two
+#define LOG_MAX_RINGS           128         // maximum number of threads that can use the async log
+#define LOG_MAX_ARGS_SIZE       2048        // packed arguments that are larger are formatted by the caller
+#define LOG_MAX_TEXT_SIZE       8192        // maximum size of a formatted log text
+#define LOG_WRITER_WAIT_MSECS   10          // writer thread flushes the rings at least this often
+#define LOG_FLUSH_TIMEOUT       1.0         // seconds, errors and asserts wait at most this long for the writer
+#define LOG_BINARY_MAGIC        0x474f4c52  // "RLOG"
+#define LOG_BINARY_VERSION      1
+
 #if SX_PLATFORM_WINDOWS || SX_PLATFORM_IOS || SX_PLATFORM_ANDROID
 #   define TERM_COLOR_RESET     ""
 #   define TERM_COLOR_RED       ""
@@ -136,10 +147,11 @@ typedef struct rizz__core_cmd {
     void* user;
 } rizz__core_cmd;
 
+// tls variables are registered to slots, `g_core.tls_vars[slot-1]`
+// each thread keeps the pointers of variables in `tl_tls_slots[slot]`
 typedef struct rizz__tls_var {
     uint32_t name_hash;
     void* user;
-    sx_tls tls;
     void* (*init_cb)(int thread_idx, uint32_t thread_id, void* user);
 } rizz__tls_var;
 
@@ -156,6 +168,98 @@ typedef struct rizz__log_entry_internal {
     uint64_t timestamp;
 } rizz__log_entry_internal;
 
+typedef enum rizz__log_record_flags_ {
+    LOG_RECORD_FLAG_PADDING = 0x1,      // skip to the start of the ring
+    LOG_RECORD_FLAG_FORMATTED = 0x2     // `fmt` is the final text, there are no arguments
+} rizz__log_record_flags_;
+typedef uint8_t rizz__log_record_flags;
+
+// deferred log entry, written by the calling thread and formatted by the log writer thread
+// format string and source path are copied, because they may belong to plugins that get unloaded
+typedef struct rizz__log_record {
+    uint32_t size;          // size of the whole record, aligned to 8 bytes
+    uint8_t type;           // rizz_log_level
+    rizz__log_record_flags flags;
+    uint16_t fmt_len;       // including null terminator
+    uint16_t source_len;    // including null terminator, =0 if there is no source file
+    uint16_t args_size;
+    int line;
+    uint32_t channels;
+    uint64_t timestamp;     // sx_tm_now()
+    // followed by: fmt[fmt_len] + source[source_len] + args[args_size]
+} rizz__log_record;
+
+// binary log files (RIZZ_CORE_FLAG_LOG_BINARY) are a header and a stream of these records
+// strings (format and source files) are written only once in a LOG_BINARY_STRING record
+#define LOG_BINARY_STRING 0xff
+typedef struct rizz__log_binary_record {
+    uint32_t size;
+    uint8_t type;           // rizz_log_level or LOG_BINARY_STRING
+    rizz__log_record_flags flags;
+    uint16_t args_size;
+    uint32_t fmt_id;        // string id of the format, or the id of the string defined by this record
+    uint32_t source_id;     // =0 if there is no source file
+    int line;
+    uint32_t channels;
+    uint64_t time_us;       // since the log start
+    // followed by: args[args_size], or the null-terminated string for LOG_BINARY_STRING records
+} rizz__log_binary_record;
+
+typedef struct rizz__log_binary_header {
+    uint32_t magic;
+    uint32_t version;
+} rizz__log_binary_header;
+
+typedef enum rizz__log_arg_type {
+    LOG_ARG_INT = 1,
+    LOG_ARG_INT64,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_PTR,
+    LOG_ARG_STR,
+} rizz__log_arg_type;
+
+// single-producer (owner thread), single-consumer (log writer thread) ring of log records
+typedef struct rizz__log_ring {
+    sx_align_decl(SX_CACHE_LINE_SIZE, sx_atomic_uint32 head);    // write offset, moved by the producer
+    sx_align_decl(SX_CACHE_LINE_SIZE, sx_atomic_uint32 tail);    // read offset, moved by the writer
+    sx_atomic_uint32 flushed;   // records before this offset are written to the outputs
+    uint32_t tid;
+    uint8_t* buff;
+} rizz__log_ring;
+
+// set while the owner thread of the ring is writing a record, release waits for it before freeing rings
+// kept outside of the rings, so producers never touch a ring that is already freed
+typedef struct rizz__log_ring_busy {
+    sx_align_decl(SX_CACHE_LINE_SIZE, sx_atomic_uint32 value);
+} rizz__log_ring_busy;
+
+// state that is only touched by the log writer thread
+typedef struct rizz__log_writer {
+    FILE* file;
+    FILE* binary_file;
+    char* SX_ARRAY term_buff;
+    char* SX_ARRAY file_buff;
+    uint8_t* SX_ARRAY binary_buff;
+    sx_hashtbl* binary_str_tbl;     // key: hash of string, value: index to binary_strs
+    int* SX_ARRAY binary_strs;      // offset of each string (by id-1) in binary_str_buff
+    char* SX_ARRAY binary_str_buff;
+    rizz_log_entry* SX_ARRAY backend_entries;   // entries for registered backends, pushed once per batch
+    char* SX_ARRAY backend_text;
+} rizz__log_writer;
+
+typedef struct rizz__coro_job_waiter {
+    sx_job_t job;
+    sx_coro_handle coro;
+    bool done;      // set by the worker thread that finishes the job (rizz__job_done_cb)
+} rizz__coro_job_waiter;
+
+// async reads of coroutines, the vfs callback finds them by handle, so it doesn't touch the stack
+// of a coroutine that is restarted (hot-reload) or ended while waiting
+typedef struct rizz__coro_read_request {
+    sx_coro_handle coro;
+    sx_mem_block* mem;
+} rizz__coro_read_request;
+
 typedef struct rizz__show_debugger_deferred {
     bool show;
     bool* p_open;
@@ -169,6 +273,11 @@ typedef struct rizz__core {
 
     sx_job_context* jobs;
     sx_coro_context* coro;
+    rizz__coro_job_waiter* SX_ARRAY coro_job_waiters;
+    sx_lock_t coro_job_lk;              // coro_job_waiters are also marked done by worker threads
+    sx_atomic_uint32 coro_jobs_done;    // any of coro_job_waiters is marked done
+    sx_handle_pool* coro_read_handles;
+    rizz__coro_read_request* SX_ARRAY coro_reads;    // indexed by handle index
 
     uint32_t flags;    // sx_core_flags
     int tmp_mem_max;
@@ -204,6 +313,20 @@ typedef struct rizz__core {
     sx_mutex log_mtx;   // mutex used to protected `log_entries` and `log_strpool`
     rizz__log_entry_internal* SX_ARRAY log_entries; 
     sx_strpool* log_strpool;
+    char log_binary_file[32];
+
+    // async logging: threads write records to their own rings, the writer thread formats them
+    rizz__log_ring* log_rings[LOG_MAX_RINGS];
+    rizz__log_ring_busy log_rings_busy[LOG_MAX_RINGS];
+    sx_atomic_uint32 log_num_rings;
+    sx_mutex log_rings_mtx;             // only for registering new rings
+    sx_thread* log_thread;
+    sx_sem log_sem;
+    sx_atomic_uint32 log_running;
+    sx_atomic_uint32 log_quit;
+    sx_atomic_uint32 log_num_stalls;    // number of times that a thread waited for a full ring
+    uint64_t log_start_tm;
+    rizz__log_writer log_writer;
     
     // built-in imgui windows
     rizz__show_debugger_deferred show_memory;
@@ -224,6 +347,18 @@ static rizz__core g_core;
 
 static _Thread_local rizz__tmp_alloc_tls tl_tmp_alloc;
 
+// rings are registered again if core is re-initialized, `g_log_gen` is incremented on each init
+static _Thread_local rizz__log_ring* tl_log_ring;
+static _Thread_local uint32_t tl_log_ring_gen;
+static _Thread_local uint32_t tl_log_ring_index;
+static _Thread_local bool tl_log_writer;    // logs of the writer thread itself are always synchronous
+static uint32_t g_log_gen;
+
+// slots are cleared if core is re-initialized, `g_tls_gen` is incremented on each init
+static _Thread_local void* tl_tls_slots[MAX_TLS_SLOTS + 1];
+static _Thread_local uint32_t tl_tls_gen;
+static uint32_t g_tls_gen;
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // @log
 #if SX_PLATFORM_WINDOWS
@@ -432,6 +567,8 @@ static void rizz__log_backend_remotery(const rizz_log_entry* entry, void* user)
     }
 }
 
+// synchronous path, used when the writer thread is not running (init/shutdown) or the thread could not
+// get a ring
 static void rizz__log_dispatch_entry(rizz_log_entry* entry)
 {
     // built-in backends are thread-safe, so we pass them immediately
@@ -442,6 +579,12 @@ static void rizz__log_dispatch_entry(rizz_log_entry* entry)
     rizz__log_backend_android(entry, NULL);
 #endif
 
+    if (g_core.flags & RIZZ_CORE_FLAG_LOG_TO_FILE) {
+        sx_mutex_lock(g_core.log_mtx) {
+            rizz__log_backend_file(entry, NULL);
+        }
+    }
+
     if (g_core.log_num_backends > 0) {
         if (entry->channels == 0)
             entry->channels = 0xffffffff;
@@ -458,6 +601,947 @@ static void rizz__log_dispatch_entry(rizz_log_entry* entry)
     }
 }
 
+// parses a printf conversion spec, `fmt` points to the character after '%'
+// returns the pointer after the conversion character, NULL if the spec is not supported
+// arg_size is the size of integer arguments in bytes
+static const char* rizz__log_parse_spec(const char* fmt, char* conv, int* arg_size, bool* width_star,
+                                        bool* prec_star)
+{
+    *width_star = *prec_star = false;
+    while (*fmt && sx_strchar("-+ #0'$_", *fmt)) {
+        ++fmt;
+    }
+
+    if (*fmt == '*') {
+        *width_star = true;
+        ++fmt;
+    } else {
+        while (*fmt >= '0' && *fmt <= '9') ++fmt;
+    }
+
+    if (*fmt == '.') {
+        ++fmt;
+        if (*fmt == '*') {
+            *prec_star = true;
+            ++fmt;
+        } else {
+            while (*fmt >= '0' && *fmt <= '9') ++fmt;
+        }
+    }
+
+    *arg_size = sizeof(int);
+    switch (*fmt) {
+    case 'h':   ++fmt; if (*fmt == 'h') ++fmt;                      break;
+    case 'l':   ++fmt; *arg_size = sizeof(long);
+                if (*fmt == 'l') { ++fmt; *arg_size = sizeof(long long); }  break;
+    case 'j':   ++fmt; *arg_size = sizeof(intmax_t);                break;
+    case 'z':   ++fmt; *arg_size = sizeof(size_t);                  break;
+    case 't':   ++fmt; *arg_size = sizeof(ptrdiff_t);               break;
+    case 'I':
+        ++fmt;
+        if (fmt[0] == '6' && fmt[1] == '4') {
+            fmt += 2;
+            *arg_size = sizeof(int64_t);
+        } else if (fmt[0] == '3' && fmt[1] == '2') {
+            fmt += 2;
+        } else {
+            *arg_size = sizeof(size_t);
+        }
+        break;
+    case 'L':   return NULL;    // long double
+    default:                                                        break;
+    }
+
+    *conv = *fmt;
+    return (*conv && sx_strchar("diuoxXbBcsfFeEgGaAp", *conv)) ? fmt + 1 : NULL;
+}
+
+// type of the packed argument for a conversion that is parsed by rizz__log_parse_spec
+static inline uint8_t rizz__log_arg_tag(char conv, int arg_size)
+{
+    switch (conv) {
+    case 's':
+        return LOG_ARG_STR;
+    case 'p':
+        return LOG_ARG_PTR;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        return LOG_ARG_DOUBLE;
+    default:
+        return arg_size == sizeof(int64_t) ? LOG_ARG_INT64 : LOG_ARG_INT;
+    }
+}
+
+#define rizz__log_write_arg(_buff, _offset, _max, _tag, _value)             \
+    do {                                                                    \
+        if ((_offset) + 1 + (int)sizeof(_value) > (_max))                   \
+            return -1;                                                      \
+        (_buff)[(_offset)++] = (_tag);                                      \
+        sx_memcpy(&(_buff)[(_offset)], &(_value), sizeof(_value));          \
+        (_offset) += (int)sizeof(_value);                                   \
+    } while (0)
+
+// packs printf arguments into a buffer for deferred formatting
+// returns the size of packed arguments, or -1 if the format is not supported or arguments don't fit
+static int rizz__log_pack_args(uint8_t* buff, int max_size, const char* fmt, va_list args)
+{
+    int offset = 0;
+    for (const char* p = fmt; *p; p++) {
+        if (*p != '%') {
+            continue;
+        }
+        if (p[1] == '%') {
+            ++p;
+            continue;
+        }
+
+        char conv;
+        int arg_size;
+        bool width_star, prec_star;
+        const char* end = rizz__log_parse_spec(p + 1, &conv, &arg_size, &width_star, &prec_star);
+        if (!end) {
+            return -1;
+        }
+
+        int precision = -1;
+        if (width_star) {
+            int width = va_arg(args, int);
+            rizz__log_write_arg(buff, offset, max_size, LOG_ARG_INT, width);
+        }
+        if (prec_star) {
+            precision = va_arg(args, int);
+            rizz__log_write_arg(buff, offset, max_size, LOG_ARG_INT, precision);
+        }
+
+        switch (rizz__log_arg_tag(conv, arg_size)) {
+        case LOG_ARG_STR: {
+            const char* str = va_arg(args, const char*);
+            if (!str) {
+                str = "(null)";
+            }
+            // precision limits the string, it may not be null-terminated
+            int len = 0;
+            while (str[len] && (precision < 0 || len < precision)) {
+                ++len;
+            }
+            if (offset + 1 + len + 1 > max_size) {
+                return -1;
+            }
+            buff[offset++] = LOG_ARG_STR;
+            sx_memcpy(&buff[offset], str, len);
+            buff[offset + len] = '\0';
+            offset += len + 1;
+            break;
+        }
+        case LOG_ARG_PTR: {
+            uint64_t ptr = (uint64_t)(uintptr_t)va_arg(args, void*);
+            rizz__log_write_arg(buff, offset, max_size, LOG_ARG_PTR, ptr);
+            break;
+        }
+        case LOG_ARG_DOUBLE: {
+            double d = va_arg(args, double);
+            rizz__log_write_arg(buff, offset, max_size, LOG_ARG_DOUBLE, d);
+            break;
+        }
+        case LOG_ARG_INT64: {
+            int64_t n = va_arg(args, int64_t);
+            rizz__log_write_arg(buff, offset, max_size, LOG_ARG_INT64, n);
+            break;
+        }
+        default: {
+            int n = va_arg(args, int);
+            rizz__log_write_arg(buff, offset, max_size, LOG_ARG_INT, n);
+            break;
+        }
+        }
+
+        p = end - 1;
+    }
+
+    return offset;
+}
+
+// reads a packed argument value, fails if it doesn't fit in the remaining `args_size`
+static inline bool rizz__log_read_arg(void* value, int size, const uint8_t* args, int* offset,
+                                      int args_size)
+{
+    if (*offset + size > args_size) {
+        return false;
+    }
+    sx_memcpy(value, &args[*offset], size);
+    *offset += size;
+    return true;
+}
+
+// formats a string from the format and the arguments that are packed by rizz__log_pack_args
+// all reads are bounded by `args_size`, so corrupt arguments (binary log files) stop the formatting
+// returns the length of the text
+static int rizz__log_format(char* text, int text_size, const char* fmt, const uint8_t* args, int args_size)
+{
+    int len = 0;
+    int offset = 0;
+    bool corrupt = false;
+    const char* p = fmt;
+    while (*p && len < text_size - 1 && !corrupt) {
+        if (*p != '%') {
+            text[len++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            text[len++] = '%';
+            p += 2;
+            continue;
+        }
+
+        char conv;
+        int arg_size;
+        bool width_star, prec_star;
+        const char* end = rizz__log_parse_spec(p + 1, &conv, &arg_size, &width_star, &prec_star);
+        if (!end || offset >= args_size) {
+            break;    // corrupt record, or a format that does not match the arguments
+        }
+
+        // rebuild the spec without '*', with the values of width and precision
+        char spec[64];
+        int spec_len = 0;
+        for (const char* s = p; s < end && spec_len < (int)sizeof(spec) - 16; s++) {
+            if (*s == '*') {
+                int n;
+                if (offset >= args_size || args[offset++] != LOG_ARG_INT ||
+                    !rizz__log_read_arg(&n, sizeof(n), args, &offset, args_size)) {
+                    corrupt = true;
+                    break;
+                }
+                spec_len += sx_snprintf(&spec[spec_len], (int)sizeof(spec) - spec_len, "%d", n);
+            } else {
+                spec[spec_len++] = *s;
+            }
+        }
+        spec[spec_len] = '\0';
+        if (corrupt || offset >= args_size) {
+            break;
+        }
+
+        char* dst = &text[len];
+        int dst_size = text_size - len;
+        int r = 0;
+        // the argument must be of the type that the conversion expects, or snprintf reads garbage
+        uint8_t tag = args[offset++];
+        if (tag != rizz__log_arg_tag(conv, arg_size)) {
+            break;
+        }
+        switch (tag) {
+        case LOG_ARG_INT: {
+            int n;
+            corrupt = !rizz__log_read_arg(&n, sizeof(n), args, &offset, args_size);
+            r = !corrupt ? sx_snprintf(dst, dst_size, spec, n) : 0;
+            break;
+        }
+        case LOG_ARG_INT64: {
+            int64_t n;
+            corrupt = !rizz__log_read_arg(&n, sizeof(n), args, &offset, args_size);
+            r = !corrupt ? sx_snprintf(dst, dst_size, spec, n) : 0;
+            break;
+        }
+        case LOG_ARG_DOUBLE: {
+            double d;
+            corrupt = !rizz__log_read_arg(&d, sizeof(d), args, &offset, args_size);
+            r = !corrupt ? sx_snprintf(dst, dst_size, spec, d) : 0;
+            break;
+        }
+        case LOG_ARG_PTR: {
+            uint64_t ptr;
+            corrupt = !rizz__log_read_arg(&ptr, sizeof(ptr), args, &offset, args_size);
+            r = !corrupt ? sx_snprintf(dst, dst_size, spec, (void*)(uintptr_t)ptr) : 0;
+            break;
+        }
+        case LOG_ARG_STR: {
+            const char* str = (const char*)&args[offset];
+            int str_len = 0;
+            while (offset + str_len < args_size && str[str_len]) {
+                str_len++;
+            }
+            if (offset + str_len >= args_size) {
+                corrupt = true;    // not terminated within the arguments
+                break;
+            }
+            offset += str_len + 1;
+            r = sx_snprintf(dst, dst_size, spec, str);
+            break;
+        }
+        default:
+            corrupt = true;
+            break;
+        }
+
+        len += sx_clamp(r, 0, dst_size - 1);
+        p = end;
+    }
+
+    text[len] = '\0';
+    return len;
+}
+
+static rizz__log_ring* rizz__log_thread_ring(void)
+{
+    if (tl_log_ring && tl_log_ring_gen == g_log_gen) {
+        return tl_log_ring;
+    }
+
+    rizz__log_ring* ring = NULL;
+    sx_mutex_lock(g_core.log_rings_mtx) {
+        uint32_t index = sx_atomic_load32_explicit(&g_core.log_num_rings, SX_ATOMIC_MEMORYORDER_RELAXED);
+        if (index < LOG_MAX_RINGS && sx_atomic_load32(&g_core.log_running)) {
+            ring = sx_aligned_malloc(g_core.heap_alloc, sizeof(rizz__log_ring) + LOG_RING_SIZE,
+                                     SX_CACHE_LINE_SIZE);
+            if (ring) {
+                sx_memset(ring, 0x0, sizeof(rizz__log_ring));
+                ring->tid = sx_thread_tid();
+                ring->buff = (uint8_t*)(ring + 1);
+                g_core.log_rings[index] = ring;
+                tl_log_ring_index = index;
+                sx_atomic_store32_explicit(&g_core.log_num_rings, index + 1, SX_ATOMIC_MEMORYORDER_RELEASE);
+            }
+        }
+    }
+
+    // threads that can't get a ring fall back to the synchronous path
+    tl_log_ring = ring;
+    tl_log_ring_gen = g_log_gen;
+    return ring;
+}
+
+// reserves space for a record in the ring and returns the pointer to it
+// waits for the writer thread if the ring is full
+static rizz__log_record* rizz__log_ring_reserve(rizz__log_ring* ring, uint32_t size, uint32_t* new_head)
+{
+    const uint32_t mask = LOG_RING_SIZE - 1;
+    uint32_t head = sx_atomic_load32_explicit(&ring->head, SX_ATOMIC_MEMORYORDER_RELAXED);
+    uint32_t offset = head & mask;
+    uint32_t contiguous = LOG_RING_SIZE - offset;
+    uint32_t needed = contiguous < size ? (contiguous + size) : size;
+
+    uint32_t tail = sx_atomic_load32_explicit(&ring->tail, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+    if (LOG_RING_SIZE - (head - tail) < needed) {
+        sx_atomic_fetch_add32(&g_core.log_num_stalls, 1);
+        do {
+            sx_semaphore_post(&g_core.log_sem, 1);
+            sx_thread_yield();
+            tail = sx_atomic_load32_explicit(&ring->tail, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+        } while (LOG_RING_SIZE - (head - tail) < needed);
+    }
+
+    if (contiguous < size) {
+        // records are 8 byte aligned, so there is always room for the size and flags of the padding
+        rizz__log_record* padding = (rizz__log_record*)(ring->buff + offset);
+        padding->size = contiguous;
+        padding->flags = LOG_RECORD_FLAG_PADDING;
+        offset = 0;
+    }
+
+    *new_head = head + needed;
+    return (rizz__log_record*)(ring->buff + offset);
+}
+
+// waits for the writer thread to write the records of the ring up to `head`
+// the wait is limited, in case the writer is blocked by the thread that is waiting (asserts, crashes)
+static void rizz__log_ring_wait_flushed(rizz__log_ring* ring, uint32_t head)
+{
+    uint64_t start_tm = sx_tm_now();
+    sx_semaphore_post(&g_core.log_sem, 1);
+    while ((int32_t)(head - sx_atomic_load32_explicit(&ring->flushed, SX_ATOMIC_MEMORYORDER_ACQUIRE)) > 0) {
+        if (sx_tm_sec(sx_tm_since(start_tm)) > LOG_FLUSH_TIMEOUT) {
+            break;
+        }
+        sx_thread_yield();
+    }
+}
+
+static void rizz__log_print(rizz_log_level type, uint32_t channels, const char* source_file, int line,
+                            const char* fmt, va_list args)
+{
+    rizz__log_ring* ring =
+        (sx_atomic_load32(&g_core.log_running) && !tl_log_writer) ? rizz__log_thread_ring() : NULL;
+    sx_atomic_uint32* busy = ring ? &g_core.log_rings_busy[tl_log_ring_index].value : NULL;
+    if (ring) {
+        // release closes the log (log_running=0) before it waits for busy rings, so if it's still open
+        // after the ring is marked, the ring and the writer stay alive until we are done
+        sx_atomic_store32(busy, 1);
+        if (!sx_atomic_load32(&g_core.log_running)) {
+            sx_atomic_store32(busy, 0);
+            ring = NULL;
+        }
+    }
+    int fmt_len = sx_strlen(fmt);
+
+    if (!ring) {
+        char* text = alloca(fmt_len + 1024);    // reserve only 1k for format replace strings
+        if (!text) {
+            sx_assert_alwaysf(0, "out of stack memory");
+            return;
+        }
+        sx_vsnprintf(text, fmt_len + 1024, fmt, args);
+        rizz__log_dispatch_entry(&(rizz_log_entry){ .type = type,
+                                                    .channels = channels,
+                                                    .text_len = sx_strlen(text),
+                                                    .source_file_len = source_file ? sx_strlen(source_file) : 0,
+                                                    .text = text,
+                                                    .source_file = source_file,
+                                                    .line = line });
+        return;
+    }
+
+    uint8_t packed_args[LOG_MAX_ARGS_SIZE];
+    va_list args_copy;
+    va_copy(args_copy, args);
+    int args_size = fmt_len < UINT16_MAX ? rizz__log_pack_args(packed_args, sizeof(packed_args), fmt, args_copy) : -1;
+    va_end(args_copy);
+
+    rizz__log_record_flags flags = 0;
+    if (args_size < 0) {
+        // unsupported format, format it here and send the text
+        char* text = alloca(LOG_MAX_TEXT_SIZE);
+        sx_vsnprintf(text, LOG_MAX_TEXT_SIZE, fmt, args);
+        fmt = text;
+        fmt_len = sx_strlen(text);
+        args_size = 0;
+        flags |= LOG_RECORD_FLAG_FORMATTED;
+    }
+
+    int source_len = source_file ? sx_min(sx_strlen(source_file), RIZZ_MAX_PATH - 1) : -1;
+    uint32_t size = (uint32_t)sx_align_mask(sizeof(rizz__log_record) + (fmt_len + 1) + (source_len + 1) + args_size, 7);
+
+    uint32_t new_head;
+    rizz__log_record* rec = rizz__log_ring_reserve(ring, size, &new_head);
+    *rec = (rizz__log_record){ .size = size,
+                               .type = (uint8_t)type,
+                               .flags = flags,
+                               .fmt_len = (uint16_t)(fmt_len + 1),
+                               .source_len = (uint16_t)(source_len + 1),
+                               .args_size = (uint16_t)args_size,
+                               .line = line,
+                               .channels = channels,
+                               .timestamp = sx_tm_now() };
+    char* data = (char*)(rec + 1);
+    sx_memcpy(data, fmt, fmt_len + 1);
+    data += fmt_len + 1;
+    if (source_len >= 0) {
+        sx_memcpy(data, source_file, source_len);
+        data[source_len] = '\0';
+        data += source_len + 1;
+    }
+    sx_memcpy(data, packed_args, args_size);
+
+    uint32_t tail = sx_atomic_load32_explicit(&ring->tail, SX_ATOMIC_MEMORYORDER_RELAXED);
+    sx_atomic_store32_explicit(&ring->head, new_head, SX_ATOMIC_MEMORYORDER_RELEASE);
+
+    // errors are often followed by a crash or an abort, so they are not returned before they are
+    // written out. warnings are written as soon as possible, others on the next writer round
+    if (type == RIZZ_LOG_LEVEL_ERROR) {
+        rizz__log_ring_wait_flushed(ring, new_head);
+    } else if (type == RIZZ_LOG_LEVEL_WARNING || (new_head - tail) > LOG_RING_SIZE / 2) {
+        sx_semaphore_post(&g_core.log_sem, 1);
+    }
+
+    sx_atomic_store32(busy, 0);
+}
+
+// waits until all the records that are currently in the rings are written out
+// called before asserts and crashes, so the last messages are not lost
+void rizz__log_flush(void)
+{
+    if (!sx_atomic_load32(&g_core.log_running) || tl_log_writer) {
+        return;
+    }
+
+    int num_rings = (int)sx_atomic_load32_explicit(&g_core.log_num_rings, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+    for (int i = 0; i < num_rings; i++) {
+        rizz__log_ring* ring = g_core.log_rings[i];
+        rizz__log_ring_wait_flushed(ring, sx_atomic_load32_explicit(&ring->head, SX_ATOMIC_MEMORYORDER_ACQUIRE));
+    }
+}
+
+#define rizz__log_buff_push(_buff, _data, _size) \
+    sx_memcpy(sx_array_add(g_core.core_alloc, _buff, (int)(_size)), _data, (size_t)(_size))
+
+// returns the id of the string in the binary log, writes a LOG_BINARY_STRING record if it's new
+static uint32_t rizz__log_binary_string(rizz__log_writer* w, const char* str, int len)
+{
+    uint32_t hash = sx_hash_fnv32(str, (size_t)len);
+    hash = hash ? hash : 1;    // zero is reserved for empty keys
+    int index = sx_hashtbl_find(w->binary_str_tbl, hash);
+    bool collision = false;
+    if (index != -1) {
+        int str_index = sx_hashtbl_get(w->binary_str_tbl, index);
+        if (sx_strequal(&w->binary_str_buff[w->binary_strs[str_index]], str)) {
+            return (uint32_t)str_index + 1;
+        }
+        // hash collisions are rare, the string is written again every time
+        collision = true;
+    }
+
+    const sx_alloc* alloc = g_core.core_alloc;
+    int str_index = sx_array_count(w->binary_strs);
+    if (!collision) {
+        if (sx_hashtbl_full(w->binary_str_tbl) && !sx_hashtbl_grow(&w->binary_str_tbl, alloc)) {
+            sx_out_of_memory();
+            return 0;
+        }
+        sx_hashtbl_add(w->binary_str_tbl, hash, str_index);
+    }
+    sx_array_push(alloc, w->binary_strs, sx_array_count(w->binary_str_buff));
+    rizz__log_buff_push(w->binary_str_buff, str, len + 1);
+
+    rizz__log_binary_record rec = { .size = (uint32_t)(sizeof(rec) + len + 1),
+                                    .type = LOG_BINARY_STRING,
+                                    .fmt_id = (uint32_t)str_index + 1 };
+    rizz__log_buff_push(w->binary_buff, &rec, sizeof(rec));
+    rizz__log_buff_push(w->binary_buff, str, len + 1);
+    return (uint32_t)str_index + 1;
+}
+
+static void rizz__log_writer_binary(rizz__log_writer* w, const rizz__log_record* rec, const char* fmt,
+                                    const char* source, const uint8_t* args)
+{
+    // pre-formatted texts are not interned, they are written in place of the arguments
+    bool formatted = (rec->flags & LOG_RECORD_FLAG_FORMATTED) != 0;
+    uint32_t fmt_id = !formatted ? rizz__log_binary_string(w, fmt, rec->fmt_len - 1) : 0;
+    uint32_t source_id = source ? rizz__log_binary_string(w, source, rec->source_len - 1) : 0;
+    uint16_t args_size = !formatted ? rec->args_size : rec->fmt_len;
+    if (formatted) {
+        args = (const uint8_t*)fmt;
+    }
+
+    rizz__log_binary_record brec = {
+        .size = (uint32_t)sizeof(brec) + args_size,
+        .type = rec->type,
+        .flags = rec->flags,
+        .args_size = args_size,
+        .fmt_id = fmt_id,
+        .source_id = source_id,
+        .line = rec->line,
+        .channels = rec->channels,
+        .time_us = rec->timestamp > g_core.log_start_tm ? (uint64_t)sx_tm_us(rec->timestamp - g_core.log_start_tm) : 0
+    };
+    rizz__log_buff_push(w->binary_buff, &brec, sizeof(brec));
+    if (args_size > 0) {
+        rizz__log_buff_push(w->binary_buff, args, args_size);
+    }
+}
+
+static void rizz__log_writer_entry(rizz__log_writer* w, const rizz__log_record* rec)
+{
+    const sx_alloc* alloc = g_core.core_alloc;
+    const char* fmt = (const char*)(rec + 1);
+    const char* source = rec->source_len ? (fmt + rec->fmt_len) : NULL;
+    const uint8_t* args = (const uint8_t*)(fmt + rec->fmt_len + rec->source_len);
+
+    char text_buff[LOG_MAX_TEXT_SIZE];
+    const char* text;
+    int text_len;
+    if (rec->flags & LOG_RECORD_FLAG_FORMATTED) {
+        text = fmt;
+        text_len = rec->fmt_len - 1;
+    } else {
+        text_len = rizz__log_format(text_buff, sizeof(text_buff), fmt, args, rec->args_size);
+        text = text_buff;
+    }
+
+    rizz_log_entry entry = { .type = (rizz_log_level)rec->type,
+                             .channels = rec->channels ? rec->channels : 0xffffffff,
+                             .text_len = text_len,
+                             .source_file_len = rec->source_len ? (rec->source_len - 1) : 0,
+                             .text = text,
+                             .source_file = source,
+                             .line = rec->line };
+
+    // terminal output is collected and written once per batch
+    {
+        const char* open_fmt = "";
+        const char* close_fmt = "";
+        switch (entry.type) {
+        case RIZZ_LOG_LEVEL_DEBUG:
+        case RIZZ_LOG_LEVEL_VERBOSE:    open_fmt = TERM_COLOR_DIM; close_fmt = TERM_COLOR_RESET;    break;
+        case RIZZ_LOG_LEVEL_WARNING:    open_fmt = TERM_COLOR_YELLOW; close_fmt = TERM_COLOR_RESET; break;
+        case RIZZ_LOG_LEVEL_ERROR:      open_fmt = TERM_COLOR_RED; close_fmt = TERM_COLOR_RESET;    break;
+        default:                                                                                    break;
+        }
+
+        int size = text_len + 128;
+        char* dst = sx_array_add(alloc, w->term_buff, size);
+        int len = sx_snprintf(dst, size, "%s%s%s%s\n", open_fmt, k_log_entry_types[entry.type], text, close_fmt);
+        sx_array_pop_lastn(w->term_buff, size - sx_min(len, size - 1));
+    }
+
+    rizz__log_backend_debugger(&entry, NULL);
+#if SX_PLATFORM_ANDROID
+    rizz__log_backend_android(&entry, NULL);
+#endif
+
+    if (w->file) {
+        char source_str[128];
+        rizz__log_make_source_str(source_str, sizeof(source_str), source, rec->line);
+        int size = text_len + 256;
+        char* dst = sx_array_add(alloc, w->file_buff, size);
+        int len = sx_snprintf(dst, size, "%s%s%s\n", source_str, k_log_entry_types[entry.type], text);
+        sx_array_pop_lastn(w->file_buff, size - sx_min(len, size - 1));
+    }
+
+    if (w->binary_file) {
+        rizz__log_writer_binary(w, rec, fmt, source, args);
+    }
+
+    // registered backends are called by the main thread in rizz__log_update
+    // text and source pointers are kept as offsets into `backend_text` until the batch is pushed
+    if (g_core.log_num_backends > 0) {
+        uintptr_t text_offset = (uintptr_t)sx_array_count(w->backend_text);
+        rizz__log_buff_push(w->backend_text, text, text_len + 1);
+        uintptr_t source_offset = (uintptr_t)sx_array_count(w->backend_text);
+        if (source) {
+            rizz__log_buff_push(w->backend_text, source, rec->source_len);
+        }
+        entry.text = (const char*)text_offset;
+        entry.source_file = source ? (const char*)source_offset : NULL;
+        sx_array_push(alloc, w->backend_entries, entry);
+    }
+}
+
+static void rizz__log_writer_flush(rizz__log_writer* w)
+{
+    if (sx_array_count(w->term_buff) > 0) {
+        fwrite(w->term_buff, 1, sx_array_count(w->term_buff), stdout);
+        fflush(stdout);
+        sx_array_clear(w->term_buff);
+    }
+
+    if (sx_array_count(w->file_buff) > 0) {
+        fwrite(w->file_buff, 1, sx_array_count(w->file_buff), w->file);
+        fflush(w->file);
+        sx_array_clear(w->file_buff);
+    }
+
+    if (sx_array_count(w->binary_buff) > 0) {
+        fwrite(w->binary_buff, 1, sx_array_count(w->binary_buff), w->binary_file);
+        fflush(w->binary_file);
+        sx_array_clear(w->binary_buff);
+    }
+
+    int num_entries = sx_array_count(w->backend_entries);
+    if (num_entries > 0) {
+        sx_mutex_lock(g_core.log_mtx) {
+            for (int i = 0; i < num_entries; i++) {
+                const rizz_log_entry* entry = &w->backend_entries[i];
+                const char* text = w->backend_text + (uintptr_t)entry->text;
+                const char* source = entry->source_file ? (w->backend_text + (uintptr_t)entry->source_file) : NULL;
+                sx_str_t text_id = sx_strpool_add(g_core.log_strpool, text, entry->text_len);
+                sx_str_t source_id = source ? sx_strpool_add(g_core.log_strpool, source, entry->source_file_len) : 0;
+                rizz__log_entry_internal entry_internal = { .e = *entry,
+                                                            .text_id = text_id,
+                                                            .source_id = source_id,
+                                                            .timestamp = sx_cycle_clock() };
+                sx_array_push(g_core.core_alloc, g_core.log_entries, entry_internal);
+            }
+        }
+        sx_array_clear(w->backend_entries);
+        sx_array_clear(w->backend_text);
+    }
+
+    // everything that is consumed from the rings is written now
+    int num_rings = (int)sx_atomic_load32_explicit(&g_core.log_num_rings, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+    for (int i = 0; i < num_rings; i++) {
+        rizz__log_ring* ring = g_core.log_rings[i];
+        uint32_t tail = sx_atomic_load32_explicit(&ring->tail, SX_ATOMIC_MEMORYORDER_RELAXED);
+        sx_atomic_store32_explicit(&ring->flushed, tail, SX_ATOMIC_MEMORYORDER_RELEASE);
+    }
+}
+
+// consumes all records that are currently in the rings, in the order of their timestamps
+// returns the number of records written
+static int rizz__log_writer_drain(rizz__log_writer* w)
+{
+    const uint32_t mask = LOG_RING_SIZE - 1;
+    uint32_t heads[LOG_MAX_RINGS];
+    uint32_t tails[LOG_MAX_RINGS];
+
+    int num_rings = (int)sx_atomic_load32_explicit(&g_core.log_num_rings, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+    for (int i = 0; i < num_rings; i++) {
+        rizz__log_ring* ring = g_core.log_rings[i];
+        heads[i] = sx_atomic_load32_explicit(&ring->head, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+        tails[i] = sx_atomic_load32_explicit(&ring->tail, SX_ATOMIC_MEMORYORDER_RELAXED);
+    }
+
+    int count = 0;
+    for (;;) {
+        // pick the oldest record among all rings
+        int oldest = -1;
+        const rizz__log_record* oldest_rec = NULL;
+        for (int i = 0; i < num_rings; i++) {
+            rizz__log_ring* ring = g_core.log_rings[i];
+            while (tails[i] != heads[i]) {
+                const rizz__log_record* rec = (const rizz__log_record*)(ring->buff + (tails[i] & mask));
+                if (rec->flags & LOG_RECORD_FLAG_PADDING) {
+                    tails[i] += rec->size;
+                    continue;
+                }
+                if (!oldest_rec || rec->timestamp < oldest_rec->timestamp) {
+                    oldest = i;
+                    oldest_rec = rec;
+                }
+                break;
+            }
+        }
+
+        if (oldest == -1) {
+            break;
+        }
+
+        rizz__log_writer_entry(w, oldest_rec);
+        tails[oldest] += oldest_rec->size;
+        sx_atomic_store32_explicit(&g_core.log_rings[oldest]->tail, tails[oldest], SX_ATOMIC_MEMORYORDER_RELEASE);
+        ++count;
+    }
+
+    // release the padding records that are skipped at the end
+    for (int i = 0; i < num_rings; i++) {
+        sx_atomic_store32_explicit(&g_core.log_rings[i]->tail, tails[i], SX_ATOMIC_MEMORYORDER_RELEASE);
+    }
+
+    return count;
+}
+
+static int rizz__log_writer_thread_cb(void* user1, void* user2)
+{
+    sx_unused(user1);
+    sx_unused(user2);
+
+    rizz__log_writer* w = &g_core.log_writer;
+    tl_log_writer = true;
+    while (!sx_atomic_load32(&g_core.log_quit)) {
+        sx_semaphore_wait(&g_core.log_sem, LOG_WRITER_WAIT_MSECS);
+        if (rizz__log_writer_drain(w) > 0) {
+            rizz__log_writer_flush(w);
+        }
+    }
+
+    // producers are stopped before quit, write the remaining records
+    rizz__log_writer_drain(w);
+    rizz__log_writer_flush(w);
+    return 0;
+}
+
+// flushes the pending logs before the assert message, the program usually breaks or aborts after it
+static void rizz__log_assert_cb(const char* text, const char* sourcefile, uint32_t line)
+{
+    rizz__log_flush();
+
+    char assert_text[2048];
+    sx_snprintf(assert_text, sizeof(assert_text), "ASSERT FAILURE - %s", text);
+    rizz__log_dispatch_entry(&(rizz_log_entry){ .type = RIZZ_LOG_LEVEL_ERROR,
+                                                .channels = 0xffffffff,
+                                                .text_len = sx_strlen(assert_text),
+                                                .source_file_len = sourcefile ? sx_strlen(sourcefile) : 0,
+                                                .text = assert_text,
+                                                .source_file = sourcefile,
+                                                .line = (int)line });
+}
+
+static bool rizz__log_init_writer(void)
+{
+    rizz__log_writer* w = &g_core.log_writer;
+    sx_memset(w, 0x0, sizeof(*w));
+
+    if (g_core.flags & RIZZ_CORE_FLAG_LOG_TO_FILE) {
+        // the file is kept open by the writer, instead of opening it for every entry
+        w->file = fopen(g_core.log_file, "at");
+        if (!w->file) {
+            g_core.flags &= ~RIZZ_CORE_FLAG_LOG_TO_FILE;
+        }
+    }
+
+    if (g_core.flags & RIZZ_CORE_FLAG_LOG_BINARY) {
+        w->binary_file = fopen(g_core.log_binary_file, "wb");
+        if (w->binary_file) {
+            rizz__log_binary_header header = { .magic = LOG_BINARY_MAGIC, .version = LOG_BINARY_VERSION };
+            fwrite(&header, sizeof(header), 1, w->binary_file);
+            w->binary_str_tbl = sx_hashtbl_create(g_core.core_alloc, 256);
+            if (!w->binary_str_tbl) {
+                sx_out_of_memory();
+                return false;
+            }
+        } else {
+            g_core.flags &= ~RIZZ_CORE_FLAG_LOG_BINARY;
+        }
+    }
+
+    g_core.log_start_tm = sx_tm_now();
+    ++g_log_gen;
+    sx_mutex_init(&g_core.log_rings_mtx);
+    sx_semaphore_init(&g_core.log_sem);
+    g_core.log_thread = sx_thread_create(g_core.core_alloc, rizz__log_writer_thread_cb, NULL,
+                                         128*1024, "rizz_log", NULL);
+    if (!g_core.log_thread) {
+        return false;
+    }
+    sx_atomic_store32(&g_core.log_running, 1);
+    sx_set_assert_callback(rizz__log_assert_cb);
+    return true;
+}
+
+static void rizz__log_release_writer(void)
+{
+    if (!g_core.log_thread) {
+        return;
+    }
+
+    // from now on, all logs go through the synchronous path
+    sx_set_assert_callback(NULL);
+    sx_atomic_store32(&g_core.log_running, 0);
+
+    // producers that are in the middle of writing a record finish it first, the writer is still
+    // running, so the ones that wait for a full ring or a flush can continue
+    sx_mutex_lock(g_core.log_rings_mtx) {
+        int num_rings = (int)sx_atomic_load32(&g_core.log_num_rings);
+        for (int i = 0; i < num_rings; i++) {
+            while (sx_atomic_load32(&g_core.log_rings_busy[i].value)) {
+                sx_semaphore_post(&g_core.log_sem, 1);
+                sx_thread_yield();
+            }
+        }
+    }
+
+    // writer drains the remaining records before it quits
+    sx_atomic_store32(&g_core.log_quit, 1);
+    sx_semaphore_post(&g_core.log_sem, 1);
+    sx_thread_destroy(g_core.log_thread, g_core.core_alloc);
+    g_core.log_thread = NULL;
+
+    int num_stalls = (int)sx_atomic_load32(&g_core.log_num_stalls);
+    if (num_stalls > 0) {
+        rizz__log_debug("log rings were full %d times", num_stalls);
+    }
+
+    const sx_alloc* alloc = g_core.core_alloc;
+    rizz__log_writer* w = &g_core.log_writer;
+    if (w->file) {
+        fclose(w->file);
+    }
+    if (w->binary_file) {
+        fclose(w->binary_file);
+    }
+    sx_array_free(alloc, w->term_buff);
+    sx_array_free(alloc, w->file_buff);
+    sx_array_free(alloc, w->binary_buff);
+    sx_array_free(alloc, w->binary_strs);
+    sx_array_free(alloc, w->binary_str_buff);
+    sx_array_free(alloc, w->backend_entries);
+    sx_array_free(alloc, w->backend_text);
+    if (w->binary_str_tbl) {
+        sx_hashtbl_destroy(w->binary_str_tbl, alloc);
+    }
+    sx_memset(w, 0x0, sizeof(*w));
+
+    // threads that are still alive will register new rings on the next init (see g_log_gen)
+    int num_rings = (int)sx_atomic_load32(&g_core.log_num_rings);
+    for (int i = 0; i < num_rings; i++) {
+        sx_aligned_free(g_core.heap_alloc, g_core.log_rings[i], SX_CACHE_LINE_SIZE);
+        g_core.log_rings[i] = NULL;
+    }
+    sx_atomic_store32(&g_core.log_num_rings, 0);
+
+    sx_semaphore_release(&g_core.log_sem);
+    sx_mutex_release(&g_core.log_rings_mtx);
+}
+
+// true if there is a null-terminator in the first `size` bytes of `str`
+static bool rizz__log_terminated(const uint8_t* str, int size)
+{
+    for (int i = 0; i < size; i++) {
+        if (str[i] == '\0') {
+            return true;
+        }
+    }
+    return false;
+}
+
+// decodes a binary log file (RIZZ_CORE_FLAG_LOG_BINARY) and prints it to stdout
+bool rizz__log_decode_file(const char* filepath)
+{
+    const sx_alloc* alloc = sx_alloc_malloc();
+    sx_mem_block* mem = sx_file_load_bin(alloc, filepath);
+    if (!mem) {
+        printf("could not open log file: %s\n", filepath);
+        return false;
+    }
+
+    const uint8_t* data = (const uint8_t*)mem->data;
+    int64_t size = mem->size;
+    const rizz__log_binary_header* header = (const rizz__log_binary_header*)data;
+    if (size < (int64_t)sizeof(*header) || header->magic != LOG_BINARY_MAGIC ||
+        header->version != LOG_BINARY_VERSION) {
+        printf("invalid log file: %s\n", filepath);
+        sx_mem_destroy_block(mem);
+        return false;
+    }
+
+    const char** strs = NULL;
+    char* text = sx_malloc(alloc, LOG_MAX_TEXT_SIZE);
+    sx_assert_always(text);
+
+    bool r = true;
+    int64_t offset = sizeof(*header);
+    while (offset + (int64_t)sizeof(rizz__log_binary_record) <= size) {
+        const rizz__log_binary_record* rec = (const rizz__log_binary_record*)(data + offset);
+        if (rec->size < sizeof(*rec) || offset + rec->size > size) {
+            r = false;
+            break;
+        }
+
+        const uint8_t* payload = (const uint8_t*)(rec + 1);
+        int payload_size = (int)(rec->size - sizeof(*rec));
+        if (rec->type == LOG_BINARY_STRING) {
+            if (!rizz__log_terminated(payload, payload_size)) {
+                r = false;
+                break;
+            }
+            sx_array_push(alloc, strs, (const char*)payload);
+        } else {
+            bool formatted = (rec->flags & LOG_RECORD_FLAG_FORMATTED) != 0;
+            if ((!formatted && (rec->fmt_id == 0 || rec->fmt_id > (uint32_t)sx_array_count(strs))) ||
+                rec->source_id > (uint32_t)sx_array_count(strs) || rec->type >= _RIZZ_LOG_LEVEL_COUNT ||
+                rec->args_size > payload_size) {
+                r = false;
+                break;
+            }
+
+            if (formatted) {
+                if (!rizz__log_terminated(payload, rec->args_size)) {
+                    r = false;
+                    break;
+                }
+                sx_strcpy(text, LOG_MAX_TEXT_SIZE, (const char*)payload);
+            } else {
+                rizz__log_format(text, LOG_MAX_TEXT_SIZE, strs[rec->fmt_id - 1], payload, rec->args_size);
+            }
+
+            char source[128];
+            rizz__log_make_source_str(source, sizeof(source), rec->source_id ? strs[rec->source_id - 1] : NULL,
+                                      rec->line);
+            printf("[%.3f] %s%s%s\n", (double)rec->time_us / 1000000.0, source, k_log_entry_types[rec->type],
+                   text);
+        }
+
+        offset += rec->size;
+    }
+
+    if (!r) {
+        printf("log file is corrupt at offset: %lld\n", (long long)offset);
+    }
+
+    sx_free(alloc, text);
+    sx_array_free(alloc, strs);
+    sx_mem_destroy_block(mem);
+    return r;
+}
+
 static void rizz__set_log_level(rizz_log_level level)
 {
     g_core.log_level = level;
@@ -469,25 +1553,10 @@ static void rizz__print_info(uint32_t channels, const char* source_file, int lin
         return;
     }
 
-    int fmt_len = sx_strlen(fmt);
-    char* text = alloca(fmt_len + 1024);    // reserve only 1k for format replace strings
-    if (!text) {
-        sx_assert_alwaysf(0, "out of stack memory");
-        return;
-    }
-
     va_list args;
     va_start(args, fmt);
-    sx_vsnprintf(text, fmt_len + 1024, fmt, args);
+    rizz__log_print(RIZZ_LOG_LEVEL_INFO, channels, source_file, line, fmt, args);
     va_end(args);
-
-    rizz__log_dispatch_entry(&(rizz_log_entry){ .type = RIZZ_LOG_LEVEL_INFO,
-                                                .channels = channels,
-                                                .text_len = sx_strlen(text),
-                                                .source_file_len = source_file ? sx_strlen(source_file) : 0,
-                                                .text = text,
-                                                .source_file = source_file,
-                                                .line = line });
 }
 
 static void rizz__print_debug(uint32_t channels, const char* source_file, int line, const char* fmt, ...)
@@ -497,25 +1566,10 @@ static void rizz__print_debug(uint32_t channels, const char* source_file, int li
         return;
     }
 
-    int fmt_len = sx_strlen(fmt);
-    char* text = alloca(fmt_len + 1024);    // reserve only 1k for format replace strings
-    if (!text) {
-        sx_assert_alwaysf(0, "out of stack memory");
-        return;
-    }
-
     va_list args;
     va_start(args, fmt);
-    sx_vsnprintf(text, fmt_len + 1024, fmt, args);
+    rizz__log_print(RIZZ_LOG_LEVEL_DEBUG, channels, source_file, line, fmt, args);
     va_end(args);
-
-    rizz__log_dispatch_entry(&(rizz_log_entry){ .type = RIZZ_LOG_LEVEL_DEBUG,
-                                                .channels = channels,
-                                                .text_len = sx_strlen(text),
-                                                .source_file_len = source_file ? sx_strlen(source_file) : 0,
-                                                .text = text,
-                                                .source_file = source_file,
-                                                .line = line });
 #else   // if _DEBUG
     sx_unused(channels);
     sx_unused(source_file);
@@ -530,25 +1584,10 @@ static void rizz__print_verbose(uint32_t channels, const char* source_file, int
         return;
     }
 
-    int fmt_len = sx_strlen(fmt);
-    char* text = alloca(fmt_len + 1024);    // reserve only 1k for format replace strings
-    if (!text) {
-        sx_assert_alwaysf(0, "out of stack memory");
-        return;
-    }
-
     va_list args;
     va_start(args, fmt);
-    sx_vsnprintf(text, fmt_len + 1024, fmt, args);
+    rizz__log_print(RIZZ_LOG_LEVEL_VERBOSE, channels, source_file, line, fmt, args);
     va_end(args);
-
-    rizz__log_dispatch_entry(&(rizz_log_entry){ .type = RIZZ_LOG_LEVEL_VERBOSE,
-                                                .channels = channels,
-                                                .text_len = sx_strlen(text),
-                                                .source_file_len = source_file ? sx_strlen(source_file) : 0,
-                                                .text = text,
-                                                .source_file = source_file,
-                                                .line = line });
 }
 
 static void rizz__print_error(uint32_t channels, const char* source_file, int line, const char* fmt, ...)
@@ -557,25 +1596,10 @@ static void rizz__print_error(uint32_t channels, const char* source_file, int li
         return;
     }
 
-    int fmt_len = sx_strlen(fmt);
-    char* text = alloca(fmt_len + 1024);    // reserve only 1k for format replace strings
-    if (!text) {
-        sx_assert_alwaysf(0, "out of stack memory");
-        return;
-    }
-
     va_list args;
     va_start(args, fmt);
-    sx_vsnprintf(text, fmt_len + 1024, fmt, args);
+    rizz__log_print(RIZZ_LOG_LEVEL_ERROR, channels, source_file, line, fmt, args);
     va_end(args);
-
-    rizz__log_dispatch_entry(&(rizz_log_entry){ .type = RIZZ_LOG_LEVEL_ERROR,
-                                                .channels = channels,
-                                                .text_len = sx_strlen(text),
-                                                .source_file_len = source_file ? sx_strlen(source_file) : 0,
-                                                .text = text,
-                                                .source_file = source_file,
-                                                .line = line });
 }
 
 static void rizz__print_warning(uint32_t channels, const char* source_file, int line,
@@ -585,25 +1609,10 @@ static void rizz__print_warning(uint32_t channels, const char* source_file, int
         return;
     }
 
-    int fmt_len = sx_strlen(fmt);
-    char* text = alloca(fmt_len + 1024);    // reserve only 1k for format replace strings
-    if (!text) {
-        sx_assert_alwaysf(0, "out of stack memory");
-        return;
-    }
-
     va_list args;
     va_start(args, fmt);
-    sx_vsnprintf(text, fmt_len + 1024, fmt, args);
+    rizz__log_print(RIZZ_LOG_LEVEL_WARNING, channels, source_file, line, fmt, args);
     va_end(args);
-
-    rizz__log_dispatch_entry(&(rizz_log_entry){ .type = RIZZ_LOG_LEVEL_WARNING,
-                                                .channels = channels,
-                                                .text_len = sx_strlen(text),
-                                                .source_file_len = source_file ? sx_strlen(source_file) : 0,
-                                                .text = text,
-                                                .source_file = source_file,
-                                                .line = line });
 }
 
 static void rizz__log_update()
@@ -797,6 +1806,22 @@ static void rizz__job_thread_shutdown_cb(sx_job_context* ctx, int thread_index,
     sx_unused(user);
 }
 
+// runs on the thread that finishes the job, marks the coroutines that await it
+static void rizz__job_done_cb(sx_job_context* ctx, sx_job_t job, void* user)
+{
+    sx_unused(ctx);
+    sx_unused(user);
+
+    sx_lock(g_core.coro_job_lk) {
+        for (int i = 0, c = sx_array_count(g_core.coro_job_waiters); i < c; i++) {
+            if (g_core.coro_job_waiters[i].job == job) {
+                g_core.coro_job_waiters[i].done = true;
+                sx_atomic_store32(&g_core.coro_jobs_done, 1);
+            }
+        }
+    }
+}
+
 static void rizz__rmt_input_handler(const char* text, void* context)
 {
     const sx_alloc* alloc = context;
@@ -905,6 +1930,15 @@ static void rizz__register_console_command(const char* cmd, rizz_core_cmd_cb* ca
     sx_assert(cmd[0]);
     sx_assert(callback);
 
+    // registering an existing command replaces it, so plugins can register again after reload
+    for (int i = 0, c = sx_array_count(g_core.console_cmds); i < c; i++) {
+        if (sx_strequal(g_core.console_cmds[i].name, cmd)) {
+            g_core.console_cmds[i].callback = callback;
+            g_core.console_cmds[i].user = user;
+            return;
+        }
+    }
+
     rizz__core_cmd c;
     sx_strcpy(c.name, sizeof(c.name), cmd);
     c.callback = callback;
@@ -1151,13 +2185,81 @@ static int rizz__core_echo_command(int argc, char* argv[], void* user)
     sx_unused(user);
     
     if (argc > 1) {
-        rizz__log_debug(argv[1]);
+        rizz__log_debug("%s", argv[1]);
         return 0;
     }
 
     return -1;
 }
 
+static int rizz__core_tls_register_slot(const char* name, void* user,
+                                        void* (*init_cb)(int thread_idx, uint32_t thread_id, void* user))
+{
+    sx_assert(name);
+    sx_assert(init_cb);
+
+    uint32_t hash = sx_hash_fnv32_str(name);
+    for (int i = 0, c = sx_array_count(g_core.tls_vars); i < c; i++) {
+        rizz__tls_var* tvar = &g_core.tls_vars[i];
+        if (tvar->name_hash == hash) {
+            tvar->user = user;
+            tvar->init_cb = init_cb;
+            return i + 1;
+        }
+    }
+
+    if (sx_array_count(g_core.tls_vars) == MAX_TLS_SLOTS) {
+        sx_assertf(0, "too many tls variables, increase MAX_TLS_SLOTS");
+        return 0;
+    }
+
+    rizz__tls_var tvar = (rizz__tls_var){ .name_hash = hash, .user = user, .init_cb = init_cb };
+    sx_array_push(g_core.heap_alloc, g_core.tls_vars, tvar);
+    return sx_array_count(g_core.tls_vars);
+}
+
+static void rizz__core_tls_register(const char* name, void* user,
+                                    void* (*init_cb)(int thread_idx, uint32_t thread_id, void* user))
+{
+    rizz__core_tls_register_slot(name, user, init_cb);
+}
+
+static void* rizz__core_tls_slot(int slot)
+{
+    // slot is 0 if registering has failed
+    if (slot <= 0 || slot > sx_array_count(g_core.tls_vars)) {
+        sx_assertf(0, "invalid tls slot");
+        return NULL;
+    }
+
+    if (tl_tls_gen != g_tls_gen) {
+        sx_memset(tl_tls_slots, 0x0, sizeof(tl_tls_slots));
+        tl_tls_gen = g_tls_gen;
+    }
+
+    void* var = tl_tls_slots[slot];
+    if (!var) {
+        const rizz__tls_var* tvar = &g_core.tls_vars[slot - 1];
+        var = tvar->init_cb(sx_job_thread_index(g_core.jobs), sx_job_thread_id(g_core.jobs), tvar->user);
+        tl_tls_slots[slot] = var;
+    }
+    return var;
+}
+
+static void* rizz__core_tls_var(const char* name)
+{
+    sx_assert(name);
+    uint32_t hash = sx_hash_fnv32_str(name);
+    for (int i = 0, c = sx_array_count(g_core.tls_vars); i < c; i++) {
+        if (g_core.tls_vars[i].name_hash == hash) {
+            return rizz__core_tls_slot(i + 1);
+        }
+    }
+
+    sx_assertf(0, "tls_var not registered");
+    return NULL;
+}
+
 static bool rizz__init_tmp_alloc_tls(rizz__tmp_alloc_tls* tmpalloc)
 {
     sx_assert(!tmpalloc->init);
@@ -1257,6 +2359,7 @@ bool rizz__core_init(const rizz_config* conf)
     g_core.app_ver = conf->app_version;
     g_core.flags = conf->core_flags;
     g_core.log_level = conf->log_level;
+    ++g_tls_gen;
 
     // resolve number of worker threads if not defined explicitly
     // NOTE: we always have at least one extra worker thread not matter what input is
@@ -1302,12 +2405,21 @@ bool rizz__core_init(const rizz_config* conf)
         sx_strcpy(g_core.log_file, sizeof(g_core.log_file), conf->app_name);
         sx_strcat(g_core.log_file, sizeof(g_core.log_file), ".log");
         rizz__log_init_file(g_core.log_file);
-        rizz__log_register_backend("file", rizz__log_backend_file, NULL);
+    }
+
+    if (g_core.flags & RIZZ_CORE_FLAG_LOG_BINARY) {
+        sx_strcpy(g_core.log_binary_file, sizeof(g_core.log_binary_file), conf->app_name);
+        sx_strcat(g_core.log_binary_file, sizeof(g_core.log_binary_file), ".rlog");
     }
 
     if (g_core.flags & RIZZ_CORE_FLAG_LOG_TO_PROFILER) {
         rizz__log_register_backend("remotery", rizz__log_backend_remotery, NULL);
     }
+
+    // log calls only push records into per-thread rings, formatting and output is done by the writer thread
+    if (!rizz__log_init_writer()) {
+        rizz__log_warn("(init) creating log writer thread failed, logging synchronously");
+    }
     rizz__profile_startup_end();    // log
 
     // log version
@@ -1330,7 +2442,8 @@ bool rizz__core_init(const rizz_config* conf)
                                        .max_fibers = conf->job_max_fibers,
                                        .fiber_stack_sz = conf->job_stack_size * 1024,
                                        .thread_init_cb = rizz__job_thread_init_cb,
-                                       .thread_shutdown_cb = rizz__job_thread_shutdown_cb });
+                                       .thread_shutdown_cb = rizz__job_thread_shutdown_cb,
+                                       .job_done_cb = rizz__job_done_cb });
     if (!g_core.jobs) {
         rizz__profile_startup_end();
         rizz__log_error("initializing job dispatcher failed");
@@ -1433,7 +2546,8 @@ bool rizz__core_init(const rizz_config* conf)
     // coroutines
     rizz__profile_startup_begin("coroutines");
     g_core.coro = sx_coro_create_context(g_core.coro_alloc, conf->coro_num_init_fibers, conf->coro_stack_size * 1024);
-    if (!g_core.coro) {
+    g_core.coro_read_handles = sx_handle_create_pool(g_core.core_alloc, 16);
+    if (!g_core.coro || !g_core.coro_read_handles) {
         rizz__profile_startup_end();
         rizz__log_error("initializing coroutines failed");
         return false;
@@ -1507,6 +2621,11 @@ void rizz__core_release(void)
     if (g_core.coro) {
         sx_coro_destroy_context(g_core.coro);
     }
+    sx_array_free(alloc, g_core.coro_job_waiters);
+    if (g_core.coro_read_handles) {
+        sx_handle_destroy_pool(g_core.coro_read_handles, alloc);
+    }
+    sx_array_free(alloc, g_core.coro_reads);
 
     if (g_core.flags & RIZZ_CORE_FLAG_DUMP_UNUSED_ASSETS) {
         rizz__asset_dump_unused("unused-assets.txt");
@@ -1542,6 +2661,8 @@ void rizz__core_release(void)
     sx_mutex_release(&g_core.tmp_allocs_mtx);
 
     // release log backends and queues
+    rizz__log_release_writer();
+    g_core.flags &= ~RIZZ_CORE_FLAG_LOG_TO_FILE;
     sx_mutex_release(&g_core.log_mtx);
     sx_strpool_destroy(g_core.log_strpool, alloc);
     sx_array_free(alloc, g_core.log_entries);
@@ -1555,12 +2676,6 @@ void rizz__core_release(void)
     rizz__mem_destroy_allocator(g_core.core_alloc);
     rizz__mem_release();
     
-    for (int i = 0; i < sx_array_count(g_core.tls_vars); i++) {
-        if (g_core.tls_vars[i].tls) {
-            sx_tls_destroy(g_core.tls_vars[i].tls);
-        }
-    }
-
     sx_array_free(g_core.heap_alloc, g_core.tls_vars);
     rizz__log_info("shutdown");
 
@@ -1570,6 +2685,32 @@ void rizz__core_release(void)
     sx_memset(&g_core, 0x0, sizeof(g_core));
 }
 
+// resumes coroutines whose jobs are marked done by rizz__job_done_cb
+static void rizz__core_coro_update_job_waiters(void)
+{
+    if (!sx_atomic_exchange32(&g_core.coro_jobs_done, 0)) {
+        return;
+    }
+
+    sx_lock(g_core.coro_job_lk) {
+        for (int i = 0; i < sx_array_count(g_core.coro_job_waiters); i++) {
+            rizz__coro_job_waiter* waiter = &g_core.coro_job_waiters[i];
+            if (!waiter->done) {
+                continue;
+            }
+
+            // job handles are reused, so the callback may be for an older job with the same handle
+            if (sx_job_test_and_del(g_core.jobs, waiter->job)) {
+                sx_coro_resume(g_core.coro, waiter->coro);
+                sx_array_pop(g_core.coro_job_waiters, i);
+                --i;
+            } else {
+                waiter->done = false;
+            }
+        }
+    }
+}
+
 void rizz__core_frame(void)
 {
     if (g_core.paused) {
@@ -1688,6 +2829,7 @@ void rizz__core_frame(void)
         rizz__gfx_update();
 
         rizz__profile(Coroutines) {
+            rizz__core_coro_update_job_waiters();
             sx_coro_update(g_core.coro, dt);
         }
 
@@ -1931,6 +3073,98 @@ static void rizz__core_coro_yield(void* pfrom, int nframes)
     sx__coro_yield(g_core.coro, pfrom, nframes);
 }
 
+void rizz__coro_resume(sx_coro_handle coro)
+{
+    sx_coro_resume(g_core.coro, coro);
+}
+
+static rizz_asset_state rizz__core_coro_await_asset(void* pfrom, rizz_asset asset)
+{
+    if (rizz__asset_await(asset, (rizz_asset_group){ 0 }, sx_coro_current(g_core.coro))) {
+        sx__coro_await(g_core.coro, pfrom);
+    }
+
+    // asset may be unloaded while the coroutine was waiting
+    return rizz__asset_valid(asset) ? the__asset.state(asset) : RIZZ_ASSET_STATE_ZOMBIE;
+}
+
+static void rizz__core_coro_await_group(void* pfrom, rizz_asset_group group)
+{
+    if (rizz__asset_await((rizz_asset){ 0 }, group, sx_coro_current(g_core.coro))) {
+        sx__coro_await(g_core.coro, pfrom);
+    }
+}
+
+static void rizz__core_coro_await_job(void* pfrom, sx_job_t job)
+{
+    // the job is tested inside the lock, so it's either finished here or rizz__job_done_cb finds the waiter
+    bool wait = false;
+    sx_lock(g_core.coro_job_lk) {
+        if (!sx_job_test_and_del(g_core.jobs, job)) {
+            rizz__coro_job_waiter waiter = { .job = job, .coro = sx_coro_current(g_core.coro) };
+            sx_array_push(g_core.core_alloc, g_core.coro_job_waiters, waiter);
+            wait = true;
+        }
+    }
+
+    if (wait) {
+        sx__coro_await(g_core.coro, pfrom);
+    }
+}
+
+static void rizz__core_coro_on_read(const char* path, sx_mem_block* mem, void* user)
+{
+    sx_unused(path);
+    sx_handle_t handle = (sx_handle_t)(uintptr_t)user;
+    if (!sx_handle_valid(g_core.coro_read_handles, handle)) {
+        sx_assertf(0, "invalid coroutine read request");
+        if (mem) {
+            sx_mem_destroy_block(mem);
+        }
+        return;
+    }
+
+    rizz__coro_read_request* req = &g_core.coro_reads[sx_handle_index(handle)];
+    if (sx_coro_valid(g_core.coro, req->coro)) {
+        // coroutine takes the memory and frees the request when it continues
+        req->mem = mem;
+        sx_coro_resume(g_core.coro, req->coro);
+    } else {
+        // coroutine is ended or restarted, nobody waits for the data
+        if (mem) {
+            sx_mem_destroy_block(mem);
+        }
+        sx_handle_del(g_core.coro_read_handles, handle);
+    }
+}
+
+static sx_mem_block* rizz__core_coro_await_read(void* pfrom, const char* path, rizz_vfs_flags flags,
+                                                const sx_alloc* alloc)
+{
+    sx_handle_t handle = sx_handle_new_and_grow(g_core.coro_read_handles, g_core.core_alloc);
+    if (!handle) {
+        sx_out_of_memory();
+        return NULL;
+    }
+
+    rizz__coro_read_request req = { .coro = sx_coro_current(g_core.coro) };
+    sx_array_push_byindex(g_core.core_alloc, g_core.coro_reads, req, sx_handle_index(handle));
+    the__vfs.read_async(path, flags, alloc, rizz__core_coro_on_read, (void*)(uintptr_t)handle);
+    sx__coro_await(g_core.coro, pfrom);
+
+    sx_mem_block* mem = g_core.coro_reads[sx_handle_index(handle)].mem;
+    sx_handle_del(g_core.coro_read_handles, handle);
+    return mem;
+}
+
+static const rizz_http_state* rizz__core_coro_await_http(void* pfrom, rizz_http handle)
+{
+    if (rizz__http_await(handle, sx_coro_current(g_core.coro))) {
+        sx__coro_await(g_core.coro, pfrom);
+    }
+    return the__http.state(handle);
+}
+
 void rizz__core_fix_callback_ptrs(const void** ptrs, const void** new_ptrs, int num_ptrs)
 {
     for (int i = 0; i < num_ptrs; i++) {
@@ -1957,44 +3191,6 @@ void rizz__core_fix_callback_ptrs(const void** ptrs, const void** new_ptrs, int
     }
 }
 
-static void rizz__core_tls_register(const char* name, void* user,
-                                    void* (*init_cb)(int thread_idx, uint32_t thread_id, void* user))
-{
-    sx_assert(name);
-    sx_assert(init_cb);
-
-    rizz__tls_var tvar = (rizz__tls_var){ .name_hash = sx_hash_fnv32_str(name),
-                                          .user = user,
-                                          .init_cb = init_cb,
-                                          .tls = sx_tls_create() };
-
-    sx_assert(tvar.tls);
-
-    sx_array_push(g_core.heap_alloc, g_core.tls_vars, tvar);
-}
-
-static void* rizz__core_tls_var(const char* name)
-{
-    sx_assert(name);
-    uint32_t hash = sx_hash_fnv32_str(name);
-    for (int i = 0, c = sx_array_count(g_core.tls_vars); i < c; i++) {
-        rizz__tls_var* tvar = &g_core.tls_vars[i];
-
-        if (tvar->name_hash == hash) {
-            void* var = sx_tls_get(tvar->tls);
-            if (!var) {
-                var = tvar->init_cb(sx_job_thread_index(g_core.jobs), sx_job_thread_id(g_core.jobs),
-                                    tvar->user);
-                sx_tls_set(tvar->tls, var);
-            }
-            return var;
-        }
-    }
-
-    sx_assertf(0, "tls_var not registered");
-    return NULL;
-}
-
 static rizz_version rizz__version(void)
 {
     return g_core.ver;
@@ -2123,6 +3319,8 @@ rizz_api_core the__core = { .heap_alloc = rizz__heap_alloc,
                             .tmp_alloc_push_trace = rizz__tmp_alloc_push_trace,
                             .tls_register = rizz__core_tls_register,
                             .tls_var = rizz__core_tls_var,
+                            .tls_register_slot = rizz__core_tls_register_slot,
+                            .tls_slot = rizz__core_tls_slot,
                             .trace_alloc_create = rizz__mem_create_allocator,
                             .trace_alloc_destroy = rizz__mem_destroy_allocator,
                             .trace_alloc_clear = rizz__mem_allocator_clear_trace,
@@ -2154,6 +3352,11 @@ rizz_api_core the__core = { .heap_alloc = rizz__heap_alloc,
                             .coro_end = rizz__core_coro_end,
                             .coro_wait = rizz__core_coro_wait,
                             .coro_yield = rizz__core_coro_yield,
+                            .coro_await_asset = rizz__core_coro_await_asset,
+                            .coro_await_group = rizz__core_coro_await_group,
+                            .coro_await_job = rizz__core_coro_await_job,
+                            .coro_await_read = rizz__core_coro_await_read,
+                            .coro_await_http = rizz__core_coro_await_http,
                             .register_log_backend = rizz__log_register_backend,
                             .unregister_log_backend = rizz__log_unregister_backend,
                             .print_info = rizz__print_info,
@@ -23,6 +23,7 @@
 #include "sx/string.h"
 #include "sx/atomic.h"
 #include "sx/lockless.h"
+#include "sx/math-scalar.h"
 
 #include "cj5/cj5.h"
 
@@ -40,6 +41,9 @@
 #define STAGE_ORDER_ID_BITS         10       
 #define STAGE_ORDER_ID_MASK         0x03ff   
 #define CHECKER_TEXTURE_SIZE        128
+#define TEXTURE_STREAM_BASE_SIZE    64      // streamed textures always keep the mips up to this size resident
+#define TEXTURE_STREAM_MAX_READS    4       // maximum number of in-flight mip reads
+#define TEXTURE_STREAM_IDLE_FRAMES  120     // textures that are not requested for this long fall back to base mips
 
 static sx_alloc* g_gfx_alloc = NULL;
 
@@ -154,6 +158,31 @@ typedef struct rizz__sgs_chunk {
     int parent_id;
 } rizz__sgs_chunk;
 
+// mip indexes are relative to the loaded texture (0 is the mip at `first_mip` of the file)
+typedef struct rizz__texture_stream {
+    rizz_texture* tex;
+    uint32_t serial;                        // validates in-flight reads, textures can be released meanwhile
+    char path[RIZZ_MAX_PATH];               // real path of the file, for reading the mips again
+    rizz_vfs_flags vfs_flags;
+    sg_image_desc desc;                     // initial image desc, content is filled on each residency change
+    int first_mip;
+    int num_mips;
+    int base_mip;                           // least detailed residency, base mips are always in memory
+    int resident_mip;                       // most detailed mip that is in video memory
+    int requested_mip;                      // most detailed mip that is requested in `last_request_frame`
+    int pending_mip;                        // mip that is being read, -1 if there is no read
+    bool failed;                            // file can't be streamed from, no reads until the texture is reloaded
+    int64_t last_request_frame;
+    int64_t mip_size[SG_MAX_MIPMAPS];
+    uint8_t* base_data;                     // copy of base mips, evicting to base mips doesn't need a read
+} rizz__texture_stream;
+
+typedef struct rizz__texture_stream_read {
+    rizz_texture* tex;
+    uint32_t serial;
+    int mip;
+} rizz__texture_stream_read;
+
 typedef struct rizz__gfx_texture_mgr {
     rizz_texture white_tex;
     rizz_texture black_tex;
@@ -162,6 +191,16 @@ typedef struct rizz__gfx_texture_mgr {
     sg_filter    default_mag_filter;
     int          default_aniso;
     int          default_first_mip;
+
+    rizz__texture_stream** SX_ARRAY streams;
+    sx_hashtbl*  stream_tbl;                // key: hash of rizz_texture pointer, value: index to streams
+    uint32_t     stream_serial;
+    int64_t      stream_budget;             // =0 if unlimited
+    int64_t      stream_resident_size;
+    int64_t      stream_pending_size;       // size change of in-flight reads, counts against the budget
+    int          num_stream_reads;
+    int64_t      num_stream_ins;
+    int64_t      num_stream_evicts;
 } rizz__gfx_texture_mgr;
 
 typedef enum rizz__gfx_command {
@@ -566,6 +605,379 @@ static inline sg_pixel_format rizz__texture_get_texture_format(ddsktx_format fmt
     }
 }
 
+static inline uint32_t rizz__texture_stream_key(const rizz_texture* tex)
+{
+    uint32_t key = sx_hash_u64_to_u32((uint64_t)(uintptr_t)tex);
+    return key ? key : 1;
+}
+
+static int rizz__texture_stream_find(const rizz_texture* tex)
+{
+    if (!g_gfx.tex_mgr.stream_tbl) {
+        return -1;
+    }
+
+    int index = sx_hashtbl_find_get(g_gfx.tex_mgr.stream_tbl, rizz__texture_stream_key(tex), -1);
+    if (index != -1 && g_gfx.tex_mgr.streams[index]->tex != tex) {
+        // pointer hash collision, colliding streams are not in the table
+        index = -1;
+        for (int i = 0, c = sx_array_count(g_gfx.tex_mgr.streams); i < c; i++) {
+            if (g_gfx.tex_mgr.streams[i]->tex == tex) {
+                index = i;
+                break;
+            }
+        }
+    }
+    return index;
+}
+
+static int64_t rizz__texture_stream_size(const rizz__texture_stream* stream, int mip)
+{
+    int64_t size = 0;
+    for (int i = mip; i < stream->num_mips; i++) {
+        size += stream->mip_size[i];
+    }
+    return size;
+}
+
+// called by the loader thread, copies base mips and sets the desc to upload only them
+static rizz__texture_stream* rizz__texture_stream_create(rizz_texture* tex, sg_image_desc* desc,
+                                                         const ddsktx_texture_info* tc,
+                                                         const sx_mem_block* mem, int first_mip)
+{
+    int num_mips = tex->info.mips;
+    int base_mip = 0;
+    while (base_mip < num_mips - 1 &&
+           sx_max(tex->info.width >> base_mip, tex->info.height >> base_mip) > TEXTURE_STREAM_BASE_SIZE) {
+        ++base_mip;
+    }
+
+    if (base_mip == 0) {
+        return NULL;    // too small, nothing to stream
+    }
+
+    int64_t mip_size[SG_MAX_MIPMAPS];
+    int64_t base_size = 0;
+    for (int mip = 0; mip < num_mips; mip++) {
+        ddsktx_sub_data sub_data;
+        ddsktx_get_sub(tc, &sub_data, mem->data, (int)mem->size, 0, 0, first_mip + mip);
+        mip_size[mip] = sub_data.size_bytes;
+        if (mip >= base_mip) {
+            base_size += sub_data.size_bytes;
+        }
+    }
+
+    rizz__texture_stream* stream = sx_malloc(g_gfx_alloc, sizeof(rizz__texture_stream) + (size_t)base_size);
+    if (!stream) {
+        sx_out_of_memory();
+        return NULL;
+    }
+    sx_memset(stream, 0x0, sizeof(rizz__texture_stream));
+    stream->tex = tex;
+    stream->first_mip = first_mip;
+    stream->num_mips = num_mips;
+    stream->base_mip = base_mip;
+    stream->resident_mip = base_mip;
+    stream->requested_mip = base_mip;
+    stream->pending_mip = -1;
+    stream->base_data = (uint8_t*)(stream + 1);
+    sx_memcpy(stream->mip_size, mip_size, sizeof(mip_size[0]) * num_mips);
+
+    uint8_t* dst = stream->base_data;
+    for (int mip = base_mip; mip < num_mips; mip++) {
+        ddsktx_sub_data sub_data;
+        ddsktx_get_sub(tc, &sub_data, mem->data, (int)mem->size, 0, 0, first_mip + mip);
+        sx_memcpy(dst, sub_data.buff, sub_data.size_bytes);
+        desc->content.subimage[0][mip - base_mip].ptr = dst;
+        desc->content.subimage[0][mip - base_mip].size = sub_data.size_bytes;
+        dst += sub_data.size_bytes;
+    }
+    desc->width = sx_max(tex->info.width >> base_mip, 1);
+    desc->height = sx_max(tex->info.height >> base_mip, 1);
+    desc->num_mipmaps = num_mips - base_mip;
+
+    return stream;
+}
+
+// called by the main thread after the image is created
+static void rizz__texture_stream_register(rizz__texture_stream* stream, const sg_image_desc* desc,
+                                          const rizz_asset_load_params* params)
+{
+    rizz__gfx_texture_mgr* mgr = &g_gfx.tex_mgr;
+
+    stream->serial = ++mgr->stream_serial;
+    stream->desc = *desc;
+    stream->desc.label = NULL;
+    sx_memset(&stream->desc.content, 0x0, sizeof(stream->desc.content));
+    sx_strcpy(stream->path, sizeof(stream->path), rizz__asset_real_path(params->path));
+    stream->vfs_flags = (params->flags & RIZZ_ASSET_LOAD_FLAG_ABSOLUTE_PATH) ? RIZZ_VFS_FLAG_ABSOLUTE_PATH : 0;
+    stream->last_request_frame = the__core.frame_index();
+
+    if (!mgr->stream_tbl || sx_hashtbl_full(mgr->stream_tbl)) {
+        bool r = mgr->stream_tbl ? sx_hashtbl_grow(&mgr->stream_tbl, g_gfx_alloc) :
+                    ((mgr->stream_tbl = sx_hashtbl_create(g_gfx_alloc, 256)) != NULL);
+        if (!r) {
+            sx_out_of_memory();
+            sx_free(g_gfx_alloc, stream);
+            return;
+        }
+    }
+
+    int index = sx_array_count(mgr->streams);
+    sx_array_push(g_gfx_alloc, mgr->streams, stream);
+
+    uint32_t key = rizz__texture_stream_key(stream->tex);
+    if (sx_hashtbl_find(mgr->stream_tbl, key) == -1) {
+        sx_hashtbl_add(mgr->stream_tbl, key, index);
+    }
+
+    mgr->stream_resident_size += rizz__texture_stream_size(stream, stream->base_mip);
+}
+
+static void rizz__texture_stream_unregister(rizz_texture* tex)
+{
+    rizz__gfx_texture_mgr* mgr = &g_gfx.tex_mgr;
+    int index = rizz__texture_stream_find(tex);
+    if (index == -1) {
+        return;
+    }
+
+    rizz__texture_stream* stream = mgr->streams[index];
+    mgr->stream_resident_size -= rizz__texture_stream_size(stream, stream->resident_mip);
+    if (stream->pending_mip != -1) {
+        // the read is discarded when it's done, because the stream is not found anymore
+        mgr->stream_pending_size -= rizz__texture_stream_size(stream, stream->pending_mip) -
+                                    rizz__texture_stream_size(stream, stream->resident_mip);
+    }
+
+    uint32_t key = rizz__texture_stream_key(tex);
+    int tbl_index = sx_hashtbl_find(mgr->stream_tbl, key);
+    sx_assert(tbl_index != -1);
+    bool owns_key = mgr->stream_tbl->values[tbl_index] == index;
+    if (owns_key) {
+        sx_hashtbl_remove(mgr->stream_tbl, tbl_index);
+    }
+
+    int last = sx_array_count(mgr->streams) - 1;
+    if (index != last) {
+        rizz__texture_stream* moved = mgr->streams[last];
+        mgr->streams[index] = moved;
+        int moved_tbl_index = sx_hashtbl_find(mgr->stream_tbl, rizz__texture_stream_key(moved->tex));
+        if (moved_tbl_index != -1 && mgr->stream_tbl->values[moved_tbl_index] == last) {
+            mgr->stream_tbl->values[moved_tbl_index] = index;
+        }
+    }
+    sx_array_pop_last(mgr->streams);
+
+    // give the key to a colliding stream, if there is any
+    if (owns_key) {
+        for (int i = 0, c = sx_array_count(mgr->streams); i < c; i++) {
+            if (rizz__texture_stream_key(mgr->streams[i]->tex) == key) {
+                sx_hashtbl_add(mgr->stream_tbl, key, i);
+                break;
+            }
+        }
+    }
+
+    sx_free(g_gfx_alloc, stream);
+}
+
+// creates a new image that holds mips [mip, num_mips) and replaces the current image of the texture
+// old image is destroyed with the usual deferred destroy, so it's still valid for queued commands
+static void rizz__texture_stream_set_mips(rizz__texture_stream* stream, int mip,
+                                          const sg_subimage_content* subimages)
+{
+    sx_assert(mip >= 0 && mip < stream->num_mips);
+    rizz_texture* tex = stream->tex;
+
+    sg_image_desc desc = stream->desc;
+    desc.width = sx_max(tex->info.width >> mip, 1);
+    desc.height = sx_max(tex->info.height >> mip, 1);
+    desc.num_mipmaps = stream->num_mips - mip;
+    desc.label = the__core.str_cstr(tex->info.name_hdl);
+    sx_memcpy(desc.content.subimage[0], subimages, sizeof(sg_subimage_content) * desc.num_mipmaps);
+
+    sg_image img = the__gfx.make_image(&desc);
+    if (!img.id) {
+        rizz__log_warn("texture streaming: creating image for '%s' failed", stream->path);
+        return;
+    }
+
+    the__gfx.destroy_image(tex->img);
+    tex->img = img;
+
+    g_gfx.tex_mgr.stream_resident_size += rizz__texture_stream_size(stream, mip) -
+                                          rizz__texture_stream_size(stream, stream->resident_mip);
+    if (mip < stream->resident_mip) {
+        ++g_gfx.tex_mgr.num_stream_ins;
+    } else {
+        ++g_gfx.tex_mgr.num_stream_evicts;
+    }
+    stream->resident_mip = mip;
+}
+
+static void rizz__texture_stream_evict(rizz__texture_stream* stream)
+{
+    sg_subimage_content subimages[SG_MAX_MIPMAPS];
+    uint8_t* data = stream->base_data;
+    for (int mip = stream->base_mip; mip < stream->num_mips; mip++) {
+        subimages[mip - stream->base_mip] =
+            (sg_subimage_content){ .ptr = data, .size = (int)stream->mip_size[mip] };
+        data += stream->mip_size[mip];
+    }
+    rizz__texture_stream_set_mips(stream, stream->base_mip, subimages);
+}
+
+static void rizz__texture_stream_on_read(const char* path, sx_mem_block* mem, void* user)
+{
+    rizz__gfx_texture_mgr* mgr = &g_gfx.tex_mgr;
+    rizz__texture_stream_read* req = user;
+    --mgr->num_stream_reads;
+
+    int index = rizz__texture_stream_find(req->tex);
+    rizz__texture_stream* stream = index != -1 ? mgr->streams[index] : NULL;
+    if (stream && stream->serial == req->serial) {
+        sx_assert(stream->pending_mip == req->mip);
+        mgr->stream_pending_size -= rizz__texture_stream_size(stream, req->mip) -
+                                    rizz__texture_stream_size(stream, stream->resident_mip);
+        stream->pending_mip = -1;
+
+        // on failure, the stream stays on its resident mips. reloading the texture creates a new
+        // stream, so reads are retried only after the file is modified
+        ddsktx_texture_info tc = { 0 };
+        ddsktx_error err;
+        if (!mem) {
+            rizz__log_warn("texture streaming: reading '%s' failed", path);
+            stream->failed = true;
+        } else if (!ddsktx_parse(&tc, mem->data, (int)mem->size, &err)) {
+            rizz__log_warn("texture streaming: parsing '%s' failed: %s", path, err.msg);
+            stream->failed = true;
+        } else if (tc.num_mips != stream->first_mip + stream->num_mips ||
+                   tc.width != (stream->tex->info.width << stream->first_mip)) {
+            // file is modified, texture is reloaded by the asset manager
+            rizz__log_warn("texture streaming: '%s' does not match the loaded texture", path);
+            stream->failed = true;
+        } else {
+            sg_subimage_content subimages[SG_MAX_MIPMAPS];
+            for (int mip = req->mip; mip < stream->num_mips; mip++) {
+                ddsktx_sub_data sub_data;
+                ddsktx_get_sub(&tc, &sub_data, mem->data, (int)mem->size, 0, 0, stream->first_mip + mip);
+                subimages[mip - req->mip] = (sg_subimage_content){ .ptr = sub_data.buff, .size = sub_data.size_bytes };
+            }
+            rizz__texture_stream_set_mips(stream, req->mip, subimages);
+        }
+    }
+
+    if (mem) {
+        sx_mem_destroy_block(mem);
+    }
+    sx_free(g_gfx_alloc, req);
+}
+
+static void rizz__texture_stream_read_mips(rizz__texture_stream* stream, int mip)
+{
+    rizz__gfx_texture_mgr* mgr = &g_gfx.tex_mgr;
+    rizz__texture_stream_read* req = sx_malloc(g_gfx_alloc, sizeof(rizz__texture_stream_read));
+    if (!req) {
+        sx_out_of_memory();
+        return;
+    }
+    *req = (rizz__texture_stream_read){ .tex = stream->tex, .serial = stream->serial, .mip = mip };
+
+    stream->pending_mip = mip;
+    mgr->stream_pending_size += rizz__texture_stream_size(stream, mip) -
+                                rizz__texture_stream_size(stream, stream->resident_mip);
+    ++mgr->num_stream_reads;
+    the__vfs.read_async(stream->path, stream->vfs_flags, the__vfs.alloc(), rizz__texture_stream_on_read, req);
+}
+
+static inline int rizz__texture_stream_wanted_mip(const rizz__texture_stream* stream, int64_t frame)
+{
+    return (frame - stream->last_request_frame) <= TEXTURE_STREAM_IDLE_FRAMES ?
+        stream->requested_mip : stream->base_mip;
+}
+
+// runs once per frame, before the game makes requests for the frame:
+//  - if streamed textures exceed the budget, idle textures (least recently requested first) are
+//    evicted to their base mips
+//  - textures that need more detail are read from the vfs, most detailed level that fits in the budget
+static void rizz__texture_stream_update(void)
+{
+    rizz__gfx_texture_mgr* mgr = &g_gfx.tex_mgr;
+    int64_t frame = the__core.frame_index();
+    int64_t budget = mgr->stream_budget > 0 ? mgr->stream_budget : INT64_MAX;
+    int num_streams = sx_array_count(mgr->streams);
+
+    while (mgr->stream_resident_size + mgr->stream_pending_size > budget) {
+        rizz__texture_stream* lru = NULL;
+        for (int i = 0; i < num_streams; i++) {
+            rizz__texture_stream* stream = mgr->streams[i];
+            if (stream->resident_mip < stream->base_mip && stream->pending_mip == -1 &&
+                (frame - stream->last_request_frame) > 1 &&
+                (!lru || stream->last_request_frame < lru->last_request_frame)) {
+                lru = stream;
+            }
+        }
+
+        if (!lru) {
+            break;
+        }
+        rizz__texture_stream_evict(lru);
+    }
+
+    // still over budget: drop the extra detail of visible textures that need less than they have
+    for (int i = 0; i < num_streams && mgr->num_stream_reads < TEXTURE_STREAM_MAX_READS &&
+                    mgr->stream_resident_size + mgr->stream_pending_size > budget; i++) {
+        rizz__texture_stream* stream = mgr->streams[i];
+        int mip = rizz__texture_stream_wanted_mip(stream, frame);
+        if (stream->pending_mip == -1 && mip > stream->resident_mip) {
+            if (mip == stream->base_mip || stream->failed) {
+                rizz__texture_stream_evict(stream);
+            } else {
+                rizz__texture_stream_read_mips(stream, mip);
+            }
+        }
+    }
+
+    for (int i = 0; i < num_streams && mgr->num_stream_reads < TEXTURE_STREAM_MAX_READS; i++) {
+        rizz__texture_stream* stream = mgr->streams[i];
+        int mip = rizz__texture_stream_wanted_mip(stream, frame);
+        if (stream->failed || stream->pending_mip != -1 || mip >= stream->resident_mip) {
+            continue;
+        }
+
+        int64_t resident_size = rizz__texture_stream_size(stream, stream->resident_mip);
+        int64_t available = budget - mgr->stream_resident_size - mgr->stream_pending_size;
+        while (mip < stream->resident_mip &&
+               (rizz__texture_stream_size(stream, mip) - resident_size) > available) {
+            ++mip;
+        }
+
+        if (mip < stream->resident_mip) {
+            rizz__texture_stream_read_mips(stream, mip);
+        }
+    }
+
+    g_gfx.trace.t.num_streamed_textures = num_streams;
+    g_gfx.trace.t.num_stream_reads = mgr->num_stream_reads;
+    g_gfx.trace.t.stream_resident_size = mgr->stream_resident_size;
+    g_gfx.trace.t.stream_budget = mgr->stream_budget;
+    g_gfx.trace.t.num_stream_ins = mgr->num_stream_ins;
+    g_gfx.trace.t.num_stream_evicts = mgr->num_stream_evicts;
+}
+
+static void rizz__texture_stream_release(void)
+{
+    rizz__gfx_texture_mgr* mgr = &g_gfx.tex_mgr;
+    for (int i = 0, c = sx_array_count(mgr->streams); i < c; i++) {
+        sx_free(g_gfx_alloc, mgr->streams[i]);
+    }
+    sx_array_free(g_gfx_alloc, mgr->streams);
+    if (mgr->stream_tbl) {
+        sx_hashtbl_destroy(mgr->stream_tbl, g_gfx_alloc);
+    }
+}
+
 static rizz_asset_load_data rizz__texture_on_prepare(const rizz_asset_load_params* params, const sx_mem_block* mem)
 {
     const sx_alloc* alloc = params->alloc ? params->alloc : g_gfx_alloc;
@@ -634,6 +1046,7 @@ static bool rizz__texture_on_load(rizz_asset_load_data* data, const rizz_asset_l
     const rizz_texture_load_params* tparams = params->params;
     rizz_texture* tex = data->obj.ptr;
     sg_image_desc* desc = data->user1;
+    bool stream = tparams->stream;
 
     int first_mip = tparams->first_mip ? tparams->first_mip : g_gfx.tex_mgr.default_first_mip;
     if (first_mip >= tex->info.mips) {
@@ -702,6 +1115,9 @@ static bool rizz__texture_on_load(rizz_asset_load_data* data, const rizz_asset_l
         else if (sx_strequal(params->metas[i].key, "srgb")) {
             desc->srgb = sx_tobool(params->metas[i].value);
         }
+        else if (sx_strequal(params->metas[i].key, "stream")) {
+            stream = sx_tobool(params->metas[i].value);
+        }
     }
 
     char ext[32];
@@ -715,12 +1131,16 @@ static bool rizz__texture_on_load(rizz_asset_load_data* data, const rizz_asset_l
 
             switch (tex->info.type) {
             case SG_IMAGETYPE_2D: {
-                for (int mip = first_mip; mip < tc.num_mips; mip++) {
-                    int dst_mip = mip - first_mip;
-                    ddsktx_sub_data sub_data;
-                    ddsktx_get_sub(&tc, &sub_data, mem->data, (int)mem->size, 0, 0, mip);
-                    desc->content.subimage[0][dst_mip].ptr = sub_data.buff;
-                    desc->content.subimage[0][dst_mip].size = sub_data.size_bytes;
+                // streamed textures upload only the base mips, see rizz__texture_stream_update
+                data->user2 = stream ? rizz__texture_stream_create(tex, desc, &tc, mem, first_mip) : NULL;
+                if (!data->user2) {
+                    for (int mip = first_mip; mip < tc.num_mips; mip++) {
+                        int dst_mip = mip - first_mip;
+                        ddsktx_sub_data sub_data;
+                        ddsktx_get_sub(&tc, &sub_data, mem->data, (int)mem->size, 0, 0, mip);
+                        desc->content.subimage[0][dst_mip].ptr = sub_data.buff;
+                        desc->content.subimage[0][dst_mip].size = sub_data.size_bytes;
+                    }
                 }
             } break;
             case SG_IMAGETYPE_CUBE: {
@@ -793,6 +1213,10 @@ static void rizz__texture_on_finalize(rizz_asset_load_data* data, const rizz_ass
 
     the__gfx.init_image(tex->img, desc);
 
+    if (data->user2) {
+        rizz__texture_stream_register(data->user2, desc, params);
+    }
+
     char ext[32];
     sx_os_path_ext(ext, sizeof(ext), params->path);
     // TODO: do something better in case of stbi
@@ -819,6 +1243,8 @@ static void rizz__texture_on_release(rizz_asset_obj obj, const sx_alloc* alloc)
     if (!alloc)
         alloc = g_gfx_alloc;
 
+    rizz__texture_stream_unregister(tex);
+
     if (tex->img.id)
         the__gfx.destroy_image(tex->img);
 
@@ -954,6 +1380,7 @@ static void rizz__texture_init(void)
 
 static void rizz__texture_release()
 {
+    rizz__texture_stream_release();
     if (g_gfx.tex_mgr.white_tex.img.id)
         the__gfx.destroy_image(g_gfx.tex_mgr.white_tex.img);
     if (g_gfx.tex_mgr.black_tex.img.id)
@@ -993,6 +1420,37 @@ static void rizz__texture_set_default_quality(sg_filter min_filter, sg_filter ma
     g_gfx.tex_mgr.default_first_mip = first_mip;
 }
 
+static void rizz__texture_stream_request_mip(rizz_asset texture_asset, int mip)
+{
+    const rizz_texture* tex = rizz__texture_get(texture_asset);
+    int index = rizz__texture_stream_find(tex);
+    if (index == -1) {
+        return;    // not streamed, or still loading
+    }
+
+    rizz__texture_stream* stream = g_gfx.tex_mgr.streams[index];
+    int64_t frame = the__core.frame_index();
+    mip = sx_clamp(mip, 0, stream->base_mip);
+    if (stream->last_request_frame != frame) {
+        stream->requested_mip = mip;
+        stream->last_request_frame = frame;
+    } else {
+        stream->requested_mip = sx_min(stream->requested_mip, mip);
+    }
+}
+
+static void rizz__texture_stream_request(rizz_asset texture_asset, float screen_size)
+{
+    const rizz_texture* tex = rizz__texture_get(texture_asset);
+    float ratio = (float)sx_max(tex->info.width, tex->info.height) / sx_max(screen_size, 1.0f);
+    rizz__texture_stream_request_mip(texture_asset, ratio > 1.0f ? (int)sx_log2(ratio) : 0);
+}
+
+static void rizz__texture_stream_set_budget(int64_t budget_bytes)
+{
+    g_gfx.tex_mgr.stream_budget = budget_bytes > 0 ? budget_bytes : 0;
+}
+
 static void rizz__texture_default_quality(sg_filter* min_filter, sg_filter* mag_filter, int* aniso, int* first_mip)
 {
     if (min_filter)
@@ -2147,6 +2605,9 @@ static void rizz__trace_destroy_image(sg_image img_id, void* user_data)
             int pixels = img->cmn.width * img->cmn.height * img->cmn.num_slices;
             int64_t size = (int64_t)pixels * bytesize;
             g_gfx.trace.t.render_target_size -= size;
+        } else if (!img->cmn.render_target) {
+            int pixels = img->cmn.width * img->cmn.height * img->cmn.num_slices;
+            g_gfx.trace.t.texture_size -= (int64_t)pixels * _sg_pixelformat_bytesize(img->cmn.pixel_format);
         }
         --g_gfx.trace.t.num_images;
     }
@@ -2405,6 +2866,7 @@ bool rizz__gfx_init(const sg_desc* desc, bool enable_profile)
         g_gfx.tex_mgr.default_mag_filter = conf->texture_filter_mag;
         g_gfx.tex_mgr.default_aniso = conf->texture_aniso;
         g_gfx.tex_mgr.default_first_mip = conf->texture_first_mip;
+        g_gfx.tex_mgr.stream_budget = (int64_t)conf->texture_stream_budget * 1024 * 1024;
     }
 
     return true;
@@ -2465,6 +2927,7 @@ void rizz__gfx_release()
 void rizz__gfx_update()
 {
     rizz__gfx_collect_garbage(the__core.frame_index());
+    rizz__texture_stream_update();
 }
 
 void rizz__gfx_commit_gpu()
@@ -4010,5 +4473,8 @@ rizz_api_gfx the__gfx = {
     .texture_set_default_quality= rizz__texture_set_default_quality,
     .texture_default_quality    = rizz__texture_default_quality,
     .texture_surface_pitch      = _sg_surface_pitch,
+    .texture_stream_request     = rizz__texture_stream_request,
+    .texture_stream_request_mip = rizz__texture_stream_request_mip,
+    .texture_stream_set_budget  = rizz__texture_stream_set_budget,
     .trace_info                 = rizz__trace_info,
 };
@@ -2,324 +2,2057 @@
 // Copyright 2019 Sepehr Taghdisian (septag@github). All rights reserved.
 // License: https://github.com/septag/rizz#license-bsd-2-clause
 //
+// HTTP/1.1 client (plain http, no https)
+// requests are processed by a background thread that multiplexes all sockets in a single event
+// loop (epoll on linux/android, poll on other platforms). host names are resolved in a separate
+// thread, so slow lookups don't stall the event loop. connections are kept alive and reused for
+// requests to the same host. response bodies are streamed into memory blocks as they arrive.
+// main thread only receives finished requests in `rizz__http_update`, there is no per-request polling
+// downloads are streamed into files in chunks that are written by the vfs worker, with per-chunk
+// checksums in a side file, so interrupted downloads can be verified and resumed with Range requests
+//
 
 #include "internal.h"
 
 #include "sx/array.h"
+#include "sx/atomic.h"
 #include "sx/handle.h"
+#include "sx/hash.h"
+#include "sx/io.h"
+#include "sx/os.h"
 #include "sx/string.h"
+#include "sx/threads.h"
+#include "sx/timer.h"
+
+#if SX_PLATFORM_WINDOWS
+#    include <winsock2.h>
+#    include <ws2tcpip.h>
+#    pragma comment(lib, "Ws2_32.lib")
+typedef SOCKET rizz__socket;
+#    define HTTP_INVALID_SOCKET INVALID_SOCKET
+#    define HTTP_SEND_FLAGS 0
+#    define rizz__http_close_socket(_s) closesocket(_s)
+#    define rizz__http_would_block() (WSAGetLastError() == WSAEWOULDBLOCK)
+#    define rizz__http_poll WSAPoll
+#else
+#    include <errno.h>
+#    include <fcntl.h>
+#    include <netdb.h>
+#    include <netinet/in.h>
+#    include <netinet/tcp.h>
+#    include <poll.h>
+#    include <sys/socket.h>
+#    include <sys/types.h>
+#    include <unistd.h>
+typedef int rizz__socket;
+#    define HTTP_INVALID_SOCKET -1
+#    if defined(MSG_NOSIGNAL)
+#        define HTTP_SEND_FLAGS MSG_NOSIGNAL
+#    else
+#        define HTTP_SEND_FLAGS 0
+#    endif
+#    define rizz__http_close_socket(_s) close(_s)
+#    define rizz__http_would_block() (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS)
+#    define rizz__http_poll poll
+#endif
 
-#define HTTP_IMPLEMENTATION
-#define HTTP_MALLOC(ctx, size) (sx_malloc((const sx_alloc*)ctx, size))
-#define HTTP_FREE(ctx, ptr) (sx_free((const sx_alloc*)ctx, ptr))
-SX_PRAGMA_DIAGNOSTIC_PUSH()
-SX_PRAGMA_DIAGNOSTIC_IGNORED_CLANG_GCC("-Wunused-variable")
-SX_PRAGMA_DIAGNOSTIC_IGNORED_CLANG("-Wshorten-64-to-32")
-SX_PRAGMA_DIAGNOSTIC_IGNORED_CLANG("-Wsign-compare")    // clang/win: comparison of different signs
-SX_PRAGMA_DIAGNOSTIC_IGNORED_MSVC(5105)
-#if SX_PLATFORM_ANDROID
-#    include <linux/in.h>
+#if SX_PLATFORM_LINUX || SX_PLATFORM_ANDROID
+#    include <sys/epoll.h>
+#    include <sys/eventfd.h>
+#    define HTTP_EPOLL 1
+#else
+#    define HTTP_EPOLL 0
 #endif
-#include "mattias/http.h"
-SX_PRAGMA_DIAGNOSTIC_POP();
+
+#define HTTP_MAX_HEADER_SIZE    16384
+#define HTTP_BODY_CHUNK_SIZE    65536       // bodies with unknown size are streamed into blocks of this size
+#define HTTP_RECV_BUFFER_SIZE   65536
+#define HTTP_IDLE_TIMEOUT       30.0        // seconds, idle keep-alive connections are closed after this
+#define HTTP_WAIT_MSECS         100         // event loop wakes up at least this often to close idle connections
+#define HTTP_DNS_RETRY_TIMEOUT  10.0        // seconds, failed host lookups are not retried before this
+#define HTTP_MAX_CHUNK_SIZE     0x40000000  // 1GB, larger sizes in chunked encoding are rejected
+#define HTTP_MAX_EVENTS         64
+#define HTTP_MAX_RETRIES        1           // retries on reused connections that are closed by the server
 
 typedef enum { HTTP_MODE_NONE, HTTP_MODE_GET, HTTP_MODE_POST } rizz__http_mode;
 
-typedef struct {
-    char* url;
-    rizz__http_mode mode;
-    void* data;
-    size_t size;
-} rizz__http_request_params;
+typedef enum {
+    HTTP_BODY_NONE = 0,
+    HTTP_BODY_LENGTH,       // Content-Length
+    HTTP_BODY_CHUNKED,      // Transfer-Encoding: chunked
+    HTTP_BODY_UNTIL_CLOSE   // no length, body ends when the server closes the connection
+} rizz__http_body_mode;
+
+typedef enum {
+    HTTP_CHUNK_SIZE = 0,
+    HTTP_CHUNK_DATA,
+    HTTP_CHUNK_DATA_END,
+    HTTP_CHUNK_TRAILER
+} rizz__http_chunk_state;
+
+#define HTTP_DOWNLOAD_MAGIC     0x4c445a52  // RZDL
+#define HTTP_DOWNLOAD_VERSION   1
+
+// header of ".partsum" files, followed by xxh64 hashes of every written chunk of the ".part" file
+typedef struct rizz__http_download_header {
+    uint32_t magic;
+    uint32_t version;
+    int64_t chunk_size;
+    int64_t total_size;     // =-1 if the server didn't send the size
+    uint64_t url_hash;
+    char etag[64];          // strong ETag of the file, sent in If-Range on resume
+} rizz__http_download_header;
+
+typedef struct rizz__http_download {
+    char url[RIZZ_MAX_PATH];
+    char path[RIZZ_MAX_PATH];
+    char part_path[RIZZ_MAX_PATH];
+    char sum_path[RIZZ_MAX_PATH];
+    rizz_vfs_flags vfs_flags;
+    rizz_http_progress_cb* progress_cb;
+    sx_job_t resume_job;
 
-typedef struct {
-    http_t* h;
-    rizz__http_request_params* params;    // optional: only allocated for inactive objects
+    // filled by the resume job, then owned by the http thread
+    rizz__http_download_header header;
+    int64_t resume_offset;          // bytes of the part file that are kept
+    bool complete;                  // part file is already complete, nothing to download
+    sx_mem_block* chunk;            // current chunk, starts with the unhashed tail of the part file
+    int64_t chunk_fill;
+    int64_t chunk_disk;             // bytes of the current chunk that are already in the part file
+    bool restart;                   // next chunk starts the part file, previous data is discarded
+    bool paused;                    // receiving is paused until main thread writes some chunks
+    bool discard;                   // part file doesn't match the server's file, it's removed on failure
+    sx_atomic_uint32 num_chunks;    // chunks that are sent to main thread and are not written yet
+
+    // main thread
+    int64_t written;
+    int num_writes;                 // vfs writes in flight
+    bool write_failed;
+} rizz__http_download;
+
+// chunk of a download that main thread passes to the vfs worker
+typedef struct rizz__http_download_chunk {
+    struct rizz__http_request* req;
+    sx_mem_block* data;     // bytes that are appended to the part file
+    uint64_t hash;          // xxh64 of the whole chunk
+    bool hashed;            // =false for the incomplete tail of failed downloads, data is kept for resume
+    bool first;             // starts the part file, partsum header is also rewritten
+} rizz__http_download_chunk;
+
+typedef struct rizz__http_conn rizz__http_conn;
+
+typedef struct rizz__http_request {
+    rizz_http_state state;      // main thread: filled when the request is received from the http thread
+    rizz_http handle;
     rizz_http_cb* callback;
     void* callback_user;
-} rizz__http;
+    sx_coro_handle waiter;      // coroutine that awaits the request (coro_await_http)
+    sx_atomic_uint32 cancelled; // freed by the user while in flight, result is dropped
+    sx_atomic_uint32 aborted;   // download failed to write, connection is closed
+    rizz__http_download* dl;    // only for downloads
+
+    // http thread
+    char host[256];
+    char port[16];
+    char* request_data;         // header + post data
+    int request_size;
+    int request_offset;
+    rizz__http_conn* conn;
+    int num_retries;
+    bool received;              // received any response bytes
+    bool failed;
+
+    // response
+    char* SX_ARRAY header;
+    bool header_done;
+    bool keep_alive;
+    int status_code;
+    char reason_phrase[64];
+    char content_type[128];
+    rizz__http_body_mode body_mode;
+    int64_t content_length;
+    int64_t chunk_remain;
+    rizz__http_chunk_state chunk_state;
+    char chunk_line[32];
+    int chunk_line_len;
+    sx_mem_block* body;                 // final body, allocated upfront if Content-Length is known
+    sx_mem_block** SX_ARRAY body_chunks;
+    int64_t body_size;
+} rizz__http_request;
+
+typedef enum {
+    HTTP_HOST_UNRESOLVED = 0,
+    HTTP_HOST_RESOLVING,        // waiting for the resolver thread, requests to the host stay pending
+    HTTP_HOST_RESOLVED,
+    HTTP_HOST_FAILED
+} rizz__http_host_state;
+
+typedef struct rizz__http_host {
+    char host[256];
+    char port[16];
+    rizz__http_host_state state;
+    struct addrinfo* addr;      // all resolved addresses, connections fall back to the next one on failure
+    int num_conns;
+    uint64_t failed_tm;         // last failed lookup, so requests to that host don't wait for it again
+} rizz__http_host;
 
-typedef struct {
+// host lookup, passed to the resolver thread and back
+typedef struct rizz__http_resolve {
+    int host_index;
+    char host[256];
+    char port[16];
+    struct addrinfo* addr;      // result, NULL if the lookup has failed
+} rizz__http_resolve;
+
+typedef struct rizz__http_conn {
+    rizz__socket sock;
+    int host_index;
+    const struct addrinfo* addr;    // address that we are connecting to, in host's address list
+    rizz__http_request* req;    // active request, NULL if the connection is idle
+    bool connecting;
+    bool reused;                // completed at least one request
+    bool registered;            // added to epoll
+    uint32_t events;            // HTTP_EVENT_xxx that we are waiting for
+    uint64_t idle_tm;
+} rizz__http_conn;
+
+enum { HTTP_EVENT_READ = 0x1, HTTP_EVENT_WRITE = 0x2 };
+
+typedef struct rizz__http_context {
     sx_alloc* alloc;
-    sx_handle_pool* http_handles;    // rizz__http
-    rizz__http* SX_ARRAY https;
-    rizz_http pending[RIZZ_CONFIG_MAX_HTTP_REQUESTS];
-    int num_pending;
+    sx_handle_pool* http_handles;
+    rizz__http_request** SX_ARRAY requests;     // indexed by handle index
+
+    // queues between main thread and the http thread
+    sx_mutex queue_mtx;
+    rizz__http_request** SX_ARRAY submit_queue;
+    rizz__http_request** SX_ARRAY done_queue;
+    rizz__http_download_chunk* SX_ARRAY chunk_queue;
+    sx_thread* thread;
+    sx_atomic_uint32 quit;
+
+    // http thread
+    rizz__http_request** SX_ARRAY pending;      // waiting for a connection
+    rizz__http_host* SX_ARRAY hosts;
+    rizz__http_conn** SX_ARRAY conns;
+    char* recv_buff;
+
+    // resolver thread: getaddrinfo is blocking, so lookups don't run in the event loop
+    sx_thread* resolver_thread;
+    sx_sem resolve_sem;
+    sx_mutex resolve_mtx;
+    rizz__http_resolve* SX_ARRAY resolve_queue;     // lookups waiting for the resolver thread
+    rizz__http_resolve* SX_ARRAY resolved_queue;    // finished lookups, picked up by the http thread
+
+    // main thread: downloads that are verifying the existing file, or waiting for their last writes
+    rizz__http_request** SX_ARRAY resuming;
+    rizz__http_request** SX_ARRAY finishing;
+#if HTTP_EPOLL
+    int epoll_fd;
+    int wake_fd;
+#elif !SX_PLATFORM_WINDOWS
+    int wake_pipe[2];
+#else
+    rizz__socket wake_sock;     // udp socket connected to itself, pipes don't work with WSAPoll
+#endif
+
+    // stats
+    sx_atomic_uint32 num_connects;
+    sx_atomic_uint32 num_reuses;
 } rizz__http_context;
 
 static rizz__http_context g_http;
 
-bool rizz__http_init()
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// http thread: sockets and event loop
+static void rizz__http_wake(void)
 {
-    g_http.alloc = rizz__mem_create_allocator("Http", RIZZ_MEMOPTION_INHERIT, "Core", the__core.heap_alloc());
-    g_http.http_handles = sx_handle_create_pool(g_http.alloc, RIZZ_CONFIG_MAX_HTTP_REQUESTS);
-    if (!g_http.http_handles)
-        return false;
-
-    return true;
+#if HTTP_EPOLL
+    uint64_t n = 1;
+    ssize_t r = write(g_http.wake_fd, &n, sizeof(n));
+    sx_unused(r);
+#elif !SX_PLATFORM_WINDOWS
+    char c = 1;
+    ssize_t r = write(g_http.wake_pipe[1], &c, 1);
+    sx_unused(r);
+#else
+    char c = 1;
+    send(g_http.wake_sock, &c, 1, 0);
+#endif
 }
 
-void rizz__http_release()
+// connections without any events are removed from the poll set, otherwise errors and hang-ups are
+// still reported (level-triggered) and the event loop spins, for example while a download is paused
+static void rizz__http_set_events(rizz__http_conn* conn, uint32_t events)
 {
-    if (g_http.alloc) {
-        // remove remaining http requests
-        if (g_http.http_handles) {
-            for (int i = 0; i < g_http.http_handles->count; i++) {
-                sx_handle_t handle = sx_handle_at(g_http.http_handles, i);
-                rizz__http* http = &g_http.https[sx_handle_index(handle)];
-                if (http->h) {
-                    rizz__log_warn("un-freed active http request: 0x%p", http->h);
-                    http_release(http->h);
-                } else if (http->params) {
-                    rizz__log_warn("un-freed http request: %s", http->params->url);
-                    sx_free(g_http.alloc, http->params);
-                }
-            }
+    if (conn->events == events) {
+        return;
+    }
 
-            sx_handle_destroy_pool(g_http.http_handles, g_http.alloc);
+#if HTTP_EPOLL
+    if (events == 0) {
+        if (conn->registered) {
+            epoll_ctl(g_http.epoll_fd, EPOLL_CTL_DEL, conn->sock, NULL);
+            conn->registered = false;
         }
+    } else {
+        struct epoll_event ev = { .events = ((events & HTTP_EVENT_READ) ? EPOLLIN : 0) |
+                                            ((events & HTTP_EVENT_WRITE) ? EPOLLOUT : 0),
+                                  .data.ptr = conn };
+        epoll_ctl(g_http.epoll_fd, conn->registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, conn->sock, &ev);
+        conn->registered = true;
+    }
+#endif
+    conn->events = events;
+}
 
-        sx_array_free(g_http.alloc, g_http.https);
-        sx_memset(&g_http, 0x0, sizeof(g_http));
+static bool rizz__http_set_nonblocking(rizz__socket sock)
+{
+#if SX_PLATFORM_WINDOWS
+    u_long nonblocking = 1;
+    return ioctlsocket(sock, FIONBIO, &nonblocking) == 0;
+#else
+    int flags = fcntl(sock, F_GETFL, 0);
+    return flags != -1 && fcntl(sock, F_SETFL, flags | O_NONBLOCK) != -1;
+#endif
+}
+
+static void rizz__http_close_conn(rizz__http_conn* conn)
+{
+#if HTTP_EPOLL
+    if (conn->registered) {
+        epoll_ctl(g_http.epoll_fd, EPOLL_CTL_DEL, conn->sock, NULL);
+    }
+#endif
+    rizz__http_close_socket(conn->sock);
+    --g_http.hosts[conn->host_index].num_conns;
 
-        rizz__mem_destroy_allocator(g_http.alloc);
-        g_http.alloc = NULL;
+    for (int i = 0, c = sx_array_count(g_http.conns); i < c; i++) {
+        if (g_http.conns[i] == conn) {
+            sx_array_pop(g_http.conns, i);
+            break;
+        }
     }
+    sx_free(g_http.alloc, conn);
 }
 
-void rizz__http_update()
+// returns HTTP_INVALID_SOCKET if the connection can't be started
+static rizz__socket rizz__http_open_socket(const struct addrinfo* addr)
 {
-    int remove_list[RIZZ_CONFIG_MAX_HTTP_REQUESTS];
-    int num_removes = 0;
+    rizz__socket sock = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+    if (sock == HTTP_INVALID_SOCKET) {
+        return HTTP_INVALID_SOCKET;
+    }
 
-    // process pending
-    // for callback requests, call the callback and release the request automatically
-    for (int i = 0, c = g_http.num_pending; i < c; i++) {
-        rizz_http handle = g_http.pending[i];
-        rizz__http* http = &g_http.https[sx_handle_index(handle.id)];
-        sx_assert(http->h);
-        if (http->h->status != HTTP_STATUS_PENDING)
-            continue;
+    if (!rizz__http_set_nonblocking(sock)) {
+        rizz__http_close_socket(sock);
+        return HTTP_INVALID_SOCKET;
+    }
+
+    // requests are small and written at once, so we don't want them to wait for nagle
+    int nodelay = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char*)&nodelay, sizeof(nodelay));
+#if SX_PLATFORM_APPLE
+    int nosigpipe = 1;
+    setsockopt(sock, SOL_SOCKET, SO_NOSIGPIPE, &nosigpipe, sizeof(nosigpipe));
+#endif
+
+    if (connect(sock, addr->ai_addr, (int)addr->ai_addrlen) != 0 && !rizz__http_would_block()) {
+        rizz__http_close_socket(sock);
+        return HTTP_INVALID_SOCKET;
+    }
 
-        http_status_t status = http_process(http->h);
-        if (status != HTTP_STATUS_PENDING && http->callback) {
-            http->callback((const rizz_http_state*)http->h, http->callback_user);
-            sx_assertf(http->h, "must not `free` inside callback");
-            http_release(http->h);
-            http->h = NULL;
+    return sock;
+}
 
-            remove_list[num_removes++] = i;
+static rizz__http_conn* rizz__http_connect(int host_index)
+{
+    const rizz__http_host* host = &g_http.hosts[host_index];
+    const struct addrinfo* addr = host->addr;
+    rizz__socket sock = HTTP_INVALID_SOCKET;
+    for (; addr; addr = addr->ai_next) {
+        sock = rizz__http_open_socket(addr);
+        if (sock != HTTP_INVALID_SOCKET) {
+            break;
         }
     }
+    if (sock == HTTP_INVALID_SOCKET) {
+        return NULL;
+    }
 
-    // remove finished requests
-    // this applies to callbacks only, because non-callbacks should be freed by user manually
-    for (int i = 0; i < num_removes; i++) {
-        int index = remove_list[i];
-        sx_handle_del(g_http.http_handles, g_http.pending[index].id);
-        sx_swap(g_http.pending[index], g_http.pending[g_http.num_pending - 1], rizz_http);
-        --g_http.num_pending;
+    rizz__http_conn* conn = sx_malloc(g_http.alloc, sizeof(rizz__http_conn));
+    if (!conn) {
+        sx_out_of_memory();
+        rizz__http_close_socket(sock);
+        return NULL;
     }
+    *conn = (rizz__http_conn){ .sock = sock, .host_index = host_index, .addr = addr, .connecting = true };
+    sx_array_push(g_http.alloc, g_http.conns, conn);
+    ++g_http.hosts[host_index].num_conns;
+    sx_atomic_fetch_add32(&g_http.num_connects, 1);
+    return conn;
+}
 
-    // check if we have new requests to start
-    while (g_http.num_pending < RIZZ_CONFIG_MAX_HTTP_REQUESTS) {
-        // find an inactive handle in order to start new request
-        rizz_http inactive_handle = { 0 };
-        for (int i = 0, c = g_http.http_handles->count; i < c; i++) {
-            rizz_http handle = (rizz_http){ .id = sx_handle_at(g_http.http_handles, i) };
-            if (g_http.https[sx_handle_index(handle.id)].params) {
-                inactive_handle = handle;
-                break;
+// connecting has failed, tries the remaining addresses of the host (for example IPv4 after IPv6)
+// returns false if there are no more addresses to try
+static bool rizz__http_connect_next(rizz__http_conn* conn)
+{
+    for (const struct addrinfo* addr = conn->addr->ai_next; addr; addr = addr->ai_next) {
+        rizz__socket sock = rizz__http_open_socket(addr);
+        if (sock != HTTP_INVALID_SOCKET) {
+#if HTTP_EPOLL
+            if (conn->registered) {
+                epoll_ctl(g_http.epoll_fd, EPOLL_CTL_DEL, conn->sock, NULL);
+                conn->registered = false;
             }
+#endif
+            rizz__http_close_socket(conn->sock);
+            conn->sock = sock;
+            conn->addr = addr;
+            conn->events = 0;
+            rizz__http_set_events(conn, HTTP_EVENT_WRITE);
+            return true;
         }
+    }
+    return false;
+}
 
-        if (!inactive_handle.id)
+// returns index to g_http.hosts, or -1 if out of memory
+// new hosts are passed to the resolver thread, requests wait in the pending list until it's finished
+static int rizz__http_find_host(const char* hostname, const char* port)
+{
+    rizz__http_host* host = NULL;
+    for (int i = 0, c = sx_array_count(g_http.hosts); i < c; i++) {
+        if (sx_strequal(g_http.hosts[i].host, hostname) && sx_strequal(g_http.hosts[i].port, port)) {
+            host = &g_http.hosts[i];
             break;
+        }
+    }
 
-        rizz__http* http = &g_http.https[sx_handle_index(inactive_handle.id)];
-        const rizz__http_request_params* params = http->params;
-        switch (params->mode) {
-        case HTTP_MODE_GET:
-            http->h = http_get(params->url, (void*)g_http.alloc);
-            break;
+    if (!host) {
+        host = sx_array_add(g_http.alloc, g_http.hosts, 1);
+        if (!host) {
+            sx_out_of_memory();
+            return -1;
+        }
+        sx_memset(host, 0x0, sizeof(*host));
+        sx_strcpy(host->host, sizeof(host->host), hostname);
+        sx_strcpy(host->port, sizeof(host->port), port);
+    }
 
-        case HTTP_MODE_POST:
-            http->h = http_post(params->url, params->data, params->size, (void*)g_http.alloc);
-            break;
+    // failures are retried after a while
+    if (host->state == HTTP_HOST_FAILED && sx_tm_sec(sx_tm_since(host->failed_tm)) >= HTTP_DNS_RETRY_TIMEOUT) {
+        host->state = HTTP_HOST_UNRESOLVED;
+    }
 
-        default:
-            sx_assert(0);
-            break;
+    int host_index = (int)(host - g_http.hosts);
+    if (host->state == HTTP_HOST_UNRESOLVED) {
+        rizz__http_resolve resolve = { .host_index = host_index };
+        sx_strcpy(resolve.host, sizeof(resolve.host), hostname);
+        sx_strcpy(resolve.port, sizeof(resolve.port), port);
+        sx_mutex_lock(g_http.resolve_mtx) {
+            sx_array_push(g_http.alloc, g_http.resolve_queue, resolve);
         }
-        sx_free(g_http.alloc, http->params);
-        http->params = NULL;
-        g_http.pending[g_http.num_pending++] = inactive_handle;
+        host->state = HTTP_HOST_RESOLVING;
+        sx_semaphore_post(&g_http.resolve_sem, 1);
     }
+
+    return host_index;
 }
 
-static rizz__http_request_params* rizz__http_alloc_params(const char* url, rizz__http_mode mode,
-                                                          const void* data, size_t size)
+// picks up the lookups that are finished by the resolver thread
+static void rizz__http_update_hosts(void)
 {
-    int url_size = sx_strlen(url) + 1;
-    size_t total_sz = sizeof(rizz__http_request_params) + url_size + size;
-    uint8_t* buff = sx_malloc(g_http.alloc, total_sz);
-    if (!buff) {
-        sx_out_of_memory();
-        return NULL;
+    sx_mutex_lock(g_http.resolve_mtx) {
+        for (int i = 0, c = sx_array_count(g_http.resolved_queue); i < c; i++) {
+            const rizz__http_resolve* resolve = &g_http.resolved_queue[i];
+            rizz__http_host* host = &g_http.hosts[resolve->host_index];
+            sx_assert(host->state == HTTP_HOST_RESOLVING);
+            if (resolve->addr) {
+                host->addr = resolve->addr;
+                host->state = HTTP_HOST_RESOLVED;
+            } else {
+                host->failed_tm = sx_tm_now();
+                host->state = HTTP_HOST_FAILED;
+            }
+        }
+        sx_array_clear(g_http.resolved_queue);
     }
+}
+
+static int rizz__http_resolver_thread_cb(void* user1, void* user2)
+{
+    sx_unused(user1);
+    sx_unused(user2);
+
+    while (!sx_atomic_load32(&g_http.quit)) {
+        sx_semaphore_wait(&g_http.resolve_sem, -1);
 
-    rizz__http_request_params* p = (rizz__http_request_params*)buff;
-    buff += sizeof(rizz__http_request_params);
+        for (;;) {
+            rizz__http_resolve resolve;
+            bool found = false;
+            sx_mutex_lock(g_http.resolve_mtx) {
+                int count = sx_array_count(g_http.resolve_queue);
+                if (count > 0) {
+                    resolve = g_http.resolve_queue[count - 1];
+                    sx_array_pop_last(g_http.resolve_queue);
+                    found = true;
+                }
+            }
+            if (!found || sx_atomic_load32(&g_http.quit)) {
+                break;
+            }
 
-    p->url = (char*)buff;
-    buff += url_size;
-    sx_memcpy(p->url, url, url_size);
+            struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM, .ai_protocol = IPPROTO_TCP };
+            if (getaddrinfo(resolve.host, resolve.port, &hints, &resolve.addr) != 0) {
+                resolve.addr = NULL;
+            }
 
-    p->mode = mode;
-    p->size = size;
-    if (data) {
-        p->data = buff;
-        sx_memcpy(p->data, data, size);
+            sx_mutex_lock(g_http.resolve_mtx) {
+                sx_array_push(g_http.alloc, g_http.resolved_queue, resolve);
+            }
+            rizz__http_wake();
+        }
     }
 
-    return p;
+    return 0;
 }
 
-static rizz_http rizz__http_get(const char* url)
+static void rizz__http_free_body(rizz__http_request* req)
 {
-    sx_assert(g_http.alloc);
+    for (int i = 0; i < sx_array_count(req->body_chunks); i++) {
+        sx_mem_destroy_block(req->body_chunks[i]);
+    }
+    sx_array_clear(req->body_chunks);
+    if (req->body) {
+        sx_mem_destroy_block(req->body);
+        req->body = NULL;
+    }
+    req->body_size = 0;
+}
 
-    rizz_http handle =
-        (rizz_http){ .id = sx_handle_new_and_grow(g_http.http_handles, g_http.alloc) };
-    sx_assert(handle.id);
-    rizz__http _http = (rizz__http){ 0 };
+static void rizz__http_reset_response(rizz__http_request* req)
+{
+    rizz__http_free_body(req);
+    sx_array_clear(req->header);
+    req->header_done = false;
+    req->received = false;
+    req->request_offset = 0;
+    req->status_code = 0;
+    req->reason_phrase[0] = '\0';
+    req->content_type[0] = '\0';
+    req->body_mode = HTTP_BODY_NONE;
+    req->content_length = -1;
+    req->chunk_state = HTTP_CHUNK_SIZE;
+    req->chunk_line_len = 0;
+}
 
-    if (g_http.num_pending < RIZZ_CONFIG_MAX_HTTP_REQUESTS) {
-        _http.h = http_get(url, (void*)g_http.alloc);
-        g_http.pending[g_http.num_pending++] = handle;
-    } else {
-        _http.params = rizz__http_alloc_params(url, HTTP_MODE_GET, NULL, 0);
+// chunked and unknown-size bodies are merged into a single block, null-terminated like text
+static bool rizz__http_finalize_body(rizz__http_request* req)
+{
+    if (req->body) {
+        ((char*)req->body->data)[req->body_size] = '\0';
+        return true;
     }
 
-    int index = sx_handle_index(handle.id);
-    if (index >= sx_array_count(g_http.https))
-        sx_array_push(g_http.alloc, g_http.https, _http);
-    else
-        g_http.https[index] = _http;
+    sx_mem_block* body = sx_mem_create_block(g_http.alloc, req->body_size + 1, NULL, 0);
+    if (!body) {
+        return false;
+    }
 
-    return handle;
+    uint8_t* data = body->data;
+    int64_t remain = req->body_size;
+    for (int i = 0; i < sx_array_count(req->body_chunks); i++) {
+        int64_t size = sx_min(remain, (int64_t)HTTP_BODY_CHUNK_SIZE);
+        sx_memcpy(data, req->body_chunks[i]->data, (size_t)size);
+        data += size;
+        remain -= size;
+        sx_mem_destroy_block(req->body_chunks[i]);
+    }
+    sx_array_clear(req->body_chunks);
+    *data = '\0';
+    req->body = body;
+    return true;
 }
 
-static rizz_http rizz__http_post(const char* url, const void* data, size_t size)
+// passes the current chunk to main thread, which writes the new bytes to the part file
+static bool rizz__http_download_flush(rizz__http_request* req, bool hashed)
 {
-    sx_assert(g_http.alloc);
+    rizz__http_download* dl = req->dl;
+    int64_t size = dl->chunk_fill - dl->chunk_disk;
+    if (size == 0) {
+        return true;
+    }
 
-    rizz_http handle =
-        (rizz_http){ .id = sx_handle_new_and_grow(g_http.http_handles, g_http.alloc) };
-    sx_assert(handle.id);
-    rizz__http _http = (rizz__http){ 0 };
+    rizz__http_download_chunk chunk = { .req = req, .hashed = hashed, .first = dl->restart };
+    if (hashed) {
+        chunk.hash = sx_hash_xxh64(dl->chunk->data, (size_t)dl->chunk_fill, 0);
+    }
 
-    if (g_http.num_pending < RIZZ_CONFIG_MAX_HTTP_REQUESTS) {
-        _http.h = http_post(url, data, size, (void*)g_http.alloc);
-        g_http.pending[g_http.num_pending++] = handle;
+    if (dl->chunk_disk == 0) {
+        chunk.data = dl->chunk;
+        chunk.data->size = size;
+        dl->chunk = NULL;
     } else {
-        _http.params = rizz__http_alloc_params(url, HTTP_MODE_POST, data, size);
+        // chunk starts with data that is resumed from the part file, only the rest is written
+        chunk.data = sx_mem_create_block(g_http.alloc, size, (uint8_t*)dl->chunk->data + dl->chunk_disk, 0);
+        if (!chunk.data) {
+            return false;
+        }
     }
 
-    int index = sx_handle_index(handle.id);
-    if (index >= sx_array_count(g_http.https))
-        sx_array_push(g_http.alloc, g_http.https, _http);
-    else
-        g_http.https[index] = _http;
+    dl->restart = false;
+    dl->chunk_fill = 0;
+    dl->chunk_disk = 0;
+    sx_atomic_fetch_add32(&dl->num_chunks, 1);
+    sx_mutex_lock(g_http.queue_mtx) {
+        sx_array_push(g_http.alloc, g_http.chunk_queue, chunk);
+    }
+    return true;
+}
 
-    return handle;
+static bool rizz__http_download_write(rizz__http_request* req, const char* data, int64_t size)
+{
+    rizz__http_download* dl = req->dl;
+    while (size > 0) {
+        if (!dl->chunk) {
+            dl->chunk = sx_mem_create_block(g_http.alloc, RIZZ_CONFIG_HTTP_DOWNLOAD_CHUNK_SIZE, NULL, 0);
+            if (!dl->chunk) {
+                return false;
+            }
+        }
+
+        int64_t n = sx_min(size, RIZZ_CONFIG_HTTP_DOWNLOAD_CHUNK_SIZE - dl->chunk_fill);
+        sx_memcpy((uint8_t*)dl->chunk->data + dl->chunk_fill, data, (size_t)n);
+        dl->chunk_fill += n;
+        req->body_size += n;
+        data += n;
+        size -= n;
+
+        if (dl->chunk_fill == RIZZ_CONFIG_HTTP_DOWNLOAD_CHUNK_SIZE && !rizz__http_download_flush(req, true)) {
+            return false;
+        }
+    }
+    return true;
 }
 
-static void rizz__http_free(rizz_http handle)
+// checks the response of downloads, before receiving the body
+static bool rizz__http_download_begin(rizz__http_request* req, const char* content_range, const char* etag)
 {
-    sx_assert(g_http.alloc);
+    rizz__http_download* dl = req->dl;
+    if (req->status_code == 206 && dl->resume_offset > 0) {
+        // Content-Range: bytes <first>-<last>/<total>
+        if (!content_range || !sx_strnequalnocase(content_range, "bytes ", 6)) {
+            return false;
+        }
+        int64_t first = (int64_t)strtoll(content_range + 6, NULL, 10);
+        const char* total_str = sx_strchar(content_range, '/');
+        int64_t total = (total_str && total_str[1] != '*') ? (int64_t)strtoll(total_str + 1, NULL, 10) : -1;
+        if (first != dl->resume_offset || (dl->header.total_size >= 0 && total != dl->header.total_size)) {
+            dl->discard = true;
+            return false;
+        }
+        return true;
+    } else if (req->status_code == 416 && dl->resume_offset > 0) {
+        // range starts at the end of the file: part file is already complete if the sizes match
+        // Content-Range: bytes */<total>
+        const char* total_str = content_range ? sx_strchar(content_range, '/') : NULL;
+        int64_t total = (total_str && total_str[1] != '*') ? (int64_t)strtoll(total_str + 1, NULL, 10) : -1;
+        if (total != dl->resume_offset || (dl->header.total_size >= 0 && total != dl->header.total_size)) {
+            dl->discard = true;
+            return false;
+        }
 
-    sx_assert(handle.id);
-    rizz__http* http = &g_http.https[sx_handle_index(handle.id)];
-    sx_assertf(http->h, "double free?");
-    http_release(http->h);
-    http->h = NULL;
+        // response body is an error page, it's dropped in `rizz__http_body_write`
+        dl->complete = true;
+        req->status_code = 200;
+        sx_strcpy(req->reason_phrase, sizeof(req->reason_phrase), "OK");
+        return true;
+    } else if (req->status_code == 200) {
+        // we get the whole file if the server doesn't support ranges, or the file is changed (If-Range)
+        dl->restart = true;
+        dl->resume_offset = 0;
+        dl->chunk_fill = 0;
+        dl->chunk_disk = 0;
+        dl->header = (rizz__http_download_header){ .magic = HTTP_DOWNLOAD_MAGIC,
+                                                   .version = HTTP_DOWNLOAD_VERSION,
+                                                   .chunk_size = RIZZ_CONFIG_HTTP_DOWNLOAD_CHUNK_SIZE,
+                                                   .total_size = req->content_length,
+                                                   .url_hash = sx_hash_xxh64(dl->url, sx_strlen(dl->url), 0) };
+        // weak etags can't be used with If-Range
+        if (etag && !sx_strnequal(etag, "W/", 2)) {
+            sx_strcpy(dl->header.etag, sizeof(dl->header.etag), etag);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+static void rizz__http_finish(rizz__http_request* req, bool failed)
+{
+    rizz__http_conn* conn = req->conn;
+    if (conn) {
+        conn->req = NULL;
+        req->conn = NULL;
 
-    if (http->params) {
-        sx_free(g_http.alloc, http->params);
-        http->params = NULL;
+        if (failed || !req->keep_alive) {
+            rizz__http_close_conn(conn);
+        } else {
+            conn->reused = true;
+            conn->idle_tm = sx_tm_now();
+            rizz__http_set_events(conn, HTTP_EVENT_READ);    // detects the server closing the connection
+        }
     }
 
-    sx_handle_del(g_http.http_handles, handle.id);
+    if (req->dl) {
+        // on failures, the incomplete tail is written without a hash, so it can be resumed later
+        if (!rizz__http_download_flush(req, !failed)) {
+            failed = true;
+        }
+    } else if (!failed && !rizz__http_finalize_body(req)) {
+        failed = true;
+    }
+    if (failed) {
+        rizz__http_free_body(req);
+    }
+    req->failed = failed;
 
-    // remove from pending
-    for (int i = 0, c = g_http.num_pending; i < c; i++) {
-        if (g_http.pending[i].id == handle.id) {
-            sx_swap(g_http.pending[i], g_http.pending[c - 1], rizz_http);
-            --g_http.num_pending;
-            break;
+    sx_array_free(g_http.alloc, req->header);
+    sx_array_free(g_http.alloc, req->body_chunks);
+    req->header = NULL;
+    req->body_chunks = NULL;
+
+    sx_mutex_lock(g_http.queue_mtx) {
+        sx_array_push(g_http.alloc, g_http.done_queue, req);
+    }
+}
+
+static void rizz__http_fail(rizz__http_request* req)
+{
+    // keep-alive connections may be closed by the server at any time, so if nothing is received
+    // on a reused connection, we try again with a new one
+    rizz__http_conn* conn = req->conn;
+    if (conn && conn->reused && !req->received && req->num_retries < HTTP_MAX_RETRIES) {
+        ++req->num_retries;
+        conn->req = NULL;
+        req->conn = NULL;
+        rizz__http_close_conn(conn);
+        rizz__http_reset_response(req);
+        sx_array_push(g_http.alloc, g_http.pending, req);
+        return;
+    }
+
+    rizz__http_finish(req, true);
+}
+
+static bool rizz__http_body_write(rizz__http_request* req, const char* data, int64_t size)
+{
+    if (req->dl) {
+        if (req->dl->complete) {
+            req->body_size += size;
+            return true;
         }
+        return rizz__http_download_write(req, data, size);
     }
+
+    if (req->body) {
+        sx_assert(req->body_size + size <= req->content_length);
+        sx_memcpy((uint8_t*)req->body->data + req->body_size, data, (size_t)size);
+        req->body_size += size;
+        return true;
+    }
+
+    while (size > 0) {
+        int64_t offset = req->body_size % HTTP_BODY_CHUNK_SIZE;
+        if (offset == 0) {
+            sx_mem_block* chunk = sx_mem_create_block(g_http.alloc, HTTP_BODY_CHUNK_SIZE, NULL, 0);
+            if (!chunk) {
+                return false;
+            }
+            sx_array_push(g_http.alloc, req->body_chunks, chunk);
+        }
+
+        int64_t n = sx_min(size, HTTP_BODY_CHUNK_SIZE - offset);
+        sx_memcpy((uint8_t*)sx_array_last(req->body_chunks)->data + offset, data, (size_t)n);
+        req->body_size += n;
+        data += n;
+        size -= n;
+    }
+    return true;
 }
 
-static const rizz_http_state* rizz__http_state(rizz_http handle)
+// returns <0 on error, >0 if the body is complete, 0 if more data is needed
+static int rizz__http_parse_body(rizz__http_request* req, const char* data, int size)
 {
-    sx_assert(g_http.alloc);
-    sx_assert(handle.id);
+    switch (req->body_mode) {
+    case HTTP_BODY_NONE:
+        return 1;
+
+    case HTTP_BODY_LENGTH: {
+        int64_t n = sx_min((int64_t)size, req->content_length - req->body_size);
+        if (!rizz__http_body_write(req, data, n)) {
+            return -1;
+        }
+        return req->body_size == req->content_length ? 1 : 0;
+    }
+
+    case HTTP_BODY_UNTIL_CLOSE:
+        return rizz__http_body_write(req, data, size) ? 0 : -1;
+
+    case HTTP_BODY_CHUNKED:
+        while (size > 0) {
+            switch (req->chunk_state) {
+            case HTTP_CHUNK_SIZE: {
+                char ch = *data++;
+                --size;
+                if (ch == '\n') {
+                    req->chunk_line[req->chunk_line_len] = '\0';
+                    int64_t chunk_size = 0;
+                    for (const char* s = req->chunk_line; sx_ishexchar(*s); s++) {
+                        int digit = (*s >= '0' && *s <= '9') ? (*s - '0') : (sx_tolowerchar(*s) - 'a' + 10);
+                        chunk_size = chunk_size * 16 + digit;
+                        if (chunk_size > HTTP_MAX_CHUNK_SIZE) {
+                            return -1;
+                        }
+                    }
+                    if (req->chunk_line_len == 0 || chunk_size < 0) {
+                        return -1;
+                    }
+                    req->chunk_remain = chunk_size;
+                    req->chunk_line_len = 0;
+                    req->chunk_state = chunk_size > 0 ? HTTP_CHUNK_DATA : HTTP_CHUNK_TRAILER;
+                } else if (ch != '\r') {
+                    if (req->chunk_line_len == sizeof(req->chunk_line) - 1) {
+                        return -1;
+                    }
+                    req->chunk_line[req->chunk_line_len++] = ch;
+                }
+                break;
+            }
+
+            case HTTP_CHUNK_DATA: {
+                int64_t n = sx_min((int64_t)size, req->chunk_remain);
+                if (!rizz__http_body_write(req, data, n)) {
+                    return -1;
+                }
+                data += n;
+                size -= (int)n;
+                req->chunk_remain -= n;
+                if (req->chunk_remain == 0) {
+                    req->chunk_state = HTTP_CHUNK_DATA_END;
+                }
+                break;
+            }
 
-    return (const rizz_http_state*)g_http.https[sx_handle_index(handle.id)].h;
+            case HTTP_CHUNK_DATA_END:
+                if (*data++ == '\n') {
+                    req->chunk_state = HTTP_CHUNK_SIZE;
+                }
+                --size;
+                break;
+
+            case HTTP_CHUNK_TRAILER: {
+                // trailer headers are ignored, an empty line ends the response
+                char ch = *data++;
+                --size;
+                if (ch == '\n') {
+                    if (req->chunk_line_len == 0) {
+                        return 1;
+                    }
+                    req->chunk_line_len = 0;
+                } else if (ch != '\r') {
+                    req->chunk_line_len = 1;
+                }
+                break;
+            }
+            }
+        }
+        return 0;
+    }
+
+    return -1;
 }
 
-static void rizz__http_get_cb(const char* url, rizz_http_cb* callback, void* user)
+static bool rizz__http_parse_header(rizz__http_request* req, char* header)
 {
-    sx_assert(g_http.alloc);
+    // status line: HTTP/1.x code reason
+    if (!sx_strnequal(header, "HTTP/1.", 7)) {
+        return false;
+    }
+    req->keep_alive = header[7] != '0';
 
-    rizz_http handle =
-        (rizz_http){ .id = sx_handle_new_and_grow(g_http.http_handles, g_http.alloc) };
-    sx_assert(handle.id);
-    rizz__http _http = (rizz__http){ .callback = callback, .callback_user = user };
+    const char* code = sx_skip_whitespace(header + 8);
+    req->status_code = sx_toint(code);
+    const char* reason = sx_skip_whitespace(sx_skip_word(code));
+    const char* line_end = sx_strstr(reason, "\r\n");
+    sx_strncpy(req->reason_phrase, sizeof(req->reason_phrase), reason,
+               line_end ? (int)(uintptr_t)(line_end - reason) : sx_strlen(reason));
+
+    req->content_length = -1;
+    bool chunked = false;
+    const char* content_range = NULL;
+    const char* etag = NULL;
+    for (char* line = line_end ? (char*)line_end + 2 : NULL; line && *line; ) {
+        char* next = (char*)sx_strstr(line, "\r\n");
+        if (next) {
+            *next = '\0';
+            next += 2;
+        }
+
+        char* colon = (char*)sx_strchar(line, ':');
+        if (colon) {
+            *colon = '\0';
+            const char* value = sx_skip_whitespace(colon + 1);
+            if (sx_strequalnocase(line, "Content-Length")) {
+                req->content_length = (int64_t)strtoll(value, NULL, 10);
+            } else if (sx_strequalnocase(line, "Transfer-Encoding")) {
+                chunked = sx_strstr(value, "chunked") != NULL;
+            } else if (sx_strequalnocase(line, "Connection")) {
+                if (sx_strnequalnocase(value, "close", 5)) {
+                    req->keep_alive = false;
+                } else if (sx_strnequalnocase(value, "keep-alive", 10)) {
+                    req->keep_alive = true;
+                }
+            } else if (sx_strequalnocase(line, "Content-Type")) {
+                sx_strcpy(req->content_type, sizeof(req->content_type), value);
+            } else if (sx_strequalnocase(line, "Content-Range")) {
+                content_range = value;
+            } else if (sx_strequalnocase(line, "ETag")) {
+                etag = value;
+            }
+        }
+        line = next;
+    }
 
-    if (g_http.num_pending < RIZZ_CONFIG_MAX_HTTP_REQUESTS) {
-        _http.h = http_get(url, (void*)g_http.alloc);
-        g_http.pending[g_http.num_pending++] = handle;
+    if ((req->status_code >= 100 && req->status_code < 200) || req->status_code == 204 ||
+        req->status_code == 304) {
+        req->body_mode = HTTP_BODY_NONE;
+    } else if (chunked) {
+        req->body_mode = HTTP_BODY_CHUNKED;
+    } else if (req->content_length >= 0) {
+        req->body_mode = req->content_length > 0 ? HTTP_BODY_LENGTH : HTTP_BODY_NONE;
     } else {
-        _http.params = rizz__http_alloc_params(url, HTTP_MODE_GET, NULL, 0);
+        req->body_mode = HTTP_BODY_UNTIL_CLOSE;
+        req->keep_alive = false;
     }
 
-    int index = sx_handle_index(handle.id);
-    if (index >= sx_array_count(g_http.https))
-        sx_array_push(g_http.alloc, g_http.https, _http);
-    else
-        g_http.https[index] = _http;
+    if (req->dl) {
+        return rizz__http_download_begin(req, content_range, etag);
+    }
+
+    if (req->body_mode == HTTP_BODY_LENGTH) {
+        // size is known, so the body is received directly into it's final block
+        req->body = sx_mem_create_block(g_http.alloc, req->content_length + 1, NULL, 0);
+        if (!req->body) {
+            return false;
+        }
+    }
+
+    return true;
 }
 
-static void rizz__http_post_cb(const char* url, const void* data, size_t size,
-                               rizz_http_cb* callback, void* user)
+// returns <0 on error, >0 if the response is complete, 0 if more data is needed
+static int rizz__http_parse(rizz__http_request* req, const char* data, int size)
 {
-    sx_assert(g_http.alloc);
+    req->received = true;
+    if (req->header_done) {
+        return rizz__http_parse_body(req, data, size);
+    }
 
-    rizz_http handle =
-        (rizz_http){ .id = sx_handle_new_and_grow(g_http.http_handles, g_http.alloc) };
-    sx_assert(handle.id);
-    rizz__http _http = (rizz__http){ .callback = callback, .callback_user = user };
+    int prev_size = sx_array_count(req->header);
+    sx_memcpy(sx_array_add(g_http.alloc, req->header, size), data, size);
+    int header_size = sx_array_count(req->header);
 
-    if (g_http.num_pending < RIZZ_CONFIG_MAX_HTTP_REQUESTS) {
-        _http.h = http_post(url, data, size, (void*)g_http.alloc);
-        g_http.pending[g_http.num_pending++] = handle;
-    } else {
-        _http.params = rizz__http_alloc_params(url, HTTP_MODE_POST, data, size);
+    int end = -1;
+    for (int i = sx_max(prev_size - 3, 0); i + 3 < header_size; i++) {
+        if (req->header[i] == '\r' && req->header[i + 1] == '\n' && req->header[i + 2] == '\r' &&
+            req->header[i + 3] == '\n') {
+            end = i;
+            break;
+        }
     }
 
-    int index = sx_handle_index(handle.id);
-    if (index >= sx_array_count(g_http.https))
-        sx_array_push(g_http.alloc, g_http.https, _http);
-    else
-        g_http.https[index] = _http;
+    if (end == -1) {
+        return header_size < HTTP_MAX_HEADER_SIZE ? 0 : -1;
+    }
+
+    // keep the line ending of the last header, so all header lines end with "\r\n"
+    req->header[end + 2] = '\0';
+    if (!rizz__http_parse_header(req, req->header)) {
+        return -1;
+    }
+    req->header_done = true;
+
+    int body_offset = end + 4;
+    return rizz__http_parse_body(req, req->header + body_offset, header_size - body_offset);
 }
 
-static const sx_alloc* rizz__http_alloc(void)
+static void rizz__http_conn_event(rizz__http_conn* conn, bool readable, bool writable, bool error)
 {
-    return g_http.alloc;
+    rizz__http_request* req = conn->req;
+    if (req && req->dl && req->dl->paused) {
+        return;
+    }
+
+    if (!req) {
+        // idle connection: the server closed it, or sent something that we don't expect
+        if (readable || error) {
+            rizz__http_close_conn(conn);
+        }
+        return;
+    }
+
+    if (conn->connecting) {
+        if (!writable && !error) {
+            return;
+        }
+
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (getsockopt(conn->sock, SOL_SOCKET, SO_ERROR, (char*)&err, &len) != 0 || err != 0) {
+            if (!rizz__http_connect_next(conn)) {
+                rizz__http_fail(req);
+            }
+            return;
+        }
+        conn->connecting = false;
+    }
+
+    if (req->request_offset < req->request_size) {
+        while (req->request_offset < req->request_size) {
+            int r = (int)send(conn->sock, req->request_data + req->request_offset,
+                              req->request_size - req->request_offset, HTTP_SEND_FLAGS);
+            if (r < 0) {
+                if (rizz__http_would_block()) {
+                    return;
+                }
+                rizz__http_fail(req);
+                return;
+            }
+            req->request_offset += r;
+        }
+        rizz__http_set_events(conn, HTTP_EVENT_READ);
+        return;
+    }
+
+    if (!readable && !error) {
+        return;
+    }
+
+    for (;;) {
+        int r = (int)recv(conn->sock, g_http.recv_buff, HTTP_RECV_BUFFER_SIZE, 0);
+        if (r == 0) {
+            // connection closed: ends the body if the length is unknown
+            if (req->header_done && req->body_mode == HTTP_BODY_UNTIL_CLOSE) {
+                req->keep_alive = false;
+                rizz__http_finish(req, false);
+            } else {
+                rizz__http_fail(req);
+            }
+            return;
+        } else if (r < 0) {
+            if (!rizz__http_would_block()) {
+                rizz__http_fail(req);
+            }
+            return;
+        }
+
+        int pr = rizz__http_parse(req, g_http.recv_buff, r);
+        if (pr != 0) {
+            rizz__http_finish(req, pr < 0);
+            return;
+        }
+
+        if (req->dl && sx_atomic_load32(&req->dl->num_chunks) >= RIZZ_CONFIG_HTTP_DOWNLOAD_MAX_CHUNKS) {
+            // stop receiving until main thread writes the pending chunks, data waits in socket buffers
+            req->dl->paused = true;
+            rizz__http_set_events(conn, 0);
+            return;
+        }
+    }
+}
+
+static void rizz__http_pop_pending(int index)
+{
+    // keep the order of pending requests, so they are sent in the same order that they are submitted
+    int count = sx_array_count(g_http.pending);
+    sx_memmove(&g_http.pending[index], &g_http.pending[index + 1],
+               sizeof(rizz__http_request*) * (count - index - 1));
+    sx_array_pop_last(g_http.pending);
+}
+
+static void rizz__http_dispatch_pending(void)
+{
+    for (int i = 0; i < sx_array_count(g_http.pending); i++) {
+        rizz__http_request* req = g_http.pending[i];
+        if (sx_atomic_load32(&req->cancelled)) {
+            rizz__http_pop_pending(i);
+            --i;
+            rizz__http_finish(req, true);
+            continue;
+        }
+
+        int host_index = rizz__http_find_host(req->host, req->port);
+        if (host_index == -1 || g_http.hosts[host_index].state == HTTP_HOST_FAILED) {
+            rizz__http_pop_pending(i);
+            --i;
+            rizz__http_finish(req, true);
+            continue;
+        }
+        if (g_http.hosts[host_index].state == HTTP_HOST_RESOLVING) {
+            continue;
+        }
+
+        // reuse an idle keep-alive connection to the same host
+        rizz__http_conn* conn = NULL;
+        for (int k = 0, kc = sx_array_count(g_http.conns); k < kc; k++) {
+            if (g_http.conns[k]->host_index == host_index && !g_http.conns[k]->req) {
+                conn = g_http.conns[k];
+                sx_atomic_fetch_add32(&g_http.num_reuses, 1);
+                break;
+            }
+        }
+
+        if (!conn) {
+            if (g_http.hosts[host_index].num_conns >= RIZZ_CONFIG_HTTP_MAX_HOST_CONNECTIONS) {
+                continue;
+            }
+
+            if (sx_array_count(g_http.conns) >= RIZZ_CONFIG_MAX_HTTP_REQUESTS) {
+                // make room by closing an idle connection of another host
+                rizz__http_conn* idle_conn = NULL;
+                for (int k = 0, kc = sx_array_count(g_http.conns); k < kc; k++) {
+                    if (!g_http.conns[k]->req) {
+                        idle_conn = g_http.conns[k];
+                        break;
+                    }
+                }
+                if (!idle_conn) {
+                    continue;
+                }
+                rizz__http_close_conn(idle_conn);
+            }
+
+            conn = rizz__http_connect(host_index);
+            if (!conn) {
+                rizz__http_pop_pending(i);
+                --i;
+                rizz__http_finish(req, true);
+                continue;
+            }
+        }
+
+        conn->req = req;
+        req->conn = conn;
+        rizz__http_set_events(conn, HTTP_EVENT_WRITE);
+        rizz__http_pop_pending(i);
+        --i;
+
+        // idle connections are writable right away, so send the request without waiting for the next round
+        if (!conn->connecting) {
+            rizz__http_conn_event(conn, false, true, false);
+        }
+    }
+}
+
+static void rizz__http_wait_events(int msecs)
+{
+#if HTTP_EPOLL
+    struct epoll_event events[HTTP_MAX_EVENTS];
+    int num_events = epoll_wait(g_http.epoll_fd, events, HTTP_MAX_EVENTS, msecs);
+    for (int i = 0; i < num_events; i++) {
+        if (events[i].data.ptr == NULL) {
+            uint64_t n;
+            ssize_t r = read(g_http.wake_fd, &n, sizeof(n));
+            sx_unused(r);
+            continue;
+        }
+
+        // connections that are closed in this round are nulled, so we don't touch them again
+        rizz__http_conn* conn = events[i].data.ptr;
+        bool found = false;
+        for (int k = 0, kc = sx_array_count(g_http.conns); k < kc && !found; k++) {
+            found = g_http.conns[k] == conn;
+        }
+        if (found) {
+            uint32_t e = events[i].events;
+            rizz__http_conn_event(conn, (e & EPOLLIN) != 0, (e & EPOLLOUT) != 0, (e & (EPOLLERR | EPOLLHUP)) != 0);
+        }
+    }
+#else
+    const sx_alloc* tmp_alloc = the__core.tmp_alloc_push();
+    sx_scope(the__core.tmp_alloc_pop()) {
+        int num_conns = sx_array_count(g_http.conns);
+        struct pollfd* fds = sx_malloc(tmp_alloc, sizeof(struct pollfd) * (num_conns + 1));
+        rizz__http_conn** conns = sx_malloc(tmp_alloc, sizeof(rizz__http_conn*) * (num_conns + 1));
+        sx_assert_always(fds && conns);
+
+        int num_fds = 0;
+    #if SX_PLATFORM_WINDOWS
+        fds[num_fds] = (struct pollfd){ .fd = g_http.wake_sock, .events = POLLIN };
+    #else
+        fds[num_fds] = (struct pollfd){ .fd = g_http.wake_pipe[0], .events = POLLIN };
+    #endif
+        conns[num_fds++] = NULL;
+        for (int i = 0; i < num_conns; i++) {
+            rizz__http_conn* conn = g_http.conns[i];
+            if (!conn->events) {
+                continue;
+            }
+            fds[num_fds] = (struct pollfd){ .fd = conn->sock,
+                                            .events = ((conn->events & HTTP_EVENT_READ) ? POLLIN : 0) |
+                                                      ((conn->events & HTTP_EVENT_WRITE) ? POLLOUT : 0) };
+            conns[num_fds++] = conn;
+        }
+
+        if (num_fds > 0 && rizz__http_poll(fds, num_fds, msecs) > 0) {
+            for (int i = 0; i < num_fds; i++) {
+                short e = fds[i].revents;
+                if (!e) {
+                    continue;
+                }
+
+                if (!conns[i]) {
+                    char buff[64];
+    #if SX_PLATFORM_WINDOWS
+                    while (recv(g_http.wake_sock, buff, sizeof(buff), 0) > 0) {
+                    }
+    #else
+                    ssize_t r = read(g_http.wake_pipe[0], buff, sizeof(buff));
+                    sx_unused(r);
+    #endif
+                    continue;
+                }
+
+                bool found = false;
+                for (int k = 0, kc = sx_array_count(g_http.conns); k < kc && !found; k++) {
+                    found = g_http.conns[k] == conns[i];
+                }
+                if (found) {
+                    rizz__http_conn_event(conns[i], (e & POLLIN) != 0, (e & POLLOUT) != 0,
+                                          (e & (POLLERR | POLLHUP)) != 0);
+                }
+            }
+        } else if (num_fds == 0) {
+            sx_os_sleep(msecs);
+        }
+    }
+#endif
+}
+
+static void rizz__http_close_idle(void)
+{
+    uint64_t now = sx_tm_now();
+    for (int i = 0; i < sx_array_count(g_http.conns); i++) {
+        rizz__http_conn* conn = g_http.conns[i];
+        if (!conn->req && sx_tm_sec(sx_tm_diff(now, conn->idle_tm)) > HTTP_IDLE_TIMEOUT) {
+            rizz__http_close_conn(conn);
+            --i;
+        }
+    }
+}
+
+// requests that are freed (or aborted) while they are in flight don't download the rest of their
+// response: their connections are closed, because the stream can't be reused for the next request
+static void rizz__http_cancel_conns(void)
+{
+    for (int i = 0; i < sx_array_count(g_http.conns); i++) {
+        rizz__http_request* req = g_http.conns[i]->req;
+        if (req && (sx_atomic_load32(&req->cancelled) || sx_atomic_load32(&req->aborted))) {
+            rizz__http_finish(req, true);
+            --i;
+        }
+    }
+}
+
+// continues paused downloads, once the main thread has written enough of their chunks
+static void rizz__http_update_conns(void)
+{
+    for (int i = 0, c = sx_array_count(g_http.conns); i < c; i++) {
+        rizz__http_conn* conn = g_http.conns[i];
+        rizz__http_request* req = conn->req;
+        if (req && req->dl && req->dl->paused &&
+            sx_atomic_load32(&req->dl->num_chunks) < RIZZ_CONFIG_HTTP_DOWNLOAD_MAX_CHUNKS) {
+            req->dl->paused = false;
+            rizz__http_set_events(conn, HTTP_EVENT_READ);
+        }
+    }
+}
+
+static int rizz__http_thread_cb(void* user1, void* user2)
+{
+    sx_unused(user1);
+    sx_unused(user2);
+
+    while (!sx_atomic_load32(&g_http.quit)) {
+        sx_mutex_lock(g_http.queue_mtx) {
+            for (int i = 0, c = sx_array_count(g_http.submit_queue); i < c; i++) {
+                sx_array_push(g_http.alloc, g_http.pending, g_http.submit_queue[i]);
+            }
+            sx_array_clear(g_http.submit_queue);
+        }
+
+        rizz__http_update_hosts();
+        rizz__http_dispatch_pending();
+        rizz__http_cancel_conns();
+        rizz__http_update_conns();
+        rizz__http_wait_events(HTTP_WAIT_MSECS);
+        rizz__http_close_idle();
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// main thread
+static void rizz__http_destroy_request(rizz__http_request* req)
+{
+    rizz__http_free_body(req);
+    sx_array_free(g_http.alloc, req->header);
+    sx_array_free(g_http.alloc, req->body_chunks);
+    sx_free(g_http.alloc, req->request_data);
+    if (req->dl) {
+        if (req->dl->chunk) {
+            sx_mem_destroy_block(req->dl->chunk);
+        }
+        sx_free(g_http.alloc, req->dl);
+    }
+    sx_free(g_http.alloc, req);
+}
+
+void rizz__http_release()
+{
+    if (g_http.alloc) {
+        sx_atomic_store32(&g_http.quit, 1);
+        if (g_http.thread) {
+            rizz__http_wake();
+            sx_thread_destroy(g_http.thread, g_http.alloc);
+        }
+        if (g_http.resolver_thread) {
+            sx_semaphore_post(&g_http.resolve_sem, 1);
+            sx_thread_destroy(g_http.resolver_thread, g_http.alloc);
+        }
+
+        // remove remaining http requests
+        if (g_http.http_handles) {
+            for (int i = 0; i < g_http.http_handles->count; i++) {
+                sx_handle_t handle = sx_handle_at(g_http.http_handles, i);
+                rizz__http_request* req = g_http.requests[sx_handle_index(handle)];
+                rizz__log_warn("un-freed http request: %s:%s", req->host, req->port);
+                if (req->state.status != RIZZ_HTTP_PENDING) {
+                    rizz__http_destroy_request(req);
+                }
+            }
+
+            sx_handle_destroy_pool(g_http.http_handles, g_http.alloc);
+        }
+
+        // requests that are owned by the http thread and the queues
+        for (int i = 0; i < sx_array_count(g_http.conns); i++) {
+            if (g_http.conns[i]->req) {
+                sx_array_push(g_http.alloc, g_http.pending, g_http.conns[i]->req);
+            }
+            rizz__http_close_socket(g_http.conns[i]->sock);
+            sx_free(g_http.alloc, g_http.conns[i]);
+        }
+        for (int i = 0; i < sx_array_count(g_http.submit_queue); i++) {
+            sx_array_push(g_http.alloc, g_http.pending, g_http.submit_queue[i]);
+        }
+        for (int i = 0; i < sx_array_count(g_http.done_queue); i++) {
+            sx_array_push(g_http.alloc, g_http.pending, g_http.done_queue[i]);
+        }
+        for (int i = 0; i < sx_array_count(g_http.resuming); i++) {
+            the__core.job_wait_and_del(g_http.resuming[i]->dl->resume_job);
+            sx_array_push(g_http.alloc, g_http.pending, g_http.resuming[i]);
+        }
+        for (int i = 0; i < sx_array_count(g_http.finishing); i++) {
+            sx_array_push(g_http.alloc, g_http.pending, g_http.finishing[i]);
+        }
+        for (int i = 0; i < sx_array_count(g_http.chunk_queue); i++) {
+            sx_mem_destroy_block(g_http.chunk_queue[i].data);
+        }
+        for (int i = 0; i < sx_array_count(g_http.pending); i++) {
+            rizz__http_destroy_request(g_http.pending[i]);
+        }
+
+        for (int i = 0; i < sx_array_count(g_http.hosts); i++) {
+            if (g_http.hosts[i].addr) {
+                freeaddrinfo(g_http.hosts[i].addr);
+            }
+        }
+        for (int i = 0; i < sx_array_count(g_http.resolved_queue); i++) {
+            if (g_http.resolved_queue[i].addr) {
+                freeaddrinfo(g_http.resolved_queue[i].addr);
+            }
+        }
+
+#if HTTP_EPOLL
+        if (g_http.epoll_fd > 0)
+            close(g_http.epoll_fd);
+        if (g_http.wake_fd > 0)
+            close(g_http.wake_fd);
+#elif !SX_PLATFORM_WINDOWS
+        if (g_http.wake_pipe[0] > 0) {
+            close(g_http.wake_pipe[0]);
+            close(g_http.wake_pipe[1]);
+        }
+#else
+        if (g_http.wake_sock) {
+            closesocket(g_http.wake_sock);
+        }
+#endif
+
+        sx_mutex_release(&g_http.queue_mtx);
+        sx_mutex_release(&g_http.resolve_mtx);
+        sx_semaphore_release(&g_http.resolve_sem);
+        sx_array_free(g_http.alloc, g_http.resolve_queue);
+        sx_array_free(g_http.alloc, g_http.resolved_queue);
+        sx_array_free(g_http.alloc, g_http.requests);
+        sx_array_free(g_http.alloc, g_http.submit_queue);
+        sx_array_free(g_http.alloc, g_http.done_queue);
+        sx_array_free(g_http.alloc, g_http.chunk_queue);
+        sx_array_free(g_http.alloc, g_http.pending);
+        sx_array_free(g_http.alloc, g_http.resuming);
+        sx_array_free(g_http.alloc, g_http.finishing);
+        sx_array_free(g_http.alloc, g_http.hosts);
+        sx_array_free(g_http.alloc, g_http.conns);
+        sx_free(g_http.alloc, g_http.recv_buff);
+
+        sx_alloc* alloc = g_http.alloc;
+        sx_memset(&g_http, 0x0, sizeof(g_http));
+        rizz__mem_destroy_allocator(alloc);
+
+#if SX_PLATFORM_WINDOWS
+        WSACleanup();
+#endif
+    }
+}
+
+// url: http://host[:port]/path
+static bool rizz__http_parse_url(const char* url, char* host, int host_size, char* port, int port_size,
+                                 const char** path)
+{
+    if (!sx_strnequalnocase(url, "http://", 7)) {
+        return false;
+    }
+
+    const char* host_start = url + 7;
+    const char* host_end = host_start;
+    while (*host_end && *host_end != ':' && *host_end != '/') {
+        ++host_end;
+    }
+    if (host_end == host_start) {
+        return false;
+    }
+    sx_strncpy(host, host_size, host_start, (int)(uintptr_t)(host_end - host_start));
+
+    if (*host_end == ':') {
+        const char* port_start = host_end + 1;
+        const char* port_end = port_start;
+        while (*port_end && *port_end != '/') {
+            ++port_end;
+        }
+        sx_strncpy(port, port_size, port_start, (int)(uintptr_t)(port_end - port_start));
+        host_end = port_end;
+    } else {
+        sx_strcpy(port, port_size, "80");
+    }
+
+    *path = *host_end ? host_end : "/";
+    return true;
+}
+
+static rizz__http_request* rizz__http_create_request(rizz_http_cb* callback, void* user)
+{
+    sx_assert(g_http.alloc);
+
+    rizz__http_request* req = sx_malloc(g_http.alloc, sizeof(rizz__http_request));
+    if (!req) {
+        sx_out_of_memory();
+        return NULL;
+    }
+    sx_memset(req, 0x0, sizeof(rizz__http_request));
+    req->callback = callback;
+    req->callback_user = user;
+    req->content_length = -1;
+
+    req->handle = (rizz_http){ .id = sx_handle_new_and_grow(g_http.http_handles, g_http.alloc) };
+    sx_assert(req->handle.id);
+
+    int index = sx_handle_index(req->handle.id);
+    if (index >= sx_array_count(g_http.requests))
+        sx_array_push(g_http.alloc, g_http.requests, req);
+    else
+        g_http.requests[index] = req;
+
+    return req;
+}
+
+// writes the request and passes it to the http thread. invalid urls fail on the next update
+static void rizz__http_submit(rizz__http_request* req, const char* url, rizz__http_mode mode,
+                              const void* data, size_t size, const char* extra_headers)
+{
+    char host[256];
+    char port[16];
+    const char* path;
+    bool valid = rizz__http_parse_url(url, host, sizeof(host), port, sizeof(port), &path);
+    if (!valid) {
+        rizz__log_warn("http: invalid or unsupported url: %s", url);
+        host[0] = '\0';
+        port[0] = '\0';
+        path = "/";
+    }
+
+    // request header and post data are written in one buffer, so they are sent together
+    // header buffer is sized from the url and extra headers, with room for the fixed fields
+    bool default_port = sx_strequal(port, "80");
+    int max_header_size = sx_strlen(path) + sx_strlen(host) + sx_strlen(port) + sx_strlen(extra_headers) + 128;
+    int header_size = 0;
+    req->request_data = valid ? sx_malloc(g_http.alloc, max_header_size + size) : NULL;
+    if (valid && !req->request_data) {
+        sx_out_of_memory();
+        valid = false;
+    }
+
+    if (valid) {
+        char* header = req->request_data;
+        if (mode == HTTP_MODE_POST) {
+            header_size = sx_snprintf(header, max_header_size,
+                "POST %s HTTP/1.1\r\nHost: %s%s%s\r\nConnection: keep-alive\r\nContent-Length: %u\r\n%s\r\n",
+                path, host, default_port ? "" : ":", default_port ? "" : port, (unsigned)size, extra_headers);
+        } else {
+            header_size = sx_snprintf(header, max_header_size,
+                "GET %s HTTP/1.1\r\nHost: %s%s%s\r\nConnection: keep-alive\r\n%s\r\n",
+                path, host, default_port ? "" : ":", default_port ? "" : port, extra_headers);
+        }
+
+        // a truncated header is never terminated, so the server would stall waiting for the rest
+        if (header_size <= 0 || header_size >= max_header_size - 1) {
+            rizz__log_warn("http: request header is too long: %s", url);
+            valid = false;
+        } else {
+            if (size > 0) {
+                sx_memcpy(header + header_size, data, size);
+            }
+            req->request_size = header_size + (int)size;
+        }
+    }
+    sx_strcpy(req->host, sizeof(req->host), host);
+    sx_strcpy(req->port, sizeof(req->port), port);
+
+    sx_mutex_lock(g_http.queue_mtx) {
+        if (valid) {
+            sx_array_push(g_http.alloc, g_http.submit_queue, req);
+        } else {
+            req->failed = true;
+            sx_array_push(g_http.alloc, g_http.done_queue, req);
+        }
+    }
+    rizz__http_wake();
+}
+
+static void rizz__http_complete(rizz__http_request* req)
+{
+    req->state = (rizz_http_state){
+        .status = req->failed ? RIZZ_HTTP_FAILED : RIZZ_HTTP_COMPLETED,
+        .status_code = req->status_code,
+        .reason_phrase = req->reason_phrase,
+        .content_type = req->content_type,
+        .response_size = req->dl ? (size_t)req->dl->written : (req->body ? (size_t)req->body_size : 0),
+        .response_data = req->body ? req->body->data : NULL
+    };
+
+    if (req->waiter.id) {
+        rizz__coro_resume(req->waiter);
+        req->waiter = (sx_coro_handle){ 0 };
+    }
+
+    // for callback requests, call the callback and release the request automatically
+    if (req->callback) {
+        req->callback(&req->state, req->callback_user);
+        sx_handle_del(g_http.http_handles, req->handle.id);
+        g_http.requests[sx_handle_index(req->handle.id)] = NULL;
+        rizz__http_destroy_request(req);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// downloads
+// runs in a worker thread: verifies the chunks of an existing part file, with the hashes in partsum
+// the valid part is kept and the download continues after it, other cases start from scratch
+static void rizz__http_download_resume_job_cb(int start, int end, int thrd_index, void* user)
+{
+    sx_unused(start);
+    sx_unused(end);
+    sx_unused(thrd_index);
+
+    rizz__http_download* dl = user;
+    const int64_t chunk_size = RIZZ_CONFIG_HTTP_DOWNLOAD_CHUNK_SIZE;
+
+    sx_file sum_file;
+    if (!rizz__vfs_open(&sum_file, dl->sum_path, dl->vfs_flags, SX_FILE_READ)) {
+        return;
+    }
+
+    rizz__http_download_header header;
+    bool valid = sx_file_read_var(&sum_file, header) == sizeof(header) && header.magic == HTTP_DOWNLOAD_MAGIC &&
+                 header.version == HTTP_DOWNLOAD_VERSION && header.chunk_size == chunk_size &&
+                 header.url_hash == sx_hash_xxh64(dl->url, sx_strlen(dl->url), 0);
+    int num_hashes = valid ? (int)((sx_file_size(&sum_file) - (int64_t)sizeof(header)) / sizeof(uint64_t)) : 0;
+
+    sx_file part_file;
+    if (!valid || !rizz__vfs_open(&part_file, dl->part_path, dl->vfs_flags, SX_FILE_READ)) {
+        sx_file_close(&sum_file);
+        return;
+    }
+
+    int64_t part_size = sx_file_size(&part_file);
+    int num_verified = 0;
+    bool corrupt = false;
+    bool complete = false;
+    for (int i = 0; i < num_hashes; i++) {
+        int64_t size = sx_min(chunk_size, part_size - (int64_t)i * chunk_size);
+        if (size <= 0) {
+            break;
+        }
+
+        uint64_t hash;
+        if (sx_file_read_var(&sum_file, hash) != sizeof(hash) ||
+            sx_file_read(&part_file, dl->chunk->data, size) != size ||
+            sx_hash_xxh64(dl->chunk->data, (size_t)size, 0) != hash) {
+            corrupt = true;
+            break;
+        }
+
+        // only the last chunk of the file can be smaller than chunk size
+        if (size < chunk_size) {
+            complete = header.total_size == part_size;
+            corrupt = !complete;
+            break;
+        }
+        ++num_verified;
+    }
+
+    // files with an exact multiple of chunk size don't have a short last chunk, so it's the size
+    // of the verified chunks that tells if the download was finished
+    if (!corrupt && !complete && header.total_size >= 0 &&
+        (int64_t)num_verified * chunk_size == part_size && part_size == header.total_size) {
+        complete = true;
+    }
+
+    if (complete) {
+        dl->complete = true;
+        dl->resume_offset = part_size;
+        dl->header = header;
+    } else if (!corrupt) {
+        // the tail after the last hashed chunk is loaded into the current chunk, it's hashed when
+        // the chunk is filled with the rest of the data
+        int64_t verified_size = (int64_t)num_verified * chunk_size;
+        int64_t tail = part_size - verified_size;
+        if (tail < chunk_size &&
+            (tail == 0 || (sx_file_seek(&part_file, verified_size, SX_WHENCE_BEGIN) == verified_size &&
+                           sx_file_read(&part_file, dl->chunk->data, tail) == tail))) {
+            dl->resume_offset = part_size;
+            dl->chunk_fill = tail;
+            dl->chunk_disk = tail;
+            dl->header = header;
+        }
+    }
+
+    sx_file_close(&part_file);
+    sx_file_close(&sum_file);
+}
+
+static void rizz__http_download_data_cb(const char* path, int64_t bytes_written, sx_mem_block* mem, void* user)
+{
+    sx_unused(path);
+
+    rizz__http_request* req = user;
+    rizz__http_download* dl = req->dl;
+    if (bytes_written > 0) {
+        dl->written += bytes_written;
+    } else {
+        dl->write_failed = true;
+        sx_atomic_store32(&req->aborted, 1);
+    }
+
+    sx_mem_destroy_block(mem);
+    --dl->num_writes;
+    sx_atomic_fetch_sub32(&dl->num_chunks, 1);
+    rizz__http_wake();
+
+    if (dl->progress_cb && !dl->write_failed && !sx_atomic_load32(&req->cancelled)) {
+        dl->progress_cb(dl->url, dl->written, dl->header.total_size, req->callback_user);
+    }
+}
+
+static void rizz__http_download_sum_cb(const char* path, int64_t bytes_written, sx_mem_block* mem, void* user)
+{
+    sx_unused(path);
+
+    rizz__http_request* req = user;
+    if (bytes_written <= 0) {
+        req->dl->write_failed = true;
+        sx_atomic_store32(&req->aborted, 1);
+    }
+
+    sx_mem_destroy_block(mem);
+    --req->dl->num_writes;
+}
+
+// data and hash writes go through the same vfs queue, so hashes are only saved after their data
+static void rizz__http_download_write_chunk(const rizz__http_download_chunk* chunk)
+{
+    rizz__http_request* req = chunk->req;
+    rizz__http_download* dl = req->dl;
+    if (dl->write_failed) {
+        sx_mem_destroy_block(chunk->data);
+        sx_atomic_fetch_sub32(&dl->num_chunks, 1);
+        rizz__http_wake();
+        return;
+    }
+
+    if (chunk->first) {
+        dl->written = 0;
+    }
+
+    ++dl->num_writes;
+    the__vfs.write_async(dl->part_path, chunk->data, dl->vfs_flags | (chunk->first ? 0 : RIZZ_VFS_FLAG_APPEND),
+                         rizz__http_download_data_cb, req);
+
+    if (chunk->first || chunk->hashed) {
+        int64_t header_size = chunk->first ? (int64_t)sizeof(rizz__http_download_header) : 0;
+        sx_mem_block* mem = sx_mem_create_block(g_http.alloc,
+                                                header_size + (chunk->hashed ? sizeof(uint64_t) : 0), NULL, 0);
+        if (!mem) {
+            dl->write_failed = true;
+            sx_atomic_store32(&req->aborted, 1);
+            return;
+        }
+
+        if (chunk->first) {
+            sx_memcpy(mem->data, &dl->header, sizeof(dl->header));
+        }
+        if (chunk->hashed) {
+            sx_memcpy((uint8_t*)mem->data + header_size, &chunk->hash, sizeof(chunk->hash));
+        }
+
+        ++dl->num_writes;
+        the__vfs.write_async(dl->sum_path, mem, dl->vfs_flags | (chunk->first ? 0 : RIZZ_VFS_FLAG_APPEND),
+                             rizz__http_download_sum_cb, req);
+    }
+}
+
+// sends downloads to the http thread, after their existing files are verified
+static void rizz__http_update_resuming(void)
+{
+    for (int i = 0; i < sx_array_count(g_http.resuming); i++) {
+        rizz__http_request* req = g_http.resuming[i];
+        rizz__http_download* dl = req->dl;
+        if (!the__core.job_test_and_del(dl->resume_job)) {
+            continue;
+        }
+
+        sx_array_pop(g_http.resuming, i);
+        --i;
+
+        if (sx_atomic_load32(&req->cancelled)) {
+            rizz__http_destroy_request(req);
+        } else if (dl->complete) {
+            req->status_code = 200;
+            sx_strcpy(req->reason_phrase, sizeof(req->reason_phrase), "OK");
+            dl->written = dl->resume_offset;
+            sx_array_push(g_http.alloc, g_http.finishing, req);
+        } else {
+            char range[256] = { 0 };
+            if (dl->resume_offset > 0) {
+                dl->written = dl->resume_offset;
+                sx_snprintf(range, sizeof(range), "Range: bytes=%lld-\r\n%s%s%s",
+                            (long long)dl->resume_offset, dl->header.etag[0] ? "If-Range: " : "",
+                            dl->header.etag, dl->header.etag[0] ? "\r\n" : "");
+            }
+            rizz__http_submit(req, dl->url, HTTP_MODE_GET, NULL, 0, range);
+        }
+    }
+}
+
+// completes downloads when all of their chunks are written
+static void rizz__http_update_finishing(void)
+{
+    for (int i = 0; i < sx_array_count(g_http.finishing); i++) {
+        rizz__http_request* req = g_http.finishing[i];
+        rizz__http_download* dl = req->dl;
+        if (dl->num_writes > 0 || sx_atomic_load32(&dl->num_chunks) > 0) {
+            continue;
+        }
+
+        sx_array_pop(g_http.finishing, i);
+        --i;
+
+        if (sx_atomic_load32(&req->cancelled)) {
+            rizz__http_destroy_request(req);
+            continue;
+        }
+
+        bool ok = !req->failed && !dl->write_failed;
+        if (ok) {
+            if (dl->written == 0) {
+                // empty files don't have any chunks to write
+                sx_file f;
+                ok = rizz__vfs_open(&f, dl->part_path, dl->vfs_flags, SX_FILE_WRITE);
+                if (ok) {
+                    sx_file_close(&f);
+                }
+            }
+
+            ok = ok && rizz__vfs_rename(dl->part_path, dl->path, dl->vfs_flags);
+            rizz__vfs_remove(dl->sum_path, dl->vfs_flags);
+        } else if (dl->discard) {
+            rizz__vfs_remove(dl->part_path, dl->vfs_flags);
+            rizz__vfs_remove(dl->sum_path, dl->vfs_flags);
+        }
+
+        req->failed = !ok;
+        rizz__http_complete(req);
+    }
+}
+
+void rizz__http_update()
+{
+    rizz__http_update_resuming();
+
+    const sx_alloc* tmp_alloc = the__core.tmp_alloc_push();
+    sx_scope(the__core.tmp_alloc_pop()) {
+        rizz__http_request** done = NULL;
+        rizz__http_download_chunk* chunks = NULL;
+        int num_done = 0;
+        int num_chunks = 0;
+
+        // chunks are always queued before their request is done, so they are written first
+        sx_mutex_lock(g_http.queue_mtx) {
+            num_done = sx_array_count(g_http.done_queue);
+            if (num_done > 0) {
+                done = sx_malloc(tmp_alloc, sizeof(rizz__http_request*) * num_done);
+                sx_assert_always(done);
+                sx_memcpy(done, g_http.done_queue, sizeof(rizz__http_request*) * num_done);
+                sx_array_clear(g_http.done_queue);
+            }
+
+            num_chunks = sx_array_count(g_http.chunk_queue);
+            if (num_chunks > 0) {
+                chunks = sx_malloc(tmp_alloc, sizeof(rizz__http_download_chunk) * num_chunks);
+                sx_assert_always(chunks);
+                sx_memcpy(chunks, g_http.chunk_queue, sizeof(rizz__http_download_chunk) * num_chunks);
+                sx_array_clear(g_http.chunk_queue);
+            }
+        }
+
+        for (int i = 0; i < num_chunks; i++) {
+            rizz__http_download_write_chunk(&chunks[i]);
+        }
+
+        for (int i = 0; i < num_done; i++) {
+            rizz__http_request* req = done[i];
+            if (req->dl) {
+                sx_array_push(g_http.alloc, g_http.finishing, req);
+            } else if (sx_atomic_load32(&req->cancelled)) {
+                rizz__http_destroy_request(req);
+            } else {
+                rizz__http_complete(req);
+            }
+        }
+    }
+
+    rizz__http_update_finishing();
+}
+
+// returns true if the coroutine must wait for the request to complete
+bool rizz__http_await(rizz_http handle, sx_coro_handle coro)
+{
+    sx_assert_always(sx_handle_valid(g_http.http_handles, handle.id));
+    rizz__http_request* req = g_http.requests[sx_handle_index(handle.id)];
+    sx_assertf(!req->callback, "requests with callbacks cannot be awaited");
+    if (req->state.status != RIZZ_HTTP_PENDING) {
+        return false;
+    }
+
+    req->waiter = coro;
+    return true;
+}
+
+static rizz_http rizz__http_new_request(const char* url, rizz__http_mode mode, const void* data, size_t size,
+                                        rizz_http_cb* callback, void* user)
+{
+    rizz__http_request* req = rizz__http_create_request(callback, user);
+    if (!req) {
+        return (rizz_http){ 0 };
+    }
+
+    rizz__http_submit(req, url, mode, data, size, "");
+    return req->handle;
+}
+
+static rizz_http rizz__http_get(const char* url)
+{
+    return rizz__http_new_request(url, HTTP_MODE_GET, NULL, 0, NULL, NULL);
+}
+
+static rizz_http rizz__http_post(const char* url, const void* data, size_t size)
+{
+    return rizz__http_new_request(url, HTTP_MODE_POST, data, size, NULL, NULL);
+}
+
+static rizz_http rizz__http_download_file(const char* url, const char* filepath, rizz_vfs_flags flags,
+                                          rizz_http_progress_cb* progress_cb, rizz_http_cb* callback, void* user)
+{
+    sx_assert(url);
+    sx_assert(filepath);
+
+    rizz__http_request* req = rizz__http_create_request(callback, user);
+    if (!req) {
+        return (rizz_http){ 0 };
+    }
+    rizz_http handle = req->handle;
+
+    rizz__http_download* dl = sx_malloc(g_http.alloc, sizeof(rizz__http_download));
+    sx_mem_block* chunk = sx_mem_create_block(g_http.alloc, RIZZ_CONFIG_HTTP_DOWNLOAD_CHUNK_SIZE, NULL, 0);
+    if (!dl || !chunk) {
+        sx_out_of_memory();
+        if (chunk) {
+            sx_mem_destroy_block(chunk);
+        }
+        sx_free(g_http.alloc, dl);
+        rizz__http_submit(req, "", HTTP_MODE_GET, NULL, 0, "");
+        return handle;
+    }
+
+    sx_memset(dl, 0x0, sizeof(rizz__http_download));
+    sx_strcpy(dl->url, sizeof(dl->url), url);
+    sx_strcpy(dl->path, sizeof(dl->path), filepath);
+    sx_strcat(sx_strcpy(dl->part_path, sizeof(dl->part_path), filepath), sizeof(dl->part_path), ".part");
+    sx_strcat(sx_strcpy(dl->sum_path, sizeof(dl->sum_path), filepath), sizeof(dl->sum_path), ".partsum");
+    dl->vfs_flags = flags;
+    dl->progress_cb = progress_cb;
+    dl->chunk = chunk;
+    dl->header.total_size = -1;
+    req->dl = dl;
+
+    // reading the existing file can take a while, so it's verified in a job before the request is sent
+    dl->resume_job = the__core.job_dispatch(1, rizz__http_download_resume_job_cb, dl, SX_JOB_PRIORITY_LOW, 0);
+    sx_array_push(g_http.alloc, g_http.resuming, req);
+    return handle;
+}
+
+static void rizz__http_free(rizz_http handle)
+{
+    sx_assert(g_http.alloc);
+    sx_assert(handle.id);
+    sx_assertf(sx_handle_valid(g_http.http_handles, handle.id), "double free?");
+
+    int index = sx_handle_index(handle.id);
+    rizz__http_request* req = g_http.requests[index];
+    g_http.requests[index] = NULL;
+    sx_handle_del(g_http.http_handles, handle.id);
+
+    if (req->state.status != RIZZ_HTTP_PENDING) {
+        rizz__http_destroy_request(req);
+    } else {
+        // still owned by the http thread, it's destroyed when it's received in `rizz__http_update`
+        // pending requests are dropped before connecting, in-flight ones close their connection
+        sx_atomic_store32(&req->cancelled, 1);
+        rizz__http_wake();
+    }
+}
+
+static const rizz_http_state* rizz__http_state(rizz_http handle)
+{
+    sx_assert(g_http.alloc);
+    sx_assert(handle.id);
+
+    return &g_http.requests[sx_handle_index(handle.id)]->state;
+}
+
+static void rizz__http_get_cb(const char* url, rizz_http_cb* callback, void* user)
+{
+    rizz__http_new_request(url, HTTP_MODE_GET, NULL, 0, callback, user);
+}
+
+static void rizz__http_post_cb(const char* url, const void* data, size_t size,
+                               rizz_http_cb* callback, void* user)
+{
+    rizz__http_new_request(url, HTTP_MODE_POST, data, size, callback, user);
+}
+
+static const sx_alloc* rizz__http_alloc(void)
+{
+    return g_http.alloc;
+}
+
+static void rizz__http_get_stats(rizz_http_stats* stats)
+{
+    sx_assert(stats);
+    stats->num_connects = sx_atomic_load32(&g_http.num_connects);
+    stats->num_reuses = sx_atomic_load32(&g_http.num_reuses);
+}
+
+bool rizz__http_init()
+{
+#if SX_PLATFORM_WINDOWS
+    WSADATA wsa_data;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) {
+        return false;
+    }
+#endif
+
+    g_http.alloc = rizz__mem_create_allocator("Http", RIZZ_MEMOPTION_INHERIT, "Core", the__core.heap_alloc());
+    g_http.http_handles = sx_handle_create_pool(g_http.alloc, RIZZ_CONFIG_MAX_HTTP_REQUESTS);
+    g_http.recv_buff = sx_malloc(g_http.alloc, HTTP_RECV_BUFFER_SIZE);
+    if (!g_http.http_handles || !g_http.recv_buff)
+        return false;
+
+#if HTTP_EPOLL
+    g_http.epoll_fd = epoll_create1(0);
+    g_http.wake_fd = eventfd(0, EFD_NONBLOCK);
+    if (g_http.epoll_fd == -1 || g_http.wake_fd == -1) {
+        return false;
+    }
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = NULL };
+    epoll_ctl(g_http.epoll_fd, EPOLL_CTL_ADD, g_http.wake_fd, &ev);
+#elif !SX_PLATFORM_WINDOWS
+    if (pipe(g_http.wake_pipe) != 0) {
+        return false;
+    }
+    rizz__http_set_nonblocking(g_http.wake_pipe[0]);
+    rizz__http_set_nonblocking(g_http.wake_pipe[1]);
+#else
+    g_http.wake_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (g_http.wake_sock == HTTP_INVALID_SOCKET) {
+        g_http.wake_sock = 0;
+        return false;
+    }
+    struct sockaddr_in wake_addr = { .sin_family = AF_INET };
+    wake_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int wake_addr_len = sizeof(wake_addr);
+    if (bind(g_http.wake_sock, (struct sockaddr*)&wake_addr, sizeof(wake_addr)) != 0 ||
+        getsockname(g_http.wake_sock, (struct sockaddr*)&wake_addr, &wake_addr_len) != 0 ||
+        connect(g_http.wake_sock, (struct sockaddr*)&wake_addr, sizeof(wake_addr)) != 0 ||
+        !rizz__http_set_nonblocking(g_http.wake_sock)) {
+        return false;
+    }
+#endif
+
+    sx_mutex_init(&g_http.queue_mtx);
+    sx_mutex_init(&g_http.resolve_mtx);
+    sx_semaphore_init(&g_http.resolve_sem);
+    g_http.resolver_thread = sx_thread_create(g_http.alloc, rizz__http_resolver_thread_cb, NULL, 128*1024,
+                                              "rizz_http_resolver", NULL);
+    g_http.thread = sx_thread_create(g_http.alloc, rizz__http_thread_cb, NULL, 256*1024, "rizz_http", NULL);
+    if (!g_http.thread || !g_http.resolver_thread) {
+        return false;
+    }
+
+    return true;
 }
 
 rizz_api_http the__http = { .alloc = rizz__http_alloc,
@@ -328,4 +2061,6 @@ rizz_api_http the__http = { .alloc = rizz__http_alloc,
                             .free = rizz__http_free,
                             .state = rizz__http_state,
                             .get_cb = rizz__http_get_cb,
-                            .post_cb = rizz__http_post_cb };
+                            .post_cb = rizz__http_post_cb,
+                            .download = rizz__http_download_file,
+                            .get_stats = rizz__http_get_stats };
@@ -33,6 +33,9 @@ bool rizz__core_init(const rizz_config* conf);
 void rizz__core_release(void);
 void rizz__core_frame(void);
 void rizz__core_fix_callback_ptrs(const void** ptrs, const void** new_ptrs, int num_ptrs);
+bool rizz__log_decode_file(const char* filepath);
+void rizz__log_flush(void);
+void rizz__coro_resume(sx_coro_handle coro);
 
 typedef struct mem_trace_context mem_trace_context;
 bool rizz__mem_init(uint32_t opts);
@@ -106,11 +109,17 @@ bool rizz__win_get_vstudio_dir(char* vspath, size_t vspath_size);
 bool rizz__vfs_init(void);
 void rizz__vfs_release(void);
 void rizz__vfs_async_update(void);
+bool rizz__vfs_open(sx_file* file, const char* path, rizz_vfs_flags flags, sx_file_open_flags open_flags);
+bool rizz__vfs_rename(const char* src, const char* dest, rizz_vfs_flags flags);
+bool rizz__vfs_remove(const char* path, rizz_vfs_flags flags);
 
 bool rizz__asset_init(const char* dbfile, const char* variation);
 bool rizz__asset_dump_unused(const char* filepath);
 void rizz__asset_release(void);
 void rizz__asset_update(void);
+const char* rizz__asset_real_path(const char* path);
+bool rizz__asset_valid(rizz_asset asset);
+bool rizz__asset_await(rizz_asset asset, rizz_asset_group group, sx_coro_handle coro);
 
 bool rizz__gfx_init(const sg_desc* desc, bool enable_profile);
 void rizz__gfx_release(void);
@@ -122,6 +131,7 @@ void rizz__gfx_commit_gpu(void);
 bool rizz__http_init(void);
 void rizz__http_release(void);
 void rizz__http_update(void);
+bool rizz__http_await(rizz_http handle, sx_coro_handle coro);
 
 typedef struct sg_desc sg_desc;
 void rizz__app_init_gfx_desc(sg_desc* desc);
@@ -258,10 +258,11 @@ static int rizz__vfs_worker(void* user)
                 res.write_fn = req.write_fn;
                 int64_t written = rizz__vfs_write(req.path, req.write_mem, req.flags);
 
+                // memory is always returned, so the callback can free it on failures too
+                res.write_mem = req.write_mem;
                 if (written > 0) {
                     res.code = VFS_RESPONSE_WRITE_OK;
                     res.write_bytes = written;
-                    res.write_mem = req.write_mem;
                 } else {
                     res.code = VFS_RESPONSE_WRITE_FAILED;
                 }
@@ -482,6 +483,35 @@ static uint64_t rizz__vfs_last_modified(const char* path)
         return 0;
 }
 
+// opens a file directly (not through the worker thread), used for partial reads of large files
+bool rizz__vfs_open(sx_file* file, const char* path, rizz_vfs_flags flags, sx_file_open_flags open_flags)
+{
+    char resolved_path[RIZZ_MAX_PATH];
+    rizz__vfs_resolve_path(resolved_path, sizeof(resolved_path), path, flags);
+    return sx_file_open(file, resolved_path, open_flags);
+}
+
+bool rizz__vfs_rename(const char* src, const char* dest, rizz_vfs_flags flags)
+{
+    char resolved_src[RIZZ_MAX_PATH];
+    char resolved_dest[RIZZ_MAX_PATH];
+    rizz__vfs_resolve_path(resolved_src, sizeof(resolved_src), src, flags);
+    rizz__vfs_resolve_path(resolved_dest, sizeof(resolved_dest), dest, flags);
+
+    // rename doesn't overwrite existing files on all platforms
+    if (sx_os_path_isfile(resolved_dest)) {
+        sx_os_del(resolved_dest, SX_FILE_TYPE_REGULAR);
+    }
+    return sx_os_rename(resolved_src, resolved_dest);
+}
+
+bool rizz__vfs_remove(const char* path, rizz_vfs_flags flags)
+{
+    char resolved_path[RIZZ_MAX_PATH];
+    rizz__vfs_resolve_path(resolved_path, sizeof(resolved_path), path, flags);
+    return sx_os_path_isfile(resolved_path) && sx_os_del(resolved_path, SX_FILE_TYPE_REGULAR);
+}
+
 #if RIZZ_CONFIG_HOT_LOADING
 static void dmon__event_cb(dmon_watch_id watch_id, dmon_action action, const char* rootdir,
                            const char* filepath, const char* oldfilepath, void* user)
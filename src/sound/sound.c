@@ -7,10 +7,13 @@
 #include "sx/array.h"
 #include "sx/atomic.h"
 #include "sx/handle.h"
+#include "sx/lockless.h"
 #include "sx/math-scalar.h"
 #include "sx/os.h"
 #include "sx/pool.h"
+#include "sx/simd.h"
 #include "sx/string.h"
+#include "sx/threads.h"
 #include "sx/timer.h"
 
 #include "beep.h"
@@ -26,8 +29,13 @@
 #define FIXPOINT_FRAC_MUL (1 << FIXPOINT_FRAC_BITS)
 #define FIXPOINT_FRAC_MASK ((1 << FIXPOINT_FRAC_BITS) - 1)
 
+#define SND_STREAM_DECODE_FRAMES 1024
+#define SND_MIXER_CHUNK_FRAMES 512
+#define SND_MAX_CMD_BATCHES 4
+
 RIZZ_STATE static rizz_api_plugin* the_plugin;
 RIZZ_STATE static rizz_api_core* the_core; 
+RIZZ_STATE static rizz_api_app* the_app;
 RIZZ_STATE static rizz_api_asset* the_asset;
 RIZZ_STATE static rizz_api_refl* the_refl;
 RIZZ_STATE static rizz_api_imgui* the_imgui;
@@ -62,7 +70,8 @@ SX_PRAGMA_DIAGNOSTIC_POP()
 
 typedef enum snd__source_flags_ {
     SND_SOURCEFLAG_LOOPING = 0x1,
-    SND_SOURCEFLAG_SINGLETON = 0x2
+    SND_SOURCEFLAG_SINGLETON = 0x2,
+    SND_SOURCEFLAG_STREAM = 0x4
 } snd__source_flags_;
 typedef uint32_t snd__source_flags;
 
@@ -79,13 +88,20 @@ typedef enum snd__source_format {
 typedef struct snd__source {
     void* data;
     float* samples;
+    const uint8_t* stream_data;    // compressed file data, only for streaming sources
+    int stream_data_size;
+    int stream_channels;
+    int vorbis_buffer_size;
+    float* resampled;    // samples converted to device sample-rate, NULL if rates are the same
     int num_frames;
+    int num_resampled_frames;
     int sample_rate;
     snd__source_flags flags;
     snd__source_format fmt;
     float volume;
     sx_str_t name;    // for debugging purposes
     int num_plays;
+    int mem_size;     // for debugging purposes: bytes of sample or compressed data
 } snd__source;
 
 typedef struct snd__instance {
@@ -95,6 +111,7 @@ typedef struct snd__instance {
     float volume;
     float pan;
     int bus_id;
+    int stream_id;    // index+1 to g_snd.streams, 0 if the source is not streaming
     snd__instance_state state;
 } snd__instance;
 
@@ -106,11 +123,75 @@ typedef struct snd__ringbuffer {
     sx_atomic_uint32 size;
 } snd__ringbuffer;
 
+// linear resampler, keeps it's state between calls so it can also be used for streaming
+typedef struct snd__resampler {
+    uint64_t pos;     // fixed-point position relative to `prev` sample
+    uint32_t step;    // fixed-point src_rate/dst_rate
+    float prev;       // last sample of the previous input block
+} snd__resampler;
+
+// streams are opened/closed by the main thread and decoded by the stream thread:
+//     FREE -> OPEN (main) -> PLAYING (stream thread) -> CLOSE (main) -> FREE (stream thread)
+typedef enum snd__stream_state {
+    SND_STREAMSTATE_FREE = 0,
+    SND_STREAMSTATE_OPEN,
+    SND_STREAMSTATE_PLAYING,
+    SND_STREAMSTATE_CLOSE
+} snd__stream_state;
+
+typedef struct snd__stream {
+    sx_atomic_uint32 state;    // snd__stream_state
+    sx_atomic_uint32 eof;      // set by stream thread when all the data is decoded
+    snd__ringbuffer rb;        // decoded mono samples (produced by stream thread, consumed by mixer)
+    rizz_snd_source srchandle;
+    const uint8_t* data;
+    int data_size;
+    int channels;
+    int vorbis_buffer_size;
+    int sample_rate;
+    int dst_sample_rate;
+    snd__source_format fmt;
+    bool looping;
+
+    // decoder state, only touched by stream thread
+    stb_vorbis* vorbis;
+    void* vorbis_buff;
+    drwav wav;
+    float* decode_buff;
+    snd__resampler resampler;
+    float* resample_buff;    // decoded frames are converted to device sample-rate before produce
+    int resample_buff_frames;
+
+    // stats
+    sx_atomic_uint64 decode_ticks;
+    sx_atomic_uint64 decoded_frames;
+    int num_underruns;    // main thread
+} snd__stream;
+
 typedef struct snd__bus {
     int max_lanes;
     int num_lanes;
+    float volume;
+    float lowpass;             // one-pole low-pass coefficient (0..1], 1 means no filtering
+    float lowpass_cutoff;      // unit: Hz, 0 if disabled
+    float lowpass_state[RIZZ_SND_DEVICE_NUM_CHANNELS];
+    float* submix;             // interleaved samples (device channels), owned by the bus
 } snd__bus;
 
+// debugger snapshots, copied under the lock and rendered without it
+typedef struct snd__debug_bus {
+    int max_lanes;
+    int num_lanes;
+    float volume;
+    float lowpass_cutoff;
+} snd__debug_bus;
+
+typedef struct snd__debug_play {
+    int bus_id;
+    float progress;
+    sx_str_t name;
+} snd__debug_play;
+
 typedef struct snd__clocked {
     struct snd__clocked* next;    // next item to be queued for play
     rizz_snd_source src;
@@ -146,6 +227,12 @@ typedef struct snd__cmdbuffer {
     int cmd_idx;
 } snd__cmdbuffer;
 
+// commands of all command-buffers in a frame, sent to the mixer thread
+typedef struct snd__cmdbatch {
+    uint8_t* SX_ARRAY params_buff;
+    snd__cmdheader* SX_ARRAY cmds;
+} snd__cmdbatch;
+
 typedef uint8_t* (*snd__run_command_cb)(uint8_t* buff);
 
 typedef struct snd__context {
@@ -158,6 +245,7 @@ typedef struct snd__context {
     sx_pool* clocked_pool;
     snd__clocked** clocked;
     int num_cmdbuffers;
+    int cmdbuffer_tls;          // tls slot of the per-thread snd__cmdbuffer
     rizz_snd_instance playlist[RIZZ_SND_DEVICE_MAX_LANES];
     int num_plays;
     snd__ringbuffer mixer_buffer;
@@ -167,6 +255,32 @@ typedef struct snd__context {
     snd__bus buses[RIZZ_SND_DEVICE_MAX_BUSES];
     rizz_snd_source silence_src;
     rizz_snd_source beep_src;
+    float* submix_buff;    // memory block for all bus submix buffers
+    int submix_max_frames;
+    uint64_t mix_tm;       // stats: time spent in the last mix
+    int mix_frames;
+    int mix_voices;
+    uint64_t mix_total_tm;    // stats: cumulative counters for `get_stats`, protected by `lock`
+    int64_t mix_total_frames;
+    int64_t mix_total_voice_frames;
+    sx_atomic_uint64 decode_total_tm;
+    sx_atomic_uint64 decode_total_frames;
+    sx_atomic_uint32 num_underruns;          // device callback didn't have enough mixed frames
+    sx_atomic_uint32 num_underrun_frames;
+
+    // optional mixer thread, enabled by `mixer_thread=1` in [sound] section of app config meta
+    // mixer state (playlist, instances, sources array, handle pools) is protected by `lock`
+    sx_mutex lock;
+    rizz_thread* mixer_thrd;
+    sx_sem mixer_sem;
+    int mixer_quit;
+    sx_queue_spsc* cmd_queue;         // snd__cmdbatch*: main thread -> mixer thread
+    sx_queue_spsc* cmd_free_queue;    // snd__cmdbatch*: mixer thread -> main thread
+    snd__cmdbatch cmd_batches[SND_MAX_CMD_BATCHES];
+    snd__stream* streams;    // count: RIZZ_SND_DEVICE_MAX_STREAMS
+    rizz_thread* stream_thrd;
+    sx_sem stream_sem;
+    int stream_quit;
 } snd__context;
 
 RIZZ_STATE static snd__context g_snd;
@@ -247,13 +361,85 @@ static void snd__ringbuffer_produce(snd__ringbuffer* rb, const float* samples, u
     sx_atomic_fetch_add32(&rb->size, count);
 }
 
+static void snd__resampler_init(snd__resampler* r, int src_sample_rate, int dst_sample_rate)
+{
+    sx_assert(src_sample_rate > 0 && dst_sample_rate > 0);
+    r->step = (uint32_t)(((uint64_t)src_sample_rate << FIXPOINT_FRAC_BITS) / (uint64_t)dst_sample_rate);
+    r->pos = FIXPOINT_FRAC_MUL;    // start exactly on the first sample of the first block
+    r->prev = 0;
+}
+
+// number of output frames that the resampler may produce for `num_src_frames` input
+static inline int snd__resampler_max_frames(int num_src_frames, int src_sample_rate,
+                                            int dst_sample_rate)
+{
+    return (int)(((int64_t)num_src_frames * dst_sample_rate) / src_sample_rate) + 2;
+}
+
+// linear interpolation between the input samples. input is treated as continuous with previous
+// calls, so streams can be fed block by block. returns the number of frames written to `dst`
+static int snd__resample_linear(snd__resampler* r, float* dst, int max_dst_frames, const float* src,
+                                int num_src_frames)
+{
+    if (num_src_frames == 0) {
+        return 0;
+    }
+
+    const float frac_mul_rcp = 1.0f / (float)FIXPOINT_FRAC_MUL;
+    const uint64_t end = (uint64_t)num_src_frames << FIXPOINT_FRAC_BITS;
+    uint64_t pos = r->pos;
+    int n = 0;
+
+    // sample at index 0 is `prev`, so src[i] is located at index (i + 1)
+    while (pos < end && n < max_dst_frames) {
+        uint32_t idx = (uint32_t)(pos >> FIXPOINT_FRAC_BITS);
+        float s0 = idx > 0 ? src[idx - 1] : r->prev;
+        float s1 = src[idx];
+        float t = (float)(pos & FIXPOINT_FRAC_MASK) * frac_mul_rcp;
+        dst[n++] = s0 + (s1 - s0) * t;
+        pos += r->step;
+    }
+
+    r->pos = pos >= end ? (pos - end) : pos;
+    r->prev = src[num_src_frames - 1];
+    return n;
+}
+
+// creates a copy of source samples in device sample-rate, so the mixer doesn't have to resample
+static bool snd__source_resample(snd__source* src, const sx_alloc* alloc, int dst_sample_rate)
+{
+    sx_assert(src->samples);
+    if (src->sample_rate == dst_sample_rate || src->num_frames == 0) {
+        return true;
+    }
+
+    int max_frames = snd__resampler_max_frames(src->num_frames, src->sample_rate, dst_sample_rate);
+    float* resampled = sx_aligned_malloc(alloc, sizeof(float) * max_frames, 16);
+    if (!resampled) {
+        sx_out_of_memory();
+        return false;
+    }
+
+    snd__resampler r;
+    snd__resampler_init(&r, src->sample_rate, dst_sample_rate);
+    src->resampled = resampled;
+    src->num_resampled_frames = snd__resample_linear(&r, resampled, max_frames, src->samples,
+                                                     src->num_frames);
+    src->mem_size += src->num_resampled_frames * (int)sizeof(float);
+    return true;
+}
+
 
 static void snd__destroy_source(rizz_snd_source handle, const sx_alloc* alloc)
 {
     sx_assert_always(sx_handle_valid(g_snd.source_handles, handle.id));
 
+    sx_mutex_enter(&g_snd.lock);
     snd__source* src = &g_snd.sources[sx_handle_index(handle.id)];
 
+    if (src->resampled) {
+        sx_aligned_free(alloc, src->resampled, 16);
+    }
     sx_free(alloc, src->data);
 
     if (src->name) {
@@ -261,6 +447,7 @@ static void snd__destroy_source(rizz_snd_source handle, const sx_alloc* alloc)
     }
 
     sx_handle_del(g_snd.source_handles, handle.id);
+    sx_mutex_exit(&g_snd.lock);
 
     // TODO: delete all instances with this source
 }
@@ -357,25 +544,33 @@ static rizz_asset_load_data snd__on_prepare(const rizz_asset_load_params* params
         return (rizz_asset_load_data){ {0} };
     }
 
+    sx_mutex_enter(&g_snd.lock);
     sx_handle_t handle = sx_handle_new_and_grow(g_snd.source_handles, g_snd_alloc);
+    sx_mutex_exit(&g_snd.lock);
     if (!handle) {
         sx_out_of_memory();
         return (rizz_asset_load_data){ { 0 } };
     }
 
     snd__source_flags flags = (sparams->looping ? SND_SOURCEFLAG_LOOPING : 0) |
-                              (sparams->singleton ? SND_SOURCEFLAG_SINGLETON : 0);
+                              (sparams->singleton ? SND_SOURCEFLAG_SINGLETON : 0) |
+                              (sparams->stream ? SND_SOURCEFLAG_STREAM : 0);
     snd__source src = { .num_frames = num_frames,
                         .volume = 1.0f,
                         .name =
                             sx_strpool_add(g_snd.name_pool, params->path, sx_strlen(params->path)),
                         .flags = flags,
-                        .fmt = fmt };
+                        .fmt = fmt,
+                        .vorbis_buffer_size = (int)vorbis_buffer_size };
 
+    sx_mutex_enter(&g_snd.lock);
     sx_array_push_byindex(g_snd_alloc, g_snd.sources, src, sx_handle_index(handle));
+    sx_mutex_exit(&g_snd.lock);
 
     // allocate memory for source data + samples and extra int for vorbis_buffer_size
-    int samples_sz = src.num_frames * sizeof(float);    // channels=1
+    // streaming sources keep a copy of compressed file data instead of decoded samples
+    int samples_sz = (flags & SND_SOURCEFLAG_STREAM) ? (int)mem->size
+                                                     : src.num_frames * (int)sizeof(float);    // channels=1
     int total_sz = sizeof(int) + samples_sz + sizeof(snd__source) + 16;
 
     void* data = sx_malloc(alloc, total_sz);
@@ -409,6 +604,47 @@ static bool snd__on_load(rizz_asset_load_data* data, const rizz_asset_load_param
     snd__source* src = (snd__source*)buff;
     buff += sizeof(snd__source);
 
+    if (src->flags & SND_SOURCEFLAG_STREAM) {
+        if (src->fmt == SND_SOURCEFORMAT_OGG) {
+            buff += sizeof(int);    // vorbis_buffer_size is already saved in the source
+        }
+
+        uint8_t* stream_data = sx_align_ptr(buff, 0, 16);
+        sx_memcpy(stream_data, mem->data, (size_t)mem->size);
+        src->stream_data = stream_data;
+        src->stream_data_size = (int)mem->size;
+        src->mem_size = (int)mem->size;
+
+        // only read the header here, decoding happens on the stream thread while playing
+        if (src->fmt == SND_SOURCEFORMAT_WAV) {
+            drwav wav;
+            if (!drwav_init_memory(&wav, stream_data, (size_t)mem->size)) {
+                rizz_log_warn("loading sound '%s' failed: invalid WAV format", params->path);
+                snd__destroy_source(srchandle, alloc);
+                return false;
+            }
+            src->sample_rate = wav.sampleRate;
+            src->stream_channels = wav.channels;
+            drwav_uninit(&wav);
+        } else if (src->fmt == SND_SOURCEFORMAT_OGG) {
+            int vorbis_err;
+            stb_vorbis* vorbis = stb_vorbis_open_memory(stream_data, (int)mem->size, &vorbis_err, NULL);
+            if (!vorbis) {
+                rizz_log_warn("loading sound '%s' failed: %s", params->path,
+                              snd__vorbis_get_error(vorbis_err));
+                snd__destroy_source(srchandle, alloc);
+                return false;
+            }
+            stb_vorbis_info info = stb_vorbis_get_info(vorbis);
+            src->sample_rate = info.sample_rate;
+            src->stream_channels = info.channels;
+            stb_vorbis_close(vorbis);
+        }
+
+        return true;
+    }
+
+    src->mem_size = src->num_frames * (int)sizeof(float);
     if (src->fmt == SND_SOURCEFORMAT_WAV) {
         drwav wav;
         if (!drwav_init_memory(&wav, mem->data, (size_t)mem->size)) {
@@ -502,6 +738,12 @@ static bool snd__on_load(rizz_asset_load_data* data, const rizz_asset_load_param
         } // scope
     }
 
+    // convert to device sample-rate once on load, instead of resampling on every mix
+    if (!snd__source_resample(src, alloc, saudio_sample_rate())) {
+        snd__destroy_source(srchandle, alloc);
+        return false;
+    }
+
     return true;
 }
 
@@ -515,7 +757,9 @@ static void snd__on_finalize(rizz_asset_load_data* data, const rizz_asset_load_p
     uint8_t* buff = (uint8_t*)data->user1;
     snd__source* src = (snd__source*)buff;
     sx_handle_t srchandle = (sx_handle_t)data->obj.id;
+    sx_mutex_enter(&g_snd.lock);
     g_snd.sources[sx_handle_index(srchandle)] = *src;
+    sx_mutex_exit(&g_snd.lock);
 }
 
 static void snd__on_reload(rizz_asset handle, rizz_asset_obj prev_obj, const sx_alloc* alloc)
@@ -538,6 +782,8 @@ static void snd__stream_cb(float* buffer, int num_frames, int num_channels)
 
     if (r < (uint32_t)num_frames) {
         sx_memset(buffer + r * num_channels, 0x0, (num_frames - r) * num_channels * sizeof(float));
+        sx_atomic_fetch_add32(&g_snd.num_underruns, 1);
+        sx_atomic_fetch_add32(&g_snd.num_underrun_frames, (uint32_t)num_frames - r);
     }
 
     if (the_imgui) {
@@ -568,7 +814,13 @@ static rizz_snd_source snd__create_dummy_source(const char* samples, int num_sam
                        .num_frames = num_samples,
                        .sample_rate = 22050,
                        .volume = 1.0f,
+                       .mem_size = num_samples * (int)sizeof(float),
                        .name = sx_strpool_add(g_snd.name_pool, name, sx_strlen(name)) };
+    if (!snd__source_resample(&src, g_snd_alloc, saudio_sample_rate())) {
+        sx_free(g_snd_alloc, fsamples);
+        return (rizz_snd_source){ 0 };
+    }
+
     sx_handle_t handle = sx_handle_new_and_grow(g_snd.source_handles, g_snd_alloc);
     if (!handle) {
         sx_out_of_memory();
@@ -586,6 +838,289 @@ static void snd__destroy_dummy_source(rizz_snd_source srchandle)
     if (src->samples) {
         sx_free(g_snd_alloc, src->samples);
     }
+    if (src->resampled) {
+        sx_aligned_free(g_snd_alloc, src->resampled, 16);
+    }
+}
+
+static bool snd__stream_open_decoder(snd__stream* stream)
+{
+    if (!snd__ringbuffer_init(&stream->rb, RIZZ_SND_STREAM_BUFFER_FRAMES)) {
+        return false;
+    }
+
+    if (stream->sample_rate != stream->dst_sample_rate) {
+        stream->resample_buff_frames = snd__resampler_max_frames(
+            SND_STREAM_DECODE_FRAMES, stream->sample_rate, stream->dst_sample_rate);
+        stream->resample_buff = sx_malloc(g_snd_alloc, sizeof(float) * stream->resample_buff_frames);
+        if (!stream->resample_buff) {
+            sx_out_of_memory();
+            return false;
+        }
+        snd__resampler_init(&stream->resampler, stream->sample_rate, stream->dst_sample_rate);
+    }
+
+    // interleaved multi-channel frames are decoded here and then down-mixed to mono
+    if (stream->channels > 1) {
+        stream->decode_buff =
+            sx_malloc(g_snd_alloc, sizeof(float) * SND_STREAM_DECODE_FRAMES * stream->channels);
+        if (!stream->decode_buff) {
+            sx_out_of_memory();
+            return false;
+        }
+    }
+
+    if (stream->fmt == SND_SOURCEFORMAT_WAV) {
+        if (!drwav_init_memory(&stream->wav, stream->data, (size_t)stream->data_size)) {
+            return false;
+        }
+    } else if (stream->fmt == SND_SOURCEFORMAT_OGG) {
+        int vorbis_err;
+        sx_assert(stream->vorbis_buffer_size > 0);
+        stream->vorbis_buff = sx_malloc(g_snd_alloc, stream->vorbis_buffer_size);
+        if (!stream->vorbis_buff) {
+            sx_out_of_memory();
+            return false;
+        }
+
+        stream->vorbis = stb_vorbis_open_memory(
+            stream->data, stream->data_size, &vorbis_err,
+            &(stb_vorbis_alloc){ .alloc_buffer = stream->vorbis_buff,
+                                 .alloc_buffer_length_in_bytes = stream->vorbis_buffer_size });
+        if (!stream->vorbis) {
+            rizz_log_warn("sound: opening vorbis stream failed: %s", snd__vorbis_get_error(vorbis_err));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void snd__stream_close_decoder(snd__stream* stream)
+{
+    if (stream->vorbis) {
+        stb_vorbis_close(stream->vorbis);
+        stream->vorbis = NULL;
+    }
+    if (stream->wav.onRead) {
+        drwav_uninit(&stream->wav);
+        sx_memset(&stream->wav, 0x0, sizeof(stream->wav));
+    }
+    if (stream->vorbis_buff) {
+        sx_free(g_snd_alloc, stream->vorbis_buff);
+        stream->vorbis_buff = NULL;
+    }
+    if (stream->decode_buff) {
+        sx_free(g_snd_alloc, stream->decode_buff);
+        stream->decode_buff = NULL;
+    }
+    if (stream->resample_buff) {
+        sx_free(g_snd_alloc, stream->resample_buff);
+        stream->resample_buff = NULL;
+        stream->resample_buff_frames = 0;
+    }
+    if (stream->rb.samples) {
+        snd__ringbuffer_release(&stream->rb);
+        sx_memset(&stream->rb, 0x0, sizeof(stream->rb));
+    }
+}
+
+// down-mix interleaved multi-channel frames to mono
+static void snd__downmix_to_mono(const float* samples, int num_frames, int num_channels, float* mono)
+{
+    float channels_rcp = 1.0f / (float)num_channels;
+    for (int i = 0; i < num_frames; i++) {
+        float sum = 0;
+        for (int ch = 0; ch < num_channels; ch++) {
+            sum += samples[ch];
+        }
+        samples += num_channels;
+        mono[i] = sum * channels_rcp;
+    }
+}
+
+// decodes a chunk of mono frames, returns number of frames decoded, 0 if reached the end
+static int snd__stream_decode_chunk(snd__stream* stream, float* mono)
+{
+    int n = 0;
+    float* dst = stream->channels > 1 ? stream->decode_buff : mono;
+    if (stream->fmt == SND_SOURCEFORMAT_WAV) {
+        n = (int)drwav_read_pcm_frames_f32(&stream->wav, SND_STREAM_DECODE_FRAMES, dst);
+    } else if (stream->fmt == SND_SOURCEFORMAT_OGG) {
+        n = stb_vorbis_get_samples_float_interleaved(stream->vorbis, stream->channels, dst,
+                                                     SND_STREAM_DECODE_FRAMES * stream->channels);
+    }
+
+    if (n > 0 && stream->channels > 1) {
+        snd__downmix_to_mono(stream->decode_buff, n, stream->channels, mono);
+    }
+    return n;
+}
+
+static void snd__stream_rewind(snd__stream* stream)
+{
+    if (stream->fmt == SND_SOURCEFORMAT_WAV) {
+        drwav_seek_to_pcm_frame(&stream->wav, 0);
+    } else if (stream->fmt == SND_SOURCEFORMAT_OGG) {
+        stb_vorbis_seek_start(stream->vorbis);
+    }
+}
+
+// fills the stream's ring-buffer as much as possible
+static void snd__stream_decode(snd__stream* stream)
+{
+    float mono[SND_STREAM_DECODE_FRAMES];
+    uint64_t start_tm = sx_tm_now();
+    uint64_t num_decoded = 0;
+    uint64_t num_produced = 0;
+    bool rewound = false;
+
+    uint32_t min_expect = (uint32_t)sx_max(SND_STREAM_DECODE_FRAMES, stream->resample_buff_frames);
+    while (snd__ringbuffer_expect(&stream->rb) >= min_expect) {
+        int n = snd__stream_decode_chunk(stream, mono);
+        if (n == 0) {
+            if (stream->looping && !rewound) {
+                snd__stream_rewind(stream);
+                rewound = true;
+                continue;
+            }
+            sx_atomic_store32(&stream->eof, 1);
+            break;
+        }
+
+        rewound = false;
+        if (stream->resample_buff) {
+            int num_resampled = snd__resample_linear(&stream->resampler, stream->resample_buff,
+                                                     stream->resample_buff_frames, mono, n);
+            snd__ringbuffer_produce(&stream->rb, stream->resample_buff, (uint32_t)num_resampled);
+            num_produced += (uint64_t)num_resampled;
+        } else {
+            snd__ringbuffer_produce(&stream->rb, mono, (uint32_t)n);
+            num_produced += (uint64_t)n;
+        }
+        num_decoded += (uint64_t)n;
+    }
+
+    if (num_decoded) {
+        uint64_t decode_tm = sx_tm_since(start_tm);
+        sx_atomic_fetch_add64(&stream->decode_ticks, decode_tm);
+        sx_atomic_fetch_add64(&stream->decoded_frames, num_decoded);
+        sx_atomic_fetch_add64(&g_snd.decode_total_tm, decode_tm);
+        sx_atomic_fetch_add64(&g_snd.decode_total_frames, num_produced);
+    }
+}
+
+static int snd__stream_thread_fn(void* user)
+{
+    sx_unused(user);
+
+    while (!g_snd.stream_quit) {
+        for (int i = 0; i < RIZZ_SND_DEVICE_MAX_STREAMS; i++) {
+            snd__stream* stream = &g_snd.streams[i];
+            switch (sx_atomic_load32(&stream->state)) {
+            case SND_STREAMSTATE_OPEN: {
+                if (!snd__stream_open_decoder(stream)) {
+                    // let the mixer remove the instance
+                    snd__stream_close_decoder(stream);
+                    sx_atomic_store32(&stream->eof, 1);
+                }
+
+                // main thread may have closed the stream while we were opening it
+                uint32_t expected = SND_STREAMSTATE_OPEN;
+                if (!sx_atomic_compare_exchange32_strong(&stream->state, &expected,
+                                                         SND_STREAMSTATE_PLAYING)) {
+                    sx_assert(expected == SND_STREAMSTATE_CLOSE);
+                    snd__stream_close_decoder(stream);
+                    sx_atomic_store32(&stream->eof, 0);
+                    sx_atomic_store32(&stream->state, SND_STREAMSTATE_FREE);
+                    break;
+                }
+
+                if (!sx_atomic_load32(&stream->eof)) {
+                    snd__stream_decode(stream);
+                }
+                break;
+            }
+            case SND_STREAMSTATE_PLAYING:
+                if (!sx_atomic_load32(&stream->eof)) {
+                    snd__stream_decode(stream);
+                }
+                break;
+            case SND_STREAMSTATE_CLOSE:
+                snd__stream_close_decoder(stream);
+                sx_atomic_store32(&stream->eof, 0);
+                sx_atomic_store32(&stream->state, SND_STREAMSTATE_FREE);
+                break;
+            default:
+                break;
+            }
+        }
+
+        // wake up by the main thread on each update or periodically
+        sx_semaphore_wait(&g_snd.stream_sem, 10);
+    }
+
+    return 0;
+}
+
+static int snd__stream_open(rizz_snd_source srchandle, const snd__source* src)
+{
+    for (int i = 0; i < RIZZ_SND_DEVICE_MAX_STREAMS; i++) {
+        snd__stream* stream = &g_snd.streams[i];
+        if (sx_atomic_load32(&stream->state) == SND_STREAMSTATE_FREE) {
+            stream->srchandle = srchandle;
+            stream->data = src->stream_data;
+            stream->data_size = src->stream_data_size;
+            stream->channels = src->stream_channels;
+            stream->vorbis_buffer_size = src->vorbis_buffer_size;
+            stream->fmt = src->fmt;
+            stream->sample_rate = src->sample_rate;
+            stream->dst_sample_rate = saudio_sample_rate();
+            stream->looping = (src->flags & SND_SOURCEFLAG_LOOPING) ? true : false;
+            stream->num_underruns = 0;
+            sx_atomic_store64(&stream->decode_ticks, 0);
+            sx_atomic_store64(&stream->decoded_frames, 0);
+            sx_atomic_store32(&stream->state, SND_STREAMSTATE_OPEN);
+            sx_semaphore_post(&g_snd.stream_sem, 1);
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+static void snd__stream_close(int stream_id)
+{
+    sx_assert(stream_id > 0 && stream_id <= RIZZ_SND_DEVICE_MAX_STREAMS);
+    snd__stream* stream = &g_snd.streams[stream_id - 1];
+    sx_atomic_store32(&stream->state, SND_STREAMSTATE_CLOSE);
+    sx_semaphore_post(&g_snd.stream_sem, 1);
+}
+
+// reads `num_frames` device sample-rate frames (already resampled by stream thread) from the stream
+// into `dst`. frames that are not decoded yet are filled with silence. returns number of frames read
+static int snd__stream_read(snd__stream* stream, float* dst, int num_frames)
+{
+    if (sx_atomic_load32(&stream->state) != SND_STREAMSTATE_PLAYING) {
+        sx_memset(dst, 0x0, sizeof(float) * num_frames);
+        return 0;
+    }
+
+    int r = snd__ringbuffer_consume(&stream->rb, dst, (uint32_t)num_frames);
+    if (r < num_frames) {
+        sx_memset(dst + r, 0x0, sizeof(float) * (num_frames - r));
+        if (!sx_atomic_load32(&stream->eof)) {
+            ++stream->num_underruns;
+        }
+    }
+
+    return r;
+}
+
+static inline bool snd__stream_finished(snd__stream* stream)
+{
+    return sx_atomic_load32(&stream->state) == SND_STREAMSTATE_PLAYING &&
+           sx_atomic_load32(&stream->eof) && stream->rb.size == 0;
 }
 
 static void* snd__cmdbuffer_init(int thread_index, uint32_t thread_id, void* user)
@@ -606,12 +1141,15 @@ static void* snd__cmdbuffer_init(int thread_index, uint32_t thread_id, void* use
     return cb;
 }
 
+static int snd__mixer_thread_fn(void* user);
+
 static bool snd__init()
 {
     static_assert(RIZZ_SND_DEVICE_NUM_CHANNELS == 1 || RIZZ_SND_DEVICE_NUM_CHANNELS == 2,
                   "only mono or stereo output channel is supported");
 
     g_snd_alloc = the_core->trace_alloc_create("Sound", RIZZ_MEMOPTION_INHERIT, NULL, the_core->heap_alloc());
+    sx_mutex_init(&g_snd.lock);
 
     g_snd.source_handles = sx_handle_create_pool(g_snd_alloc, 128);
     g_snd.instance_handles = sx_handle_create_pool(g_snd_alloc, 256);
@@ -634,6 +1172,18 @@ static bool snd__init()
         return false;
     }
 
+    g_snd.streams = sx_malloc(g_snd_alloc, sizeof(snd__stream) * RIZZ_SND_DEVICE_MAX_STREAMS);
+    if (!g_snd.streams) {
+        sx_out_of_memory();
+        return false;
+    }
+    sx_memset(g_snd.streams, 0x0, sizeof(snd__stream) * RIZZ_SND_DEVICE_MAX_STREAMS);
+    sx_semaphore_init(&g_snd.stream_sem);
+    g_snd.stream_thrd = the_core->thread_create(snd__stream_thread_fn, NULL, "snd_stream");
+    if (!g_snd.stream_thrd) {
+        return false;
+    }
+
     g_snd.name_pool = sx_strpool_create(g_snd_alloc, NULL);
     g_snd.clocked_pool = sx_pool_create(g_snd_alloc, sizeof(snd__clocked), 128);
     if (!g_snd.name_pool || !g_snd.clocked_pool) {
@@ -667,6 +1217,22 @@ static bool snd__init()
     // initialize first bus to use all lanes
     g_snd.buses[0].max_lanes = RIZZ_SND_DEVICE_MAX_LANES;
 
+    // each bus owns a submix buffer, big enough to hold a whole mixer buffer
+    g_snd.submix_max_frames = mixer_buffer_size / RIZZ_SND_DEVICE_NUM_CHANNELS;
+    int submix_size = g_snd.submix_max_frames * RIZZ_SND_DEVICE_NUM_CHANNELS;
+    g_snd.submix_buff =
+        sx_aligned_malloc(g_snd_alloc, sizeof(float) * submix_size * RIZZ_SND_DEVICE_MAX_BUSES, 16);
+    if (!g_snd.submix_buff) {
+        sx_out_of_memory();
+        return false;
+    }
+    for (int i = 0; i < RIZZ_SND_DEVICE_MAX_BUSES; i++) {
+        snd__bus* bus = &g_snd.buses[i];
+        bus->volume = 1.0f;
+        bus->lowpass = 1.0f;
+        bus->submix = g_snd.submix_buff + i * submix_size;
+    }
+
     // we have a command buffer for each worker thread
     g_snd.cmd_buffers = sx_malloc(g_snd_alloc, sizeof(snd__cmdbuffer*) * the_core->job_num_threads());
     if (!g_snd.cmd_buffers) {
@@ -675,15 +1241,68 @@ static bool snd__init()
     }
     g_snd.num_cmdbuffers = the_core->job_num_threads();
     sx_memset(g_snd.cmd_buffers, 0x0, sizeof(snd__cmdbuffer*) * the_core->job_num_threads());
-    the_core->tls_register("snd_cmdbuffer", NULL, snd__cmdbuffer_init);
+    g_snd.cmdbuffer_tls = the_core->tls_register_slot("snd_cmdbuffer", NULL, snd__cmdbuffer_init);
+
+    const char* mixer_thread = the_app->config_meta_value("sound", "mixer_thread");
+    if (mixer_thread && sx_tobool(mixer_thread)) {
+        g_snd.cmd_queue = sx_queue_spsc_create(g_snd_alloc, sizeof(snd__cmdbatch*), SND_MAX_CMD_BATCHES);
+        g_snd.cmd_free_queue =
+            sx_queue_spsc_create(g_snd_alloc, sizeof(snd__cmdbatch*), SND_MAX_CMD_BATCHES);
+        if (!g_snd.cmd_queue || !g_snd.cmd_free_queue) {
+            sx_out_of_memory();
+            return false;
+        }
+        for (int i = 0; i < SND_MAX_CMD_BATCHES; i++) {
+            snd__cmdbatch* batch = &g_snd.cmd_batches[i];
+            sx_queue_spsc_produce(g_snd.cmd_free_queue, &batch);
+        }
+
+        sx_semaphore_init(&g_snd.mixer_sem);
+        g_snd.mixer_thrd = the_core->thread_create(snd__mixer_thread_fn, NULL, "snd_mixer");
+        if (!g_snd.mixer_thrd) {
+            return false;
+        }
+    }
 
     return true;
 }
 
 static void snd__release()
 {
+    if (g_snd.mixer_thrd) {
+        g_snd.mixer_quit = 1;
+        sx_semaphore_post(&g_snd.mixer_sem, 1);
+        the_core->thread_destroy(g_snd.mixer_thrd);
+        sx_semaphore_release(&g_snd.mixer_sem);
+    }
+
+    for (int i = 0; i < SND_MAX_CMD_BATCHES; i++) {
+        sx_array_free(g_snd_alloc, g_snd.cmd_batches[i].params_buff);
+        sx_array_free(g_snd_alloc, g_snd.cmd_batches[i].cmds);
+    }
+    if (g_snd.cmd_queue) {
+        sx_queue_spsc_destroy(g_snd.cmd_queue, g_snd_alloc);
+    }
+    if (g_snd.cmd_free_queue) {
+        sx_queue_spsc_destroy(g_snd.cmd_free_queue, g_snd_alloc);
+    }
+
     saudio_shutdown();
 
+    if (g_snd.stream_thrd) {
+        g_snd.stream_quit = 1;
+        sx_semaphore_post(&g_snd.stream_sem, 1);
+        the_core->thread_destroy(g_snd.stream_thrd);
+        sx_semaphore_release(&g_snd.stream_sem);
+    }
+
+    if (g_snd.streams) {
+        for (int i = 0; i < RIZZ_SND_DEVICE_MAX_STREAMS; i++) {
+            snd__stream_close_decoder(&g_snd.streams[i]);
+        }
+        sx_free(g_snd_alloc, g_snd.streams);
+    }
+
     if (g_snd.cmd_buffers) {
         for (int i = 0; i < g_snd.num_cmdbuffers; i++) {
             snd__cmdbuffer* cb = g_snd.cmd_buffers[i];
@@ -728,6 +1347,10 @@ static void snd__release()
     snd__ringbuffer_release(&g_snd.mixer_buffer);
     snd__ringbuffer_release(&g_snd.mixer_plot_buffer);
 
+    if (g_snd.submix_buff) {
+        sx_aligned_free(g_snd_alloc, g_snd.submix_buff, 16);
+    }
+
     if (g_snd.name_pool) {
         sx_strpool_destroy(g_snd.name_pool, g_snd_alloc);
     }
@@ -736,6 +1359,7 @@ static void snd__release()
     }
 
     the_asset->unregister_asset_type("sound");
+    sx_mutex_release(&g_snd.lock);
     the_core->trace_alloc_destroy(g_snd_alloc);
     g_snd_alloc = NULL;
 }
@@ -745,7 +1369,6 @@ static inline rizz_snd_instance snd__create_instance(rizz_snd_source srchandle,
 {
     sx_assert(bus >= 0 && bus < RIZZ_SND_DEVICE_MAX_BUSES);
     sx_assert_always(sx_handle_valid(g_snd.source_handles, srchandle.id));
-    sx_handle_t handle = sx_handle_new_and_grow(g_snd.instance_handles, g_snd_alloc);
 
     snd__instance inst = (snd__instance){ .srchandle = srchandle,
                                           .volume = volume,
@@ -753,7 +1376,10 @@ static inline rizz_snd_instance snd__create_instance(rizz_snd_source srchandle,
                                           .bus_id = bus,
                                           .play_frame = -1 };
 
+    sx_mutex_enter(&g_snd.lock);
+    sx_handle_t handle = sx_handle_new_and_grow(g_snd.instance_handles, g_snd_alloc);
     sx_array_push_byindex(g_snd_alloc, g_snd.instances, inst, sx_handle_index(handle));
+    sx_mutex_exit(&g_snd.lock);
     return (rizz_snd_instance){ handle };
 }
 
@@ -767,6 +1393,11 @@ static inline void snd__destroy_instance(rizz_snd_instance insthandle, bool remo
         --g_snd.buses[inst->bus_id].num_lanes;
     }
 
+    if (inst->stream_id) {
+        snd__stream_close(inst->stream_id);
+        inst->stream_id = 0;
+    }
+
     if (inst->state == SND_INSTANCESTATE_PLAYING) {
         // decrement num_plays from the source
         sx_assert_always(sx_handle_valid(g_snd.source_handles, inst->srchandle.id));
@@ -789,7 +1420,20 @@ static void snd__queue_play(rizz_snd_instance insthandle)
     sx_assert_always(sx_handle_valid(g_snd.source_handles, inst->srchandle.id));
 
     snd__source* src = &g_snd.sources[sx_handle_index(inst->srchandle.id)];
-    sx_assert(src->samples);
+    sx_assert(src->samples || (src->flags & SND_SOURCEFLAG_STREAM));
+
+    if (src->flags & SND_SOURCEFLAG_STREAM) {
+        // (re)start decoding from the beginning
+        if (inst->stream_id) {
+            snd__stream_close(inst->stream_id);
+        }
+        inst->stream_id = snd__stream_open(inst->srchandle, src);
+        if (!inst->stream_id) {
+            rizz_log_warn("sound: cannot play '%s', maximum streams (%d) are playing",
+                          sx_strpool_cstr(g_snd.name_pool, src->name), RIZZ_SND_DEVICE_MAX_STREAMS);
+            return;
+        }
+    }
 
     inst->play_frame = the_core->frame_index();
     inst->pos = 0;
@@ -840,7 +1484,9 @@ static rizz_snd_instance snd__play(rizz_snd_source srchandle, int bus, float vol
 {
     rizz_snd_instance insthandle = snd__create_instance(srchandle, bus, volume, pan);
     if (!paused) {
+        sx_mutex_enter(&g_snd.lock);
         snd__queue_play(insthandle);
+        sx_mutex_exit(&g_snd.lock);
     }
     return insthandle;
 }
@@ -881,6 +1527,7 @@ static rizz_snd_instance snd__play_clocked(rizz_snd_source src, float wait_tm, i
 
 static void snd__stop(rizz_snd_instance insthandle)
 {
+    sx_mutex_enter(&g_snd.lock);
     if (sx_handle_valid(g_snd.instance_handles, insthandle.id)) {
         for (int i = 0, c = g_snd.num_plays; i < c; i++) {
             if (g_snd.playlist[i].id == insthandle.id) {
@@ -891,27 +1538,59 @@ static void snd__stop(rizz_snd_instance insthandle)
         }
         snd__destroy_instance(insthandle, true);
     }
+    sx_mutex_exit(&g_snd.lock);
 }
 
 static void snd__stop_all(void)
 {
+    sx_mutex_enter(&g_snd.lock);
     for (int i = 0, c = g_snd.num_plays; i < c; i++) {
         snd__destroy_instance(g_snd.playlist[i], true);
     }
     g_snd.num_plays = 0;
+    sx_mutex_exit(&g_snd.lock);
 }
 
 static void snd__resume(rizz_snd_instance insthandle)
 {
+    sx_mutex_enter(&g_snd.lock);
     if (sx_handle_valid(g_snd.instance_handles, insthandle.id)) {
         snd__queue_play(insthandle);
     }
+    sx_mutex_exit(&g_snd.lock);
+}
+
+static void snd__bus_set_volume(int bus, float volume)
+{
+    sx_assert(bus >= 0 && bus < RIZZ_SND_DEVICE_MAX_BUSES);
+    sx_mutex_enter(&g_snd.lock);
+    g_snd.buses[bus].volume = sx_max(volume, 0.0f);
+    sx_mutex_exit(&g_snd.lock);
+}
+
+static void snd__bus_set_lowpass(int bus, float cutoff)
+{
+    sx_assert(bus >= 0 && bus < RIZZ_SND_DEVICE_MAX_BUSES);
+    float sample_rate = (float)saudio_sample_rate();
+    float lowpass = 1.0f;
+    if (cutoff <= 0 || cutoff >= sample_rate * 0.5f) {
+        cutoff = 0;
+    } else {
+        lowpass = 1.0f - sx_exp(-SX_PI2 * cutoff / sample_rate);
+    }
+
+    sx_mutex_enter(&g_snd.lock);
+    snd__bus* b = &g_snd.buses[bus];
+    b->lowpass = lowpass;
+    b->lowpass_cutoff = cutoff;
+    sx_mutex_exit(&g_snd.lock);
 }
 
 static void snd__bus_stop(int bus)
 {
     sx_assert(bus >= 0 && bus < RIZZ_SND_DEVICE_MAX_BUSES);
 
+    sx_mutex_enter(&g_snd.lock);
     int num_plays = g_snd.num_plays;
     for (int i = 0; i < num_plays; i++) {
         rizz_snd_instance insthandle = g_snd.playlist[i];
@@ -919,44 +1598,148 @@ static void snd__bus_stop(int bus)
         if (inst->bus_id == bus) {
             sx_swap(g_snd.playlist[i], g_snd.playlist[num_plays - 1], rizz_snd_instance);
             --num_plays;
+            --i;
             snd__destroy_instance(insthandle, true);
         }
     }
     g_snd.num_plays = num_plays;
+    sx_mutex_exit(&g_snd.lock);
+}
+
+
+// fills `frames` with mono samples of the instance in device sample-rate, and advances the
+// instance position. returns false if the instance is finished and should be removed
+static bool snd__mix_fetch_voice(snd__instance* inst, const snd__source* src, float* frames,
+                                 int num_frames, int dst_sample_rate)
+{
+    if (inst->stream_id) {
+        // streaming sources are decoded by stream thread into the stream's ring-buffer
+        snd__stream* stream = &g_snd.streams[inst->stream_id - 1];
+        int r = snd__stream_read(stream, frames, num_frames);
+
+        // keep the position in source frames for the debugger
+        inst->pos += (int)(((int64_t)r * src->sample_rate) / dst_sample_rate);
+        if (inst->pos >= src->num_frames) {
+            inst->pos = src->num_frames > 0 ? (inst->pos % src->num_frames) : 0;
+        }
+        return !snd__stream_finished(stream);
+    }
+
+    const float* samples = src->resampled ? src->resampled : src->samples;
+    int total_frames = src->resampled ? src->num_resampled_frames : src->num_frames;
+    bool looping = (src->flags & SND_SOURCEFLAG_LOOPING) ? true : false;
+    int frames_written = 0;
+
+    while (frames_written < num_frames) {
+        int n = sx_min(num_frames - frames_written, total_frames - inst->pos);
+        if (n > 0) {
+            sx_memcpy(frames + frames_written, samples + inst->pos, sizeof(float) * n);
+            frames_written += n;
+            inst->pos += n;
+        }
+
+        if (inst->pos >= total_frames) {
+            if (!looping || total_frames == 0) {
+                break;
+            }
+            inst->pos = 0;
+        }
+    }
+
+    if (frames_written < num_frames) {
+        sx_memset(frames + frames_written, 0x0, sizeof(float) * (num_frames - frames_written));
+    }
+
+    return looping || inst->pos < total_frames;
+}
+
+// dst += frames * gain, upmixed to stereo. both buffers must be 16 bytes aligned
+static void snd__mix_voice_stereo(float* dst, const float* frames, int num_frames, float gain_l,
+                                  float gain_r)
+{
+    sx_simd_t left = sx_simd_splat1(gain_l);
+    sx_simd_t right = sx_simd_splat1(gain_r);
+    int num_simd_frames = num_frames & ~3;
+    for (int i = 0; i < num_simd_frames; i += 4) {
+        sx_simd_t mono = sx_simd_load(frames + i);
+        sx_simd_t l = sx_simd_mul(mono, left);
+        sx_simd_t r = sx_simd_mul(mono, right);
+        float* d = dst + i * 2;
+        sx_simd_store(d, sx_simd_add(sx_simd_load(d), sx_simd_shuffle_xAyB(l, r)));
+        sx_simd_store(d + 4, sx_simd_add(sx_simd_load(d + 4), sx_simd_shuffle_zCwD(l, r)));
+    }
+
+    for (int i = num_simd_frames; i < num_frames; i++) {
+        dst[i * 2] += frames[i] * gain_l;
+        dst[i * 2 + 1] += frames[i] * gain_r;
+    }
 }
 
+// dst += samples * gain. both buffers must be 16 bytes aligned
+static void snd__mix_add(float* dst, const float* samples, int num_samples, float gain)
+{
+    sx_simd_t g = sx_simd_splat1(gain);
+    int num_simd_samples = num_samples & ~3;
+    for (int i = 0; i < num_simd_samples; i += 4) {
+        sx_simd_store(dst + i, sx_simd_madd(sx_simd_load(samples + i), g, sx_simd_load(dst + i)));
+    }
+
+    for (int i = num_simd_samples; i < num_samples; i++) {
+        dst[i] += samples[i] * gain;
+    }
+}
 
-// TODO: research on fixed-point math, in order to implement linear sampling
-static int snd__resample_point(float* dst, int num_dst_samples, int sample_offset, const float* src,
-                               float src_sample_rate, float dst_sample_rate)
+static void snd__mix_clip(float* dst, int num_samples)
 {
-    float multiplier = dst_sample_rate / src_sample_rate;
-    uint32_t step_fixed = (uint32_t)sx_floor(FIXPOINT_FRAC_MUL / multiplier);
-    uint64_t pos = ((uint64_t)sample_offset << FIXPOINT_FRAC_BITS);
+    sx_simd_t min = sx_simd_splat1(-1.0f);
+    sx_simd_t max = sx_simd_splat1(1.0f);
+    int num_simd_samples = num_samples & ~3;
+    for (int i = 0; i < num_simd_samples; i += 4) {
+        sx_simd_store(dst + i, sx_simd_min(sx_simd_max(sx_simd_load(dst + i), min), max));
+    }
 
-    for (int i = 0; i < num_dst_samples; i++, pos += step_fixed) {
-        int p = (int)(pos >> FIXPOINT_FRAC_BITS);
-        dst[i] = src[p];
+    for (int i = num_simd_samples; i < num_samples; i++) {
+        dst[i] = sx_clamp(dst[i], -1.0f, 1.0f);
     }
+}
 
-    int new_pos = (int)(pos >> FIXPOINT_FRAC_BITS);
-    return new_pos != sample_offset ? new_pos : sample_offset + num_dst_samples;
+// one-pole low-pass filter, applied in place on the bus submix buffer
+static void snd__bus_lowpass(snd__bus* bus, float* samples, int num_frames, int num_channels)
+{
+    float a = bus->lowpass;
+    for (int ch = 0; ch < num_channels; ch++) {
+        float y = bus->lowpass_state[ch];
+        for (int i = ch, c = num_frames * num_channels; i < c; i += num_channels) {
+            y += a * (samples[i] - y);
+            samples[i] = y;
+        }
+        bus->lowpass_state[ch] = y;
+    }
 }
 
+// mixes all playing instances into their bus submix buffers, then processes each bus and mixes
+// the results into `dst`. dst must be 16 bytes aligned and zero-initialized
 static void snd__mix(float* dst, int dst_num_frames, int dst_num_channels, int dst_sample_rate)
 {
-    float dst_sample_ratef = (float)dst_sample_rate;
-    int frames_written = 0;
+    sx_assert(dst_num_frames <= g_snd.submix_max_frames);
+    sx_assert(dst_num_channels == 1 || dst_num_channels == 2);
+
+    uint64_t start_tm = sx_tm_now();
     float master_pan_ch1 = g_snd.master_pan > 0.0f ? (1.0f - g_snd.master_pan) : 1.0f;
     float master_pan_ch2 = g_snd.master_pan < 0.0f ? (1.0f + g_snd.master_pan) : 1.0f;
+    int dst_num_samples = dst_num_frames * dst_num_channels;
 
     rizz_snd_instance garbage[RIZZ_SND_DEVICE_MAX_LANES];
     int num_garbage = 0;
+    bool bus_active[RIZZ_SND_DEVICE_MAX_BUSES] = { 0 };
     sx_assert(g_snd.num_plays <= RIZZ_SND_DEVICE_MAX_LANES);
 
     const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
 
     sx_scope(the_core->tmp_alloc_pop()) {
+        // single voice buffer, reused for all instances
+        float* frames = sx_aligned_malloc(tmp_alloc, sizeof(float) * dst_num_frames, 16);
+        sx_assert_always(frames);
 
         for (int i = 0, c = g_snd.num_plays; i < c; i++) {
             rizz_snd_instance insthandle = g_snd.playlist[i];
@@ -964,73 +1747,48 @@ static void snd__mix(float* dst, int dst_num_frames, int dst_num_channels, int d
             snd__instance* inst = &g_snd.instances[sx_handle_index(insthandle.id)];
             rizz_snd_source srchandle = inst->srchandle;
             sx_assert_always(sx_handle_valid(g_snd.source_handles, srchandle.id));
-            snd__source* src = &g_snd.sources[sx_handle_index(srchandle.id)];
-
-            int pos = inst->pos;
-            int src_frames_remain = src->num_frames - pos;
-            int num_frames = sx_min(dst_num_frames, src_frames_remain);
-            int num_samples = num_frames;    // mono
-            float* frames;
-
-            if (src->sample_rate != dst_sample_rate) {
-                // resample and upmix to device_channels
-                frames = sx_malloc(tmp_alloc, sizeof(float) * num_samples);
-                sx_assert(frames);
+            const snd__source* src = &g_snd.sources[sx_handle_index(srchandle.id)];
 
-                inst->pos = snd__resample_point(frames, num_samples, inst->pos, src->samples,
-                                                (float)src->sample_rate, dst_sample_ratef);
-            } else {
-                // the source and device sample format is the same. do nothing
-                frames = src->samples + inst->pos;
-                inst->pos += num_frames;
+            if (!snd__mix_fetch_voice(inst, src, frames, dst_num_frames, dst_sample_rate)) {
+                garbage[num_garbage++] = insthandle;
             }
 
-            // remove sound if EOF / loop
-            if (inst->pos >= src->num_frames) {
-                if (!(src->flags & SND_SOURCEFLAG_LOOPING)) {
-                    garbage[num_garbage++] = insthandle;
-                } else {
-                    inst->pos = 0;
-                }
+            snd__bus* bus = &g_snd.buses[inst->bus_id];
+            if (!bus_active[inst->bus_id]) {
+                sx_memset(bus->submix, 0x0, sizeof(float) * dst_num_samples);
+                bus_active[inst->bus_id] = true;
             }
 
-            // add to destination buffer. upmix to device_channels if output is stereo
-            float vol = inst->volume * src->volume * g_snd.master_volume;
-
-            int dst_num_samples = num_frames * dst_num_channels;
+            // add to bus submix buffer. upmix to device_channels if output is stereo
+            float vol = inst->volume * src->volume;
             if (dst_num_channels == 2) {
                 float pan = inst->pan;
                 float channel1 = master_pan_ch1 * (pan > 0 ? (1.0f - pan) : 1.0f) * vol;    // left
                 float channel2 = master_pan_ch2 * (pan < 0 ? (1.0f + pan) : 1.0f) * vol;    // right
-
-                for (int s = 0, p = 0; s < dst_num_samples; s += dst_num_channels, p++) {
-                    dst[s] += frames[p] * channel1;
-                    dst[s + 1] += frames[p] * channel2;
-                }
-            } else if (dst_num_channels == 1) {
-                for (int s = 0, p = 0; s < dst_num_samples; s += dst_num_channels, p++) {
-                    dst[s] += frames[p] * vol;
-                }
+                snd__mix_voice_stereo(bus->submix, frames, dst_num_frames, channel1, channel2);
             } else {
-                sx_assertf(0, "not implemented");
+                snd__mix_add(bus->submix, frames, dst_num_frames, vol);
             }
-
-            frames_written = sx_max(frames_written, num_frames);
         }
     } // scope
 
-    // A very naive clipping
-    int samples_written = frames_written * dst_num_channels;
-    for (int i = 0; i < samples_written; i++) {
-        dst[i] = sx_clamp(dst[i], -1.0f, 1.0f);
-    }
+    // process buses and mix them into destination, one pass per bus
+    for (int i = 0; i < RIZZ_SND_DEVICE_MAX_BUSES; i++) {
+        snd__bus* bus = &g_snd.buses[i];
+        if (!bus_active[i]) {
+            sx_memset(bus->lowpass_state, 0x0, sizeof(bus->lowpass_state));
+            continue;
+        }
 
-    // fill remaining frames with zeros
-    if (frames_written < dst_num_frames) {
-        sx_memset(dst + frames_written * dst_num_channels, 0x0,
-                  (dst_num_frames - frames_written) * dst_num_channels * sizeof(float));
+        if (bus->lowpass < 1.0f) {
+            snd__bus_lowpass(bus, bus->submix, dst_num_frames, dst_num_channels);
+        }
+        snd__mix_add(dst, bus->submix, dst_num_samples, bus->volume * g_snd.master_volume);
     }
 
+    // A very naive clipping
+    snd__mix_clip(dst, dst_num_samples);
+
     // delete garbage instances and remove from playlist
     for (int i = 0; i < num_garbage; i++) {
         rizz_snd_instance insthandle = garbage[i];
@@ -1043,6 +1801,35 @@ static void snd__mix(float* dst, int dst_num_frames, int dst_num_channels, int d
         }
         snd__destroy_instance(insthandle, true);
     }
+
+    g_snd.mix_tm = sx_tm_since(start_tm);
+    g_snd.mix_frames = dst_num_frames;
+    g_snd.mix_voices = g_snd.num_plays + num_garbage;
+    g_snd.mix_total_tm += g_snd.mix_tm;
+    g_snd.mix_total_frames += dst_num_frames;
+    g_snd.mix_total_voice_frames += (int64_t)g_snd.mix_voices * dst_num_frames;
+}
+
+// mixes `num_frames` and pushes them to the device ring-buffer
+static void snd__mix_into_buffer(int num_frames, int device_channels, int device_sample_rate)
+{
+    num_frames = sx_min(num_frames, g_snd.submix_max_frames);
+    const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
+
+    sx_scope(the_core->tmp_alloc_pop()) {
+        float* frames = sx_aligned_malloc(tmp_alloc, sizeof(float) * num_frames * device_channels, 16);
+        sx_assert_always(frames);
+        sx_memset(frames, 0x0, sizeof(float) * num_frames * device_channels);
+        rizz_profile(snd_mix) {
+            sx_mutex_enter(&g_snd.lock);
+            snd__mix(frames, num_frames, device_channels, device_sample_rate);
+            sx_mutex_exit(&g_snd.lock);
+        }
+        snd__ringbuffer_produce(&g_snd.mixer_buffer, frames, num_frames * device_channels);
+    }
+
+    // wake up stream thread to refill the consumed stream buffers
+    sx_semaphore_post(&g_snd.stream_sem, 1);
 }
 
 static void snd__update(float dt)
@@ -1051,6 +1838,7 @@ static void snd__update(float dt)
     int device_sample_rate = saudio_sample_rate();
 
     // update clocked items
+    sx_mutex_enter(&g_snd.lock);
     for (int i = 0, c = sx_array_count(g_snd.clocked); i < c; i++) {
         snd__clocked* clocked = g_snd.clocked[i];
         if (clocked->tm < clocked->wait_tm && !clocked->first) {
@@ -1077,6 +1865,12 @@ static void snd__update(float dt)
             }
         }
     }
+    sx_mutex_exit(&g_snd.lock);
+
+    // mixer thread fills the buffer by itself
+    if (g_snd.mixer_thrd) {
+        return;
+    }
 
     // mix into main sound buffer
     int frames_remain = snd__ringbuffer_expect(&g_snd.mixer_buffer) / device_channels;
@@ -1088,18 +1882,7 @@ static void snd__update(float dt)
 
     frames_remain = frames_needed != 0 ? sx_min(frames_remain, frames_needed) : frames_remain;
     if (frames_remain) {
-        const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
-        
-        sx_scope(the_core->tmp_alloc_pop()) {
-            float* frames = sx_malloc(tmp_alloc, sizeof(float) * frames_remain * device_channels);
-            if (!frames) {
-                sx_out_of_memory();
-                return;
-            }
-            sx_memset(frames, 0x0, sizeof(float) * frames_remain * device_channels);
-            snd__mix(frames, frames_remain, device_channels, device_sample_rate);
-            snd__ringbuffer_produce(&g_snd.mixer_buffer, frames, frames_remain * device_channels);
-        }
+        snd__mix_into_buffer(frames_remain, device_channels, device_sample_rate);
     }
 }
 
@@ -1202,17 +1985,154 @@ static void snd__plot_samples_wav(const char* label, const float* samples, int n
     } // scope
 }
 
+static void snd__show_streams(void)
+{
+    if (!the_imgui->CollapsingHeader_TreeNodeFlags("Streams", 0)) {
+        return;
+    }
+
+    if (the_imgui->BeginTable("Streams", 5,
+                              ImGuiTableFlags_Resizable|ImGuiTableFlags_BordersV|ImGuiTableFlags_BordersOuterH|
+                              ImGuiTableFlags_SizingFixedFit|ImGuiTableFlags_RowBg,
+                              SX_VEC2_ZERO, 0)) {
+        the_imgui->TableSetupColumn("#", 0, 30.0f, 0);
+        the_imgui->TableSetupColumn("Buffer", 0, 80.0f, 0);
+        the_imgui->TableSetupColumn("Decode", 0, 110.0f, 0);
+        the_imgui->TableSetupColumn("Underruns", 0, 65.0f, 0);
+        the_imgui->TableSetupColumn("Source", 0, 0, 0);
+        the_imgui->TableHeadersRow();
+
+        for (int i = 0; i < RIZZ_SND_DEVICE_MAX_STREAMS; i++) {
+            snd__stream* stream = &g_snd.streams[i];
+            if (sx_atomic_load32(&stream->state) != SND_STREAMSTATE_PLAYING) {
+                continue;
+            }
+
+            the_imgui->TableNextRow(0, 0);
+            the_imgui->TableNextColumn();
+            the_imgui->Text("%d", i + 1);
+
+            the_imgui->TableNextColumn();
+            float fill = stream->rb.capacity ? (float)stream->rb.size / (float)stream->rb.capacity : 0;
+            the_imgui->ProgressBar(fill, sx_vec2f(-1.0f, 15.0f), NULL);
+
+            // decode time per second of decoded audio
+            the_imgui->TableNextColumn();
+            uint64_t decoded_frames = sx_atomic_load64(&stream->decoded_frames);
+
+            // sources are shared with the mixer thread, copy what we need under the lock
+            int sample_rate = 0;
+            const char* name = "";
+            sx_mutex_enter(&g_snd.lock);
+            if (sx_handle_valid(g_snd.source_handles, stream->srchandle.id)) {
+                const snd__source* src = &g_snd.sources[sx_handle_index(stream->srchandle.id)];
+                sample_rate = src->sample_rate;
+                name = sx_strpool_cstr(g_snd.name_pool, src->name);
+            }
+            sx_mutex_exit(&g_snd.lock);
+
+            if (decoded_frames > 0 && sample_rate > 0) {
+                double decoded_secs = (double)decoded_frames / (double)sample_rate;
+                double decode_ms = sx_tm_ms(sx_atomic_load64(&stream->decode_ticks));
+                the_imgui->Text("%.2fms/sec", decode_ms / decoded_secs);
+            } else {
+                the_imgui->Text("-");
+            }
+
+            the_imgui->TableNextColumn();
+            the_imgui->Text("%d", stream->num_underruns);
+
+            the_imgui->TableNextColumn();
+            the_imgui->Text("%s", name);
+        }
+        the_imgui->EndTable();
+    }
+}
+
 static void snd__show_mixer_tab_contents()
 {
     the_imguix->label("channels", "%d", saudio_channels());
     the_imgui->SliderFloat("master", &g_snd.master_volume, 0.0f, 1.2f, "%.1f", 0);
     the_imgui->SliderFloat("pan", &g_snd.master_pan, -1.0f, 1.0f, "%.1f", 0);
 
+    the_imguix->label("mixer", g_snd.mixer_thrd ? "thread" : "frame update");
+    the_imguix->label("buffer", "%.0f%%", 100.0f * (float)g_snd.mixer_buffer.size /
+                                              (float)g_snd.mixer_buffer.capacity);
+    the_imguix->label("underruns", "%u (%u frames)", sx_atomic_load32(&g_snd.num_underruns),
+                      sx_atomic_load32(&g_snd.num_underrun_frames));
+
+    // mixer cost, normalized to 1000 frames per voice, so it's comparable between frames
+    double mix_ms = sx_tm_ms(g_snd.mix_tm);
+    the_imguix->label("mix", "%.3fms (%d voices, %d frames)", mix_ms, g_snd.mix_voices,
+                      g_snd.mix_frames);
+    if (g_snd.mix_voices > 0 && g_snd.mix_frames > 0) {
+        the_imguix->label("mix/voice", "%.2fus per 1000 frames",
+                          1000000.0 * mix_ms / (double)(g_snd.mix_voices * g_snd.mix_frames));
+    }
+
     // plot samples
     static float plot_scale = 1.0f;
     const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
     
     sx_scope(the_core->tmp_alloc_pop()) {
+        // take a snapshot of buses and playing instances, so the mixer thread is only blocked
+        // for the copy and not while the UI is being rendered
+        snd__debug_bus buses[RIZZ_SND_DEVICE_MAX_BUSES];
+        snd__debug_play* plays = sx_malloc(tmp_alloc, sizeof(snd__debug_play) * RIZZ_SND_DEVICE_MAX_LANES);
+        if (!plays) {
+            sx_out_of_memory();
+            return;
+        }
+
+        sx_mutex_enter(&g_snd.lock);
+        for (int i = 0; i < RIZZ_SND_DEVICE_MAX_BUSES; i++) {
+            const snd__bus* bus = &g_snd.buses[i];
+            buses[i] = (snd__debug_bus){ .max_lanes = bus->max_lanes,
+                                         .num_lanes = bus->num_lanes,
+                                         .volume = bus->volume,
+                                         .lowpass_cutoff = bus->lowpass_cutoff };
+        }
+
+        int num_sounds = g_snd.num_plays;
+        for (int i = 0; i < num_sounds; i++) {
+            rizz_snd_instance insthandle = g_snd.playlist[i];
+            sx_assert_always(sx_handle_valid(g_snd.instance_handles, insthandle.id));
+
+            const snd__instance* inst = &g_snd.instances[sx_handle_index(insthandle.id)];
+            sx_assert_always(sx_handle_valid(g_snd.source_handles, inst->srchandle.id));
+            const snd__source* src = &g_snd.sources[sx_handle_index(inst->srchandle.id)];
+
+            int total_frames = (src->resampled && !inst->stream_id) ? src->num_resampled_frames
+                                                                    : src->num_frames;
+            plays[i] = (snd__debug_play){ .bus_id = inst->bus_id,
+                                          .progress = (float)inst->pos / (float)total_frames,
+                                          .name = src->name };
+        }
+        sx_mutex_exit(&g_snd.lock);
+
+        if (the_imgui->CollapsingHeader_TreeNodeFlags("Buses", 0)) {
+            for (int i = 0; i < RIZZ_SND_DEVICE_MAX_BUSES; i++) {
+                const snd__debug_bus* bus = &buses[i];
+                if (bus->max_lanes == 0) {
+                    continue;
+                }
+
+                char label[32];
+                the_imgui->PushID_Int(i);
+                sx_snprintf(label, sizeof(label), "bus #%d (%d/%d)", i, bus->num_lanes, bus->max_lanes);
+                the_imgui->Text("%s", label);
+                float volume = bus->volume;
+                if (the_imgui->SliderFloat("volume", &volume, 0.0f, 1.2f, "%.1f", 0)) {
+                    snd__bus_set_volume(i, volume);
+                }
+                float cutoff = bus->lowpass_cutoff;
+                if (the_imgui->SliderFloat("lowpass", &cutoff, 0.0f, 20000.0f, cutoff > 0 ? "%.0fHz" : "off", 0)) {
+                    snd__bus_set_lowpass(i, cutoff);
+                }
+                the_imgui->PopID();
+            }
+        }
+
         int num_channels = saudio_channels();
         int num_samples = RIZZ_SND_DEVICE_BUFFER_FRAMES * num_channels;
         float* samples = sx_malloc(tmp_alloc, sizeof(float) * num_samples);
@@ -1246,7 +2166,6 @@ static void snd__show_mixer_tab_contents()
                                   ImGuiTableFlags_Resizable|ImGuiTableFlags_BordersV|ImGuiTableFlags_BordersOuterH|
                                   ImGuiTableFlags_SizingFixedFit|ImGuiTableFlags_RowBg|ImGuiTableFlags_ScrollY,
                                   SX_VEC2_ZERO, 0)) {
-            int num_sounds = g_snd.num_plays;
             the_imgui->GetContentRegionAvail(&region);
             the_imgui->TableSetupColumn("#", 0, 30.0f, 0);
             the_imgui->TableSetupColumn("Bus", 0, 30.0f, 0);
@@ -1262,40 +2181,38 @@ static void snd__show_mixer_tab_contents()
                 for (int i = start; i >= end; i--) {
                     the_imgui->TableNextRow(0, 0);
 
-                    rizz_snd_instance insthandle = g_snd.playlist[i];
-                    sx_assert_always(sx_handle_valid(g_snd.instance_handles, insthandle.id));
-
-                    const snd__instance* inst = &g_snd.instances[sx_handle_index(insthandle.id)];
-                    sx_assert_always(sx_handle_valid(g_snd.source_handles, inst->srchandle.id));
-                    const snd__source* src = &g_snd.sources[sx_handle_index(inst->srchandle.id)];
+                    const snd__debug_play* play = &plays[i];
 
                     the_imgui->TableNextColumn();
                     the_imgui->Text("%d", i + 1);
 
                     the_imgui->TableNextColumn();
-                    the_imgui->Text("%d", inst->bus_id);
+                    the_imgui->Text("%d", play->bus_id);
 
-                    float progress = (float)inst->pos / (float)src->num_frames;
                     the_imgui->TableNextColumn();
-                    the_imgui->ProgressBar(progress, sx_vec2f(-1.0f, 15.0f), NULL);
+                    the_imgui->ProgressBar(play->progress, sx_vec2f(-1.0f, 15.0f), NULL);
 
-                    sx_assert(src->name);
+                    sx_assert(play->name);
                     the_imgui->TableNextColumn();
-                    the_imgui->Text(sx_strpool_cstr(g_snd.name_pool, src->name));
+                    the_imgui->Text("%s", sx_strpool_cstr(g_snd.name_pool, play->name));
                 }
             }
             the_imgui->ImGuiListClipper_End(&clipper);
             the_imgui->EndTable();
         }
+
+        snd__show_streams();
     } // scope
 }
 
 static float snd__source_duration(rizz_snd_source srchandle)
 {
+    sx_mutex_enter(&g_snd.lock);
     sx_assert_always(sx_handle_valid(g_snd.source_handles, srchandle.id));
-
     snd__source* src = &g_snd.sources[sx_handle_index(srchandle.id)];
-    return (float)src->num_frames / (float)src->sample_rate;
+    float duration = (float)src->num_frames / (float)src->sample_rate;
+    sx_mutex_exit(&g_snd.lock);
+    return duration;
 }
 
 static void snd__show_sources_tab_contents()
@@ -1336,15 +2253,20 @@ static void snd__show_sources_tab_contents()
                     selected_source = i;
                 }
 
+                // num_plays is updated by the mixer
+                sx_mutex_enter(&g_snd.lock);
+                int num_plays = src->num_plays;
+                sx_mutex_exit(&g_snd.lock);
+
                 the_imgui->TableSetColumnIndex(1);
-                sx_snprintf(pcount_str, sizeof(pcount_str), "%d", src->num_plays);
+                sx_snprintf(pcount_str, sizeof(pcount_str), "%d", num_plays);
                 the_imgui->ColorButton(pcount_str,
-                                       src->num_plays > 0 ? sx_vec4f(0.0f, 0.8f, 0.1f, 1.0f)
+                                       num_plays > 0 ? sx_vec4f(0.0f, 0.8f, 0.1f, 1.0f)
                                                           : sx_vec4f(0.3f, 0.3f, 0.3f, 1.0f),
                                        0, sx_vec2f(14.0f, 14.0f));
 
                 the_imgui->TableSetColumnIndex(2);
-                the_imgui->Text(sx_strpool_cstr(g_snd.name_pool, src->name));                
+                the_imgui->Text("%s", sx_strpool_cstr(g_snd.name_pool, src->name));
             }
         }
         the_imgui->ImGuiListClipper_End(&clipper);
@@ -1359,7 +2281,9 @@ static void snd__show_sources_tab_contents()
         sx_handle_t handle = sx_handle_at(g_snd.source_handles, selected_source);
         sx_assert_always(sx_handle_valid(g_snd.source_handles, handle));
         const snd__source* src = &g_snd.sources[sx_handle_index(handle)];
-        snd__plot_samples_wav("##source_plot", src->samples, src->num_frames, 70);
+        if (src->samples) {
+            snd__plot_samples_wav("##source_plot", src->samples, src->num_frames, 70);
+        }
 
         const float offset = 100.0f;
         the_imgui->Columns(2, "source_info_cols", true);
@@ -1370,6 +2294,8 @@ static void snd__show_sources_tab_contents()
         the_imguix->label_spacing(offset, 0, "duration", "%.3fs (%.2fms)", duration, duration * 1000.0f);
         the_imguix->label_spacing(offset, 0, "looping", (src->flags & SND_SOURCEFLAG_LOOPING) ? "Yes" : "No");
         the_imguix->label_spacing(offset, 0, "singleton", (src->flags & SND_SOURCEFLAG_SINGLETON) ? "Yes" : "No");
+        the_imguix->label_spacing(offset, 0, "stream", (src->flags & SND_SOURCEFLAG_STREAM) ? "Yes" : "No");
+        the_imguix->label_spacing(offset, 0, "memory", "%.1fkb", (float)src->mem_size / 1024.0f);
 
         the_imgui->NextColumn();
         static int bus_id = 0;
@@ -1409,6 +2335,20 @@ static void snd__show_debugger(bool* p_open)
     the_imgui->End();
 }
 
+static void snd__get_stats(rizz_snd_stats* stats)
+{
+    sx_assert(stats);
+
+    sx_mutex_enter(&g_snd.lock);
+    stats->mix_ticks = g_snd.mix_total_tm;
+    stats->mix_frames = g_snd.mix_total_frames;
+    stats->mix_voice_frames = g_snd.mix_total_voice_frames;
+    sx_mutex_exit(&g_snd.lock);
+    stats->decode_ticks = sx_atomic_load64(&g_snd.decode_total_tm);
+    stats->decoded_frames = (int64_t)sx_atomic_load64(&g_snd.decode_total_frames);
+    stats->sample_rate = saudio_sample_rate();
+}
+
 static float snd__master_volume(void)
 {
     return g_snd.master_volume;
@@ -1416,7 +2356,9 @@ static float snd__master_volume(void)
 
 static void snd__set_master_volume(float vol)
 {
+    sx_mutex_enter(&g_snd.lock);
     g_snd.master_volume = sx_clamp(vol, 0.0f, 1.2f);
+    sx_mutex_exit(&g_snd.lock);
 }
 
 static float snd__master_pan(void)
@@ -1426,13 +2368,16 @@ static float snd__master_pan(void)
 
 static void snd__set_master_pan(float pan)
 {
+    sx_mutex_enter(&g_snd.lock);
     g_snd.master_pan = sx_clamp(pan, -1.0f, 1.0f);
+    sx_mutex_exit(&g_snd.lock);
 }
 
 static void snd__bus_set_max_lanes(int bus, int max_lanes)
 {
     sx_assert(bus >= 0 && bus < RIZZ_SND_DEVICE_MAX_BUSES);
 
+    sx_mutex_enter(&g_snd.lock);
     // count all lanes and check if we have to
     int count = 0;
     for (int i = 0; i < RIZZ_SND_DEVICE_MAX_BUSES; i++) {
@@ -1449,20 +2394,23 @@ static void snd__bus_set_max_lanes(int bus, int max_lanes)
     } else {
         g_snd.buses[bus].max_lanes = max_lanes;
     }
+    sx_mutex_exit(&g_snd.lock);
 }
 
 static float snd__source_volume(rizz_snd_source srchandle)
 {
+    sx_mutex_enter(&g_snd.lock);
     sx_assert_always(sx_handle_valid(g_snd.source_handles, srchandle.id));
-
-    snd__source* src = &g_snd.sources[sx_handle_index(srchandle.id)];
-    return src->volume;
+    float volume = g_snd.sources[sx_handle_index(srchandle.id)].volume;
+    sx_mutex_exit(&g_snd.lock);
+    return volume;
 }
 
 static void snd__source_stop(rizz_snd_source srchandle)
 {
     sx_assert_always(sx_handle_valid(g_snd.source_handles, srchandle.id));
 
+    sx_mutex_enter(&g_snd.lock);
     int c = g_snd.num_plays;
     for (int i = 0; i < c; i++) {
         rizz_snd_instance insthandle = g_snd.playlist[i];
@@ -1476,17 +2424,21 @@ static void snd__source_stop(rizz_snd_source srchandle)
         }
     }
     g_snd.num_plays = c;
+    sx_mutex_exit(&g_snd.lock);
 }
 
 static bool snd__source_looping(rizz_snd_source srchandle)
 {
+    sx_mutex_enter(&g_snd.lock);
     sx_assert_always(sx_handle_valid(g_snd.source_handles, srchandle.id));
-    snd__source* src = &g_snd.sources[sx_handle_index(srchandle.id)];
-    return src->flags & SND_SOURCEFLAG_LOOPING;
+    snd__source_flags flags = g_snd.sources[sx_handle_index(srchandle.id)].flags;
+    sx_mutex_exit(&g_snd.lock);
+    return flags & SND_SOURCEFLAG_LOOPING;
 }
 
 static void snd__source_set_looping(rizz_snd_source srchandle, bool loop)
 {
+    sx_mutex_enter(&g_snd.lock);
     sx_assert_always(sx_handle_valid(g_snd.source_handles, srchandle.id));
     snd__source* src = &g_snd.sources[sx_handle_index(srchandle.id)];
     if (loop) {
@@ -1494,10 +2446,12 @@ static void snd__source_set_looping(rizz_snd_source srchandle, bool loop)
     } else {
         src->flags &= ~SND_SOURCEFLAG_LOOPING;
     }
+    sx_mutex_exit(&g_snd.lock);
 }
 
 static void snd__source_set_singleton(rizz_snd_source srchandle, bool singleton)
 {
+    sx_mutex_enter(&g_snd.lock);
     sx_assert_always(sx_handle_valid(g_snd.source_handles, srchandle.id));
     snd__source* src = &g_snd.sources[sx_handle_index(srchandle.id)];
     if (singleton) {
@@ -1505,13 +2459,16 @@ static void snd__source_set_singleton(rizz_snd_source srchandle, bool singleton)
     } else {
         src->flags &= ~SND_SOURCEFLAG_SINGLETON;
     }
+    sx_mutex_exit(&g_snd.lock);
 }
 
 static void snd__source_set_volume(rizz_snd_source srchandle, float vol)
 {
+    sx_mutex_enter(&g_snd.lock);
     sx_assert_always(sx_handle_valid(g_snd.source_handles, srchandle.id));
     snd__source* src = &g_snd.sources[sx_handle_index(srchandle.id)];
     src->volume = sx_clamp(vol, 0.0f, 1.2f);
+    sx_mutex_exit(&g_snd.lock);
 }
 
 static inline uint8_t* snd__cb_alloc_params_buff(snd__cmdbuffer* cb, int size, int* offset)
@@ -1538,7 +2495,7 @@ typedef struct snd__play_params {
 
 static void snd__cb_play(rizz_snd_source src, int bus, float volume, float pan, bool paused)
 {
-    snd__cmdbuffer* cb = the_core->tls_var("snd_cmdbuffer");
+    snd__cmdbuffer* cb = the_core->tls_slot(g_snd.cmdbuffer_tls);
     sx_assert(cb->cmd_idx < INT_MAX);
 
     int offset = 0;
@@ -1566,7 +2523,7 @@ static uint8_t* snd__cb_run_play(uint8_t* buff)
 static void snd__cb_play_clocked(rizz_snd_source src, float wait_tm, int bus, float volume,
                                  float pan)
 {
-    snd__cmdbuffer* cb = the_core->tls_var("snd_cmdbuffer");
+    snd__cmdbuffer* cb = the_core->tls_slot(g_snd.cmdbuffer_tls);
     sx_assert(cb->cmd_idx < INT_MAX);
 
     int offset = 0;
@@ -1593,7 +2550,7 @@ static uint8_t* snd__cb_run_play_clocked(uint8_t* buff)
 
 static void snd__cb_bus_stop(int bus)
 {
-    snd__cmdbuffer* cb = the_core->tls_var("snd_cmdbuffer");
+    snd__cmdbuffer* cb = the_core->tls_slot(g_snd.cmdbuffer_tls);
     sx_assert(cb->cmd_idx < INT_MAX);
 
     int offset = 0;
@@ -1619,7 +2576,7 @@ static uint8_t* snd__cb_run_bus_stop(uint8_t* buff)
 
 static void snd__cb_set_master_volume(float volume)
 {
-    snd__cmdbuffer* cb = the_core->tls_var("snd_cmdbuffer");
+    snd__cmdbuffer* cb = the_core->tls_slot(g_snd.cmdbuffer_tls);
     sx_assert(cb->cmd_idx < INT_MAX);
 
     int offset = 0;
@@ -1645,7 +2602,7 @@ static uint8_t* snd__cb_run_set_master_volume(uint8_t* buff)
 
 static void snd__cb_set_master_pan(float pan)
 {
-    snd__cmdbuffer* cb = the_core->tls_var("snd_cmdbuffer");
+    snd__cmdbuffer* cb = the_core->tls_slot(g_snd.cmdbuffer_tls);
     sx_assert(cb->cmd_idx < INT_MAX);
 
     int offset = 0;
@@ -1671,7 +2628,7 @@ static uint8_t* snd__cb_run_set_master_pan(uint8_t* buff)
 
 static void snd__cb_source_stop(rizz_snd_source src)
 {
-    snd__cmdbuffer* cb = the_core->tls_var("snd_cmdbuffer");
+    snd__cmdbuffer* cb = the_core->tls_slot(g_snd.cmdbuffer_tls);
     sx_assert(cb->cmd_idx < INT_MAX);
 
     int offset = 0;
@@ -1697,7 +2654,7 @@ static uint8_t* snd__cb_run_source_stop(uint8_t* buff)
 
 static void snd__cb_source_set_volume(rizz_snd_source src, float vol)
 {
-    snd__cmdbuffer* cb = the_core->tls_var("snd_cmdbuffer");
+    snd__cmdbuffer* cb = the_core->tls_slot(g_snd.cmdbuffer_tls);
     sx_assert(cb->cmd_idx < INT_MAX);
 
     int offset = 0;
@@ -1735,11 +2692,100 @@ static const snd__run_command_cb k_snd_run_cbs[_SND_COMMAND_COUNT] = {
     snd__cb_run_source_set_volume
 };
 
+// moves recorded commands of all command-buffers into a batch and sends it to the mixer thread
+static void snd__submit_command_buffers(void)
+{
+    int num_cmds = 0;
+    for (int i = 0, c = g_snd.num_cmdbuffers; i < c; i++) {
+        num_cmds += g_snd.cmd_buffers[i] ? sx_array_count(g_snd.cmd_buffers[i]->cmds) : 0;
+    }
+
+    snd__cmdbatch* batch;
+    if (num_cmds == 0 || !sx_queue_spsc_consume(g_snd.cmd_free_queue, &batch)) {
+        // nothing to submit, or mixer thread is busy with all batches: try again next frame
+        return;
+    }
+
+    for (int i = 0, c = g_snd.num_cmdbuffers; i < c; i++) {
+        snd__cmdbuffer* cb = g_snd.cmd_buffers[i];
+        if (!cb || sx_array_count(cb->cmds) == 0) {
+            continue;
+        }
+
+        int params_size = sx_array_count(cb->params_buff);
+        int base_offset = sx_array_count(batch->params_buff);
+        if (params_size > 0) {
+            uint8_t* params = sx_array_add(g_snd_alloc, batch->params_buff, params_size);
+            sx_memcpy(params, cb->params_buff, params_size);
+        }
+
+        for (int k = 0, kc = sx_array_count(cb->cmds); k < kc; k++) {
+            snd__cmdheader hdr = cb->cmds[k];
+            hdr.params_offset += base_offset;
+            sx_array_push(g_snd_alloc, batch->cmds, hdr);
+        }
+
+        // reset
+        sx_array_clear(cb->params_buff);
+        sx_array_clear(cb->cmds);
+        cb->cmd_idx = 0;
+    }
+
+    sx_queue_spsc_produce(g_snd.cmd_queue, &batch);
+    sx_semaphore_post(&g_snd.mixer_sem, 1);
+}
+
+static void snd__execute_command_batch(snd__cmdbatch* batch)
+{
+    sx_mutex_enter(&g_snd.lock);
+    for (int k = 0, kc = sx_array_count(batch->cmds); k < kc; k++) {
+        const snd__cmdheader* hdr = &batch->cmds[k];
+        k_snd_run_cbs[hdr->cmd](&batch->params_buff[hdr->params_offset]);
+    }
+    sx_mutex_exit(&g_snd.lock);
+
+    sx_array_clear(batch->params_buff);
+    sx_array_clear(batch->cmds);
+}
+
+// mixes whenever the device ring-buffer has room for a chunk, independent of the frame-rate
+static int snd__mixer_thread_fn(void* user)
+{
+    sx_unused(user);
+
+    int device_channels = saudio_channels();
+    int device_sample_rate = saudio_sample_rate();
+    // sleep for about half of a chunk's duration if there is nothing to mix
+    int wait_msecs = sx_max(1, (SND_MIXER_CHUNK_FRAMES * 500) / device_sample_rate);
+
+    while (!g_snd.mixer_quit) {
+        snd__cmdbatch* batch;
+        while (sx_queue_spsc_consume(g_snd.cmd_queue, &batch)) {
+            snd__execute_command_batch(batch);
+            sx_queue_spsc_produce(g_snd.cmd_free_queue, &batch);
+        }
+
+        int frames_remain = snd__ringbuffer_expect(&g_snd.mixer_buffer) / device_channels;
+        if (frames_remain >= SND_MIXER_CHUNK_FRAMES) {
+            snd__mix_into_buffer(frames_remain, device_channels, device_sample_rate);
+        } else {
+            sx_semaphore_wait(&g_snd.mixer_sem, wait_msecs);
+        }
+    }
+
+    return 0;
+}
+
 static void snd__execute_command_buffers()
 {
     static_assert((sizeof(k_snd_run_cbs) / sizeof(snd__run_command_cb)) == _SND_COMMAND_COUNT,
                   "k_snd_run_cbs must match snd__command");
 
+    if (g_snd.mixer_thrd) {
+        snd__submit_command_buffers();
+        return;
+    }
+
     for (int i = 0, c = g_snd.num_cmdbuffers; i < c; i++) {
         snd__cmdbuffer* cb = g_snd.cmd_buffers[i];
         if (!cb) {
@@ -1779,6 +2825,8 @@ static rizz_api_snd the__snd = { .queued = { .play = snd__cb_play,
                                  .stop_all = snd__stop_all,
                                  .resume = snd__resume,
                                  .bus_set_max_lanes = snd__bus_set_max_lanes,
+                                 .bus_set_volume = snd__bus_set_volume,
+                                 .bus_set_lowpass = snd__bus_set_lowpass,
                                  .bus_stop = snd__bus_stop,
                                  .master_volume = snd__master_volume,
                                  .set_master_volume = snd__set_master_volume,
@@ -1792,6 +2840,7 @@ static rizz_api_snd the__snd = { .queued = { .play = snd__cb_play,
                                  .source_set_singleton = snd__source_set_singleton,
                                  .source_set_volume = snd__source_set_volume,
                                  .source_get = snd__source_get,
+                                 .get_stats = snd__get_stats,
                                  .show_debugger = snd__show_debugger };
 
 rizz_plugin_decl_main(sound, plugin, e)
@@ -1807,6 +2856,7 @@ rizz_plugin_decl_main(sound, plugin, e)
     case RIZZ_PLUGIN_EVENT_INIT:
         the_plugin = plugin->api;
         the_core = the_plugin->get_api(RIZZ_API_CORE, 0);
+        the_app = the_plugin->get_api(RIZZ_API_APP, 0);
         the_asset = the_plugin->get_api(RIZZ_API_ASSET, 0);
         the_refl = the_plugin->get_api(RIZZ_API_REFLECT, 0);
         the_imgui = the_plugin->get_api_byname("imgui", 0);
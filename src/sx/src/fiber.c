@@ -108,7 +108,9 @@ typedef enum {
     CORO_RET_END,      // Executation is finished
     CORO_RET_YIELD,    // Pass this 'update' to the next N update which is 'arg' in
                        // sx_fiber_return
-    CORO_RET_WAIT      // Wait for msecs: 'arg' is msecs in sx_fiber_return
+    CORO_RET_WAIT,     // Wait for msecs: 'arg' is msecs in sx_fiber_return
+    CORO_RET_AWAIT,    // Suspended in await_list, until sx_coro_resume
+    CORO_RET_RESUME    // Resumed from await, continues on the next update
 } sx_coro_ret_type;
 
 typedef union {
@@ -126,6 +128,8 @@ typedef struct sx__coro_state {
     sx__coro_state_counter counter;
     struct sx__coro_state* next;
     struct sx__coro_state* prev;
+    uint32_t await_id;      // id of the last handle returned by sx_coro_current, =0 if none
+    bool resume_pending;    // resumed before it's suspended, the next await returns immediately
     bool init;
 } sx__coro_state;
 
@@ -134,8 +138,11 @@ typedef struct sx_coro_context {
     sx_pool* coro_pool;             // sx__coro_state
     sx__coro_state* run_list;
     sx__coro_state* run_list_last;
+    sx__coro_state* await_list;     // suspended coroutines, not visited in updates
+    sx__coro_state* await_list_last;
     sx__coro_state* cur_coro;
     int stack_sz;
+    uint32_t await_id;
 } sx_coro_context;
 
 static inline void sx__coro_add_list(sx__coro_state** pfirst, sx__coro_state** plast,
@@ -233,6 +240,9 @@ void sx__coro_invoke(sx_coro_context* ctx, sx_fiber_cb* callback, void* user)
     fs->fiber = sx_fiber_create(fs->stack_mem, callback);
     fs->callback = callback;
     fs->user = user;
+    fs->ret_state = CORO_RET_NONE;
+    fs->await_id = 0;
+    fs->resume_pending = false;
     // Add to the end of the list
     sx__coro_add_list(&ctx->run_list, &ctx->run_list_last, fs);
 
@@ -266,6 +276,11 @@ void sx_coro_update(sx_coro_context* ctx, float dt)
             }
             break;
         }
+        case CORO_RET_RESUME: {
+            ctx->cur_coro = fs;
+            fs->fiber = sx_fiber_switch(fs->fiber, fs->user).from;
+            break;
+        }
         default:
             sx_assertf(0, "Invalid ret type in update loop");
             break;
@@ -287,6 +302,8 @@ bool sx_coro_replace_callback(sx_coro_context* ctx, sx_fiber_cb* callback,
 
         // just remove the fiber if the new callback is NULL
         if (fs->callback == callback) {
+            fs->await_id = 0;
+            fs->resume_pending = false;
             if (new_callback) {
                 fs->callback = new_callback;
                 fs->fiber = sx_fiber_create(fs->stack_mem, new_callback);
@@ -299,6 +316,29 @@ bool sx_coro_replace_callback(sx_coro_context* ctx, sx_fiber_cb* callback,
         fs = next;
     }
 
+    // suspended coroutines are restarted on the next update, handles that are waiting for them
+    // are invalidated
+    fs = ctx->await_list;
+    while (fs) {
+        sx__coro_state* next = fs->next;
+
+        if (fs->callback == callback) {
+            sx__coro_remove_list(&ctx->await_list, &ctx->await_list_last, fs);
+            fs->await_id = 0;
+            fs->resume_pending = false;
+            if (new_callback) {
+                fs->callback = new_callback;
+                fs->fiber = sx_fiber_create(fs->stack_mem, new_callback);
+                fs->ret_state = CORO_RET_RESUME;
+                sx__coro_add_list(&ctx->run_list, &ctx->run_list_last, fs);
+                r = true;
+            } else {
+                sx_pool_del(ctx->coro_pool, fs);
+            }
+        }
+        fs = next;
+    }
+
     return r;
 }
 
@@ -314,7 +354,12 @@ static inline void sx__coro_return(sx_coro_context* ctx, sx_fiber_t* pfrom, sx_c
     // If fiber is finished, just remove it from the list
     if (type == CORO_RET_END) {
         sx__coro_remove_list(&ctx->run_list, &ctx->run_list_last, fs);
+        fs->await_id = 0;
         sx_pool_del(ctx->coro_pool, fs);
+    } else if (type == CORO_RET_AWAIT) {
+        fs->ret_state = type;
+        sx__coro_remove_list(&ctx->run_list, &ctx->run_list_last, fs);
+        sx__coro_add_list(&ctx->await_list, &ctx->await_list_last, fs);
     } else {
         fs->ret_state = type;
         fs->counter.n = 0;
@@ -342,3 +387,49 @@ void sx__coro_yield(sx_coro_context* ctx, sx_fiber_t* pfrom, int nupdates)
 {
     sx__coro_return(ctx, pfrom, CORO_RET_YIELD, nupdates);
 }
+
+void sx__coro_await(sx_coro_context* ctx, sx_fiber_t* pfrom)
+{
+    sx_assertf(ctx->cur_coro,
+               "You must call this function from within sx_fiber_cb invoked by sx_fiber_invoke");
+    sx__coro_state* fs = ctx->cur_coro;
+    if (fs->resume_pending) {
+        fs->resume_pending = false;
+        return;
+    }
+
+    sx__coro_return(ctx, pfrom, CORO_RET_AWAIT, 0);
+}
+
+sx_coro_handle sx_coro_current(sx_coro_context* ctx)
+{
+    sx_assertf(ctx->cur_coro,
+               "You must call this function from within sx_fiber_cb invoked by sx_fiber_invoke");
+    sx__coro_state* fs = ctx->cur_coro;
+    fs->await_id = ++ctx->await_id ? ctx->await_id : ++ctx->await_id;    // skip zero on wrap
+    fs->resume_pending = false;
+    return (sx_coro_handle){ .state = fs, .id = fs->await_id };
+}
+
+void sx_coro_resume(sx_coro_context* ctx, sx_coro_handle handle)
+{
+    sx__coro_state* fs = handle.state;
+    if (!fs || !handle.id || fs->await_id != handle.id) {
+        return;    // coroutine is ended, restarted or awaits on something else
+    }
+
+    fs->await_id = 0;
+    if (fs->ret_state == CORO_RET_AWAIT && ctx->cur_coro != fs) {
+        sx__coro_remove_list(&ctx->await_list, &ctx->await_list_last, fs);
+        fs->ret_state = CORO_RET_RESUME;
+        sx__coro_add_list(&ctx->run_list, &ctx->run_list_last, fs);
+    } else {
+        fs->resume_pending = true;
+    }
+}
+
+bool sx_coro_valid(sx_coro_context* ctx, sx_coro_handle handle)
+{
+    sx_unused(ctx);
+    return handle.state && handle.id && handle.state->await_id == handle.id;
+}
@@ -4,6 +4,13 @@
 //
 #include "sx/handle.h"
 #include "sx/allocator.h"
+#include "sx/atomic.h"
+#include "sx/lockless.h"
+#include "sx/math-scalar.h"
+
+#if SX_COMPILER_MSVC
+#    include <intrin.h>
+#endif
 
 const uint32_t k__handle_index_mask = (1 << (32 - SX_CONFIG_HANDLE_GEN_BITS)) - 1;
 const uint32_t k__handle_gen_mask = ((1 << SX_CONFIG_HANDLE_GEN_BITS) - 1);
@@ -55,3 +62,273 @@ bool sx_handle_grow_pool(sx_handle_pool** ppool, const sx_alloc* alloc)
     *ppool = new_pool;
     return true;
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// sx_handle_pool_mt
+// slots are referenced by (index + 1) in the free-list, so 0 means null. the free-list head keeps a
+// tag in the upper 32 bits, so a pop that raced with another pop+push (ABA) fails the CAS.
+// chunk N holds (capacity << N) slots, followed by the item data of those slots
+#define SX__HANDLE_MT_MAX_CHUNKS 32
+
+typedef struct sx__handle_mt_slot {
+    sx_atomic_uint32 handle;       // alive handle, 0 if the slot is free
+    sx_atomic_uint32 next_free;    // next slot in the free-list
+    uint32_t gen;                  // last generation, only accessed by the thread that owns the slot
+    uint32_t _reserved;
+} sx__handle_mt_slot;
+
+typedef struct sx_handle_pool_mt {
+    const sx_alloc* alloc;
+    int item_sz;
+    int chunk_shift;    // log2(capacity) of the first chunk
+    sx_atomic_ptr chunks[SX__HANDLE_MT_MAX_CHUNKS];
+    sx_atomic_uint32 num_slots;
+    int num_chunks;     // protected by grow_lock
+    sx_lock_t grow_lock;
+
+    sx_align_decl(SX_CACHE_LINE_SIZE, sx_atomic_uint64) free_list;    // (tag << 32) | (index + 1)
+    sx_align_decl(SX_CACHE_LINE_SIZE, sx_atomic_uint32) count;
+} sx_handle_pool_mt;
+
+static inline int sx__handle_mt_log2(uint32_t n)
+{
+    sx_assert(n);
+#if SX_COMPILER_MSVC
+    unsigned long index;
+    _BitScanReverse(&index, n);
+    return (int)index;
+#else
+    return 31 - __builtin_clz(n);
+#endif
+}
+
+// last chunk is cut, so the number of slots doesn't exceed max handle index
+static inline int sx__handle_mt_chunk_size(const sx_handle_pool_mt* pool, int chunk)
+{
+    int first = ((1 << chunk) - 1) << pool->chunk_shift;
+    return sx_min(1 << (pool->chunk_shift + chunk), (int)k__handle_index_mask + 1 - first);
+}
+
+static inline uint8_t* sx__handle_mt_chunk(const sx_handle_pool_mt* pool, int index, int* chunk,
+                                           int* offset)
+{
+    int c = sx__handle_mt_log2(((uint32_t)index >> pool->chunk_shift) + 1);
+    *offset = index - ((((int)1 << c) - 1) << pool->chunk_shift);
+    *chunk = c;
+    sx_handle_pool_mt* _pool = (sx_handle_pool_mt*)pool;
+    return (uint8_t*)sx_atomic_loadptr_explicit(&_pool->chunks[c], SX_ATOMIC_MEMORYORDER_ACQUIRE);
+}
+
+static inline sx__handle_mt_slot* sx__handle_mt_slot_get(const sx_handle_pool_mt* pool, int index)
+{
+    int chunk, offset;
+    uint8_t* buff = sx__handle_mt_chunk(pool, index, &chunk, &offset);
+    sx_assert(buff);
+    return (sx__handle_mt_slot*)buff + offset;
+}
+
+// pushes a chain of slots (first -> ... -> last, linked by next_free) to the free-list
+static void sx__handle_mt_push_free(sx_handle_pool_mt* pool, int first, int last)
+{
+    sx__handle_mt_slot* last_slot = sx__handle_mt_slot_get(pool, last);
+    unsigned long long top = sx_atomic_load64_explicit(&pool->free_list, SX_ATOMIC_MEMORYORDER_RELAXED);
+    uint64_t new_top;
+    do {
+        sx_atomic_store32_explicit(&last_slot->next_free, (uint32_t)top, SX_ATOMIC_MEMORYORDER_RELAXED);
+        new_top = (((top >> 32) + 1) << 32) | (uint32_t)(first + 1);
+    } while (!sx_atomic_compare_exchange64_weak_explicit(&pool->free_list, &top, new_top,
+                                                         SX_ATOMIC_MEMORYORDER_RELEASE,
+                                                         SX_ATOMIC_MEMORYORDER_RELAXED));
+}
+
+static int sx__handle_mt_pop_free(sx_handle_pool_mt* pool)
+{
+    unsigned long long top = sx_atomic_load64_explicit(&pool->free_list, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+    for (;;) {
+        uint32_t id = (uint32_t)top;
+        if (id == 0) {
+            return -1;
+        }
+
+        // next_free can be stale if another thread popped the slot meanwhile, but then the tag
+        // has also changed and the CAS fails
+        sx__handle_mt_slot* slot = sx__handle_mt_slot_get(pool, (int)id - 1);
+        uint32_t next = sx_atomic_load32_explicit(&slot->next_free, SX_ATOMIC_MEMORYORDER_RELAXED);
+        uint64_t new_top = (((top >> 32) + 1) << 32) | next;
+        if (sx_atomic_compare_exchange64_weak_explicit(&pool->free_list, &top, new_top,
+                                                       SX_ATOMIC_MEMORYORDER_ACQUIRE,
+                                                       SX_ATOMIC_MEMORYORDER_ACQUIRE)) {
+            return (int)id - 1;
+        }
+    }
+}
+
+// allocates the next chunk and returns the first slot of it, the rest go to the free-list
+static int sx__handle_mt_grow(sx_handle_pool_mt* pool)
+{
+    int index;
+    sx_lock_enter(&pool->grow_lock);
+
+    // another thread may have already grown the pool while we were waiting for the lock
+    index = sx__handle_mt_pop_free(pool);
+    int chunk = pool->num_chunks;
+    int first = ((1 << chunk) - 1) << pool->chunk_shift;
+    if (index == -1 && chunk < SX__HANDLE_MT_MAX_CHUNKS && first <= (int)k__handle_index_mask) {
+        int count = sx__handle_mt_chunk_size(pool, chunk);
+        size_t data_offset = sx_align_mask(sizeof(sx__handle_mt_slot) * count, 15);
+        uint8_t* buff = (uint8_t*)sx_malloc(pool->alloc, data_offset + (size_t)pool->item_sz * count);
+        if (buff) {
+            sx__handle_mt_slot* slots = (sx__handle_mt_slot*)buff;
+            for (int i = 0; i < count; i++) {
+                sx_atomic_store32_explicit(&slots[i].handle, 0, SX_ATOMIC_MEMORYORDER_RELAXED);
+                sx_atomic_store32_explicit(&slots[i].next_free,
+                                           (i + 1) < count ? (uint32_t)(first + i + 2) : 0,
+                                           SX_ATOMIC_MEMORYORDER_RELAXED);
+                slots[i].gen = 0;
+            }
+
+            sx_atomic_storeptr_explicit(&pool->chunks[chunk], (uintptr_t)buff,
+                                        SX_ATOMIC_MEMORYORDER_RELEASE);
+            sx_atomic_fetch_add32(&pool->num_slots, (uint32_t)count);
+            ++pool->num_chunks;
+
+            index = first;
+            if (count > 1) {
+                sx__handle_mt_push_free(pool, first + 1, first + count - 1);
+            }
+        } else {
+            sx_out_of_memory();
+        }
+    }
+
+    sx_lock_exit(&pool->grow_lock);
+    return index;
+}
+
+sx_handle_pool_mt* sx_handle_create_pool_mt(const sx_alloc* alloc, int capacity, int item_sz)
+{
+    sx_assert(capacity > 0);
+    sx_assert(item_sz >= 0);
+
+    capacity = sx_clamp(sx_nearest_pow2(capacity), 16, (int)k__handle_index_mask + 1);
+    sx_handle_pool_mt* pool = (sx_handle_pool_mt*)sx_aligned_malloc(alloc, sizeof(sx_handle_pool_mt),
+                                                                    SX_CACHE_LINE_SIZE);
+    if (!pool) {
+        sx_out_of_memory();
+        return NULL;
+    }
+    sx_memset(pool, 0x0, sizeof(sx_handle_pool_mt));
+
+    pool->alloc = alloc;
+    pool->item_sz = sx_align_mask(item_sz, 7);
+    pool->chunk_shift = sx__handle_mt_log2((uint32_t)capacity);
+
+    // first chunk is allocated here, so readers always have something to look at
+    int index = sx__handle_mt_grow(pool);
+    if (index == -1) {
+        sx_aligned_free(alloc, pool, SX_CACHE_LINE_SIZE);
+        return NULL;
+    }
+    sx__handle_mt_push_free(pool, index, index);
+
+    return pool;
+}
+
+void sx_handle_destroy_pool_mt(sx_handle_pool_mt* pool, const sx_alloc* alloc)
+{
+    if (pool) {
+        sx_assert(alloc == pool->alloc);
+        for (int i = 0; i < pool->num_chunks; i++) {
+            sx_free(alloc, (void*)(uintptr_t)pool->chunks[i]);
+        }
+        sx_aligned_free(alloc, pool, SX_CACHE_LINE_SIZE);
+    }
+}
+
+sx_handle_t sx_handle_new_mt(sx_handle_pool_mt* pool)
+{
+    int index = sx__handle_mt_pop_free(pool);
+    if (index == -1) {
+        index = sx__handle_mt_grow(pool);
+        if (index == -1) {
+            sx_assertf(0, "handle pool is full");
+            return SX_INVALID_HANDLE;
+        }
+    }
+
+    sx__handle_mt_slot* slot = sx__handle_mt_slot_get(pool, index);
+    uint32_t gen = (slot->gen + 1) & k__handle_gen_mask;
+    if (gen == 0) {
+        gen = 1;    // handle of the first slot would become zero (invalid)
+    }
+    slot->gen = gen;
+
+    sx_handle_t handle = sx__handle_make(gen, index);
+    sx_atomic_store32_explicit(&slot->handle, handle, SX_ATOMIC_MEMORYORDER_RELEASE);
+    sx_atomic_fetch_add32_explicit(&pool->count, 1, SX_ATOMIC_MEMORYORDER_RELAXED);
+    return handle;
+}
+
+void sx_handle_del_mt(sx_handle_pool_mt* pool, sx_handle_t handle)
+{
+    sx_assert(handle);
+    int index = sx_handle_index(handle);
+    sx_assert((uint32_t)index < sx_atomic_load32(&pool->num_slots));
+
+    // only one of the threads that delete the same handle wins and puts the slot back
+    sx__handle_mt_slot* slot = sx__handle_mt_slot_get(pool, index);
+    uint32_t expected = handle;
+    if (!sx_atomic_compare_exchange32_strong_explicit(&slot->handle, &expected, 0,
+                                                      SX_ATOMIC_MEMORYORDER_ACQREL,
+                                                      SX_ATOMIC_MEMORYORDER_RELAXED)) {
+        sx_assertf(0, "handle is not valid");
+        return;
+    }
+
+    sx_atomic_fetch_sub32_explicit(&pool->count, 1, SX_ATOMIC_MEMORYORDER_RELAXED);
+    sx__handle_mt_push_free(pool, index, index);
+}
+
+bool sx_handle_valid_mt(const sx_handle_pool_mt* pool, sx_handle_t handle)
+{
+    sx_assert(handle);
+    sx_handle_pool_mt* _pool = (sx_handle_pool_mt*)pool;
+    int index = sx_handle_index(handle);
+    if ((uint32_t)index >= sx_atomic_load32(&_pool->num_slots)) {
+        return false;
+    }
+
+    sx__handle_mt_slot* slot = sx__handle_mt_slot_get(pool, index);
+    return sx_atomic_load32_explicit(&slot->handle, SX_ATOMIC_MEMORYORDER_ACQUIRE) == handle;
+}
+
+void* sx_handle_data_mt(const sx_handle_pool_mt* pool, sx_handle_t handle)
+{
+    sx_assert(pool->item_sz > 0);
+    sx_assert(sx_handle_valid_mt(pool, handle));
+
+    int chunk, offset;
+    uint8_t* buff = sx__handle_mt_chunk(pool, sx_handle_index(handle), &chunk, &offset);
+    int count = sx__handle_mt_chunk_size(pool, chunk);
+    size_t data_offset = sx_align_mask(sizeof(sx__handle_mt_slot) * count, 15);
+    return buff + data_offset + (size_t)pool->item_sz * offset;
+}
+
+int sx_handle_count_mt(const sx_handle_pool_mt* pool)
+{
+    sx_handle_pool_mt* _pool = (sx_handle_pool_mt*)pool;
+    return (int)sx_atomic_load32_explicit(&_pool->count, SX_ATOMIC_MEMORYORDER_RELAXED);
+}
+
+int sx_handle_capacity_mt(const sx_handle_pool_mt* pool)
+{
+    sx_handle_pool_mt* _pool = (sx_handle_pool_mt*)pool;
+    return (int)sx_atomic_load32(&_pool->num_slots);
+}
+
+sx_handle_t sx_handle_at_mt(const sx_handle_pool_mt* pool, int index)
+{
+    sx_assert(index >= 0 && index < sx_handle_capacity_mt(pool));
+    sx__handle_mt_slot* slot = sx__handle_mt_slot_get(pool, index);
+    return sx_atomic_load32_explicit(&slot->handle, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+}
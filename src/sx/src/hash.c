@@ -5,6 +5,11 @@
 #include "sx/hash.h"
 #include "sx/allocator.h"
 #include "sx/math-scalar.h"
+#include "sx/simd.h"
+
+#if SX_COMPILER_MSVC
+#    include <intrin.h>
+#endif
 
 static inline SX_ALLOW_UNUSED SX_CONSTFN bool sx__ispow2(int n)
 {
@@ -461,4 +466,227 @@ void sx_hashtbltval_clear(sx_hashtbl_tval* tbl)
 {
     sx_memset(tbl->keys, 0x0, sizeof(uint32_t) * tbl->capacity);
     tbl->count = 0;
-}
\ No newline at end of file
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// sx_hashmap
+// control bytes of a slot: high bit set means the slot is free (empty or deleted), otherwise the
+// lower 7 bits are 'h2' of the key's hash. upper bits of the hash ('h1') selects the first group.
+// probing jumps over aligned groups with triangular steps, which visits every group exactly once
+// when number of groups is power of 2
+#define SX__HASHMAP_EMPTY 0x80
+#define SX__HASHMAP_DELETED 0xfe
+
+static inline int sx__hashmap_ctz(uint32_t n)
+{
+    sx_assert(n);
+#if SX_COMPILER_MSVC
+    unsigned long index;
+    _BitScanForward(&index, n);
+    return (int)index;
+#else
+    return __builtin_ctz(n);
+#endif
+}
+
+// returns 16bit mask of the slots in the group that their control byte is equal to 'c'
+#if SX_SIMD_SSE
+static inline uint32_t sx__hashmap_match(const uint8_t* group, uint8_t c)
+{
+    __m128i ctrl = _mm_load_si128((const __m128i*)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)c)));
+}
+
+static inline uint32_t sx__hashmap_match_free(const uint8_t* group)
+{
+    return (uint32_t)_mm_movemask_epi8(_mm_load_si128((const __m128i*)group));
+}
+#elif SX_SIMD_NEON && SX_ARCH_64BIT
+static inline uint32_t sx__hashmap_movemask(uint8x16_t m)
+{
+    static const uint8_t k_bits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    uint8x16_t bits = vandq_u8(m, vld1q_u8(k_bits));
+    return (uint32_t)vaddv_u8(vget_low_u8(bits)) | ((uint32_t)vaddv_u8(vget_high_u8(bits)) << 8);
+}
+
+static inline uint32_t sx__hashmap_match(const uint8_t* group, uint8_t c)
+{
+    return sx__hashmap_movemask(vceqq_u8(vld1q_u8(group), vdupq_n_u8(c)));
+}
+
+static inline uint32_t sx__hashmap_match_free(const uint8_t* group)
+{
+    return sx__hashmap_movemask(vtstq_u8(vld1q_u8(group), vdupq_n_u8(0x80)));
+}
+#else
+static inline uint32_t sx__hashmap_match(const uint8_t* group, uint8_t c)
+{
+    uint32_t mask = 0;
+    for (int i = 0; i < SX_HASHMAP_GROUP_SIZE; i++) {
+        mask |= (uint32_t)(group[i] == c) << i;
+    }
+    return mask;
+}
+
+static inline uint32_t sx__hashmap_match_free(const uint8_t* group)
+{
+    uint32_t mask = 0;
+    for (int i = 0; i < SX_HASHMAP_GROUP_SIZE; i++) {
+        mask |= (uint32_t)(group[i] >> 7) << i;
+    }
+    return mask;
+}
+#endif
+
+sx_hashmap* sx_hashmap_create(const sx_alloc* alloc, int capacity)
+{
+    sx_assert(capacity > 0);
+
+    capacity = sx_max(sx_nearest_pow2(capacity), SX_HASHMAP_GROUP_SIZE);
+    sx_hashmap* tbl = (sx_hashmap*)sx_malloc(
+        alloc, sizeof(sx_hashmap) + capacity * (sizeof(uint8_t) + sizeof(uint64_t) + sizeof(int)) +
+                   SX_HASHMAP_GROUP_SIZE);
+    if (!tbl) {
+        sx_out_of_memory();
+        return NULL;
+    }
+
+    // capacity is a multiple of group size, so keys are also aligned after control bytes
+    tbl->ctrls = (uint8_t*)sx_align_ptr(tbl + 1, 0, SX_HASHMAP_GROUP_SIZE);
+    tbl->keys = (uint64_t*)(tbl->ctrls + capacity);
+    tbl->values = (int*)(tbl->keys + capacity);
+    tbl->_bitshift = sx__calc_bitshift(capacity);
+    tbl->count = 0;
+    tbl->num_deleted = 0;
+    tbl->capacity = capacity;
+
+    sx_memset(tbl->ctrls, SX__HASHMAP_EMPTY, capacity);
+
+    return tbl;
+}
+
+void sx_hashmap_destroy(sx_hashmap* tbl, const sx_alloc* alloc)
+{
+    if (tbl) {
+        tbl->count = tbl->capacity = 0;
+        sx_free(alloc, tbl);
+    }
+}
+
+bool sx_hashmap_grow(sx_hashmap** ptbl, const sx_alloc* alloc)
+{
+    sx_hashmap* tbl = *ptbl;
+    // if most of the used slots are tombstones, rehashing with the same size is enough to clean them
+    int capacity = tbl->num_deleted >= tbl->count ? tbl->capacity : (tbl->capacity << 1);
+    sx_hashmap* new_tbl = sx_hashmap_create(alloc, capacity);
+    if (!new_tbl)
+        return false;
+
+    for (int i = 0, c = tbl->capacity; i < c; i++) {
+        if ((tbl->ctrls[i] & 0x80) == 0)
+            sx_hashmap_add(new_tbl, tbl->keys[i], tbl->values[i]);
+    }
+
+    sx_hashmap_destroy(tbl, alloc);
+    *ptbl = new_tbl;
+    return true;
+}
+
+int sx_hashmap_add(sx_hashmap* tbl, uint64_t key, int value)
+{
+    uint64_t h = key * 11400714819323198485llu;
+    uint8_t h2 = (uint8_t)((h >> (tbl->_bitshift - 7)) & 0x7f);
+    uint32_t mask = (uint32_t)tbl->capacity - 1;
+    uint32_t pos = (uint32_t)(h >> tbl->_bitshift) & ~(uint32_t)(SX_HASHMAP_GROUP_SIZE - 1);
+    int num_groups = tbl->capacity / SX_HASHMAP_GROUP_SIZE;
+    int insert_idx = -1;
+
+    for (int g = 0; g < num_groups; g++) {
+        const uint8_t* group = tbl->ctrls + pos;
+        uint32_t m = sx__hashmap_match(group, h2);
+        while (m) {
+            int idx = (int)pos + sx__hashmap_ctz(m);
+            if (tbl->keys[idx] == key) {
+                tbl->values[idx] = value;
+                return idx;
+            }
+            m &= m - 1;
+        }
+
+        // remember the first free slot, but keep probing until an empty slot to rule out duplicates
+        if (insert_idx == -1) {
+            uint32_t free_mask = sx__hashmap_match_free(group);
+            if (free_mask)
+                insert_idx = (int)pos + sx__hashmap_ctz(free_mask);
+        }
+
+        if (sx__hashmap_match(group, SX__HASHMAP_EMPTY))
+            break;
+
+        pos = (pos + (uint32_t)(g + 1) * SX_HASHMAP_GROUP_SIZE) & mask;
+    }
+
+    sx_assertf(insert_idx != -1, "hashmap is full");
+    if (insert_idx == -1)
+        return -1;
+
+    if (tbl->ctrls[insert_idx] == SX__HASHMAP_DELETED)
+        --tbl->num_deleted;
+    tbl->ctrls[insert_idx] = h2;
+    tbl->keys[insert_idx] = key;
+    tbl->values[insert_idx] = value;
+    ++tbl->count;
+    return insert_idx;
+}
+
+int sx_hashmap_find(const sx_hashmap* tbl, uint64_t key)
+{
+    uint64_t h = key * 11400714819323198485llu;
+    uint8_t h2 = (uint8_t)((h >> (tbl->_bitshift - 7)) & 0x7f);
+    uint32_t mask = (uint32_t)tbl->capacity - 1;
+    uint32_t pos = (uint32_t)(h >> tbl->_bitshift) & ~(uint32_t)(SX_HASHMAP_GROUP_SIZE - 1);
+    int num_groups = tbl->capacity / SX_HASHMAP_GROUP_SIZE;
+
+    for (int g = 0; g < num_groups; g++) {
+        const uint8_t* group = tbl->ctrls + pos;
+        uint32_t m = sx__hashmap_match(group, h2);
+        while (m) {
+            int idx = (int)pos + sx__hashmap_ctz(m);
+            if (tbl->keys[idx] == key)
+                return idx;
+            m &= m - 1;
+        }
+
+        // key would have been inserted into this group, if there was an empty slot
+        if (sx__hashmap_match(group, SX__HASHMAP_EMPTY))
+            return -1;
+
+        pos = (pos + (uint32_t)(g + 1) * SX_HASHMAP_GROUP_SIZE) & mask;
+    }
+
+    return -1;
+}
+
+void sx_hashmap_remove(sx_hashmap* tbl, int index)
+{
+    sx_assert(index >= 0 && index < tbl->capacity);
+    sx_assert((tbl->ctrls[index] & 0x80) == 0);
+
+    // if the group still has an empty slot, no probe has ever passed through it, so the slot can
+    // become empty again. otherwise, a tombstone is needed to keep the probe chains intact
+    const uint8_t* group = tbl->ctrls + (index & ~(SX_HASHMAP_GROUP_SIZE - 1));
+    if (sx__hashmap_match(group, SX__HASHMAP_EMPTY)) {
+        tbl->ctrls[index] = SX__HASHMAP_EMPTY;
+    } else {
+        tbl->ctrls[index] = SX__HASHMAP_DELETED;
+        ++tbl->num_deleted;
+    }
+    --tbl->count;
+}
+
+void sx_hashmap_clear(sx_hashmap* tbl)
+{
+    sx_memset(tbl->ctrls, SX__HASHMAP_EMPTY, tbl->capacity);
+    tbl->count = 0;
+    tbl->num_deleted = 0;
+}
@@ -81,6 +81,7 @@ typedef struct sx_job_context {
     int quit;
     sx_job_thread_init_cb* thread_init_cb;
     sx_job_thread_shutdown_cb* thread_shutdown_cb;
+    sx_job_done_cb* job_done_cb;
     void* thread_user;
     sx__job_pending* pending;
 } sx_job_context;
@@ -92,6 +93,16 @@ static void sx__del_job(sx_job_context* ctx, sx__job* job)
     }
 }
 
+// decrements the job counter and deletes the finished sub-job
+static void sx__job_finish(sx_job_context* ctx, sx__job* job)
+{
+    sx_job_t counter = job->counter;
+    if (sx_atomic_fetch_sub32(counter, 1) == 1 && ctx->job_done_cb) {
+        ctx->job_done_cb(ctx, counter, ctx->thread_user);
+    }
+    sx__del_job(ctx, job);
+}
+
 static void fiber_fn(sx_fiber_transfer transfer)
 {
     sx__job* job = (sx__job*)transfer.user;
@@ -227,8 +238,7 @@ static void sx__job_selector_main_thrd(sx_fiber_transfer transfer)
         // Delete the job and decrement job counter if it's done
         if (r.job->done) {
             tdata->cur_job = NULL;
-            sx_atomic_fetch_sub32(r.job->counter, 1);
-            sx__del_job(ctx, r.job);
+            sx__job_finish(ctx, r.job);
         }
     }
 
@@ -267,8 +277,7 @@ static void sx__job_selector_fn(sx_fiber_transfer transfer)
             // Delete the job and decrement job counter if it's done
             if (r.job->done) {
                 tdata->cur_job = NULL;
-                sx_atomic_fetch_sub32(r.job->counter, 1);
-                sx__del_job(ctx, r.job);
+                sx__job_finish(ctx, r.job);
             }
         } else if (r.waiting_list_alive) {
             // If we have a pending job, continue this loop one more time
@@ -571,6 +580,7 @@ sx_job_context* sx_job_create_context(const sx_alloc* alloc, const sx_job_contex
     ctx->stack_sz = desc->fiber_stack_sz > 0 ? desc->fiber_stack_sz : DEFAULT_FIBER_STACK_SIZE;
     ctx->thread_init_cb = desc->thread_init_cb;
     ctx->thread_shutdown_cb = desc->thread_shutdown_cb;
+    ctx->job_done_cb = desc->job_done_cb;
     ctx->thread_user = desc->thread_user_data;
     int max_fibers = desc->max_fibers > 0 ? desc->max_fibers : DEFAULT_MAX_FIBERS;
 
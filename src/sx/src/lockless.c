@@ -1,6 +1,11 @@
 #include "sx/lockless.h"
 #include "sx/atomic.h"
 #include "sx/allocator.h"
+#include "sx/math-scalar.h"
+
+#if SX_COMPILER_MSVC
+#    include <intrin.h>
+#endif
 
 // single producer/single consumer - self contained queue
 // Reference:
@@ -224,3 +229,318 @@ bool sx_queue_spsc_full(const sx_queue_spsc* queue)
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// multi-producer/multi-consumer bounded queue
+// Reference:
+// https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+// every cell has a sequence number that tells producers and consumers if it's their turn
+typedef struct sx__queue_mpmc_cell {
+    sx_atomic_uint32 seq;
+    uint32_t _reserved;
+} sx__queue_mpmc_cell;
+
+typedef struct sx_queue_mpmc {
+    uint8_t* cells;
+    int item_sz;
+    int stride;
+    uint32_t mask;
+
+    // producers and consumers are on separate cache-lines, so they don't invalidate each other
+    sx_align_decl(SX_CACHE_LINE_SIZE, sx_atomic_uint32) enqueue_pos;
+    sx_align_decl(SX_CACHE_LINE_SIZE, sx_atomic_uint32) dequeue_pos;
+} sx_queue_mpmc;
+
+sx_queue_mpmc* sx_queue_mpmc_create(const sx_alloc* alloc, int item_sz, int capacity)
+{
+    sx_assert(item_sz > 0);
+    sx_assert(capacity > 1);
+
+    capacity = sx_nearest_pow2(capacity);
+    int stride = (int)sizeof(sx__queue_mpmc_cell) + sx_align_mask(item_sz, 7);
+    sx_queue_mpmc* queue = (sx_queue_mpmc*)sx_aligned_malloc(
+        alloc, sizeof(sx_queue_mpmc) + stride * capacity, SX_CACHE_LINE_SIZE);
+    if (!queue) {
+        sx_out_of_memory();
+        return NULL;
+    }
+    sx_memset(queue, 0x0, sizeof(sx_queue_mpmc));
+
+    queue->cells = (uint8_t*)(queue + 1);
+    queue->item_sz = item_sz;
+    queue->stride = stride;
+    queue->mask = (uint32_t)capacity - 1;
+
+    for (int i = 0; i < capacity; i++) {
+        sx__queue_mpmc_cell* cell = (sx__queue_mpmc_cell*)(queue->cells + stride * i);
+        sx_atomic_store32_explicit(&cell->seq, (uint32_t)i, SX_ATOMIC_MEMORYORDER_RELAXED);
+    }
+
+    return queue;
+}
+
+void sx_queue_mpmc_destroy(sx_queue_mpmc* queue, const sx_alloc* alloc)
+{
+    if (queue) {
+        sx_aligned_free(alloc, queue, SX_CACHE_LINE_SIZE);
+    }
+}
+
+bool sx_queue_mpmc_produce(sx_queue_mpmc* queue, const void* data)
+{
+    sx__queue_mpmc_cell* cell;
+    uint32_t pos = sx_atomic_load32_explicit(&queue->enqueue_pos, SX_ATOMIC_MEMORYORDER_RELAXED);
+    for (;;) {
+        cell = (sx__queue_mpmc_cell*)(queue->cells + queue->stride * (pos & queue->mask));
+        uint32_t seq = sx_atomic_load32_explicit(&cell->seq, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            if (sx_atomic_compare_exchange32_weak_explicit(&queue->enqueue_pos, &pos, pos + 1,
+                                                           SX_ATOMIC_MEMORYORDER_RELAXED,
+                                                           SX_ATOMIC_MEMORYORDER_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;    // full: the cell is not consumed yet from the previous round
+        } else {
+            pos = sx_atomic_load32_explicit(&queue->enqueue_pos, SX_ATOMIC_MEMORYORDER_RELAXED);
+        }
+    }
+
+    sx_memcpy(cell + 1, data, queue->item_sz);
+    sx_atomic_store32_explicit(&cell->seq, pos + 1, SX_ATOMIC_MEMORYORDER_RELEASE);
+    return true;
+}
+
+bool sx_queue_mpmc_consume(sx_queue_mpmc* queue, void* data)
+{
+    sx__queue_mpmc_cell* cell;
+    uint32_t pos = sx_atomic_load32_explicit(&queue->dequeue_pos, SX_ATOMIC_MEMORYORDER_RELAXED);
+    for (;;) {
+        cell = (sx__queue_mpmc_cell*)(queue->cells + queue->stride * (pos & queue->mask));
+        uint32_t seq = sx_atomic_load32_explicit(&cell->seq, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+        int32_t diff = (int32_t)(seq - (pos + 1));
+        if (diff == 0) {
+            if (sx_atomic_compare_exchange32_weak_explicit(&queue->dequeue_pos, &pos, pos + 1,
+                                                           SX_ATOMIC_MEMORYORDER_RELAXED,
+                                                           SX_ATOMIC_MEMORYORDER_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;    // empty
+        } else {
+            pos = sx_atomic_load32_explicit(&queue->dequeue_pos, SX_ATOMIC_MEMORYORDER_RELAXED);
+        }
+    }
+
+    sx_memcpy(data, cell + 1, queue->item_sz);
+    sx_atomic_store32_explicit(&cell->seq, pos + queue->mask + 1, SX_ATOMIC_MEMORYORDER_RELEASE);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// multi-producer/single-consumer unbounded queue
+// Reference:
+// https://www.1024cores.net/home/lock-free-algorithms/queues/non-intrusive-mpsc-node-based-queue
+// nodes are referenced by 1-based ids (0 is null) and live in chunks that never move or get freed
+// until the queue is destroyed. chunk N holds (capacity << N) nodes.
+// consumed nodes go back to a free-list, which producers pop from. the free-list head keeps a tag
+// in the upper 32 bits, so a pop that raced with another pop+push (ABA) fails the CAS
+#define SX__QUEUE_MPSC_MAX_CHUNKS 24
+
+typedef struct sx__queue_mpsc_node {
+    sx_atomic_uint32 next;         // next node in the queue
+    sx_atomic_uint32 next_free;    // next node in the free-list
+} sx__queue_mpsc_node;
+
+typedef struct sx_queue_mpsc {
+    const sx_alloc* alloc;
+    int item_sz;
+    int stride;
+    int chunk_shift;    // log2(capacity) of the first chunk
+    sx_atomic_ptr chunks[SX__QUEUE_MPSC_MAX_CHUNKS];
+    int num_chunks;     // protected by grow_lock
+    sx_lock_t grow_lock;
+
+    sx_align_decl(SX_CACHE_LINE_SIZE, sx_atomic_uint64) free_list;    // (tag << 32) | id
+    sx_align_decl(SX_CACHE_LINE_SIZE, sx_atomic_uint32) head;         // last produced node
+    sx_align_decl(SX_CACHE_LINE_SIZE, uint32_t) tail;                 // consumer's stub node
+} sx_queue_mpsc;
+
+static inline int sx__queue_mpsc_log2(uint32_t n)
+{
+    sx_assert(n);
+#if SX_COMPILER_MSVC
+    unsigned long index;
+    _BitScanReverse(&index, n);
+    return (int)index;
+#else
+    return 31 - __builtin_clz(n);
+#endif
+}
+
+static inline sx__queue_mpsc_node* sx__queue_mpsc_node_get(sx_queue_mpsc* queue, uint32_t id)
+{
+    sx_assert(id > 0);
+    uint32_t index = id - 1;
+    int chunk = sx__queue_mpsc_log2((index >> queue->chunk_shift) + 1);
+    uint32_t offset = index - ((((uint32_t)1 << chunk) - 1) << queue->chunk_shift);
+    uint8_t* buff = (uint8_t*)sx_atomic_loadptr_explicit(&queue->chunks[chunk],
+                                                         SX_ATOMIC_MEMORYORDER_ACQUIRE);
+    sx_assert(buff);
+    return (sx__queue_mpsc_node*)(buff + (size_t)queue->stride * offset);
+}
+
+// pushes a chain of nodes (first -> ... -> last, linked by next_free) to the free-list
+static void sx__queue_mpsc_push_free(sx_queue_mpsc* queue, uint32_t first, uint32_t last)
+{
+    sx__queue_mpsc_node* last_node = sx__queue_mpsc_node_get(queue, last);
+    unsigned long long top = sx_atomic_load64_explicit(&queue->free_list, SX_ATOMIC_MEMORYORDER_RELAXED);
+    uint64_t new_top;
+    do {
+        sx_atomic_store32_explicit(&last_node->next_free, (uint32_t)top, SX_ATOMIC_MEMORYORDER_RELAXED);
+        new_top = (((top >> 32) + 1) << 32) | first;
+    } while (!sx_atomic_compare_exchange64_weak_explicit(&queue->free_list, &top, new_top,
+                                                         SX_ATOMIC_MEMORYORDER_RELEASE,
+                                                         SX_ATOMIC_MEMORYORDER_RELAXED));
+}
+
+static uint32_t sx__queue_mpsc_pop_free(sx_queue_mpsc* queue)
+{
+    unsigned long long top = sx_atomic_load64_explicit(&queue->free_list, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+    for (;;) {
+        uint32_t id = (uint32_t)top;
+        if (id == 0) {
+            return 0;
+        }
+
+        // next_free can be stale if another thread popped the node meanwhile, but then the tag
+        // has also changed and the CAS fails
+        sx__queue_mpsc_node* node = sx__queue_mpsc_node_get(queue, id);
+        uint32_t next = sx_atomic_load32_explicit(&node->next_free, SX_ATOMIC_MEMORYORDER_RELAXED);
+        uint64_t new_top = (((top >> 32) + 1) << 32) | next;
+        if (sx_atomic_compare_exchange64_weak_explicit(&queue->free_list, &top, new_top,
+                                                       SX_ATOMIC_MEMORYORDER_ACQUIRE,
+                                                       SX_ATOMIC_MEMORYORDER_ACQUIRE)) {
+            return id;
+        }
+    }
+}
+
+// allocates the next chunk and returns the first node of it, the rest go to the free-list
+static uint32_t sx__queue_mpsc_grow(sx_queue_mpsc* queue, const sx_alloc* alloc)
+{
+    uint32_t id = 0;
+    sx_lock_enter(&queue->grow_lock);
+
+    // another producer may have already grown the queue while we were waiting for the lock
+    id = sx__queue_mpsc_pop_free(queue);
+    int chunk = queue->num_chunks;
+    // ids are 32bit, so total number of nodes is also limited to 2^31
+    if (id == 0 && chunk < SX__QUEUE_MPSC_MAX_CHUNKS && (queue->chunk_shift + chunk) < 31) {
+        uint32_t count = (uint32_t)1 << (queue->chunk_shift + chunk);
+        uint8_t* buff = (uint8_t*)sx_malloc(alloc, (size_t)queue->stride * count);
+        if (buff) {
+            uint32_t first_id = ((((uint32_t)1 << chunk) - 1) << queue->chunk_shift) + 1;
+            for (uint32_t i = 0; i < count; i++) {
+                sx__queue_mpsc_node* node = (sx__queue_mpsc_node*)(buff + (size_t)queue->stride * i);
+                sx_atomic_store32_explicit(&node->next, 0, SX_ATOMIC_MEMORYORDER_RELAXED);
+                sx_atomic_store32_explicit(&node->next_free, (i + 1) < count ? (first_id + i + 1) : 0,
+                                           SX_ATOMIC_MEMORYORDER_RELAXED);
+            }
+
+            sx_atomic_storeptr_explicit(&queue->chunks[chunk], (uintptr_t)buff,
+                                        SX_ATOMIC_MEMORYORDER_RELEASE);
+            ++queue->num_chunks;
+
+            id = first_id;
+            if (count > 1) {
+                sx__queue_mpsc_push_free(queue, first_id + 1, first_id + count - 1);
+            }
+        } else {
+            sx_out_of_memory();
+        }
+    }
+
+    sx_lock_exit(&queue->grow_lock);
+    return id;
+}
+
+sx_queue_mpsc* sx_queue_mpsc_create(const sx_alloc* alloc, int item_sz, int capacity)
+{
+    sx_assert(item_sz > 0);
+    sx_assert(capacity > 0);
+
+    capacity = sx_max(sx_nearest_pow2(capacity), 16);
+    sx_queue_mpsc* queue = (sx_queue_mpsc*)sx_aligned_malloc(alloc, sizeof(sx_queue_mpsc),
+                                                             SX_CACHE_LINE_SIZE);
+    if (!queue) {
+        sx_out_of_memory();
+        return NULL;
+    }
+    sx_memset(queue, 0x0, sizeof(sx_queue_mpsc));
+
+    queue->alloc = alloc;
+    queue->item_sz = item_sz;
+    queue->stride = (int)sizeof(sx__queue_mpsc_node) + sx_align_mask(item_sz, 7);
+    queue->chunk_shift = sx__queue_mpsc_log2((uint32_t)capacity);
+
+    // initialize stub node
+    uint32_t stub = sx__queue_mpsc_grow(queue, alloc);
+    if (!stub) {
+        sx_aligned_free(alloc, queue, SX_CACHE_LINE_SIZE);
+        return NULL;
+    }
+    sx_atomic_store32_explicit(&queue->head, stub, SX_ATOMIC_MEMORYORDER_RELAXED);
+    queue->tail = stub;
+
+    return queue;
+}
+
+void sx_queue_mpsc_destroy(sx_queue_mpsc* queue, const sx_alloc* alloc)
+{
+    if (queue) {
+        sx_assert(alloc == queue->alloc);
+        for (int i = 0; i < queue->num_chunks; i++) {
+            sx_free(alloc, (void*)(uintptr_t)queue->chunks[i]);
+        }
+        sx_aligned_free(alloc, queue, SX_CACHE_LINE_SIZE);
+    }
+}
+
+bool sx_queue_mpsc_produce(sx_queue_mpsc* queue, const void* data)
+{
+    uint32_t id = sx__queue_mpsc_pop_free(queue);
+    if (id == 0) {
+        id = sx__queue_mpsc_grow(queue, queue->alloc);
+        if (id == 0) {
+            return false;
+        }
+    }
+
+    sx__queue_mpsc_node* node = sx__queue_mpsc_node_get(queue, id);
+    sx_memcpy(node + 1, data, queue->item_sz);
+    sx_atomic_store32_explicit(&node->next, 0, SX_ATOMIC_MEMORYORDER_RELAXED);
+
+    // the consumer can't see the node until prev->next is set, so there is a short window that
+    // the queue looks empty (or cut) to the consumer
+    uint32_t prev = sx_atomic_exchange32_explicit(&queue->head, id, SX_ATOMIC_MEMORYORDER_ACQREL);
+    sx_atomic_store32_explicit(&sx__queue_mpsc_node_get(queue, prev)->next, id,
+                               SX_ATOMIC_MEMORYORDER_RELEASE);
+    return true;
+}
+
+bool sx_queue_mpsc_consume(sx_queue_mpsc* queue, void* data)
+{
+    uint32_t tail = queue->tail;
+    sx__queue_mpsc_node* tail_node = sx__queue_mpsc_node_get(queue, tail);
+    uint32_t next = sx_atomic_load32_explicit(&tail_node->next, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+    if (next == 0) {
+        return false;
+    }
+
+    // next node becomes the new stub, and the old stub is recycled
+    sx_memcpy(data, sx__queue_mpsc_node_get(queue, next) + 1, queue->item_sz);
+    queue->tail = next;
+    sx__queue_mpsc_push_free(queue, tail, tail);
+    return true;
+}
@@ -6,6 +6,15 @@
 #include "sx/string.h"
 #include "sx/allocator.h"
 #include "sx/array.h"
+#include "sx/atomic.h"
+#include "sx/hash.h"
+#include "sx/lockless.h"
+#include "sx/math-scalar.h"
+#include "sx/simd.h"
+
+#if SX_COMPILER_MSVC
+#    include <intrin.h>
+#endif
 
 #define STB_SPRINTF_IMPLEMENTATION
 #define STB_SPRINTF_STATIC
@@ -99,9 +108,185 @@ char* sx_strcpy(char* SX_RESTRICT dst, int dst_sz, const char* SX_RESTRICT src)
     return &dst[num];
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// SIMD helpers for the string functions
+// scanning functions (strlen, strchar, strnlen) only do 16 byte aligned loads, which never cross a
+// page boundary, so they can't fault even if they read past the terminator.
+// compare functions have two pointers with different alignments, so they use unaligned loads and
+// fall back to a byte compare when the next 16 bytes of any of the strings crosses a page.
+// reading past the terminator is intentional, so address sanitizer is disabled for these functions
+#if SX_SIMD_SSE || (SX_SIMD_NEON && SX_ARCH_64BIT)
+#    define SX__STR_SIMD 1
+#else
+#    define SX__STR_SIMD 0
+#endif
+
+#if defined(__has_feature)
+#    if __has_feature(address_sanitizer)
+#        define SX__STR_NO_ASAN __attribute__((no_sanitize_address))
+#    endif
+#endif
+#if !defined(SX__STR_NO_ASAN) && defined(__SANITIZE_ADDRESS__)
+#    define SX__STR_NO_ASAN __attribute__((no_sanitize_address))
+#endif
+#ifndef SX__STR_NO_ASAN
+#    define SX__STR_NO_ASAN
+#endif
+
+#define SX__STR_PAGE_SIZE 4096
+
+#if SX__STR_SIMD
+static inline int sx__str_ctz(uint32_t n)
+{
+    sx_assert(n);
+#    if SX_COMPILER_MSVC
+    unsigned long index;
+    _BitScanForward(&index, n);
+    return (int)index;
+#    else
+    return __builtin_ctz(n);
+#    endif
+}
+
+static inline bool sx__str_page_safe(const char* p)
+{
+    return ((uintptr_t)p & (SX__STR_PAGE_SIZE - 1)) <= (SX__STR_PAGE_SIZE - 16);
+}
+
+#    if SX_SIMD_SSE
+typedef __m128i sx__str_vec;
+
+static inline SX__STR_NO_ASAN sx__str_vec sx__str_load(const char* p)
+{
+    return _mm_load_si128((const __m128i*)p);
+}
+
+static inline SX__STR_NO_ASAN sx__str_vec sx__str_loadu(const char* p)
+{
+    return _mm_loadu_si128((const __m128i*)p);
+}
+
+// returns 16bit mask of the bytes that are equal
+static inline uint32_t sx__str_eq(sx__str_vec a, sx__str_vec b)
+{
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+}
+
+static inline sx__str_vec sx__str_splat(char c)
+{
+    return _mm_set1_epi8(c);
+}
+
+// ascii only, like sx_tolowerchar. bytes >= 0x80 are negative in signed compares, so they are
+// never in range
+static inline sx__str_vec sx__str_tolower(sx__str_vec v)
+{
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+                                  _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+    return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+#    else
+typedef uint8x16_t sx__str_vec;
+
+static inline SX__STR_NO_ASAN sx__str_vec sx__str_load(const char* p)
+{
+    return vld1q_u8((const uint8_t*)p);
+}
+
+static inline SX__STR_NO_ASAN sx__str_vec sx__str_loadu(const char* p)
+{
+    return vld1q_u8((const uint8_t*)p);
+}
+
+static inline uint32_t sx__str_eq(sx__str_vec a, sx__str_vec b)
+{
+    static const uint8_t k_bits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    uint8x16_t bits = vandq_u8(vceqq_u8(a, b), vld1q_u8(k_bits));
+    return (uint32_t)vaddv_u8(vget_low_u8(bits)) | ((uint32_t)vaddv_u8(vget_high_u8(bits)) << 8);
+}
+
+static inline sx__str_vec sx__str_splat(char c)
+{
+    return vdupq_n_u8((uint8_t)c);
+}
+
+static inline sx__str_vec sx__str_tolower(sx__str_vec v)
+{
+    uint8x16_t upper = vandq_u8(vcgeq_u8(v, vdupq_n_u8('A')), vcleq_u8(v, vdupq_n_u8('Z')));
+    return vorrq_u8(v, vandq_u8(upper, vdupq_n_u8(0x20)));
+}
+#    endif    // SX_SIMD_SSE
+
+// first block is aligned down, bytes before `str` are masked out of the results
+static inline SX__STR_NO_ASAN int sx__str_find_zero(const char* str, int _max)
+{
+    const char* p = (const char*)((uintptr_t)str & ~(uintptr_t)15);
+    sx__str_vec zero = sx__str_splat('\0');
+    uint32_t mask = sx__str_eq(sx__str_load(p), zero) >> (uint32_t)(str - p);
+    if (mask) {
+        return sx_min(sx__str_ctz(mask), _max);
+    }
+
+    for (;;) {
+        p += 16;
+        int offset = (int)(intptr_t)(p - str);
+        if (offset >= _max) {
+            return _max;
+        }
+        mask = sx__str_eq(sx__str_load(p), zero);
+        if (mask) {
+            return sx_min(offset + sx__str_ctz(mask), _max);
+        }
+    }
+}
+
+// compares up to `num` characters, stops at the first difference or the terminator
+static inline SX__STR_NO_ASAN bool sx__str_nequal(const char* a, const char* b, int num, bool nocase)
+{
+    sx__str_vec zero = sx__str_splat('\0');
+    while (num > 0) {
+        if (sx__str_page_safe(a) && sx__str_page_safe(b)) {
+            sx__str_vec va = sx__str_loadu(a);
+            sx__str_vec vb = sx__str_loadu(b);
+            if (nocase) {
+                va = sx__str_tolower(va);
+                vb = sx__str_tolower(vb);
+            }
+
+            uint32_t limit = num < 16 ? ((1u << num) - 1) : 0xffff;
+            uint32_t diff = ~sx__str_eq(va, vb) & limit;
+            uint32_t end = sx__str_eq(va, zero) & limit;
+            if (diff | end) {
+                // equal only if the terminator comes before any difference
+                return diff == 0 || (end != 0 && sx__str_ctz(end) < sx__str_ctz(diff));
+            }
+            a += 16;
+            b += 16;
+            num -= 16;
+        } else {
+            char ca = nocase ? sx_tolowerchar(*a) : *a;
+            char cb = nocase ? sx_tolowerchar(*b) : *b;
+            if (ca != cb) {
+                return false;
+            } else if (ca == '\0') {
+                return true;
+            }
+            ++a;
+            ++b;
+            --num;
+        }
+    }
+
+    return true;
+}
+#endif    // SX__STR_SIMD
+
 // https://github.com/lattera/glibc/blob/master/string/strlen.c
-int sx_strlen(const char* str)
+SX__STR_NO_ASAN int sx_strlen(const char* str)
 {
+#if SX__STR_SIMD
+    return sx__str_find_zero(str, INT32_MAX);
+#else
     const char* char_ptr;
     const uintptr_t* longword_ptr;
     uintptr_t longword, himagic, lomagic;
@@ -151,10 +336,14 @@ int sx_strlen(const char* str)
     sx_assertf(0, "Not a null-terminated string");
     return -1;
     #endif
+#endif    // SX__STR_SIMD
 }
 
-static inline int sx__strnlen(const char* str, int _max)
+static inline SX__STR_NO_ASAN int sx__strnlen(const char* str, int _max)
 {
+#if SX__STR_SIMD
+    return _max > 0 ? sx__str_find_zero(str, _max) : 0;
+#else
     const char* char_ptr;
     const uintptr_t* longword_ptr;
     uintptr_t longword, himagic, lomagic;
@@ -210,6 +399,7 @@ static inline int sx__strnlen(const char* str, int _max)
     sx_assertf(0, "Not a null-terminated string");
     return -1;
     #endif
+#endif    // SX__STR_SIMD
 }
 
 char* sx_strncpy(char* SX_RESTRICT dst, int dst_sz, const char* SX_RESTRICT src, int _num)
@@ -269,8 +459,29 @@ const char* sx_strrchar(const char* str, char ch)
 }
 
 // https://github.com/lattera/glibc/blob/master/string/strchr.c
-const char* sx_strchar(const char* str, char ch)
+SX__STR_NO_ASAN const char* sx_strchar(const char* str, char ch)
 {
+#if SX__STR_SIMD
+    const char* p = (const char*)((uintptr_t)str & ~(uintptr_t)15);
+    sx__str_vec zero = sx__str_splat('\0');
+    sx__str_vec c = sx__str_splat(ch);
+    sx__str_vec v = sx__str_load(p);
+    uint32_t mask = (sx__str_eq(v, c) | sx__str_eq(v, zero)) >> (uint32_t)(str - p);
+    if (mask) {
+        p = str + sx__str_ctz(mask);
+        return *p == ch ? p : NULL;
+    }
+
+    for (;;) {
+        p += 16;
+        v = sx__str_load(p);
+        mask = sx__str_eq(v, c) | sx__str_eq(v, zero);
+        if (mask) {
+            p += sx__str_ctz(mask);
+            return *p == ch ? p : NULL;
+        }
+    }
+#else
     const uint8_t* char_ptr;
     uintptr_t* longword_ptr;
     uintptr_t longword, magic_bits, charmask;
@@ -340,6 +551,7 @@ const char* sx_strchar(const char* str, char ch)
     }
 
     return NULL;
+#endif    // SX__STR_SIMD
 }
 
 const char* sx_strstr(const char* SX_RESTRICT str, const char* SX_RESTRICT find)
@@ -416,6 +628,9 @@ bool sx_strstr_wildcard(const char* str, const char* pattern)
 
 bool sx_strequal(const char* SX_RESTRICT a, const char* SX_RESTRICT b)
 {
+#if SX__STR_SIMD
+    return sx__str_nequal(a, b, INT32_MAX, false);
+#else
     int alen = sx_strlen(a);
     int blen = sx_strlen(b);
     if (alen != blen)
@@ -426,10 +641,14 @@ bool sx_strequal(const char* SX_RESTRICT a, const char* SX_RESTRICT b)
             return false;
     }
     return true;
+#endif    // SX__STR_SIMD
 }
 
 bool sx_strequalnocase(const char* SX_RESTRICT a, const char* SX_RESTRICT b)
 {
+#if SX__STR_SIMD
+    return sx__str_nequal(a, b, INT32_MAX, true);
+#else
     int alen = sx_strlen(a);
     int blen = sx_strlen(b);
     if (alen != blen)
@@ -440,10 +659,14 @@ bool sx_strequalnocase(const char* SX_RESTRICT a, const char* SX_RESTRICT b)
             return false;
     }
     return true;
+#endif    // SX__STR_SIMD
 }
 
 bool sx_strnequal(const char* SX_RESTRICT a, const char* SX_RESTRICT b, int num)
 {
+#if SX__STR_SIMD
+    return sx__str_nequal(a, b, num, false);
+#else
     int _alen = sx_strlen(a);
     int _blen = sx_strlen(b);
     int alen = sx_min(num, _alen);
@@ -456,10 +679,14 @@ bool sx_strnequal(const char* SX_RESTRICT a, const char* SX_RESTRICT b, int num)
             return false;
     }
     return true;
+#endif    // SX__STR_SIMD
 }
 
 bool sx_strnequalnocase(const char* SX_RESTRICT a, const char* SX_RESTRICT b, int num)
 {
+#if SX__STR_SIMD
+    return sx__str_nequal(a, b, num, true);
+#else
     int _alen = sx_strlen(a);
     int _blen = sx_strlen(b);
     int alen = sx_min(num, _alen);
@@ -472,6 +699,7 @@ bool sx_strnequalnocase(const char* SX_RESTRICT a, const char* SX_RESTRICT b, in
             return false;
     }
     return true;
+#endif    // SX__STR_SIMD
 }
 
 char sx_tolowerchar(char ch)
@@ -838,3 +1066,281 @@ void sx_strpool_collate_free(const sx_strpool* sp, sx_strpool_collate_data data)
     sx_assert(data.first);
     strpool_free_collated(sp, data.first);
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// strintern
+// strings are distributed to shards by the high bits of their id, every shard has it's own lock,
+// hash table (linear probing) and arena. tables are replaced when they grow, but old ones are kept
+// until destroy, so lock-free readers that still hold the old table are safe
+// arena entries: [int32 len][chars][\0], string pointers point to chars
+#define SX__STRINTERN_NUM_SHARDS 16
+#define SX__STRINTERN_SHARD_SHIFT 60
+#define SX__STRINTERN_ARENA_SIZE 16384
+
+typedef struct sx__strintern_slot {
+    sx_atomic_uint64 id;    // 0 if empty, str is valid after id is published
+    const char* str;
+} sx__strintern_slot;
+
+typedef struct sx__strintern_table {
+    struct sx__strintern_table* prev;
+    uint32_t mask;
+    int _reserved;
+    sx__strintern_slot slots[1];
+} sx__strintern_table;
+
+typedef struct sx__strintern_arena {
+    struct sx__strintern_arena* next;
+    int offset;
+    int size;
+} sx__strintern_arena;
+
+typedef struct sx__strintern_shard {
+    sx_lock_t lock;
+    sx_atomic_ptr table;
+    int count;    // protected by lock
+    sx__strintern_arena* arena;
+} sx__strintern_shard;
+
+typedef struct sx_strintern {
+    const sx_alloc* alloc;
+    sx__strintern_shard shards[SX__STRINTERN_NUM_SHARDS];
+} sx_strintern;
+
+static sx__strintern_table* sx__strintern_create_table(const sx_alloc* alloc, int capacity)
+{
+    sx_assert(sx_ispow2(capacity));
+    sx__strintern_table* table = (sx__strintern_table*)sx_malloc(
+        alloc, sizeof(sx__strintern_table) + sizeof(sx__strintern_slot) * (capacity - 1));
+    if (!table) {
+        sx_out_of_memory();
+        return NULL;
+    }
+
+    table->prev = NULL;
+    table->mask = (uint32_t)capacity - 1;
+    sx_memset(table->slots, 0x0, sizeof(sx__strintern_slot) * capacity);
+    return table;
+}
+
+static const char* sx__strintern_lookup(const sx__strintern_table* table, sx_strid_t id)
+{
+    for (uint32_t i = (uint32_t)id & table->mask;; i = (i + 1) & table->mask) {
+        const sx__strintern_slot* slot = &table->slots[i];
+        uint64_t slot_id = sx_atomic_load64_explicit((sx_atomic_uint64*)&slot->id,
+                                                     SX_ATOMIC_MEMORYORDER_ACQUIRE);
+        if (slot_id == id) {
+            return slot->str;
+        } else if (slot_id == 0) {
+            return NULL;
+        }
+    }
+}
+
+// ids are hashes, so a matching id is only a hit if the stored string is also the same
+static bool sx__strintern_equal(const char* interned, const char* str, int len)
+{
+    return *((const int32_t*)interned - 1) == len && sx_memcmp(interned, str, len) == 0;
+}
+
+// only called with the shard locked, table must have free slots
+static void sx__strintern_insert(sx__strintern_table* table, sx_strid_t id, const char* str)
+{
+    uint32_t i = (uint32_t)id & table->mask;
+    while (table->slots[i].id != 0) {
+        i = (i + 1) & table->mask;
+    }
+    table->slots[i].str = str;
+    sx_atomic_store64_explicit(&table->slots[i].id, id, SX_ATOMIC_MEMORYORDER_RELEASE);
+}
+
+static const char* sx__strintern_arena_copy(sx__strintern_shard* shard, const sx_alloc* alloc,
+                                            const char* str, int len)
+{
+    int size = sx_align_mask((int)sizeof(int32_t) + len + 1, 3);
+    sx__strintern_arena* arena = shard->arena;
+    if (!arena || (arena->offset + size) > arena->size) {
+        int arena_size = sx_max(SX__STRINTERN_ARENA_SIZE, size);
+        arena = (sx__strintern_arena*)sx_malloc(alloc, sizeof(sx__strintern_arena) + arena_size);
+        if (!arena) {
+            sx_out_of_memory();
+            return NULL;
+        }
+        arena->next = shard->arena;
+        arena->offset = 0;
+        arena->size = arena_size;
+        shard->arena = arena;
+    }
+
+    uint8_t* buff = (uint8_t*)(arena + 1) + arena->offset;
+    arena->offset += size;
+    *((int32_t*)buff) = len;
+    char* dst = (char*)(buff + sizeof(int32_t));
+    sx_memcpy(dst, str, len);
+    dst[len] = '\0';
+    return dst;
+}
+
+// only called with the shard locked, returns 0 if out of memory
+static sx_strid_t sx__strintern_insert_locked(sx_strintern* si, sx__strintern_shard* shard,
+                                              sx__strintern_table* table, sx_strid_t id,
+                                              const char* str, int len)
+{
+    // keep the load factor under 0.5, so probe chains of misses stay short
+    if ((shard->count + 1) * 2 > (int)(table->mask + 1)) {
+        sx__strintern_table* new_table =
+            sx__strintern_create_table(si->alloc, (int)(table->mask + 1) << 1);
+        if (new_table) {
+            for (uint32_t i = 0; i <= table->mask; i++) {
+                if (table->slots[i].id) {
+                    sx__strintern_insert(new_table, table->slots[i].id, table->slots[i].str);
+                }
+            }
+            new_table->prev = table;
+            sx_atomic_storeptr_explicit(&shard->table, (uintptr_t)new_table,
+                                        SX_ATOMIC_MEMORYORDER_RELEASE);
+            table = new_table;
+        } else if ((shard->count + 1) > (int)table->mask) {
+            id = 0;    // out of memory, and the table is full
+        }
+    }
+
+    const char* copy = id ? sx__strintern_arena_copy(shard, si->alloc, str, len) : NULL;
+    if (copy) {
+        sx__strintern_insert(table, id, copy);
+        ++shard->count;
+    } else {
+        id = 0;
+    }
+    return id;
+}
+
+sx_strintern* sx_strintern_create(const sx_alloc* alloc, int capacity)
+{
+    sx_strintern* si = (sx_strintern*)sx_aligned_malloc(alloc, sizeof(sx_strintern), SX_CACHE_LINE_SIZE);
+    if (!si) {
+        sx_out_of_memory();
+        return NULL;
+    }
+    sx_memset(si, 0x0, sizeof(sx_strintern));
+    si->alloc = alloc;
+
+    int shard_capacity = sx_max(sx_nearest_pow2(capacity * 2 / SX__STRINTERN_NUM_SHARDS), 16);
+    for (int i = 0; i < SX__STRINTERN_NUM_SHARDS; i++) {
+        sx__strintern_table* table = sx__strintern_create_table(alloc, shard_capacity);
+        if (!table) {
+            sx_strintern_destroy(si, alloc);
+            return NULL;
+        }
+        si->shards[i].table = (uintptr_t)table;
+    }
+
+    return si;
+}
+
+void sx_strintern_destroy(sx_strintern* si, const sx_alloc* alloc)
+{
+    if (si) {
+        sx_assert(alloc == si->alloc);
+        for (int i = 0; i < SX__STRINTERN_NUM_SHARDS; i++) {
+            sx__strintern_shard* shard = &si->shards[i];
+            sx__strintern_table* table = (sx__strintern_table*)shard->table;
+            while (table) {
+                sx__strintern_table* prev = table->prev;
+                sx_free(alloc, table);
+                table = prev;
+            }
+
+            sx__strintern_arena* arena = shard->arena;
+            while (arena) {
+                sx__strintern_arena* next = arena->next;
+                sx_free(alloc, arena);
+                arena = next;
+            }
+        }
+        sx_aligned_free(alloc, si, SX_CACHE_LINE_SIZE);
+    }
+}
+
+sx_strid_t sx_strintern_hash(const char* str, int len)
+{
+    if (len < 0) {
+        len = sx_strlen(str);
+    }
+    sx_strid_t id = sx_hash_xxh64(str, (size_t)len, 0);
+    return id != 0 ? id : 1;    // zero is reserved for empty slots and 'not found'
+}
+
+sx_strid_t sx_strintern_add(sx_strintern* si, const char* str, int len)
+{
+    if (len < 0) {
+        len = sx_strlen(str);
+    }
+    sx_strid_t id = sx_strintern_hash(str, len);
+    sx__strintern_shard* shard = &si->shards[id >> SX__STRINTERN_SHARD_SHIFT];
+
+    // fast path: string is already interned, no locks
+    sx__strintern_table* table = (sx__strintern_table*)sx_atomic_loadptr_explicit(
+        &shard->table, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+    const char* interned = sx__strintern_lookup(table, id);
+    if (!interned) {
+        sx_lock_enter(&shard->lock);
+
+        // search again, another thread might have added the same string while we were waiting
+        table = (sx__strintern_table*)shard->table;
+        interned = sx__strintern_lookup(table, id);
+        if (!interned) {
+            id = sx__strintern_insert_locked(si, shard, table, id, str, len);
+        }
+
+        sx_lock_exit(&shard->lock);
+    }
+
+    if (interned && !sx__strintern_equal(interned, str, len)) {
+        // different string with the same id, reported in all builds because ids can't be told apart
+        sx__debug_message(__FILE__, __LINE__, "strintern: hash collision between '%s' and '%.*s'",
+                          interned, len, str);
+        return 0;
+    }
+    return id;
+}
+
+sx_strid_t sx_strintern_find(const sx_strintern* si, const char* str, int len)
+{
+    if (len < 0) {
+        len = sx_strlen(str);
+    }
+    sx_strid_t id = sx_strintern_hash(str, len);
+    const char* interned = sx_strintern_cstr(si, id);
+    return (interned && sx__strintern_equal(interned, str, len)) ? id : 0;
+}
+
+const char* sx_strintern_cstr(const sx_strintern* si, sx_strid_t id)
+{
+    if (id == 0) {
+        return NULL;
+    }
+
+    sx__strintern_shard* shard = (sx__strintern_shard*)&si->shards[id >> SX__STRINTERN_SHARD_SHIFT];
+    sx__strintern_table* table = (sx__strintern_table*)sx_atomic_loadptr_explicit(
+        &shard->table, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+    return sx__strintern_lookup(table, id);
+}
+
+int sx_strintern_len(const sx_strintern* si, sx_strid_t id)
+{
+    const char* str = sx_strintern_cstr(si, id);
+    return str ? *((const int32_t*)str - 1) : 0;
+}
+
+int sx_strintern_count(const sx_strintern* si)
+{
+    int count = 0;
+    for (int i = 0; i < SX__STRINTERN_NUM_SHARDS; i++) {
+        sx__strintern_shard* shard = (sx__strintern_shard*)&si->shards[i];
+        sx_lock_enter(&shard->lock);
+        count += shard->count;
+        sx_lock_exit(&shard->lock);
+    }
+    return count;
+}